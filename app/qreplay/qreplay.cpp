@@ -0,0 +1,169 @@
+#include <iostream>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <sff/sac/waveform.hpp>
+#include <sff/utilities/time.hpp>
+#include "qphase/ingest/packet.hpp"
+#include "qphase/ingest/replayer.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include "private/removeBlanksAndCapitalize.hpp"
+
+/// @brief Streams archived SAC files to a QPhase ingest server as though the
+///        data were arriving from digitizers, optionally faster than real
+///        time.
+
+namespace
+{
+
+/// @result The packets of one SAC file.
+std::vector<QPhase::Ingest::Packet>
+    sacToPackets(const std::string &fileName, const int samplesPerPacket)
+{
+    SFF::SAC::Waveform sacWaveform;
+    sacWaveform.read(fileName);
+    auto network = sacWaveform.getHeader(SFF::SAC::Character::KNETWK);
+    auto station = sacWaveform.getHeader(SFF::SAC::Character::KSTNM);
+    auto channel = sacWaveform.getHeader(SFF::SAC::Character::KCMPNM);
+    auto locationCode = sacWaveform.getHeader(SFF::SAC::Character::KHOLE);
+    network = removeBlanksAndCapitalize(network);
+    station = removeBlanksAndCapitalize(station);
+    channel = removeBlanksAndCapitalize(channel);
+    locationCode = removeBlanksAndCapitalize(locationCode);
+    if (network == "-12345" || station == "-12345" || channel == "-12345")
+    {
+        throw std::invalid_argument("Network, station, or channel not set");
+    }
+    if (locationCode == "-12345"){locationCode = "01";}
+    QPhase::Waveforms::Segment<double> segment;
+    segment.setSamplingRate(sacWaveform.getSamplingRate());
+    segment.setStartTime(sacWaveform.getStartTime().getEpoch());
+    segment.setData(sacWaveform.getNumberOfSamples(),
+                    sacWaveform.getDataPointer());
+    QPhase::Waveforms::Waveform<double> waveform;
+    waveform.setSegments(std::move(segment));
+    return QPhase::Ingest::Replayer::makePackets(waveform, network, station,
+                                                 channel, locationCode,
+                                                 samplesPerPacket);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    namespace po = boost::program_options;
+    po::options_description description(
+        "Streams SAC files to a QPhase ingest server.\nOptions");
+    description.add_options()
+        ("help", "Produces this help message.")
+        ("port", po::value<uint16_t> ()->required(),
+         "The port on which the server is listening.")
+        ("address", po::value<std::string> ()->default_value("127.0.0.1"),
+         "The IPv4 address of the server.")
+        ("speed", po::value<double> ()->default_value(1),
+         "Packets are sent at this multiple of real time.  If this is not "
+         "positive then packets are sent as fast as possible.")
+        ("samples-per-packet", po::value<int> ()->default_value(512),
+         "The number of samples in each packet.")
+        ("loop", po::value<int> ()->default_value(1),
+         "The number of times to replay the files.  Each pass is shifted "
+         "forward in time so the server sees continuous data.")
+        ("files", po::value<std::vector<std::string>> ()->multitoken()
+                                                        ->required(),
+         "The SAC files to replay.");
+    po::positional_options_description positional;
+    positional.add("files", -1);
+    po::variables_map variables;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv)
+                  .options(description).positional(positional).run(),
+                  variables);
+        if (variables.count("help"))
+        {
+            std::cout << description << std::endl;
+            return EXIT_SUCCESS;
+        }
+        po::notify(variables);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl << description << std::endl;
+        return EXIT_FAILURE;
+    }
+    auto port = variables["port"].as<uint16_t> ();
+    auto address = variables["address"].as<std::string> ();
+    auto speed = variables["speed"].as<double> ();
+    auto samplesPerPacket = variables["samples-per-packet"].as<int> ();
+    auto nLoops = variables["loop"].as<int> ();
+
+    std::vector<QPhase::Ingest::Packet> packets;
+    for (const auto &fileName : variables["files"].as<std::vector<std::string>> ())
+    {
+        if (!std::filesystem::exists(fileName))
+        {
+            std::cerr << fileName << " does not exist" << std::endl;
+            continue;
+        }
+        try
+        {
+            auto filePackets = sacToPackets(fileName, samplesPerPacket);
+            packets.insert(packets.end(),
+                           std::make_move_iterator(filePackets.begin()),
+                           std::make_move_iterator(filePackets.end()));
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to load " << fileName << ": "
+                      << e.what() << std::endl;
+        }
+    }
+    if (packets.empty())
+    {
+        std::cerr << "No packets to replay" << std::endl;
+        return EXIT_FAILURE;
+    }
+    // Each loop starts where the previous one ended
+    auto earliest = packets.front().startTime;
+    auto latest = packets.front().startTime;
+    int64_t nSamples = 0;
+    for (const auto &packet : packets)
+    {
+        earliest = std::min(earliest, packet.startTime);
+        auto duration = std::chrono::microseconds {static_cast<int64_t>
+                        (packet.data.size()*packet.samplingRateDenominator*1.e6
+                        /packet.samplingRateNumerator)};
+        latest = std::max(latest, packet.startTime + duration);
+        nSamples = nSamples + static_cast<int64_t> (packet.data.size());
+    }
+    auto loopShift = latest - earliest;
+
+    QPhase::Ingest::Replayer replayer;
+    try
+    {
+        replayer.connect(port, address);
+        for (int loop = 0; loop < nLoops; ++loop)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto nBytes = replayer.replay(packets, speed);
+            std::chrono::duration<double> elapsed
+                = std::chrono::steady_clock::now() - start;
+            std::cout << "Sent " << packets.size() << " packets ("
+                      << nSamples << " samples, " << nBytes << " bytes) in "
+                      << elapsed.count() << " s" << std::endl;
+            for (auto &packet : packets)
+            {
+                packet.startTime = packet.startTime + loopShift;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Replay failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#ifndef PRIVATE_ALIGNEDALLOCATOR_HPP
+#define PRIVATE_ALIGNEDALLOCATOR_HPP
+#include <cstddef>
+#include <new>
+namespace
+{
+/// @brief A standard library allocator that returns memory aligned to the
+///        given boundary.  The default of 64 bytes is a cache line and the
+///        width of an AVX-512 register.
+template<typename T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+public:
+    using value_type = T;
+    template<typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    explicit AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept
+    {
+    }
+    [[nodiscard]] T *allocate(const std::size_t n)
+    {
+        return static_cast<T *> (::operator new(n*sizeof(T),
+                                                std::align_val_t {Alignment}));
+    }
+    void deallocate(T *p, const std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t {Alignment});
+    }
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept
+    {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept
+    {
+        return false;
+    }
+};
+}
+#endif
@@ -1,9 +1,22 @@
 #ifndef PRIVATE_DATABASE_UTILITIES_HPP
 #define PRIVATE_DATABASE_UTILITIES_HPP
 #include <ostream>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
 #include <soci/soci.h>
 namespace
 {
+/// All times (arrival.time, origin.time, waveform.ontime/offtime,
+/// station_data.ondate/offdate) are stored as INTEGER microseconds since
+/// the epoch.  Queries fetch this many rows per round trip into typed
+/// column vectors.
+constexpr std::size_t QUERY_BATCH_SIZE{256};
+/// The schema version recorded in PRAGMA user_version.  Version 0 stored
+/// the microseconds in DOUBLE columns.
+constexpr int SCHEMA_VERSION{1};
+
 class BigInt
 {
 public:
@@ -35,8 +48,8 @@ CREATE TABLE IF NOT EXISTS station_data (
  latitude DOUBLE PRECISION NOT NULL CHECK(latitude >= -90 AND latitude <= 90),
  longitude DOUBLE PRECISION NOT NULL, 
  elevation DOUBLE PRECISION,
- ondate DOUBLE NOT NULL,
- offdate DOUBLE NOT NULL CHECK(ondate < offdate),
+ ondate INTEGER NOT NULL,
+ offdate INTEGER NOT NULL CHECK(ondate < offdate),
  description VARCHAR(256) DEFAULT '',
  lddate TIMESTAMP CURRENT_TIMESTAMP
  );
@@ -54,8 +67,8 @@ CREATE TABLE IF NOT EXISTS channel_data (
  sampling_rate DOUBLE PRECISION CHECK(sampling_rate > 0),
  azimuth DOUBLE PRECISION CHECK(azimuth >= 0 AND azimuth < 360),
  dip DOUBLE PRECISION CHECK(dip >= -90 AND dip <= 90),
- ondate DOUBLE NOT NULL,
- offdate DOUBLE NOT NULL CHECK(ondate < offdate),
+ ondate INTEGER NOT NULL,
+ offdate INTEGER NOT NULL CHECK(ondate < offdate),
  lddate TIMESTAMP CURRENT_TIMESTAMP
 );
 )""";
@@ -73,7 +86,7 @@ CREATE TABLE IF NOT EXISTS origin (
  latitude DOUBLE PRECISION NOT NULL CHECK(latitude >= -90 AND latitude < 90),
  longitude DOUBLE PRECISION NOT NULL,
  depth DOUBLE PRECISION NOT NULL CHECK(depth > -10 AND depth < 1000),
- time DOUBLE NOT NULL,
+ time INTEGER NOT NULL,
  authority VARCHAR(128) DEFAULT 'UU',
  lddate TIMESTAMP CURRENT_TIMESTAMP
  );
@@ -86,7 +99,7 @@ CREATE TABLE IF NOT EXISTS arrival (
  station VARCHAR(32) NOT NULL,
  channel VARCHAR(32) NOT NULL,
  location_code VARCHAR(32) NOT NULL DEFAULT '01',
- time DOUBLE NOT NULL,
+ time INTEGER NOT NULL,
  phase VARCHAR(8) NOT NULL,
  first_motion INTEGER DEFAULT 0,
  review_status VARCHAR(1) DEFAULT 'A',
@@ -102,8 +115,8 @@ CREATE TABLE IF NOT EXISTS waveform (
  channel VARCHAR(32) NOT NULL,
  location_code VARCHAR(32) NOT NULL DEFAULT '01',
  event_identifier INTEGER,
- ontime DOUBLE NOT NULL,
- offtime DOUBLE NOT NULL CHECK(ontime < offtime),
+ ontime INTEGER NOT NULL,
+ offtime INTEGER NOT NULL CHECK(ontime < offtime),
  filename TEXT NOT NULL,
  lddate TIMESTAMP CURRENT_TIMESTAMP,
  FOREIGN KEY(event_identifier) REFERENCES event(identifier)
@@ -121,13 +134,93 @@ CREATE TABLE IF NOT EXISTS event (
  FOREIGN KEY(preferred_magnitude) REFERENCES magnitude(identifier)
  );
 )""";
-    session << stationData;
-    session << channelData;
-    session << magnitude;
-    session << origin;
-    session << arrival;
-    session << waveform;
-    session << event;
+    const std::vector<std::pair<std::string, std::string>> tables{
+        {"station_data", stationData},
+        {"channel_data", channelData},
+        {"magnitude", magnitude},
+        {"origin", origin},
+        {"arrival", arrival},
+        {"waveform", waveform},
+        {"event", event}};
+    const std::vector<std::pair<std::string, std::vector<std::string>>>
+        timeColumns{{"station_data", {"ondate", "offdate"}},
+                    {"channel_data", {"ondate", "offdate"}},
+                    {"origin", {"time"}},
+                    {"arrival", {"time"}},
+                    {"waveform", {"ontime", "offtime"}}};
+    int version{0};
+    session << "PRAGMA user_version;", soci::into(version);
+    if (version < SCHEMA_VERSION)
+    {
+        // SQLite can not change a column's type so tables made by version 0
+        // are rebuilt with their times rounded to integers.  Foreign key
+        // enforcement would otherwise block dropping the old tables.
+        session << "PRAGMA foreign_keys = OFF;";
+        soci::transaction transaction(session);
+        for (const auto &[table, columns] : timeColumns)
+        {
+            std::vector<std::string> names;
+            bool isVersion0{false};
+            soci::rowset<soci::row> rows
+                = (session.prepare << "PRAGMA table_info(" + table + ");");
+            for (const auto &row : rows)
+            {
+                auto name = row.get<std::string> ("name");
+                auto type = row.get<std::string> ("type");
+                names.push_back(name);
+                if (type != "INTEGER" &&
+                    std::find(columns.begin(), columns.end(), name)
+                    != columns.end())
+                {
+                    isVersion0 = true;
+                }
+            }
+            if (!isVersion0){continue;}
+            std::string selection;
+            std::string insertion;
+            for (const auto &name : names)
+            {
+                if (!selection.empty())
+                {
+                    selection = selection + ", ";
+                    insertion = insertion + ", ";
+                }
+                insertion = insertion + name;
+                if (std::find(columns.begin(), columns.end(), name)
+                    != columns.end())
+                {
+                    selection = selection
+                              + "CAST(ROUND(" + name + ") AS INTEGER)";
+                }
+                else
+                {
+                    selection = selection + name;
+                }
+            }
+            auto definition = std::find_if(tables.begin(), tables.end(),
+                                           [&table = table](const auto &t)
+                                           {
+                                               return t.first == table;
+                                           })->second;
+            auto migration = table + "_migration";
+            definition.replace(definition.find(table), table.size(),
+                               migration);
+            session << definition;
+            session << "INSERT INTO " + migration + "(" + insertion + ") "
+                     + "SELECT " + selection + " FROM " + table + ";";
+            session << "DROP TABLE " + table + ";";
+            session << "ALTER TABLE " + migration + " RENAME TO "
+                     + table + ";";
+        }
+        for (const auto &table : tables){session << table.second;}
+        session << "PRAGMA user_version = " + std::to_string(SCHEMA_VERSION)
+                 + ";";
+        transaction.commit();
+    }
+    else
+    {
+        for (const auto &table : tables){session << table.second;}
+    }
 }
 
 [[maybe_unused]]
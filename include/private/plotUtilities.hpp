@@ -7,10 +7,13 @@
 #include <cassert>
 #endif
 #include <QLine>
+#include <QPainter>
+#include <QPolygonF>
 #include <QVector>
 #include "qphase/waveforms/segment.hpp"
 #include "qphase/waveforms/waveform.hpp"
 #include "qphase/waveforms/channel.hpp"
+#include "qphase/processing/kernels.hpp"
 namespace
 {
 /// @brief Transforms
@@ -80,9 +83,9 @@ std::pair<T, T> getMinMaxForPlotting(const double plotT0,
     // Trace wholly contained in plot
     if (traceT0 >= plotT0 && traceT1 <= plotT1)
     {
-        auto [vMin, vMax] = std::minmax_element(signal, signal + nSamples);
-        smallestValue = std::min(smallestValue, *vMin);
-        largestValue  = std::max(largestValue,  *vMax);
+        auto [vMin, vMax] = QPhase::Processing::minMax(nSamples, signal);
+        smallestValue = std::min(smallestValue, vMin);
+        largestValue  = std::max(largestValue,  vMax);
     }
     else
     {
@@ -92,10 +95,12 @@ std::pair<T, T> getMinMaxForPlotting(const double plotT0,
        auto i2 = static_cast<int> ( std::ceil( (plotT1 - traceT0)
                                                /samplingPeriod) ) + 1;
        i2 = std::min(nSamples, i2);
-       for (int i = i1; i < i2; ++i)
+       if (i2 > i1)
        {
-            smallestValue = std::min(smallestValue, signal[i]);
-            largestValue  = std::max(largestValue,  signal[i]);
+           auto [vMin, vMax]
+               = QPhase::Processing::minMax(i2 - i1, signal + i1);
+           smallestValue = std::min(smallestValue, vMin);
+           largestValue  = std::max(largestValue,  vMax);
        }
     }
     return std::pair(smallestValue, largestValue);
@@ -118,22 +123,72 @@ std::pair<T, T> getMinMaxForPlotting(const QPhase::Waveforms::Segment<T> &segmen
 
 template<typename T>
 [[nodiscard]] [[maybe_unused]]
-std::pair<T, T> getMinMaxForPlotting(const QPhase::Waveforms::Channel<T> &channel,
+std::pair<T, T> getMinMaxForPlotting(const QPhase::Waveforms::Waveform<T> &waveform,
                                      const std::chrono::microseconds &plotT0MuS,
                                      const std::chrono::microseconds &plotT1MuS)
 {
     T vMin = std::numeric_limits<T>::max();
     T vMax = std::numeric_limits<T>::lowest();
-    auto waveform = channel.getWaveformReference();
-    for (const auto &segment : waveform)
+    // Only visit the samples in the plot window
+    for (const auto &window : waveform.samplesIn(plotT0MuS, plotT1MuS))
     {
-        auto [v0, v1] = getMinMaxForPlotting(segment, plotT0MuS, plotT1MuS);
+        const auto signal = waveform[window.segment].getDataPointer();
+        if (window.endIndex <= window.startIndex){continue;}
+        auto [v0, v1]
+            = QPhase::Processing::minMax(window.endIndex - window.startIndex,
+                                         signal + window.startIndex);
         vMin = std::min(vMin, v0);
         vMax = std::max(vMax, v1);
     }
     return std::pair(vMin, vMax);
 }
 
+template<typename T>
+[[nodiscard]] [[maybe_unused]]
+std::pair<T, T> getMinMaxForPlotting(const QPhase::Waveforms::Channel<T> &channel,
+                                     const std::chrono::microseconds &plotT0MuS,
+                                     const std::chrono::microseconds &plotT1MuS)
+{
+    return getMinMaxForPlotting(channel.getWaveformReference(),
+                                plotT0MuS, plotT1MuS);
+}
+
+
+/// @brief The drawing of a waveform segment.  Densely sampled data is drawn
+///        as a vertical line per pixel spanning the samples' extrema and
+///        sparsely sampled data as a polyline through the samples.
+struct SegmentLines
+{
+    /// The vertical lines when decimating.
+    QVector<QLineF> lines;
+    /// The polyline through the samples when not decimating.
+    QPolygonF polyline;
+};
+
+/// @brief The drawings of a waveform's segments.  The buffers retain their
+///        capacity when refilled so redrawing a plot does not allocate once
+///        the buffers have grown to fit it.
+struct WaveformLines
+{
+    /// @brief Marks the segments as unused.  Their memory is kept.
+    void clear() noexcept
+    {
+        nSegments = 0;
+    }
+    /// @result The buffers for the next segment.
+    [[nodiscard]] SegmentLines &next()
+    {
+        if (nSegments == static_cast<int> (segments.size()))
+        {
+            segments.push_back(SegmentLines {});
+        }
+        nSegments = nSegments + 1;
+        return segments[nSegments - 1];
+    }
+    /// The buffers.  Only the first nSegments are in use.
+    QVector<SegmentLines> segments;
+    int nSegments{0};
+};
 
 /// @brief Creates the lines comprising a waveform.
 /// @param[in] plotT0          The start time of the plot in seconds.
@@ -151,22 +206,29 @@ std::pair<T, T> getMinMaxForPlotting(const QPhase::Waveforms::Channel<T> &channe
 ///                            go 95 pct of the way to the plot min/max
 ///                            available vertical space.
 /// @param[in] range           This forces the plot to be in a custom range.
+///                            If NULL then the signal's range in the plot
+///                            is used.
+/// @param[out] lines          The lines or the polyline.  These are
+///                            overwritten and their capacity is reused.
 template<typename T>
-QVector<QLineF> createLines(const double plotT0, const double plotT1,
-                            const double traceT0, const double traceT1,
-                            const double dt,
-                            const int nSamples, const T *__restrict__ signal,
-                            const qreal plotWidth,
-                            const qreal plotHeight,
-                            const qreal heightFraction = 0.95,
-                            const std::pair<T, T> *range = nullptr)
+void createLines(const double plotT0, const double plotT1,
+                 const double traceT0, const double traceT1,
+                 const double dt,
+                 const int nSamples, const T *__restrict__ signal,
+                 const qreal plotWidth,
+                 const qreal plotHeight,
+                 const qreal heightFraction,
+                 const std::pair<T, T> *range,
+                 SegmentLines *lines)
 {
     constexpr qreal qZero = 0;
-    QVector<QLineF> lines;
+    // Shrinking keeps the capacity
+    lines->lines.resize(0);
+    lines->polyline.resize(0);
     // No data or plot isn't in the window
     if (plotT0 > traceT1 || plotT1 < traceT0 || dt == 0 || nSamples < 1)
     {
-        return lines;
+        return;
     }
     if (signal == nullptr){throw std::runtime_error("Signal is NULL");} 
     auto nPixels = static_cast<int> (plotWidth);
@@ -201,10 +263,14 @@ QVector<QLineF> createLines(const double plotT0, const double plotT1,
     qreal sMax = 1;
     if (range == nullptr)
     {
-        auto [sMinPtr, sMaxPtr] = std::minmax_element(signal + traceStartIndex,
-                                                      signal + traceEndIndex);
-        sMin = static_cast<qreal> (*sMinPtr);
-        sMax = static_cast<qreal> (*sMaxPtr);
+        if (traceEndIndex > traceStartIndex)
+        {
+            auto [vMin, vMax]
+                = QPhase::Processing::minMax(traceEndIndex - traceStartIndex,
+                                             signal + traceStartIndex);
+            sMin = static_cast<qreal> (vMin);
+            sMax = static_cast<qreal> (vMax);
+        }
     }
     else
     {
@@ -224,8 +290,8 @@ QVector<QLineF> createLines(const double plotT0, const double plotT1,
     // Decimate
     if (step > 5)
     {
-        lines.resize(nPixels);
-        auto linesPtr = lines.data();
+        lines->lines.resize(nPixels);
+        auto linesPtr = lines->lines.data();
         for (int l = 0; l < nPixels; ++l)
         {
             int i1 = traceStartIndex
@@ -266,29 +332,23 @@ QVector<QLineF> createLines(const double plotT0, const double plotT1,
                                 t1, std::min(s2, s2Next));
         }
     }
-    else // Do not decimate
+    else if (nLinesPlot > 0) // Do not decimate
     {
-        lines.resize(std::max(0, nLinesPlot));
-        auto linesPtr = lines.data();
-        for (int it = traceStartIndex; it < traceEndIndex - 1; ++it)
+        // Consecutive samples share a vertex
+        lines->polyline.resize(nLinesPlot + 1);
+        auto pointsPtr = lines->polyline.data();
+        for (int it = traceStartIndex; it < traceEndIndex; ++it)
         {
-            auto sampleTime1 = static_cast<qreal> (traceT0 + it*dt);
-            auto sampleTime2 = static_cast<qreal> (traceT0 + (it + 1)*dt);
-            auto t1 = minMaxRescale(sampleTime1, qZero, plotWidth,
-                                    qPlotT0, qPlotInv);
-            auto t2 = minMaxRescale(sampleTime2, qZero, plotWidth,
-                                    qPlotT0, qPlotInv);
+            auto sampleTime = static_cast<qreal> (traceT0 + it*dt);
+            auto t = minMaxRescale(sampleTime, qZero, plotWidth,
+                                   qPlotT0, qPlotInv);
             // Reverse target min/max so as to flip y (i.e., +y is plotted up)
-            auto s1 = minMaxRescale(static_cast<qreal> (signal[it]),
-                                    heightMax, heightMin,
-                                    sMin, dsInv);
-            auto s2 = minMaxRescale(static_cast<qreal> (signal[it+1]),
-                                    heightMax, heightMin,
-                                    sMin, dsInv);
-            linesPtr[it - traceStartIndex].setLine(t1, s1, t2, s2);
+            auto s = minMaxRescale(static_cast<qreal> (signal[it]),
+                                   heightMax, heightMin,
+                                   sMin, dsInv);
+            pointsPtr[it - traceStartIndex] = QPointF(t, s);
         }
     }
-    return lines;
 }
 /// @brief Creates the lines comprising a waveform segment.
 /// @param[in] plotT0          The start time of the plot in microseconds.
@@ -300,38 +360,32 @@ QVector<QLineF> createLines(const double plotT0, const double plotT1,
 ///                            go 95 pct of the way to the plot min/max
 ///                            available vertical space.
 /// @param[in] range           This forces the plot to be in a custom range.
+/// @param[out] lines          The lines or the polyline of the segment.
 template<typename T>
-QVector<QLineF> createLines(const QPhase::Waveforms::Segment<T> &segment,
-                            const std::chrono::microseconds &plotT0MuS,
-                            const std::chrono::microseconds &plotT1MuS,
-                            const qreal plotWidth,
-                            const qreal plotHeight,
-                            const qreal heightFraction = 0.95,
-                            const std::pair<T, T> *range = nullptr)
+void createLines(const QPhase::Waveforms::Segment<T> &segment,
+                 const std::chrono::microseconds &plotT0MuS,
+                 const std::chrono::microseconds &plotT1MuS,
+                 const qreal plotWidth,
+                 const qreal plotHeight,
+                 const qreal heightFraction,
+                 const std::pair<T, T> *range,
+                 SegmentLines *lines)
 {
-    QVector<QLineF> lines;
     double plotT0 = plotT0MuS.count()*1.e-6;
     double plotT1 = plotT1MuS.count()*1.e-6;
     double traceT0 = segment.getStartTime().count()*1.e-6;
     double traceT1 = segment.getEndTime().count()*1.e-6;
-/*
-std::cout << "faking it:" << " " << plotT0 << " " << plotT1 << std::endl;
-plotT0= traceT0;
-plotT1= traceT1;
-std::cout << std::setprecision(16) << plotT0 << " " << plotT1 << " " << traceT0 << " " << traceT1 << std::endl;
-*/
     double dt = segment.getSamplingPeriod();
     auto nSamples = segment.getNumberOfSamples(); 
     const auto signal = segment.getDataPointer();
-    lines = createLines(plotT0, plotT1,
-                        traceT0, traceT1,
-                        dt, nSamples, signal,
-                        plotWidth, plotHeight,
-                        heightFraction,
-                        range);
-    return lines;
+    createLines(plotT0, plotT1,
+                traceT0, traceT1,
+                dt, nSamples, signal,
+                plotWidth, plotHeight,
+                heightFraction,
+                range, lines);
 }
-/// @brief Creates the lines comprising a waveform segment.
+/// @brief Creates the lines comprising a waveform.
 /// @param[in] plotT0          The start time of the plot in microseconds.
 /// @param[in] plotT1          The end time of the plot in microseconds.
 /// @param[in] plotWidth       The number of horizontal pixels.
@@ -341,36 +395,90 @@ std::cout << std::setprecision(16) << plotT0 << " " << plotT1 << " " << traceT0
 ///                            go 95 pct of the way to the plot min/max
 ///                            available vertical space.
 /// @param[in] range           This forces the plot to be in a custom range.
+/// @param[out] lines          The lines of each segment in the plot.  The
+///                            buffers of a previous call are reused.
 template<typename T>
-QVector<QVector<QLineF>>
-    createLines(const QPhase::Waveforms::Channel<T> &channel,
-                const std::chrono::microseconds &plotT0MuS,
-                const std::chrono::microseconds &plotT1MuS,
-                const qreal plotWidth,
-                const qreal plotHeight,
-                const qreal heightFraction = 0.95,
-                const std::pair<T, T> *range = nullptr)
+void createLines(const QPhase::Waveforms::Waveform<T> &waveform,
+                 const std::chrono::microseconds &plotT0MuS,
+                 const std::chrono::microseconds &plotT1MuS,
+                 const qreal plotWidth,
+                 const qreal plotHeight,
+                 const qreal heightFraction,
+                 const std::pair<T, T> *range,
+                 WaveformLines *lines)
 {
-    QVector<QVector<QLineF>> lines;
-    auto waveform = channel.getWaveformReference();
-    lines.reserve(waveform.getNumberOfSegments());
-    for (const auto &segment : waveform)
+    lines->clear();
+    // Only visit the segments that can intersect the plot window
+    auto [first, last] = waveform.getSegmentIndices(plotT0MuS, plotT1MuS);
+    for (int i = first; i < last; ++i)
     {
+        const auto &segment = waveform[i];
+        auto &linesForSegment = lines->next();
         try
         {
-            auto linesForSegment = createLines<T>(segment,
-                                                  plotT0MuS, plotT1MuS,
-                                                  plotWidth, plotHeight,
-                                                  heightFraction,
-                                                  range);
-            lines.push_back(std::move(linesForSegment));
+            createLines<T>(segment,
+                           plotT0MuS, plotT1MuS,
+                           plotWidth, plotHeight,
+                           heightFraction,
+                           range, &linesForSegment);
         }
         catch (const std::exception &e)
         {
             qWarning() << e.what();
         }
     }
-    return lines;
+}
+
+/// @brief Creates the lines comprising a channel's waveform.  If the channel
+///        has a processing pipeline then the processed waveform is drawn.
+///        Only the plot window is processed and the result is memoized by
+///        the channel.
+template<typename T>
+void createLines(const QPhase::Waveforms::Channel<T> &channel,
+                 const std::chrono::microseconds &plotT0MuS,
+                 const std::chrono::microseconds &plotT1MuS,
+                 const qreal plotWidth,
+                 const qreal plotHeight,
+                 const qreal heightFraction,
+                 const std::pair<T, T> *range,
+                 WaveformLines *lines)
+{
+    if (!channel.haveProcessingPipeline())
+    {
+        createLines(channel.getWaveformReference(),
+                    plotT0MuS, plotT1MuS,
+                    plotWidth, plotHeight,
+                    heightFraction, range, lines);
+        return;
+    }
+    // Four samples per pixel keeps the min/max envelope of each pixel
+    double resolution{0};
+    auto duration = std::chrono::duration<double> (plotT1MuS - plotT0MuS);
+    if (duration.count() > 0 && plotWidth > 0)
+    {
+        resolution = 4*plotWidth/duration.count();
+    }
+    auto processed = channel.getProcessedWaveform(plotT0MuS, plotT1MuS,
+                                                  resolution);
+    createLines(*processed,
+                plotT0MuS, plotT1MuS,
+                plotWidth, plotHeight,
+                heightFraction, range, lines);
+}
+
+/// @brief Draws the lines comprising a waveform.
+[[maybe_unused]]
+void drawLines(QPainter *painter, const WaveformLines &lines)
+{
+    for (int i = 0; i < lines.nSegments; ++i)
+    {
+        const auto &segment = lines.segments[i];
+        if (!segment.lines.isEmpty()){painter->drawLines(segment.lines);}
+        if (!segment.polyline.isEmpty())
+        {
+            painter->drawPolyline(segment.polyline);
+        }
+    }
 }
 
 }
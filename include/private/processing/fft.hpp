@@ -0,0 +1,353 @@
+#ifndef PRIVATE_PROCESSING_FFT_HPP
+#define PRIVATE_PROCESSING_FFT_HPP
+#include <cmath>
+#include <complex>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+namespace
+{
+/// @result The smallest length no less than n whose only prime factors are
+///         2, 3, and 5.  Transforms of these lengths use the specialized
+///         butterflies.
+[[nodiscard]] inline int nextFFTLength(const int n)
+{
+    if (n <= 1){return 1;}
+    for (int length = n; ; ++length)
+    {
+        int remainder = length;
+        for (const int p : {2, 3, 5})
+        {
+            while (remainder%p == 0){remainder = remainder/p;}
+        }
+        if (remainder == 1){return length;}
+    }
+}
+
+/// @result The product a*b.  This is written out since, without
+///         -ffast-math, std::complex multiplication calls a library routine
+///         that handles infinities and NaNs.
+[[nodiscard]] inline std::complex<double>
+    multiply(const std::complex<double> &a, const std::complex<double> &b)
+{
+    return std::complex<double> {a.real()*b.real() - a.imag()*b.imag(),
+                                 a.real()*b.imag() + a.imag()*b.real()};
+}
+
+/// @brief A mixed-radix, decimation in time, complex FFT of a fixed length.
+///        The length is factored into radices of 4, 2, 3, 5, then any
+///        remaining primes; the last are handled by a generic O(p^2)
+///        butterfly so lengths from \c nextFFTLength() should be preferred.
+///        Radices 2, 3, 4, and 5 have specialized butterflies.
+///        The forward transform is y_k = sum_j x_j exp(-2 pi i j k/n) and
+///        the inverse is unscaled.
+/// @note A plan is immutable after construction so it may be shared by
+///       many threads.
+/// @note The factorization and butterflies are adapted from KissFFT by
+///       Mark Borgerding which carries the following notice:
+///
+///       Copyright (c) 2003-2010, Mark Borgerding. All rights reserved.
+///
+///       Redistribution and use in source and binary forms, with or without
+///       modification, are permitted provided that the following conditions
+///       are met:
+///       - Redistributions of source code must retain the above copyright
+///         notice, this list of conditions and the following disclaimer.
+///       - Redistributions in binary form must reproduce the above
+///         copyright notice, this list of conditions and the following
+///         disclaimer in the documentation and/or other materials provided
+///         with the distribution.
+///       - Neither the author nor the names of any contributors may be used
+///         to endorse or promote products derived from this software
+///         without specific prior written permission.
+///
+///       THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+///       "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+///       LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+///       FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+///       COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+///       INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+///       BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+///       LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+///       CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+///       LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+///       ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+///       POSSIBILITY OF SUCH DAMAGE.
+class FFTPlan
+{
+public:
+    /// @param[in] n  The transform length.
+    /// @throws std::invalid_argument if n is not positive.
+    explicit FFTPlan(const int n) :
+        mLength(n)
+    {
+        if (n < 1){throw std::invalid_argument("Length must be positive");}
+        mForwardTwiddles.resize(n);
+        mInverseTwiddles.resize(n);
+        for (int i = 0; i < n; ++i)
+        {
+            auto phase = -2*std::numbers::pi*static_cast<double> (i)/n;
+            mForwardTwiddles[i] = std::polar(1.0, phase);
+            mInverseTwiddles[i] = std::conj(mForwardTwiddles[i]);
+        }
+        // Factor with radix 4 first since it is cheapest per point
+        int remainder = n;
+        int p = 4;
+        while (remainder > 1)
+        {
+            while (remainder%p != 0)
+            {
+                if (p == 4)
+                {
+                    p = 2;
+                }
+                else if (p == 2)
+                {
+                    p = 3;
+                }
+                else
+                {
+                    p = p + 2;
+                }
+                if (p*p > remainder){p = remainder;}
+            }
+            remainder = remainder/p;
+            mFactors.push_back(p);
+            mFactors.push_back(remainder);
+        }
+        if (mFactors.empty())
+        {
+            mFactors.push_back(1);
+            mFactors.push_back(1);
+        }
+    }
+    /// @result The transform length.
+    [[nodiscard]] int size() const noexcept
+    {
+        return mLength;
+    }
+    /// @brief Computes the forward transform.
+    /// @param[in] x   The signal.  This is an array whose dimension is [n].
+    /// @param[out] y  The transform.  This is an array whose dimension is
+    ///                [n] and it must not overlap x.
+    void forward(const std::complex<double> *x, std::complex<double> *y) const
+    {
+        transform(y, x, 1, mFactors.data(), mForwardTwiddles.data(), false);
+    }
+    /// @brief Computes the unscaled inverse transform.
+    /// @param[in] x   The transform.  This is an array whose dimension is [n].
+    /// @param[out] y  The signal scaled by n.  This is an array whose
+    ///                dimension is [n] and it must not overlap x.
+    void inverse(const std::complex<double> *x, std::complex<double> *y) const
+    {
+        transform(y, x, 1, mFactors.data(), mInverseTwiddles.data(), true);
+    }
+private:
+    void transform(std::complex<double> *y,
+                   const std::complex<double> *x,
+                   const int stride,
+                   const int *factors,
+                   const std::complex<double> *twiddles,
+                   const bool inverse) const
+    {
+        const int p = factors[0];
+        const int m = factors[1];
+        if (m == 1)
+        {
+            for (int q = 0; q < p; ++q){y[q] = x[q*stride];}
+        }
+        else
+        {
+            for (int q = 0; q < p; ++q)
+            {
+                transform(y + q*m, x + q*stride, stride*p, factors + 2,
+                          twiddles, inverse);
+            }
+        }
+        if (p == 2)
+        {
+            butterfly2(y, stride, twiddles, m);
+        }
+        else if (p == 3)
+        {
+            butterfly3(y, stride, twiddles, m);
+        }
+        else if (p == 4)
+        {
+            butterfly4(y, stride, twiddles, m, inverse);
+        }
+        else if (p == 5)
+        {
+            butterfly5(y, stride, twiddles, m);
+        }
+        else if (p > 1)
+        {
+            butterfly(y, stride, twiddles, m, p);
+        }
+    }
+    static void butterfly2(std::complex<double> *y, const int stride,
+                           const std::complex<double> *twiddles, const int m)
+    {
+        auto *y2 = y + m;
+        for (int k = 0; k < m; ++k)
+        {
+            auto t = multiply(y2[k], twiddles[k*stride]);
+            y2[k] = y[k] - t;
+            y[k] = y[k] + t;
+        }
+    }
+    static void butterfly4(std::complex<double> *y, const int stride,
+                           const std::complex<double> *twiddles, const int m,
+                           const bool inverse)
+    {
+        for (int k = 0; k < m; ++k)
+        {
+            auto s0 = multiply(y[k + m], twiddles[k*stride]);
+            auto s1 = multiply(y[k + 2*m], twiddles[2*k*stride]);
+            auto s2 = multiply(y[k + 3*m], twiddles[3*k*stride]);
+            auto s5 = y[k] - s1;
+            auto y0 = y[k] + s1;
+            auto s3 = s0 + s2;
+            auto s4 = s0 - s2;
+            y[k + 2*m] = y0 - s3;
+            y[k] = y0 + s3;
+            // Multiply s4 by -i for the forward and +i for the inverse
+            std::complex<double> r{s4.imag(), -s4.real()};
+            if (inverse){r =-r;}
+            y[k + m]   = s5 + r;
+            y[k + 3*m] = s5 - r;
+        }
+    }
+    /// The twiddle exp(-+2 pi i/3) is read from the table at n/3 so the
+    /// same code serves both directions.
+    void butterfly3(std::complex<double> *y, const int stride,
+                    const std::complex<double> *twiddles, const int m) const
+    {
+        const auto w = twiddles[stride*m];
+        for (int k = 0; k < m; ++k)
+        {
+            auto s1 = multiply(y[k + m], twiddles[k*stride]);
+            auto s2 = multiply(y[k + 2*m], twiddles[2*k*stride]);
+            auto s3 = s1 + s2;
+            auto s0 = s1 - s2;
+            auto y1 = y[k] - 0.5*s3;
+            // s0 times i*Im(w)
+            std::complex<double> r{-s0.imag()*w.imag(), s0.real()*w.imag()};
+            y[k] = y[k] + s3;
+            y[k + 2*m] = y1 - r;
+            y[k + m] = y1 + r;
+        }
+    }
+    /// The twiddles exp(-+2 pi i/5) and exp(-+4 pi i/5) are read from the
+    /// table at n/5 and 2n/5 so the same code serves both directions.
+    void butterfly5(std::complex<double> *y, const int stride,
+                    const std::complex<double> *twiddles, const int m) const
+    {
+        const auto ya = twiddles[stride*m];
+        const auto yb = twiddles[2*stride*m];
+        for (int k = 0; k < m; ++k)
+        {
+            auto s0 = y[k];
+            auto s1 = multiply(y[k + m], twiddles[k*stride]);
+            auto s2 = multiply(y[k + 2*m], twiddles[2*k*stride]);
+            auto s3 = multiply(y[k + 3*m], twiddles[3*k*stride]);
+            auto s4 = multiply(y[k + 4*m], twiddles[4*k*stride]);
+            auto s7 = s1 + s4;
+            auto s10 = s1 - s4;
+            auto s8 = s2 + s3;
+            auto s9 = s2 - s3;
+            y[k] = s0 + s7 + s8;
+            auto s5 = s0 + ya.real()*s7 + yb.real()*s8;
+            std::complex<double> s6{ ya.imag()*s10.imag() + yb.imag()*s9.imag(),
+                                    -ya.imag()*s10.real() - yb.imag()*s9.real()};
+            y[k + m] = s5 - s6;
+            y[k + 4*m] = s5 + s6;
+            auto s11 = s0 + yb.real()*s7 + ya.real()*s8;
+            std::complex<double> s12{-yb.imag()*s10.imag() + ya.imag()*s9.imag(),
+                                      yb.imag()*s10.real() - ya.imag()*s9.real()};
+            y[k + 2*m] = s11 + s12;
+            y[k + 3*m] = s11 - s12;
+        }
+    }
+    void butterfly(std::complex<double> *y, const int stride,
+                   const std::complex<double> *twiddles, const int m,
+                   const int p) const
+    {
+        constexpr int MAX_STACK_RADIX{8};
+        std::complex<double> stackScratch[MAX_STACK_RADIX];
+        std::vector<std::complex<double>> heapScratch;
+        auto *scratch = stackScratch;
+        if (p > MAX_STACK_RADIX)
+        {
+            heapScratch.resize(p);
+            scratch = heapScratch.data();
+        }
+        for (int u = 0; u < m; ++u)
+        {
+            for (int q = 0; q < p; ++q){scratch[q] = y[u + q*m];}
+            for (int q = 0; q < p; ++q)
+            {
+                auto k = u + q*m;
+                auto step = stride*k;
+                long long index = 0;
+                auto sum = scratch[0];
+                for (int j = 1; j < p; ++j)
+                {
+                    index = (index + step)%mLength;
+                    sum = sum + multiply(scratch[j], twiddles[index]);
+                }
+                y[k] = sum;
+            }
+        }
+    }
+    std::vector<std::complex<double>> mForwardTwiddles;
+    std::vector<std::complex<double>> mInverseTwiddles;
+    std::vector<int> mFactors;
+    int mLength{0};
+};
+
+/// The number of plans retained by \c getFFTPlan().
+constexpr int FFT_PLAN_CACHE_CAPACITY{32};
+
+/// @result The cached plan for the length.  Plans are shared by all callers.
+///         The least recently used plan is evicted once more than
+///         \c FFT_PLAN_CACHE_CAPACITY lengths are cached; callers holding
+///         an evicted plan keep it alive.
+[[nodiscard]] inline std::shared_ptr<const FFTPlan> getFFTPlan(const int n)
+{
+    using LengthList = std::list<int>;
+    struct Entry
+    {
+        std::shared_ptr<const FFTPlan> plan;
+        /// The entry's position in the recently used list.
+        LengthList::iterator position;
+    };
+    static std::mutex mutex;
+    static std::map<int, Entry> cache;
+    /// Lengths from most to least recently used.
+    static LengthList recentlyUsed;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(n);
+    if (it != cache.end())
+    {
+        recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed,
+                            it->second.position);
+        return it->second.plan;
+    }
+    auto plan = std::make_shared<const FFTPlan> (n);
+    recentlyUsed.push_front(n);
+    cache.insert(std::pair {n, Entry {plan, recentlyUsed.begin()}});
+    while (static_cast<int> (cache.size()) > FFT_PLAN_CACHE_CAPACITY)
+    {
+        cache.erase(recentlyUsed.back());
+        recentlyUsed.pop_back();
+    }
+    return plan;
+}
+
+}
+#endif
@@ -0,0 +1,198 @@
+// This file deliberately has no include guard.  It defines the kernels
+// generically in terms of a vector traits class, V, and is included once per
+// instruction set inside its own namespace and compiler target region so
+// that each copy is compiled for that instruction set.  The including file
+// is responsible for including <algorithm>, <cmath>, and <utility>.
+
+/// Sums are accumulated in vector registers over blocks of this many samples
+/// then added to a double precision total.  This bounds the round-off of
+/// float accumulation and keeps the in-block indices exact in float.
+constexpr int BLOCK_SIZE{4096};
+
+template<class V, typename T = typename V::value_type>
+std::pair<T, T> minMax(const int n, const T *__restrict__ x)
+{
+    constexpr int w = V::width;
+    T vMin = x[0];
+    T vMax = x[0];
+    int i = 0;
+    if (n >= w)
+    {
+        auto rMin = V::load(x);
+        auto rMax = rMin;
+        for (i = w; i + w <= n; i = i + w)
+        {
+            auto r = V::load(x + i);
+            rMin = V::min(rMin, r);
+            rMax = V::max(rMax, r);
+        }
+        vMin = V::reduceMin(rMin);
+        vMax = V::reduceMax(rMax);
+    }
+    for (; i < n; ++i)
+    {
+        vMin = std::min(vMin, x[i]);
+        vMax = std::max(vMax, x[i]);
+    }
+    return std::pair {vMin, vMax};
+}
+
+template<class V, typename T = typename V::value_type>
+T absoluteMaximum(const int n, const T *__restrict__ x)
+{
+    constexpr int w = V::width;
+    T vMax = 0;
+    int i = 0;
+    if (n >= w)
+    {
+        auto rMax = V::zero();
+        for (; i + w <= n; i = i + w)
+        {
+            rMax = V::max(rMax, V::abs(V::load(x + i)));
+        }
+        vMax = V::reduceMax(rMax);
+    }
+    for (; i < n; ++i)
+    {
+        vMax = std::max(vMax, std::abs(x[i]));
+    }
+    return vMax;
+}
+
+/// @result sum_i x_i
+template<class V, typename T = typename V::value_type>
+double sum(const int n, const T *__restrict__ x)
+{
+    constexpr int w = V::width;
+    double total{0};
+    for (int i0 = 0; i0 < n; i0 = i0 + BLOCK_SIZE)
+    {
+        auto i1 = std::min(n, i0 + BLOCK_SIZE);
+        auto accumulator = V::zero();
+        int i = i0;
+        for (; i + w <= i1; i = i + w)
+        {
+            accumulator = V::add(accumulator, V::load(x + i));
+        }
+        double partial = V::reduceAdd(accumulator);
+        for (; i < i1; ++i){partial = partial + x[i];}
+        total = total + partial;
+    }
+    return total;
+}
+
+/// @result sum_i x_i^2
+template<class V, typename T = typename V::value_type>
+double sumOfSquares(const int n, const T *__restrict__ x)
+{
+    constexpr int w = V::width;
+    double total{0};
+    for (int i0 = 0; i0 < n; i0 = i0 + BLOCK_SIZE)
+    {
+        auto i1 = std::min(n, i0 + BLOCK_SIZE);
+        auto accumulator = V::zero();
+        int i = i0;
+        for (; i + w <= i1; i = i + w)
+        {
+            auto r = V::load(x + i);
+            accumulator = V::fmadd(r, r, accumulator);
+        }
+        double partial = V::reduceAdd(accumulator);
+        for (; i < i1; ++i){partial = partial + x[i]*x[i];}
+        total = total + partial;
+    }
+    return total;
+}
+
+/// @result sum_i i x_i.  Within a block, sum_j (i0 + j) x_{i0+j}
+///         = i0 sum_j x_{i0+j} + sum_j j x_{i0+j}.
+template<class V, typename T = typename V::value_type>
+double indexWeightedSum(const int n, const T *__restrict__ x)
+{
+    constexpr int w = V::width;
+    double total{0};
+    for (int i0 = 0; i0 < n; i0 = i0 + BLOCK_SIZE)
+    {
+        auto i1 = std::min(n, i0 + BLOCK_SIZE);
+        auto blockSum = V::zero();
+        auto weightedSum = V::zero();
+        auto indices = V::iota();
+        auto step = V::set1(static_cast<T> (w));
+        int i = i0;
+        for (; i + w <= i1; i = i + w)
+        {
+            auto r = V::load(x + i);
+            blockSum = V::add(blockSum, r);
+            weightedSum = V::fmadd(indices, r, weightedSum);
+            indices = V::add(indices, step);
+        }
+        double partialSum = V::reduceAdd(blockSum);
+        double partialWeightedSum = V::reduceAdd(weightedSum);
+        for (; i < i1; ++i)
+        {
+            partialSum = partialSum + x[i];
+            partialWeightedSum = partialWeightedSum
+                               + static_cast<double> (i - i0)*x[i];
+        }
+        total = total + static_cast<double> (i0)*partialSum
+              + partialWeightedSum;
+    }
+    return total;
+}
+
+/// @brief x_i = x_i + a + b i
+template<class V, typename T = typename V::value_type>
+void addAffine(const int n, const double a, const double b,
+               T *__restrict__ x)
+{
+    constexpr int w = V::width;
+    auto slope = V::set1(static_cast<T> (b));
+    auto step = V::set1(static_cast<T> (w));
+    for (int i0 = 0; i0 < n; i0 = i0 + BLOCK_SIZE)
+    {
+        auto i1 = std::min(n, i0 + BLOCK_SIZE);
+        auto intercept = a + b*i0;
+        auto blockIntercept = V::set1(static_cast<T> (intercept));
+        auto indices = V::iota();
+        int i = i0;
+        for (; i + w <= i1; i = i + w)
+        {
+            auto line = V::fmadd(slope, indices, blockIntercept);
+            V::store(x + i, V::add(V::load(x + i), line));
+            indices = V::add(indices, step);
+        }
+        for (; i < i1; ++i)
+        {
+            x[i] = static_cast<T> (x[i] + intercept + b*(i - i0));
+        }
+    }
+}
+
+/// @brief x_i = alpha x_i
+template<class V, typename T = typename V::value_type>
+void scale(const int n, const T alpha, T *__restrict__ x)
+{
+    constexpr int w = V::width;
+    auto rAlpha = V::set1(alpha);
+    int i = 0;
+    for (; i + w <= n; i = i + w)
+    {
+        V::store(x + i, V::mul(rAlpha, V::load(x + i)));
+    }
+    for (; i < n; ++i){x[i] = alpha*x[i];}
+}
+
+/// @result The function table for this instruction set.
+template<class V, typename T = typename V::value_type>
+Kernels<T> makeKernels()
+{
+    Kernels<T> kernels;
+    kernels.minMax = &minMax<V>;
+    kernels.absoluteMaximum = &absoluteMaximum<V>;
+    kernels.sum = &sum<V>;
+    kernels.sumOfSquares = &sumOfSquares<V>;
+    kernels.indexWeightedSum = &indexWeightedSum<V>;
+    kernels.addAffine = &addAffine<V>;
+    kernels.scale = &scale<V>;
+    return kernels;
+}
@@ -0,0 +1,89 @@
+#ifndef PRIVATE_SPSCQUEUE_HPP
+#define PRIVATE_SPSCQUEUE_HPP
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+namespace
+{
+/// @brief A bounded, lock-free, single-producer single-consumer queue.
+///        Exactly one thread may call \c tryPush() and exactly one thread
+///        may call \c tryPop().  The indices live on separate cache lines
+///        and each side caches the other's index so the common case touches
+///        no shared cache line.
+template<typename T>
+class SPSCQueue
+{
+public:
+    /// @param[in] capacity  The minimum number of elements the queue holds.
+    ///                      This is rounded up to a power of two.
+    /// @throws std::invalid_argument if capacity is not positive.
+    explicit SPSCQueue(const std::size_t capacity)
+    {
+        if (capacity < 1)
+        {
+            throw std::invalid_argument("Capacity must be positive");
+        }
+        std::size_t size = 1;
+        while (size < capacity){size = 2*size;}
+        mMask = size - 1;
+        mSlots = std::make_unique<std::optional<T>[]> (size);
+    }
+    /// @brief Attempts to enqueue a value.  Called by the producer only.
+    /// @result False indicates the queue is full and value was not moved.
+    [[nodiscard]] bool tryPush(T &&value)
+    {
+        auto tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead > mMask)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead > mMask){return false;}
+        }
+        mSlots[tail & mMask].emplace(std::move(value));
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    /// @brief Attempts to dequeue a value.  Called by the consumer only.
+    /// @result The oldest value or nothing if the queue is empty.
+    [[nodiscard]] std::optional<T> tryPop()
+    {
+        auto head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail){return std::nullopt;}
+        }
+        auto &slot = mSlots[head & mMask];
+        std::optional<T> result{std::move(slot)};
+        slot.reset();
+        mHead.store(head + 1, std::memory_order_release);
+        return result;
+    }
+    /// @result True indicates the queue appears empty.  This is exact only
+    ///         when called from the consumer.
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return mHead.load(std::memory_order_acquire)
+            == mTail.load(std::memory_order_acquire);
+    }
+    /// @result The number of elements the queue holds.
+    [[nodiscard]] std::size_t capacity() const noexcept
+    {
+        return mMask + 1;
+    }
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue& operator=(const SPSCQueue &) = delete;
+private:
+    std::unique_ptr<std::optional<T>[]> mSlots;
+    std::size_t mMask{0};
+    // Consumer side
+    alignas(64) std::atomic<std::size_t> mHead{0};
+    std::size_t mCachedTail{0};
+    // Producer side
+    alignas(64) std::atomic<std::size_t> mTail{0};
+    std::size_t mCachedHead{0};
+};
+}
+#endif
@@ -0,0 +1,124 @@
+#ifndef QPHASE_INGEST_DIRECTORY_WATCHER_HPP
+#define QPHASE_INGEST_DIRECTORY_WATCHER_HPP
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+namespace QPhase
+{
+ namespace Database::Internal
+ {
+  class Waveform;
+ }
+ namespace Waveforms
+ {
+  template<class T> class RealTimeWaveform;
+ }
+}
+namespace QPhase::Ingest
+{
+/// @class DirectoryWatcher "directoryWatcher.hpp" "qphase/ingest/directoryWatcher.hpp"
+/// @brief Watches a spool directory with inotify and ingests SAC files as
+///        the acquisition system writes them.  Each file's header is parsed
+///        as soon as it is complete, then only the samples appended since
+///        the previous notification are read.  The directory is never
+///        rescanned.
+/// @note The samples of each channel are appended to a real-time waveform
+///       which can be handed to a real-time \c ChannelScene.  Each file also
+///       has an entry in a waveform index, in the form of the internal
+///       database's waveform rows, that grows with the file.  The update
+///       callback is invoked on the watcher's thread.
+/// @note Only files created or moved into the directory after \c start()
+///       are ingested.  If the kernel's event queue overflows then the
+///       overflow is counted as an error.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class DirectoryWatcher
+{
+public:
+    /// @brief Invoked with a file's index entry whenever new samples from
+    ///        that file are ingested.
+    using UpdateCallback
+        = std::function<void (const QPhase::Database::Internal::Waveform &)>;
+
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    DirectoryWatcher();
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Sets the retention of the channels' real-time waveforms.
+    /// @param[in] retention  The duration of data to retain.
+    /// @throws std::invalid_argument if retention is not positive.
+    /// @throws std::runtime_error if \c isRunning() is true.
+    void setRetention(const std::chrono::microseconds &retention);
+    /// @result The retention of the real-time waveforms.  By default this
+    ///         is 10 minutes.
+    [[nodiscard]] std::chrono::microseconds getRetention() const noexcept;
+    /// @brief Sets the function invoked when a file's index entry changes.
+    /// @throws std::runtime_error if \c isRunning() is true.
+    void setUpdateCallback(const UpdateCallback &callback);
+    /// @brief Starts watching a directory.
+    /// @param[in] directory  The spool directory.
+    /// @throws std::invalid_argument if the directory does not exist.
+    /// @throws std::runtime_error if the watcher is running or inotify
+    ///         fails.
+    void start(const std::filesystem::path &directory);
+    /// @result True indicates the watcher is running.
+    [[nodiscard]] bool isRunning() const noexcept;
+    /// @brief Stops watching.  The channels and index are retained.
+    void stop() noexcept;
+    /// @}
+
+    /// @name Channels
+    /// @{
+
+    /// @result True indicates the channel NETWORK.STATION.CHANNEL.LOCATION
+    ///         exists.
+    [[nodiscard]] bool haveChannel(const std::string &name) const noexcept;
+    /// @result The names of the channels.
+    [[nodiscard]] std::vector<std::string> getChannelNames() const;
+    /// @result The real-time waveform of the channel.
+    /// @throws std::invalid_argument if the channel does not exist.
+    [[nodiscard]] std::shared_ptr<const Waveforms::RealTimeWaveform<double>>
+        getWaveform(const std::string &name) const;
+    /// @}
+
+    /// @name Index
+    /// @{
+
+    /// @result The index entries of the ingested files sorted by file name.
+    ///         Files with fewer than two samples are not yet indexed.
+    [[nodiscard]] std::vector<QPhase::Database::Internal::Waveform> getIndex() const;
+    /// @result The number of files from which samples were ingested.
+    [[nodiscard]] int64_t getNumberOfFiles() const noexcept;
+    /// @result The number of samples ingested.
+    [[nodiscard]] int64_t getNumberOfSamples() const noexcept;
+    /// @result The number of files that could not be ingested plus the
+    ///         number of event queue overflows.
+    [[nodiscard]] int64_t getNumberOfErrors() const noexcept;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Destructor.  This stops the watcher.
+    ~DirectoryWatcher();
+    /// @}
+
+    DirectoryWatcher(const DirectoryWatcher &) = delete;
+    DirectoryWatcher(DirectoryWatcher &&) noexcept = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher &) = delete;
+    DirectoryWatcher& operator=(DirectoryWatcher &&) noexcept = delete;
+private:
+    class DirectoryWatcherImpl;
+    std::unique_ptr<DirectoryWatcherImpl> pImpl;
+};
+}
+#endif
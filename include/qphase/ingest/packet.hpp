@@ -0,0 +1,88 @@
+#ifndef QPHASE_INGEST_PACKET_HPP
+#define QPHASE_INGEST_PACKET_HPP
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+namespace QPhase::Ingest
+{
+/// @brief Defines how samples are encoded in a packet's payload.
+enum class DataType : uint8_t
+{
+    Integer32 = 1, /*!< Little-endian 32-bit signed integers (counts). */
+    Float32 = 2,   /*!< Little-endian IEEE single precision. */
+    Float64 = 3    /*!< Little-endian IEEE double precision. */
+};
+/// @brief A packet of contiguous samples from one channel.
+/// @note On the wire a packet is framed as the following little-endian
+///       fields followed by the samples:
+///       | Bytes | Field                                          |
+///       |-------|------------------------------------------------|
+///       | 4     | The magic characters "QPPK".                   |
+///       | 2     | The protocol version (1).                      |
+///       | 1     | The \c DataType.                               |
+///       | 1     | Reserved (0).                                  |
+///       | 4 x 8 | The network, station, channel, and location    |
+///       |       | codes each NUL padded to 8 bytes.              |
+///       | 8     | The start time in microseconds since the epoch.|
+///       | 4     | The sampling rate numerator in Hz.             |
+///       | 4     | The sampling rate denominator.                 |
+///       | 4     | The number of samples.                         |
+struct Packet
+{
+    std::string network;      /*!< The network code - e.g., UU. */
+    std::string station;      /*!< The station name - e.g., BRTU. */
+    std::string channel;      /*!< The channel code - e.g., HHZ. */
+    std::string locationCode; /*!< The location code - e.g., 01. */
+    std::chrono::microseconds startTime{0}; /*!< The time (UTC) of the first
+                                                 sample. */
+    int32_t samplingRateNumerator{0};   /*!< The sampling rate is the
+                                             numerator over the denominator
+                                             in Hz. */
+    int32_t samplingRateDenominator{1}; /*!< The sampling rate denominator. */
+    std::vector<double> data; /*!< The samples. */
+};
+/// @result The number of bytes in a frame's header.
+[[nodiscard]] constexpr int getFrameHeaderLength() noexcept
+{
+    return 60;
+}
+/// @result The largest number of samples a frame may hold.  This bounds the
+///         memory a malformed or hostile stream can request.
+[[nodiscard]] constexpr int getMaximumNumberOfSamples() noexcept
+{
+    return 1 << 20;
+}
+/// @brief Encodes a packet into a frame.
+/// @param[in] packet    The packet to encode.
+/// @param[in] dataType  The encoding of the samples.  Integer samples are
+///                      rounded.
+/// @result The frame.
+/// @throws std::invalid_argument if a code is too long, the sampling rate
+///         is not positive, or there are too many samples.
+[[nodiscard]] std::vector<char> encode(const Packet &packet,
+                                       DataType dataType = DataType::Float64);
+/// @brief Determines the length of a frame from its header.
+/// @param[in] nBytes  The number of bytes available in buffer.
+/// @param[in] buffer  The start of the frame.
+/// @result The total length of the frame in bytes or 0 if fewer than
+///         \c getFrameHeaderLength() bytes are available.
+/// @throws std::invalid_argument if the header is invalid.
+[[nodiscard]] int getFrameLength(int nBytes, const char *buffer);
+/// @brief Extracts the channel name of a frame without decoding it.
+/// @param[in] nBytes  The number of bytes in the buffer.  This must be at
+///                    least \c getFrameHeaderLength().
+/// @param[in] buffer  The frame.
+/// @result The name NETWORK.STATION.CHANNEL.LOCATION.
+/// @throws std::invalid_argument if the header is invalid.
+[[nodiscard]] std::string getName(int nBytes, const char *buffer);
+/// @brief Decodes a frame.
+/// @param[in] nBytes  The number of bytes in the frame.
+/// @param[in] buffer  The frame.
+/// @result The packet.
+/// @throws std::invalid_argument if the frame is invalid or truncated.
+[[nodiscard]] Packet decode(int nBytes, const char *buffer);
+/// @result The name NETWORK.STATION.CHANNEL.LOCATION of the packet.
+[[nodiscard]] std::string getName(const Packet &packet);
+}
+#endif
@@ -0,0 +1,112 @@
+#ifndef QPHASE_INGEST_REPLAYER_HPP
+#define QPHASE_INGEST_REPLAYER_HPP
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "qphase/ingest/packet.hpp"
+namespace QPhase::Waveforms
+{
+template<class T> class Waveform;
+}
+namespace QPhase::Ingest
+{
+/// @class Replayer "replayer.hpp" "qphase/ingest/replayer.hpp"
+/// @brief Streams archived packets to a \c Server as though they were
+///        arriving from a digitizer.  Packets are sent when their last
+///        sample would have been recorded, optionally sped up, so the
+///        server can be exercised at many times real time.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class Replayer
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    Replayer();
+    /// @brief Move constructor.
+    /// @param[in,out] replayer  The replayer from which to initialize this
+    ///                          class.  On exit, replayer's behavior is
+    ///                          undefined.
+    Replayer(Replayer &&replayer) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Move assignment.
+    /// @param[in,out] replayer  The replayer whose memory will be moved to
+    ///                          this.  On exit, replayer's behavior is
+    ///                          undefined.
+    /// @result The memory from replayer moved to this.
+    Replayer& operator=(Replayer &&replayer) noexcept;
+    /// @}
+
+    /// @name Connection
+    /// @{
+
+    /// @brief Connects to a server.
+    /// @param[in] port     The server's port.
+    /// @param[in] address  The server's IPv4 address.
+    /// @throws std::invalid_argument if the address is invalid.
+    /// @throws std::runtime_error if the connection fails.
+    void connect(uint16_t port, const std::string &address = "127.0.0.1");
+    /// @result True indicates the replayer is connected.
+    [[nodiscard]] bool isConnected() const noexcept;
+    /// @brief Closes the connection.
+    void disconnect() noexcept;
+    /// @}
+
+    /// @name Replay
+    /// @{
+
+    /// @brief Streams packets to the server.
+    /// @param[in] packets      The packets.  These are sent in the order
+    ///                         their last samples were recorded.
+    /// @param[in] speedFactor  Packets are sent at this multiple of real
+    ///                         time.  If this is not positive then packets
+    ///                         are sent as fast as possible.
+    /// @param[in] dataType     The encoding of the samples.
+    /// @result The number of bytes sent.
+    /// @throws std::runtime_error if not connected or the connection fails.
+    /// @throws std::invalid_argument if a packet cannot be encoded.
+    int64_t replay(const std::vector<Packet> &packets,
+                   double speedFactor = 1,
+                   DataType dataType = DataType::Float64);
+    /// @}
+
+    /// @brief Splits a waveform into packets.
+    /// @param[in] waveform          The waveform.  Each segment must have a
+    ///                              sampling rate.
+    /// @param[in] network           The network code.
+    /// @param[in] station           The station name.
+    /// @param[in] channel           The channel code.
+    /// @param[in] locationCode      The location code.
+    /// @param[in] samplesPerPacket  The largest number of samples in a packet.
+    /// @result The packets in time order.
+    /// @throws std::invalid_argument if samplesPerPacket is not positive or
+    ///         a sampling rate cannot be represented in a packet.
+    [[nodiscard]] static std::vector<Packet>
+        makePackets(const Waveforms::Waveform<double> &waveform,
+                    const std::string &network,
+                    const std::string &station,
+                    const std::string &channel,
+                    const std::string &locationCode,
+                    int samplesPerPacket = 512);
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Destructor.
+    ~Replayer();
+    /// @}
+
+    Replayer(const Replayer &) = delete;
+    Replayer& operator=(const Replayer &) = delete;
+private:
+    class ReplayerImpl;
+    std::unique_ptr<ReplayerImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,115 @@
+#ifndef QPHASE_INGEST_SERVER_HPP
+#define QPHASE_INGEST_SERVER_HPP
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+namespace QPhase::Waveforms
+{
+template<class T> class RealTimeWaveform;
+}
+namespace QPhase::Ingest
+{
+/// @class Server "server.hpp" "qphase/ingest/server.hpp"
+/// @brief Accepts framed packets (see \c Packet) from clients over TCP on
+///        the loopback interface and appends them to per-channel real-time
+///        waveforms.
+/// @note Each connection has a reader thread that splits the byte stream
+///       into frames.  Frames are routed by channel name to one of several
+///       decoder threads through lock-free single-producer single-consumer
+///       queues.  Since a channel always maps to the same decoder, every
+///       real-time waveform has exactly one writer as it requires and the
+///       readers of \c getWaveform() never block ingest.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class Server
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    Server();
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Sets the retention of channels that are created when their
+    ///        first packet arrives.
+    /// @param[in] retention  The duration of data to retain.
+    /// @throws std::invalid_argument if retention is not positive.
+    void setDefaultRetention(const std::chrono::microseconds &retention);
+    /// @result The retention of channels created on arrival.  By default
+    ///         this is 10 minutes.
+    [[nodiscard]] std::chrono::microseconds getDefaultRetention() const noexcept;
+    /// @brief Registers a channel.  Its packets will be appended to the
+    ///        given waveform.
+    /// @param[in] name      The channel name NETWORK.STATION.CHANNEL.LOCATION.
+    /// @param[in] waveform  The initialized waveform.  No one else may write
+    ///                      to it.
+    /// @throws std::invalid_argument if the waveform is NULL or not
+    ///         initialized or the channel already exists.
+    void addChannel(const std::string &name,
+                    std::shared_ptr<Waveforms::RealTimeWaveform<double>> waveform);
+    /// @brief Starts accepting connections.
+    /// @param[in] port      The port on which to listen.  If this is 0 then
+    ///                      the operating system picks one; see
+    ///                      \c getPort().
+    /// @param[in] nWorkers  The number of decoder threads.
+    /// @throws std::invalid_argument if nWorkers is not positive.
+    /// @throws std::runtime_error if the server is running or the socket
+    ///         cannot be bound.
+    void start(uint16_t port = 0, int nWorkers = 2);
+    /// @result True indicates the server is running.
+    [[nodiscard]] bool isRunning() const noexcept;
+    /// @result The port on which the server is listening.
+    /// @throws std::runtime_error if \c isRunning() is false.
+    [[nodiscard]] uint16_t getPort() const;
+    /// @brief Closes all connections, decodes the frames already received,
+    ///        and stops the threads.  The channels are retained.
+    void stop() noexcept;
+    /// @}
+
+    /// @name Channels
+    /// @{
+
+    /// @result True indicates the channel exists.
+    [[nodiscard]] bool haveChannel(const std::string &name) const noexcept;
+    /// @result The names of the channels.
+    [[nodiscard]] std::vector<std::string> getChannelNames() const;
+    /// @result The waveform to which the channel's packets are appended.
+    /// @throws std::invalid_argument if the channel does not exist.
+    [[nodiscard]] std::shared_ptr<const Waveforms::RealTimeWaveform<double>>
+        getWaveform(const std::string &name) const;
+    /// @}
+
+    /// @name Statistics
+    /// @{
+
+    /// @result The number of packets that were appended.
+    [[nodiscard]] int64_t getNumberOfPackets() const noexcept;
+    /// @result The number of samples that were appended.
+    [[nodiscard]] int64_t getNumberOfSamples() const noexcept;
+    /// @result The number of frames that could not be decoded or appended
+    ///         plus the number of connections closed on malformed headers.
+    [[nodiscard]] int64_t getNumberOfErrors() const noexcept;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Destructor.  This stops the server.
+    ~Server();
+    /// @}
+
+    Server(const Server &) = delete;
+    Server(Server &&) noexcept = delete;
+    Server& operator=(const Server &) = delete;
+    Server& operator=(Server &&) noexcept = delete;
+private:
+    class ServerImpl;
+    std::unique_ptr<ServerImpl> pImpl;
+};
+}
+#endif
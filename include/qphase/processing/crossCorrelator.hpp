@@ -0,0 +1,194 @@
+#ifndef QPHASE_PROCESSING_CROSS_CORRELATOR_HPP
+#define QPHASE_PROCESSING_CROSS_CORRELATOR_HPP
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "qphase/database/internal/arrival.hpp"
+namespace QPhase::Waveforms
+{
+template<class T> class Gather;
+}
+namespace QPhase::Processing
+{
+/// @class CrossCorrelator "crossCorrelator.hpp" "qphase/processing/crossCorrelator.hpp"
+/// @brief Measures the alignment of a template, e.g., a window of a
+///        reference trace or a stack, on many channels with the normalized
+///        (Pearson) cross-correlation
+///        \f[
+///           c_k = \frac{ \sum_i (t_i - \bar{t}) (x_{i+k} - \bar{x}_k) }
+///                      { \sqrt{\sum_i (t_i - \bar{t})^2}
+///                        \sqrt{\sum_i (x_{i+k} - \bar{x}_k)^2} }
+///        \f]
+///        where \f$ \bar{x}_k \f$ is the mean of the channel over the
+///        template's length at lag k.  Only lags at which the template fits
+///        entirely in the channel are considered.
+/// @note The correlations are computed with FFTs whose plans are cached per
+///       length and shared.  Since the template is real, two channels are
+///       packed into the real and imaginary parts of one complex transform.
+///       The template's spectrum is computed once per call and the channel
+///       pairs are divided among the worker threads.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class CrossCorrelator
+{
+public:
+    /// @brief The measured alignment of the template on one channel.
+    struct Lag
+    {
+        int channel{0};         /*!< The channel (row) index. */
+        double lag{0};          /*!< The sample index in the channel at
+                                     which the template's first sample
+                                     aligns best.  This is refined to a
+                                     fraction of a sample by fitting a
+                                     parabola through the peak. */
+        double coefficient{0};  /*!< The interpolated correlation
+                                     coefficient at the lag.  This is in
+                                     the range [-1, 1] and is 0 when the
+                                     channel is constant over the search. */
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    CrossCorrelator();
+    /// @brief Copy constructor.
+    /// @param[in] correlator  The correlator from which to initialize this
+    ///                        class.
+    CrossCorrelator(const CrossCorrelator &correlator);
+    /// @brief Move constructor.
+    /// @param[in,out] correlator  The correlator from which to initialize
+    ///                            this class.  On exit, correlator's
+    ///                            behavior is undefined.
+    CrossCorrelator(CrossCorrelator &&correlator) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] correlator  The correlator to copy to this.
+    /// @result A deep copy of the input correlator.
+    CrossCorrelator& operator=(const CrossCorrelator &correlator);
+    /// @brief Move assignment.
+    /// @param[in,out] correlator  The correlator whose memory will be moved
+    ///                            to this.  On exit, correlator's behavior is
+    ///                            undefined.
+    /// @result The memory from correlator moved to this.
+    CrossCorrelator& operator=(CrossCorrelator &&correlator) noexcept;
+    /// @}
+
+    /// @name Template
+    /// @{
+
+    /// @brief Sets the template.
+    /// @param[in] n  The number of samples in the template.
+    /// @param[in] x  The template.  This is an array whose dimension is [n].
+    /// @throws std::invalid_argument if n is less than 2, x is NULL, or the
+    ///         template is constant.
+    void setTemplate(int n, const T *x);
+    /// @result True indicates the template was set.
+    [[nodiscard]] bool haveTemplate() const noexcept;
+    /// @result The number of samples in the template.
+    /// @throws std::runtime_error if \c haveTemplate() is false.
+    [[nodiscard]] int getTemplateLength() const;
+    /// @}
+
+    /// @name Threading
+    /// @{
+
+    /// @brief Sets the number of threads among which the channels are
+    ///        divided.
+    /// @param[in] nThreads  The number of threads.  By default this is 1.
+    /// @throws std::invalid_argument if nThreads is not positive.
+    void setNumberOfThreads(int nThreads);
+    /// @result The number of threads.
+    [[nodiscard]] int getNumberOfThreads() const noexcept;
+    /// @}
+
+    /// @name Correlation
+    /// @{
+
+    /// @brief Correlates the template with each channel of a matrix.
+    /// @param[in] nChannels         The number of channels (rows).
+    /// @param[in] nSamples          The number of samples in each channel.
+    /// @param[in] leadingDimension  The distance in elements between the
+    ///                              starts of consecutive rows.
+    /// @param[in] x                 The row-major channels.  This is an
+    ///                              array whose dimension is
+    ///                              [nChannels x leadingDimension].
+    /// @param[in] searchWindows     If not empty, the first and last lag of
+    ///                              each channel to search.  These are
+    ///                              clipped to the lags at which the
+    ///                              template fits in the channel.  This is
+    ///                              useful to look near a current pick.
+    /// @result The best lag of each channel.
+    /// @throws std::invalid_argument if the template is longer than the
+    ///         channels, x is NULL, the leading dimension is too small, the
+    ///         number of search windows does not match the number of
+    ///         channels, or a search window is empty after clipping.
+    /// @throws std::runtime_error if \c haveTemplate() is false.
+    [[nodiscard]] std::vector<Lag> correlate(int nChannels,
+                                             int nSamples,
+                                             int leadingDimension,
+                                             const T *x,
+                                             const std::vector<std::pair<int, int>> &searchWindows = {}) const;
+    /// @brief Correlates the template with each channel of the gather.
+    /// @param[in] gather         The gather.
+    /// @param[in] searchWindows  If not empty, the first and last lag of
+    ///                           each channel to search.
+    /// @result The best lag of each channel.  A lag is the column of the
+    ///         gather at which the template starts.
+    /// @throws std::invalid_argument if the gather is empty or see
+    ///         \c correlate().
+    /// @throws std::runtime_error if \c haveTemplate() is false.
+    [[nodiscard]] std::vector<Lag> correlate(const QPhase::Waveforms::Gather<T> &gather,
+                                             const std::vector<std::pair<int, int>> &searchWindows = {}) const;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~CrossCorrelator();
+    /// @}
+private:
+    class CrossCorrelatorImpl;
+    std::unique_ptr<CrossCorrelatorImpl> pImpl;
+};
+
+/// @brief Moves the arrivals to the times measured by correlating a
+///        template with a gather.
+/// @param[in] lags                The lags from \c CrossCorrelator::correlate()
+///                                for the gather.
+/// @param[in] gather              The gather that was correlated.  An
+///                                arrival is matched to the row with its
+///                                network, station, channel, and location
+///                                code.  A blank location code and -- are
+///                                treated as the same.
+/// @param[in] phase               The phase of the template's pick.  Only
+///                                arrivals of this phase are updated so,
+///                                e.g., an S pick on the same channel is
+///                                not moved by a P template.
+/// @param[in] templatePickOffset  The time from the template's first sample
+///                                to the pick in the template.
+/// @param[in] minimumCoefficient  Lags with a correlation coefficient less
+///                                than this are not applied.
+/// @param[in,out] arrivals        The arrivals.  On exit, the time of each
+///                                matched arrival of the phase with an
+///                                adequate coefficient is updated.
+/// @result The number of arrivals that were updated.
+/// @throws std::invalid_argument if arrivals is NULL or a lag's channel is
+///         not in the gather.
+template<class T>
+int updateArrivals(const std::vector<typename CrossCorrelator<T>::Lag> &lags,
+                   const QPhase::Waveforms::Gather<T> &gather,
+                   QPhase::Database::Internal::Arrival::Phase phase,
+                   const std::chrono::microseconds &templatePickOffset,
+                   double minimumCoefficient,
+                   std::vector<QPhase::Database::Internal::Arrival> *arrivals);
+}
+#endif
@@ -0,0 +1,131 @@
+#ifndef QPHASE_PROCESSING_KERNELS_HPP
+#define QPHASE_PROCESSING_KERNELS_HPP
+#include <utility>
+namespace QPhase::Waveforms
+{
+template<class T> class Segment;
+}
+namespace QPhase::Processing
+{
+/// @brief The instruction sets to which the kernels can dispatch.
+enum class InstructionSet
+{
+    Scalar, /*!< Portable C++. */
+    AVX2,   /*!< AVX2 with FMA. */
+    AVX512  /*!< AVX-512 foundation. */
+};
+/// @result The instruction set the kernels currently dispatch to.  Unless
+///         changed with \c setInstructionSet() this is the best instruction
+///         set supported by this CPU.
+[[nodiscard]] InstructionSet getInstructionSet() noexcept;
+/// @result True indicates this CPU supports the given instruction set.
+[[nodiscard]] bool isSupported(InstructionSet instructionSet) noexcept;
+/// @brief Forces the kernels to dispatch to the given instruction set.
+///        This is intended for testing and benchmarking.
+/// @throws std::invalid_argument if \c isSupported() is false.
+void setInstructionSet(InstructionSet instructionSet);
+
+/// @name Reductions
+/// @{
+
+/// @param[in] n  The number of samples.
+/// @param[in] x  The signal.  This is an array whose dimension is [n].
+/// @result The minimum and maximum of x.
+/// @throws std::invalid_argument if n is not positive or x is NULL.
+template<typename T>
+[[nodiscard]] std::pair<T, T> minMax(int n, const T *x);
+/// @result The maximum of |x|.
+/// @throws std::invalid_argument if n is not positive or x is NULL.
+template<typename T>
+[[nodiscard]] T absoluteMaximum(int n, const T *x);
+/// @result The mean of x.  This is accumulated in double precision.
+/// @throws std::invalid_argument if n is not positive or x is NULL.
+template<typename T>
+[[nodiscard]] double mean(int n, const T *x);
+/// @result The root-mean-square of x.  This is accumulated in double
+///         precision.
+/// @throws std::invalid_argument if n is not positive or x is NULL.
+template<typename T>
+[[nodiscard]] double rms(int n, const T *x);
+/// @}
+
+/// @name In-Place Operations
+/// @{
+
+/// @brief Removes the mean from x.
+/// @param[in] n      The number of samples.
+/// @param[in,out] x  The signal to demean.  This is an array whose
+///                   dimension is [n].
+/// @throws std::invalid_argument if n is positive and x is NULL.
+template<typename T>
+void demean(int n, T *x);
+/// @brief Removes the least-squares line from x.
+/// @throws std::invalid_argument if n is positive and x is NULL.
+template<typename T>
+void detrend(int n, T *x);
+/// @brief Computes x = alpha x.
+/// @throws std::invalid_argument if n is positive and x is NULL.
+template<typename T>
+void scale(int n, T alpha, T *x);
+/// @brief Applies a Hann (cosine) taper to both ends of x.
+/// @param[in] n         The number of samples.
+/// @param[in] fraction  The fraction of the signal to taper at each end.
+///                      This must be in the range [0, 0.5].
+/// @param[in,out] x     The signal to taper.
+/// @throws std::invalid_argument if the fraction is out of range or n is
+///         positive and x is NULL.
+/// @note The window weights come from a scalar trigonometric recurrence;
+///       only the ends of the signal are touched.
+template<typename T>
+void taper(int n, double fraction, T *x);
+/// @}
+
+/// @name Precision Conversion
+/// @{
+
+/// @brief Converts x to y.
+/// @param[in] n   The number of samples.
+/// @param[in] x   The signal to convert.  This is an array whose dimension
+///                is [n].
+/// @param[out] y  The converted signal.  This is an array whose dimension
+///                is [n].
+/// @throws std::invalid_argument if n is positive and x or y is NULL.
+void convert(int n, const float *x, double *y);
+void convert(int n, const double *x, float *y);
+/// @}
+
+/// @name Segment Kernels
+/// @{
+
+/// @result The minimum and maximum of the segment's samples.
+/// @throws std::invalid_argument if the segment has no samples.
+template<typename T>
+[[nodiscard]] std::pair<T, T> minMax(const QPhase::Waveforms::Segment<T> &segment);
+/// @result The maximum absolute value of the segment's samples.
+/// @throws std::invalid_argument if the segment has no samples.
+template<typename T>
+[[nodiscard]] T absoluteMaximum(const QPhase::Waveforms::Segment<T> &segment);
+/// @result The mean of the segment's samples.
+/// @throws std::invalid_argument if the segment has no samples.
+template<typename T>
+[[nodiscard]] double mean(const QPhase::Waveforms::Segment<T> &segment);
+/// @result The root-mean-square of the segment's samples.
+/// @throws std::invalid_argument if the segment has no samples.
+template<typename T>
+[[nodiscard]] double rms(const QPhase::Waveforms::Segment<T> &segment);
+/// @brief Removes the mean from the segment.
+template<typename T>
+void demean(QPhase::Waveforms::Segment<T> *segment);
+/// @brief Removes the least-squares line from the segment.
+template<typename T>
+void detrend(QPhase::Waveforms::Segment<T> *segment);
+/// @brief Multiplies the segment by alpha.
+template<typename T>
+void scale(T alpha, QPhase::Waveforms::Segment<T> *segment);
+/// @brief Applies a Hann taper to both ends of the segment.
+/// @throws std::invalid_argument if the fraction is not in [0, 0.5].
+template<typename T>
+void taper(double fraction, QPhase::Waveforms::Segment<T> *segment);
+/// @}
+}
+#endif
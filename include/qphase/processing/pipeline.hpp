@@ -0,0 +1,142 @@
+#ifndef QPHASE_PROCESSING_PIPELINE_HPP
+#define QPHASE_PROCESSING_PIPELINE_HPP
+#include <chrono>
+#include <cstdint>
+#include <memory>
+namespace QPhase::Waveforms
+{
+template<class T> class Waveform;
+}
+namespace QPhase::Processing
+{
+template<class T> class SOSFilter;
+}
+namespace QPhase::Processing
+{
+/// @class Pipeline "pipeline.hpp" "qphase/processing/pipeline.hpp"
+/// @brief A chain of processing operations (e.g., demean, filter, normalize)
+///        that is recorded once and evaluated lazily.  Nothing is computed
+///        when an operation is added.  Instead, \c evaluate() extracts the
+///        requested time window plus enough padding for the filters to warm
+///        up, applies the operations in order, and trims the result back to
+///        the window.  This way only the samples that will be looked at are
+///        ever processed.
+/// @note Every modification gives the pipeline a new identifier.  Callers
+///       that memoize results should key them on the identifier so they
+///       are invalidated when the chain or its parameters change.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class Pipeline
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    Pipeline();
+    /// @brief Copy constructor.
+    /// @param[in] pipeline  The pipeline from which to initialize this class.
+    Pipeline(const Pipeline &pipeline);
+    /// @brief Move constructor.
+    /// @param[in,out] pipeline  The pipeline from which to initialize this
+    ///                          class.  On exit, pipeline's behavior is
+    ///                          undefined.
+    Pipeline(Pipeline &&pipeline) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] pipeline  The pipeline to copy to this.
+    /// @result A deep copy of the input pipeline.
+    Pipeline& operator=(const Pipeline &pipeline);
+    /// @brief Move assignment.
+    /// @param[in,out] pipeline  The pipeline whose memory will be moved to
+    ///                          this.  On exit, pipeline's behavior is
+    ///                          undefined.
+    /// @result The memory from pipeline moved to this.
+    Pipeline& operator=(Pipeline &&pipeline) noexcept;
+    /// @}
+
+    /// @name Operations
+    /// @{
+
+    /// @brief Appends removal of each segment's mean.
+    void addDemean();
+    /// @brief Appends removal of each segment's best fitting line.
+    void addDetrend();
+    /// @brief Appends a Hann taper of each segment.
+    /// @param[in] fraction  The fraction of each segment to taper.  Half is
+    ///                      applied to either end.  This must be in the
+    ///                      range [0,1].
+    /// @throws std::invalid_argument if the fraction is out of range.
+    void addTaper(double fraction);
+    /// @brief Appends multiplication of the samples by a constant.
+    /// @param[in] factor  The scale factor.
+    void addScale(double factor);
+    /// @brief Appends scaling of the waveform so its largest absolute
+    ///        amplitude is 1.
+    void addNormalize();
+    /// @brief Appends a filter.
+    /// @param[in] filter     The filter to apply.  The filter's streaming
+    ///                       state is ignored.
+    /// @param[in] zeroPhase  If true then the filter is applied forward and
+    ///                       backward.
+    /// @param[in] warmUp     The length of data the filter needs to settle.
+    ///                       This is read before (and, for zero-phase
+    ///                       filters, after) the evaluation window.  A few
+    ///                       periods of the lowest corner frequency is
+    ///                       typical.
+    /// @throws std::invalid_argument if the filter is not initialized or
+    ///         the warm-up is negative.
+    void addFilter(const SOSFilter<T> &filter,
+                   bool zeroPhase,
+                   const std::chrono::microseconds &warmUp);
+    /// @result The number of operations in the chain.
+    [[nodiscard]] int getNumberOfOperations() const noexcept;
+    /// @result The padding read on either side of an evaluation window.
+    [[nodiscard]] std::chrono::microseconds getPadding() const noexcept;
+    /// @result An identifier that is unique to this chain of operations and
+    ///         parameters.  It changes whenever the pipeline is modified.
+    [[nodiscard]] uint64_t getIdentifier() const noexcept;
+    /// @}
+
+    /// @name Evaluation
+    /// @{
+
+    /// @brief Processes the waveform over a time window.
+    /// @param[in] waveform    The waveform to process.
+    /// @param[in] startTime   The start time (UTC) of the window in
+    ///                        microseconds since the epoch.
+    /// @param[in] endTime     The end time (UTC) of the window in
+    ///                        microseconds since the epoch.
+    /// @param[in] resolution  If positive, segments sampled faster than this
+    ///                        many samples per second are reduced to the
+    ///                        minimum and maximum of consecutive runs of
+    ///                        samples so that the result has about this
+    ///                        many samples per second and the same envelope.
+    ///                        This is intended for display.
+    /// @result The processed samples of the waveform in [startTime, endTime].
+    /// @throws std::invalid_argument if the start time exceeds the end time.
+    [[nodiscard]] QPhase::Waveforms::Waveform<T>
+        evaluate(const QPhase::Waveforms::Waveform<T> &waveform,
+                 const std::chrono::microseconds &startTime,
+                 const std::chrono::microseconds &endTime,
+                 double resolution = 0) const;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Removes all operations.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~Pipeline();
+    /// @}
+private:
+    class PipelineImpl;
+    std::unique_ptr<PipelineImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,137 @@
+#ifndef QPHASE_PROCESSING_RESAMPLER_HPP
+#define QPHASE_PROCESSING_RESAMPLER_HPP
+#include <memory>
+#include <vector>
+namespace QPhase::Waveforms
+{
+template<class T> class Segment;
+template<class T> class Waveform;
+}
+namespace QPhase::Processing
+{
+/// @class Resampler "resampler.hpp" "qphase/processing/resampler.hpp"
+/// @brief Changes the sampling rate of a signal by the rational factor L/M
+///        with a polyphase FIR filter.  Conceptually, the signal is
+///        upsampled by L, lowpass filtered to the lesser of the input and
+///        output Nyquist frequencies, then downsampled by M.  The polyphase
+///        form never evaluates the discarded or zero-stuffed samples so
+///        integer decimation (L = 1) costs one short dot product per
+///        output sample.
+/// @note The anti-alias filter is a Kaiser windowed sinc with a delay that
+///       is compensated so the output is time aligned with the input.
+///       Designs are cached per ratio and shared among resamplers.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class Resampler
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    Resampler();
+    /// @brief Copy constructor.
+    /// @param[in] resampler  The resampler from which to initialize this
+    ///                       class.
+    Resampler(const Resampler &resampler);
+    /// @brief Move constructor.
+    /// @param[in,out] resampler  The resampler from which to initialize this
+    ///                           class.  On exit, resampler's behavior is
+    ///                           undefined.
+    Resampler(Resampler &&resampler) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] resampler  The resampler to copy to this.
+    /// @result A deep copy of the input resampler.
+    Resampler& operator=(const Resampler &resampler);
+    /// @brief Move assignment.
+    /// @param[in,out] resampler  The resampler whose memory will be moved to
+    ///                           this.  On exit, resampler's behavior is
+    ///                           undefined.
+    /// @result The memory from resampler moved to this.
+    Resampler& operator=(Resampler &&resampler) noexcept;
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Initializes the resampler for the rational factor L/M.  The
+    ///        factors are reduced by their greatest common divisor.
+    /// @param[in] upFactor    The upsampling factor, L.
+    /// @param[in] downFactor  The downsampling factor, M.
+    /// @throws std::invalid_argument if either factor is not positive or
+    ///         the reduced factors exceed \c getMaximumFactor().
+    void initialize(int upFactor, int downFactor);
+    /// @brief Initializes the resampler to take signals at the input rate
+    ///        to the output rate.
+    /// @param[in] inputSamplingRate   The input sampling rate in Hz.
+    /// @param[in] outputSamplingRate  The output sampling rate in Hz.
+    /// @throws std::invalid_argument if either rate is not positive or the
+    ///         ratio cannot be represented with factors no greater than
+    ///         \c getMaximumFactor().
+    void initializeFromSamplingRates(double inputSamplingRate,
+                                     double outputSamplingRate);
+    /// @result True indicates the resampler is initialized.
+    [[nodiscard]] bool isInitialized() const noexcept;
+    /// @result The reduced upsampling factor, L.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getUpFactor() const;
+    /// @result The reduced downsampling factor, M.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getDownFactor() const;
+    /// @result The anti-alias filter taps at the upsampled rate.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] std::vector<double> getFilterCoefficients() const;
+    /// @result The largest supported up or down factor.
+    [[nodiscard]] static int getMaximumFactor() noexcept;
+    /// @}
+
+    /// @name Resampling
+    /// @{
+
+    /// @param[in] n  The number of input samples.
+    /// @result The number of output samples when resampling n samples.
+    ///         This is the number of output samples that fall within the
+    ///         time span of the input.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getOutputLength(int n) const;
+    /// @brief Resamples a signal.
+    /// @param[in] n   The number of input samples.
+    /// @param[in] x   The input signal.  This is an array whose dimension
+    ///                is [n].
+    /// @param[in] nY  The space allocated to y.
+    /// @param[out] y  The resampled signal.  The first \c getOutputLength()
+    ///                samples are set.
+    /// @throws std::invalid_argument if x or y is NULL or nY is too small.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void apply(int n, const T *x, int nY, T *y) const;
+    /// @result The resampled segment.  The output starts at exactly the
+    ///         same time as the input and its sampling rate is exactly the
+    ///         input rate times L/M.
+    /// @throws std::invalid_argument if the segment has no sampling rate.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] QPhase::Waveforms::Segment<T> apply(const QPhase::Waveforms::Segment<T> &segment) const;
+    /// @result The waveform with each segment resampled.
+    /// @throws std::invalid_argument if a segment has no sampling rate.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] QPhase::Waveforms::Waveform<T> apply(const QPhase::Waveforms::Waveform<T> &waveform) const;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~Resampler();
+    /// @}
+private:
+    class ResamplerImpl;
+    std::unique_ptr<ResamplerImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,165 @@
+#ifndef QPHASE_PROCESSING_ROTATOR_HPP
+#define QPHASE_PROCESSING_ROTATOR_HPP
+#include <memory>
+#include <vector>
+namespace QPhase::Waveforms
+{
+template<class T> class Gather;
+}
+namespace QPhase::Processing
+{
+/// @class Rotator "rotator.hpp" "qphase/processing/rotator.hpp"
+/// @brief Rotates the horizontal channels of the three-channel sensors in a
+///        gather.  Each sensor's pair of horizontals, e.g., N/E, 1/2, or
+///        R/T, is taken from the azimuths in its metadata to north/east or
+///        to radial/transverse for an event back-azimuth.  Rotating back
+///        and forth is exact to round-off so a display can switch between
+///        the orientations without rebuilding the gather.
+/// @note The gather has already put the three channels of a sensor on a
+///       common sample grid so the rows are rotated in place.  Both
+///       horizontals of a sample are combined with one 2 x 2 matrix in a
+///       single vectorized pass and the sensors are divided among threads.
+///       A sample is flagged as a gap in both outputs if it is a gap in
+///       either input.
+/// @note Following the usual convention the radial is positive away from
+///       the event (azimuth = back-azimuth + 180 degrees) and the
+///       transverse is the radial rotated 90 degrees clockwise
+///       (azimuth = back-azimuth + 270 degrees).
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class Rotator
+{
+public:
+    /// @brief The target orientation of the horizontals.
+    enum class Orientation
+    {
+        NorthEast,        /*!< North and east (ZNE). */
+        RadialTransverse  /*!< Radial and transverse (ZRT) for the
+                               sensor's back-azimuth. */
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    Rotator();
+    /// @brief Copy constructor.
+    /// @param[in] rotator  The rotator from which to initialize this class.
+    Rotator(const Rotator &rotator);
+    /// @brief Move constructor.
+    /// @param[in,out] rotator  The rotator from which to initialize this
+    ///                         class.  On exit, rotator's behavior is
+    ///                         undefined.
+    Rotator(Rotator &&rotator) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] rotator  The rotator to copy to this.
+    /// @result A deep copy of the input rotator.
+    Rotator& operator=(const Rotator &rotator);
+    /// @brief Move assignment.
+    /// @param[in,out] rotator  The rotator whose memory will be moved to
+    ///                         this.  On exit, rotator's behavior is
+    ///                         undefined.
+    /// @result The memory from rotator moved to this.
+    Rotator& operator=(Rotator &&rotator) noexcept;
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Finds the three-channel sensors in the gather.
+    /// @param[in] gather  The gather.
+    /// @throws std::invalid_argument if a sensor's horizontal is not
+    ///         horizontal or its azimuth is unknown and cannot be inferred
+    ///         from a channel code ending in N or E, or its horizontals are
+    ///         nearly parallel.  In this case the class is unchanged.
+    void initialize(const QPhase::Waveforms::Gather<T> &gather);
+    /// @result True indicates the class is initialized.
+    [[nodiscard]] bool isInitialized() const noexcept;
+    /// @result The number of three-channel sensors.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getNumberOfSensors() const;
+    /// @result The gather row of each sensor's vertical channel.  The
+    ///         sensor's horizontals are the next two rows.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] std::vector<int> getVerticalRows() const;
+    /// @}
+
+    /// @name Back-Azimuths
+    /// @{
+
+    /// @brief Sets the back-azimuth of each sensor.
+    /// @param[in] backAzimuths  The back-azimuth, measured clockwise from
+    ///                          north, from each sensor to the event in
+    ///                          degrees.
+    /// @throws std::invalid_argument if the number of back-azimuths does
+    ///         not match the number of sensors or a back-azimuth is not
+    ///         finite.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void setBackAzimuths(const std::vector<double> &backAzimuths);
+    /// @brief Sets the back-azimuths from the sensors' locations to an
+    ///        event on a spherical earth.
+    /// @param[in] latitude   The event latitude in degrees.
+    /// @param[in] longitude  The event longitude in degrees.
+    /// @throws std::invalid_argument if the latitude is not in [-90, 90] or
+    ///         a sensor's location is unknown.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void setEventLocation(double latitude, double longitude);
+    /// @result The back-azimuth of each sensor in degrees.
+    /// @throws std::runtime_error if \c haveBackAzimuths() is false.
+    [[nodiscard]] std::vector<double> getBackAzimuths() const;
+    /// @result True indicates the back-azimuths were set.
+    [[nodiscard]] bool haveBackAzimuths() const noexcept;
+    /// @}
+
+    /// @name Threading
+    /// @{
+
+    /// @brief Sets the number of threads among which the sensors are
+    ///        divided.
+    /// @param[in] nThreads  The number of threads.  By default this is 1.
+    /// @throws std::invalid_argument if nThreads is not positive.
+    void setNumberOfThreads(int nThreads);
+    /// @result The number of threads.
+    [[nodiscard]] int getNumberOfThreads() const noexcept;
+    /// @}
+
+    /// @name Rotation
+    /// @{
+
+    /// @brief Rotates the horizontals of each sensor in place.  The current
+    ///        orientation is read from the gather's metadata which is then
+    ///        updated: the azimuths are set and the last letter of the
+    ///        channel codes becomes N/E or R/T.
+    /// @param[in] orientation  The target orientation.
+    /// @param[in,out] gather   The gather with which the class was
+    ///                         initialized.  On exit, the sensors'
+    ///                         horizontals are rotated.
+    /// @throws std::invalid_argument if gather is NULL, its rows do not
+    ///         match those at initialization, or a sensor's horizontals
+    ///         cannot be rotated.
+    /// @throws std::runtime_error if \c isInitialized() is false or the
+    ///         orientation is radial/transverse and \c haveBackAzimuths()
+    ///         is false.
+    void rotate(Orientation orientation,
+                QPhase::Waveforms::Gather<T> *gather) const;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~Rotator();
+    /// @}
+private:
+    class RotatorImpl;
+    std::unique_ptr<RotatorImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,177 @@
+#ifndef QPHASE_PROCESSING_SOS_FILTER_HPP
+#define QPHASE_PROCESSING_SOS_FILTER_HPP
+#include <memory>
+#include <utility>
+#include <vector>
+namespace QPhase::Waveforms
+{
+template<class T> class Segment;
+template<class T> class Waveform;
+}
+namespace QPhase::Processing
+{
+/// @class SOSFilter "sosFilter.hpp" "qphase/processing/sosFilter.hpp"
+/// @brief An infinite impulse response filter implemented as a cascade of
+///        second order sections (biquads).  Each section is
+///        \f[
+///            H_k(z) = \frac{b_{0k} + b_{1k} z^{-1} + b_{2k} z^{-2}}
+///                          {1 + a_{1k} z^{-1} + a_{2k} z^{-2}}
+///        \f]
+///        and is applied in transposed direct form II.  Irrespective of
+///        the sample precision the filter is evaluated in double precision.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class SOSFilter
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    SOSFilter();
+    /// @brief Copy constructor.
+    /// @param[in] filter  The filter from which to initialize this class.
+    SOSFilter(const SOSFilter &filter);
+    /// @brief Move constructor.
+    /// @param[in,out] filter  The filter from which to initialize this class.
+    ///                        On exit, filter's behavior is undefined.
+    SOSFilter(SOSFilter &&filter) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] filter  The filter to copy to this.
+    /// @result A deep copy of the input filter.
+    SOSFilter& operator=(const SOSFilter &filter);
+    /// @brief Move assignment.
+    /// @param[in,out] filter  The filter whose memory will be moved to this.
+    ///                        On exit, filter's behavior is undefined.
+    /// @result The memory from filter moved to this.
+    SOSFilter& operator=(SOSFilter &&filter) noexcept;
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Initializes the filter from its section coefficients.
+    /// @param[in] numerators    The numerator coefficients
+    ///                          \f$ \{b_{0k}, b_{1k}, b_{2k}\} \f$ of each
+    ///                          section.  This has dimension
+    ///                          [3 x nSections].
+    /// @param[in] denominators  The denominator coefficients
+    ///                          \f$ \{a_{0k}, a_{1k}, a_{2k}\} \f$ of each
+    ///                          section.  This has dimension
+    ///                          [3 x nSections].  Each section is
+    ///                          normalized by \f$ a_{0k} \f$.
+    /// @throws std::invalid_argument if the coefficient sizes are
+    ///         inconsistent or not a multiple of 3, or any
+    ///         \f$ a_{0k} \f$ is zero.
+    void initialize(const std::vector<double> &numerators,
+                    const std::vector<double> &denominators);
+    /// @brief Designs a Butterworth lowpass filter.
+    /// @param[in] order         The filter order.  This must be positive.
+    /// @param[in] corner        The corner frequency in Hz.
+    /// @param[in] samplingRate  The sampling rate in Hz.
+    /// @throws std::invalid_argument if the order or sampling rate is not
+    ///         positive or the corner is not in (0, samplingRate/2).
+    void initializeLowpass(int order, double corner, double samplingRate);
+    /// @brief Designs a Butterworth highpass filter.
+    /// @param[in] order         The filter order.  This must be positive.
+    /// @param[in] corner        The corner frequency in Hz.
+    /// @param[in] samplingRate  The sampling rate in Hz.
+    /// @throws std::invalid_argument if the order or sampling rate is not
+    ///         positive or the corner is not in (0, samplingRate/2).
+    void initializeHighpass(int order, double corner, double samplingRate);
+    /// @brief Designs a Butterworth bandpass filter.
+    /// @param[in] order         The order of the lowpass prototype.  The
+    ///                          bandpass has 2 x order poles.
+    /// @param[in] corners       The low and high corner frequencies in Hz.
+    /// @param[in] samplingRate  The sampling rate in Hz.
+    /// @throws std::invalid_argument if the order or sampling rate is not
+    ///         positive or the corners are not increasing and in
+    ///         (0, samplingRate/2).
+    void initializeBandpass(int order,
+                            const std::pair<double, double> &corners,
+                            double samplingRate);
+    /// @result True indicates the filter is initialized.
+    [[nodiscard]] bool isInitialized() const noexcept;
+    /// @result The number of second order sections.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getNumberOfSections() const;
+    /// @result The normalized numerator coefficients of each section.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] std::vector<double> getNumeratorCoefficients() const;
+    /// @result The normalized denominator coefficients of each section.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] std::vector<double> getDenominatorCoefficients() const;
+    /// @}
+
+    /// @name Streaming
+    /// @{
+
+    /// @brief Filters the signal in place.  The filter state at the end of
+    ///        the signal is retained so that the next call continues where
+    ///        this one left off.
+    /// @param[in] n      The number of samples.
+    /// @param[in,out] x  The signal to filter.  This is an array whose
+    ///                   dimension is [n].
+    /// @throws std::invalid_argument if n is positive and x is NULL.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void apply(int n, T *x);
+    /// @brief Filters the segment in place continuing from the current
+    ///        filter state.
+    /// @throws std::invalid_argument if the segment is NULL.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void apply(QPhase::Waveforms::Segment<T> *segment);
+    /// @brief Sets the filter state to rest.
+    void resetInitialConditions() noexcept;
+    /// @}
+
+    /// @name Waveforms
+    /// @{
+
+    /// @brief Filters all segments of the waveform in place.  The filter
+    ///        state is carried across segments that abut on the sample grid
+    ///        so splitting a contiguous signal does not change the output.
+    ///        After a gap (the next segment starts more than one and a half
+    ///        sampling periods after the previous segment's last sample) or
+    ///        an overlap the filter restarts from rest so the samples on
+    ///        either side do not affect one another.  This does not affect
+    ///        the streaming state.
+    /// @param[in,out] waveform  The waveform to filter.
+    /// @param[in] zeroPhase     If true then the waveform is filtered forward
+    ///                          then backward; this squares the magnitude
+    ///                          response and cancels the phase response.
+    /// @throws std::invalid_argument if the waveform is NULL.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void filter(QPhase::Waveforms::Waveform<T> *waveform,
+                bool zeroPhase = false) const;
+    /// @brief Filters many waveforms in place.  Each waveform is filtered
+    ///        as in the single waveform variant but the channels are
+    ///        processed together so that the vector registers hold samples
+    ///        from several channels.
+    /// @param[in,out] waveforms  The waveforms to filter.
+    /// @param[in] zeroPhase      If true then the waveforms are filtered
+    ///                           forward then backward.
+    /// @throws std::invalid_argument if any waveform is NULL.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void filter(const std::vector<QPhase::Waveforms::Waveform<T> *> &waveforms,
+                bool zeroPhase = false) const;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~SOSFilter();
+    /// @}
+private:
+    class SOSFilterImpl;
+    std::unique_ptr<SOSFilterImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,145 @@
+#ifndef QPHASE_PROCESSING_SPECTROGRAM_HPP
+#define QPHASE_PROCESSING_SPECTROGRAM_HPP
+#include <memory>
+namespace QPhase::Processing
+{
+/// @class Spectrogram "spectrogram.hpp" "qphase/processing/spectrogram.hpp"
+/// @brief Computes the magnitude of the short-time Fourier transform of a
+///        signal.  Frame j is the tapered window of samples
+///        [j*hop, j*hop + windowLength) and, since the signal is real, only
+///        the non-negative frequencies 0, df, ..., fftLength/2 df are kept
+///        where df = samplingRate/fftLength.
+/// @note The magnitudes are scaled by 2/sum(taper) (1/sum(taper) at zero and
+///       Nyquist) so a sinusoid of amplitude A at a frequency bin reads A.
+/// @note The tapers and FFT plans are cached and shared by all instances so
+///       initializing is cheap.  Two real frames are packed into one complex
+///       transform and the frames are divided among threads.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class Spectrogram
+{
+public:
+    /// @brief The taper applied to each frame.
+    enum class Window
+    {
+        Hann,     /*!< Hann (raised cosine) window. */
+        Hamming,  /*!< Hamming window. */
+        Blackman, /*!< Blackman window. */
+        Boxcar    /*!< No taper. */
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    Spectrogram();
+    /// @brief Copy constructor.
+    /// @param[in] spectrogram  The spectrogram from which to initialize this
+    ///                         class.
+    Spectrogram(const Spectrogram &spectrogram);
+    /// @brief Move constructor.
+    /// @param[in,out] spectrogram  The spectrogram from which to initialize
+    ///                             this class.  On exit, spectrogram's
+    ///                             behavior is undefined.
+    Spectrogram(Spectrogram &&spectrogram) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] spectrogram  The spectrogram to copy to this.
+    /// @result A deep copy of the input spectrogram.
+    Spectrogram& operator=(const Spectrogram &spectrogram);
+    /// @brief Move assignment.
+    /// @param[in,out] spectrogram  The spectrogram whose memory will be moved
+    ///                             to this.  On exit, spectrogram's behavior
+    ///                             is undefined.
+    /// @result The memory from spectrogram moved to this.
+    Spectrogram& operator=(Spectrogram &&spectrogram) noexcept;
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Initializes the transform.
+    /// @param[in] windowLength  The number of samples in a frame.
+    /// @param[in] hopLength     The number of samples between the starts of
+    ///                          consecutive frames.
+    /// @param[in] window        The taper.
+    /// @param[in] fftLength     The transform length.  If this is 0 then the
+    ///                          smallest efficient length no less than the
+    ///                          window length is used.
+    /// @throws std::invalid_argument if the window length is less than 2,
+    ///         the hop length is not positive, or the FFT length is positive
+    ///         and less than the window length.
+    void initialize(int windowLength, int hopLength,
+                    Window window = Window::Hann, int fftLength = 0);
+    /// @result True indicates the class is initialized.
+    [[nodiscard]] bool isInitialized() const noexcept;
+    /// @result The number of samples in a frame.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getWindowLength() const;
+    /// @result The number of samples between the starts of frames.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getHopLength() const;
+    /// @result The transform length.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getFFTLength() const;
+    /// @result The taper.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] Window getWindow() const;
+    /// @result The number of frequencies in a frame, fftLength/2 + 1.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getNumberOfFrequencies() const;
+    /// @param[in] nSamples  The number of samples in the signal.
+    /// @result The number of complete frames in the signal.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getNumberOfFrames(int nSamples) const;
+    /// @}
+
+    /// @name Threading
+    /// @{
+
+    /// @brief Sets the number of threads among which the frames are divided.
+    /// @param[in] nThreads  The number of threads.  By default this is 1.
+    /// @throws std::invalid_argument if nThreads is not positive.
+    void setNumberOfThreads(int nThreads);
+    /// @result The number of threads.
+    [[nodiscard]] int getNumberOfThreads() const noexcept;
+    /// @}
+
+    /// @name Transform
+    /// @{
+
+    /// @brief Computes the magnitudes of a range of frames.
+    /// @param[in] nSamples     The number of samples in the signal.
+    /// @param[in] x            The signal.  This is an array whose dimension
+    ///                         is [nSamples].
+    /// @param[in] firstFrame   The first frame to compute.
+    /// @param[in] nFrames      The number of frames to compute.
+    /// @param[out] magnitudes  The magnitudes.  This is a row-major array
+    ///                         whose dimension is
+    ///                         [nFrames x \c getNumberOfFrequencies()].
+    /// @throws std::invalid_argument if x or magnitudes is NULL or the frames
+    ///         are not in the range [0, \c getNumberOfFrames(nSamples)).
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void compute(int nSamples, const T *x,
+                 int firstFrame, int nFrames,
+                 float *magnitudes) const;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~Spectrogram();
+    /// @}
+private:
+    class SpectrogramImpl;
+    std::unique_ptr<SpectrogramImpl> pImpl;
+};
+}
+#endif
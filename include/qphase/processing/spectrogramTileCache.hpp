@@ -0,0 +1,148 @@
+#ifndef QPHASE_PROCESSING_SPECTROGRAM_TILE_CACHE_HPP
+#define QPHASE_PROCESSING_SPECTROGRAM_TILE_CACHE_HPP
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+namespace QPhase::Waveforms
+{
+template<class T> class Segment;
+}
+namespace QPhase::Processing
+{
+template<class T> class Spectrogram;
+/// @class SpectrogramTileCache "spectrogramTileCache.hpp" "qphase/processing/spectrogramTileCache.hpp"
+/// @brief Caches the spectrogram of a segment in tiles of a fixed number of
+///        frames.  A tile is keyed by the channel, the spectrogram's window,
+///        window length, FFT length, and hop length, the segment's start
+///        time, and the tile's position in the segment.  Requesting a time
+///        range only computes the tiles that are not already cached so
+///        panning a display computes just the newly exposed tiles, and
+///        switching back to earlier parameters reuses their tiles.
+/// @note The least recently used tiles are evicted once the capacity is
+///       reached.  A tile at the end of a segment that has fewer than the
+///       full number of frames is recomputed when the segment has grown.
+///       Tiles computed from data that has since changed, e.g., after
+///       refiltering, must be released with \c erase().
+/// @note The cache is thread safe.  Tiles are immutable once returned.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class SpectrogramTileCache
+{
+public:
+    /// @brief A block of consecutive frames.
+    struct Tile
+    {
+        /// The magnitudes.  This is a row-major array whose dimension is
+        /// [nFrames x nFrequencies].
+        std::vector<float> magnitudes;
+        /// The time (UTC) of the first sample of the first frame in
+        /// microseconds since the epoch.  A frame's center is half a window
+        /// later.
+        std::chrono::microseconds startTime{0};
+        /// The time between frames in seconds.
+        double frameInterval{0};
+        /// The spacing of the frequencies in Hz.
+        double frequencySpacing{0};
+        /// The index of the first frame in the segment.
+        int64_t firstFrame{0};
+        /// The number of frames.
+        int nFrames{0};
+        /// The number of frequencies in each frame.
+        int nFrequencies{0};
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    SpectrogramTileCache();
+    /// @brief Copy constructor.  The tiles are shared with the input.
+    /// @param[in] cache  The cache from which to initialize this class.
+    SpectrogramTileCache(const SpectrogramTileCache &cache);
+    /// @brief Move constructor.
+    /// @param[in,out] cache  The cache from which to initialize this class.
+    ///                       On exit, cache's behavior is undefined.
+    SpectrogramTileCache(SpectrogramTileCache &&cache) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.  The tiles are shared with the input.
+    /// @param[in] cache  The cache to copy to this.
+    /// @result A copy of the input cache.
+    SpectrogramTileCache& operator=(const SpectrogramTileCache &cache);
+    /// @brief Move assignment.
+    /// @param[in,out] cache  The cache whose memory will be moved to this.
+    ///                       On exit, cache's behavior is undefined.
+    /// @result The memory from cache moved to this.
+    SpectrogramTileCache& operator=(SpectrogramTileCache &&cache) noexcept;
+    /// @}
+
+    /// @name Properties
+    /// @{
+
+    /// @brief Sets the number of frames in a tile.  This releases the
+    ///        cached tiles.
+    /// @param[in] nFrames  The number of frames in a tile.
+    /// @throws std::invalid_argument if nFrames is not positive.
+    void setFramesPerTile(int nFrames);
+    /// @result The number of frames in a tile.  By default this is 128.
+    [[nodiscard]] int getFramesPerTile() const noexcept;
+    /// @brief Sets the maximum number of cached tiles.
+    /// @param[in] nTiles  The maximum number of tiles.
+    /// @throws std::invalid_argument if nTiles is not positive.
+    void setCapacity(int nTiles);
+    /// @result The maximum number of cached tiles.  By default this is 512.
+    [[nodiscard]] int getCapacity() const noexcept;
+    /// @result The number of cached tiles.
+    [[nodiscard]] int size() const noexcept;
+    /// @result The number of tiles computed since construction.  A tile
+    ///         found in the cache is not counted.
+    [[nodiscard]] int64_t getNumberOfComputedTiles() const noexcept;
+    /// @}
+
+    /// @name Tiles
+    /// @{
+
+    /// @brief Gets the tiles whose frames overlap a time range.  Missing
+    ///        tiles are computed and cached.
+    /// @param[in] channel      The channel name, e.g., UU.FORK.HHZ.01.
+    /// @param[in] spectrogram  The spectrogram engine.
+    /// @param[in] segment      The segment of the channel's waveform.
+    /// @param[in] startTime    The start of the time range (UTC) in
+    ///                         microseconds since the epoch.
+    /// @param[in] endTime      The end of the time range (UTC) in
+    ///                         microseconds since the epoch.
+    /// @result The tiles in increasing time.  This is empty if no complete
+    ///         frame overlaps the range.
+    /// @throws std::invalid_argument if the spectrogram is not initialized,
+    ///         the segment has no sampling rate, or the start time exceeds
+    ///         the end time.
+    [[nodiscard]] std::vector<std::shared_ptr<const Tile>>
+        getTiles(const std::string &channel,
+                 const Spectrogram<T> &spectrogram,
+                 const QPhase::Waveforms::Segment<T> &segment,
+                 const std::chrono::microseconds &startTime,
+                 const std::chrono::microseconds &endTime);
+    /// @brief Releases the cached tiles of a channel.
+    /// @param[in] channel  The channel name.
+    void erase(const std::string &channel);
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Releases the cached tiles and resets the class.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~SpectrogramTileCache();
+    /// @}
+private:
+    class SpectrogramTileCacheImpl;
+    std::unique_ptr<SpectrogramTileCacheImpl> pImpl;
+};
+}
+#endif
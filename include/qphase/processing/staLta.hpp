@@ -0,0 +1,193 @@
+#ifndef QPHASE_PROCESSING_STA_LTA_HPP
+#define QPHASE_PROCESSING_STA_LTA_HPP
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+namespace QPhase::Waveforms
+{
+template<class T> class Gather;
+template<class T> class Waveform;
+}
+namespace QPhase::Processing
+{
+/// @class STALTA "staLta.hpp" "qphase/processing/staLta.hpp"
+/// @brief A short-term average over long-term average (STA/LTA) detector
+///        for many channels at once.  The characteristic function is the
+///        ratio of the average signal energy in a short window to that in
+///        a long window.  A trigger turns on when the ratio reaches the on
+///        threshold and off when it falls below the off threshold.
+/// @note The averages are recurrences in time so the channels, not the
+///       samples, are processed in parallel: tiles of the row-major input
+///       are transposed so that consecutive channels occupy the lanes of a
+///       vector register.  The state is kept between calls to \c process()
+///       so a stream can be fed in arbitrary chunks.
+/// @note The characteristic function is 0 until a full long window of
+///       samples has been processed.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T>
+class STALTA
+{
+public:
+    /// @brief Defines the averaging.
+    enum class Type
+    {
+        Recursive, /*!< Exponentially weighted averages with time constants
+                        of the short and long windows.  This needs constant
+                        state per channel. */
+        Classic    /*!< Boxcar averages over the short and long windows
+                        ending at the current sample.  This keeps a long
+                        window of history per channel. */
+    };
+    /// @brief A detection on one channel.
+    struct Trigger
+    {
+        int channel{0}; /*!< The channel (row) index. */
+        std::chrono::microseconds onTime{0};  /*!< The time (UTC) at which
+                                                   the trigger turned on. */
+        std::chrono::microseconds offTime{0}; /*!< The time (UTC) at which
+                                                   the trigger turned off. */
+        double maximum{0}; /*!< The largest STA/LTA while triggered. */
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    STALTA();
+    /// @brief Copy constructor.
+    /// @param[in] detector  The detector from which to initialize this class.
+    STALTA(const STALTA &detector);
+    /// @brief Move constructor.
+    /// @param[in,out] detector  The detector from which to initialize this
+    ///                          class.  On exit, detector's behavior is
+    ///                          undefined.
+    STALTA(STALTA &&detector) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] detector  The detector to copy to this.
+    /// @result A deep copy of the input detector.
+    STALTA& operator=(const STALTA &detector);
+    /// @brief Move assignment.
+    /// @param[in,out] detector  The detector whose memory will be moved to
+    ///                          this.  On exit, detector's behavior is
+    ///                          undefined.
+    /// @result The memory from detector moved to this.
+    STALTA& operator=(STALTA &&detector) noexcept;
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Initializes the detector.
+    /// @param[in] nChannels     The number of channels.
+    /// @param[in] samplingRate  The sampling rate in Hz.
+    /// @param[in] shortWindow   The duration of the short window in seconds.
+    /// @param[in] longWindow    The duration of the long window in seconds.
+    /// @param[in] type          The averaging.
+    /// @throws std::invalid_argument if nChannels or samplingRate is not
+    ///         positive, the short window is less than one sample, or the
+    ///         long window is not longer than the short window.
+    void initialize(int nChannels, double samplingRate,
+                    double shortWindow, double longWindow,
+                    Type type = Type::Recursive);
+    /// @result True indicates the class is initialized.
+    [[nodiscard]] bool isInitialized() const noexcept;
+    /// @result The number of channels.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getNumberOfChannels() const;
+    /// @result The sampling rate in Hz.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] double getSamplingRate() const;
+    /// @result The short and long window lengths in samples.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] std::pair<int, int> getWindowLengths() const;
+    /// @brief Sets the trigger thresholds.
+    /// @param[in] onThreshold   A trigger turns on when the STA/LTA reaches
+    ///                          this value.
+    /// @param[in] offThreshold  A trigger turns off when the STA/LTA falls
+    ///                          below this value.
+    /// @throws std::invalid_argument if the off threshold is not positive or
+    ///         exceeds the on threshold.
+    void setTriggerThresholds(double onThreshold, double offThreshold);
+    /// @result The on and off thresholds.  By default these are 3 and 1.5.
+    [[nodiscard]] std::pair<double, double> getTriggerThresholds() const noexcept;
+    /// @}
+
+    /// @name Streaming
+    /// @{
+
+    /// @brief Resets the averages and open triggers.  Completed triggers
+    ///        are kept; see \c clearTriggers().
+    /// @param[in] startTime  The time (UTC) of the next sample to process
+    ///                       in microseconds since the epoch.
+    void reset(const std::chrono::microseconds &startTime = std::chrono::microseconds {0}) noexcept;
+    /// @brief Processes the next chunk of samples of every channel.
+    /// @param[in] nSamples          The number of samples per channel.
+    /// @param[in] leadingDimension  The distance in elements between the
+    ///                              starts of consecutive rows of x and
+    ///                              characteristicFunction.  This must be
+    ///                              at least nSamples.
+    /// @param[in] x                 The row-major [nChannels x
+    ///                              leadingDimension] signals.
+    /// @param[out] characteristicFunction  The row-major [nChannels x
+    ///                              leadingDimension] STA/LTA.
+    /// @throws std::invalid_argument if the leading dimension is too small
+    ///         or x or characteristicFunction is NULL.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void process(int nSamples, int leadingDimension,
+                 const T *x, T *characteristicFunction);
+    /// @brief Ends any open triggers at the last processed sample.
+    void closeTriggers();
+    /// @result The completed triggers in the order they turned off.
+    [[nodiscard]] std::vector<Trigger> getTriggers() const;
+    /// @brief Discards the completed triggers.
+    void clearTriggers() noexcept;
+    /// @result The number of samples per channel processed since the last
+    ///         reset.
+    [[nodiscard]] int64_t getNumberOfProcessedSamples() const noexcept;
+    /// @}
+
+    /// @name Batch
+    /// @{
+
+    /// @brief Computes the STA/LTA of every channel of a gather.  The
+    ///        detector is reset to the gather's start time and open
+    ///        triggers are closed at its end.  The gap mask is honored:
+    ///        each recorded run of a channel is processed from rest, with
+    ///        its own warm-up, and open triggers are closed at the run's
+    ///        last sample.  The characteristic function is 0 in gaps.
+    /// @param[in] gather  The gather.
+    /// @result The characteristic functions on the gather's grid.
+    /// @throws std::invalid_argument if the number of channels or the
+    ///         sampling rate does not match the detector.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] Waveforms::Gather<T> process(const Waveforms::Gather<T> &gather);
+    /// @brief Computes the STA/LTA of a single-channel detector's waveform.
+    ///        Each segment is processed independently.
+    /// @param[in] waveform  The waveform.
+    /// @result The characteristic function with the waveform's segments.
+    /// @throws std::invalid_argument if the detector does not have one
+    ///         channel or a segment's sampling rate does not match.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] Waveforms::Waveform<T> process(const Waveforms::Waveform<T> &waveform);
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~STALTA();
+    /// @}
+private:
+    class STALTAImpl;
+    std::unique_ptr<STALTAImpl> pImpl;
+};
+}
+#endif
@@ -1,11 +1,16 @@
 #ifndef QPHASE_WAVEFORMS_CHANNEL_HPP
 #define QPHASE_WAVEFORMS_CHANNEL_HPP
+#include <chrono>
 #include <memory>
 namespace QPhase::Waveforms
 {
 template<class T> class Waveform;
 class SimpleResponse;
 }
+namespace QPhase::Processing
+{
+template<class T> class Pipeline;
+}
 namespace QPhase::Waveforms
 {
 /// @class Channel "channel.hpp" "qphase/waveforms/channel.hpp"
@@ -115,6 +120,44 @@ public:
     [[nodiscard]] bool haveSimpleResponse() const noexcept;
     /// @}
 
+    /// @name Processing (Optional)
+    /// @{
+
+    /// @brief Sets the processing to apply to the waveform.  The processing
+    ///        is not performed here; it is performed on demand by
+    ///        \c getProcessedWaveform() for the requested window only.
+    /// @param[in] pipeline  The processing pipeline.
+    /// @note This invalidates all previously processed windows.
+    void setProcessingPipeline(const QPhase::Processing::Pipeline<T> &pipeline);
+    /// @result The processing pipeline.  If none was set then this is an
+    ///         empty pipeline.
+    [[nodiscard]] const QPhase::Processing::Pipeline<T> &getProcessingPipelineReference() const noexcept;
+    /// @result True indicates a pipeline with at least one operation was set.
+    [[nodiscard]] bool haveProcessingPipeline() const noexcept;
+    /// @brief Gets the processed waveform in a time window.  The last few
+    ///        results are memoized by pipeline, window, and resolution so a
+    ///        repeated request for the same window (e.g., a repaint) does not
+    ///        reprocess the data.  Any other window, including a sub-window
+    ///        of a memoized one, is processed anew since operations such as
+    ///        demeaning, tapering, and normalization depend on the window.
+    /// @param[in] startTime   The start time (UTC) of the window in
+    ///                        microseconds since the epoch.
+    /// @param[in] endTime     The end time (UTC) of the window in
+    ///                        microseconds since the epoch.
+    /// @param[in] resolution  The desired number of samples per second.  If
+    ///                        positive, densely sampled data are reduced to
+    ///                        their envelope.  See
+    ///                        \c QPhase::Processing::Pipeline::evaluate().
+    /// @result The processed samples in [startTime, endTime].  If no pipeline
+    ///         was set then these are the unprocessed samples.
+    /// @throws std::runtime_error if \c haveWaveform() is false.
+    /// @throws std::invalid_argument if the start time exceeds the end time.
+    [[nodiscard]] std::shared_ptr<const Waveform<T>>
+        getProcessedWaveform(const std::chrono::microseconds &startTime,
+                             const std::chrono::microseconds &endTime,
+                             double resolution = 0) const;
+    /// @}
+
     /// @name Destructors
     /// @{
 
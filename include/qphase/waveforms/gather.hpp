@@ -0,0 +1,203 @@
+#ifndef QPHASE_WAVEFORMS_GATHER_HPP
+#define QPHASE_WAVEFORMS_GATHER_HPP
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+namespace QPhase::Waveforms
+{
+template<class T> class Station;
+}
+namespace QPhase::Waveforms
+{
+/// @class Gather "gather.hpp" "qphase/waveforms/gather.hpp"
+/// @brief A time window of many channels packed into one matrix.  Row i
+///        holds the samples of channel i on a common time grid
+///        t_j = t_0 + j/f_s.  The matrix is a single allocation aligned to
+///        64 bytes and each row is padded to a multiple of 64 bytes so
+///        every row starts on its own cache line.  This lets operations
+///        across channels run as tight loops and lets threads work on
+///        separate rows without sharing cache lines.
+/// @note Samples that are not covered by the channel's waveform (gaps) are
+///       zero and are flagged in a gap mask with the same layout as the
+///       data.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T>
+class Gather
+{
+public:
+    /// @brief The role of a row's channel in its sensor.
+    enum class Component
+    {
+        Unknown,     /*!< The channel of a single-channel sensor. */
+        Vertical,    /*!< The vertical channel of a sensor. */
+        Horizontal1, /*!< The first horizontal channel of a three-channel
+                          sensor - e.g., N, 1, or R. */
+        Horizontal2  /*!< The second horizontal channel of a three-channel
+                          sensor - e.g., E, 2, or T. */
+    };
+    /// @brief Describes a row of the gather.
+    struct ChannelMetadata
+    {
+        std::string network;      /*!< The network code - e.g., UU. */
+        std::string station;      /*!< The station name - e.g., BRTU. */
+        std::string channel;      /*!< The channel code - e.g., HHZ. */
+        std::string locationCode; /*!< The location code - e.g., 01. */
+        double latitude{0};       /*!< The sensor latitude in degrees.
+                                       This is NaN if unknown. */
+        double longitude{0};      /*!< The sensor longitude in degrees.
+                                       This is NaN if unknown. */
+        double elevation{0};      /*!< The sensor elevation in meters.
+                                       This is NaN if unknown. */
+        double dip{0};            /*!< The channel dip in degrees.  This is
+                                       NaN if unknown. */
+        double azimuth{0};        /*!< The channel azimuth in degrees.  This
+                                       is NaN if unknown. */
+        Component component{Component::Unknown}; /*!< The channel's role in
+                                                       its sensor.  The rows
+                                                       of a three-channel
+                                                       sensor are
+                                                       consecutive. */
+        int numberOfValidSamples{0}; /*!< The number of samples in the row
+                                          that are not in a gap. */
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    Gather();
+    /// @brief Copy constructor.
+    /// @param[in] gather  The gather from which to initialize this class.
+    Gather(const Gather &gather);
+    /// @brief Move constructor.
+    /// @param[in,out] gather  The gather from which to initialize this class.
+    ///                        On exit, gather's behavior is undefined.
+    Gather(Gather &&gather) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] gather  The gather to copy to this.
+    /// @result A deep copy of the input gather.
+    Gather& operator=(const Gather &gather);
+    /// @brief Move assignment.
+    /// @param[in,out] gather  The gather whose memory will be moved to this.
+    ///                        On exit, gather's behavior is undefined.
+    /// @result The memory from gather moved to this.
+    Gather& operator=(Gather &&gather) noexcept;
+    /// @}
+
+    /// @name Construction
+    /// @{
+
+    /// @brief Packs the channels of the stations into the gather in one
+    ///        pass over the waveforms.  Rows are ordered by station then by
+    ///        three-channel sensors (vertical, north, east), single-channel
+    ///        vertical sensors, and single-channel sensors.
+    /// @param[in] stations      The stations to pack.
+    /// @param[in] startTime     The time (UTC) of the first column in
+    ///                          microseconds since the epoch.
+    /// @param[in] endTime       The time (UTC) of the last column in
+    ///                          microseconds since the epoch.
+    /// @param[in] samplingRate  The sampling rate of the gather in Hz.
+    ///                          Segments sampled at a different rate are
+    ///                          resampled to this rate.
+    /// @note Each segment is placed at the column nearest its first sample
+    ///       so the gather time of a sample may differ from its recorded
+    ///       time by up to half a sampling period.
+    /// @throws std::invalid_argument if the start time exceeds the end time,
+    ///         the sampling rate is not positive, or a segment's rate cannot
+    ///         be resampled to the gather rate.
+    void build(const std::vector<Station<T>> &stations,
+               const std::chrono::microseconds &startTime,
+               const std::chrono::microseconds &endTime,
+               double samplingRate);
+    /// @result The number of channels (rows).
+    [[nodiscard]] int getNumberOfChannels() const noexcept;
+    /// @result The number of samples (columns) in each row.
+    [[nodiscard]] int getNumberOfSamples() const noexcept;
+    /// @result The distance in elements between the starts of consecutive
+    ///         rows.  This is at least \c getNumberOfSamples().
+    [[nodiscard]] int getLeadingDimension() const noexcept;
+    /// @result The time (UTC) of the first column in microseconds since the
+    ///         epoch.
+    [[nodiscard]] std::chrono::microseconds getStartTime() const noexcept;
+    /// @result The sampling rate of the gather in Hz.
+    /// @throws std::runtime_error if the gather was not built.
+    [[nodiscard]] double getSamplingRate() const;
+    /// @}
+
+    /// @name Data
+    /// @{
+
+    /// @result A pointer to the [nChannels x leadingDimension] row-major
+    ///         data matrix.
+    [[nodiscard]] const T *getDataPointer() const noexcept;
+    [[nodiscard]] T *getDataPointer() noexcept;
+    /// @result A pointer to the samples of the given channel.
+    /// @throws std::invalid_argument if the channel is out of range.
+    [[nodiscard]] const T *getRowPointer(int channel) const;
+    [[nodiscard]] T *getRowPointer(int channel);
+    /// @result A pointer to the [nChannels x leadingDimension] row-major
+    ///         gap mask.  A value of 1 indicates a recorded sample and 0
+    ///         indicates a gap.
+    [[nodiscard]] const uint8_t *getMaskPointer() const noexcept;
+    /// @result A pointer to the gap mask of the given channel.
+    /// @throws std::invalid_argument if the channel is out of range.
+    [[nodiscard]] const uint8_t *getMaskRowPointer(int channel) const;
+    /// @brief Provides write access to a channel's gap mask - e.g., to mark
+    ///        samples invalid after combining rows.
+    /// @param[in] channel  The row.  This must be in the range
+    ///                     [0, \c getNumberOfChannels()).
+    /// @result A pointer to the \c getNumberOfSamples() mask values of the
+    ///         given channel.  Only 0 (gap) and 1 (recorded) may be written.
+    ///         A caller that changes the mask must update the row's
+    ///         \c ChannelMetadata::numberOfValidSamples with
+    ///         \c setMetadata() and should zero the samples it flags as
+    ///         gaps.
+    /// @throws std::invalid_argument if the channel is out of range.
+    [[nodiscard]] uint8_t *getMaskRowPointer(int channel);
+    /// @result True indicates the sample was recorded and false indicates
+    ///         it is in a gap.
+    /// @throws std::invalid_argument if the channel or sample is out of
+    ///         range.
+    [[nodiscard]] bool isValid(int channel, int sample) const;
+    /// @}
+
+    /// @name Metadata
+    /// @{
+
+    /// @result The metadata of each row.
+    [[nodiscard]] const std::vector<ChannelMetadata> &getMetadataReference() const noexcept;
+    /// @brief Replaces the metadata of a row - e.g., after the row's
+    ///        samples were rotated to a new orientation.
+    /// @param[in] channel   The row.
+    /// @param[in] metadata  The row's new metadata.
+    /// @throws std::invalid_argument if the channel is out of range.
+    void setMetadata(int channel, const ChannelMetadata &metadata);
+    /// @result The row of the given channel or -1 if it is not in the
+    ///         gather.
+    [[nodiscard]] int findChannel(const std::string &network,
+                                  const std::string &station,
+                                  const std::string &channel,
+                                  const std::string &locationCode) const noexcept;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~Gather();
+    /// @}
+private:
+    class GatherImpl;
+    std::unique_ptr<GatherImpl> pImpl;
+};
+}
+#endif
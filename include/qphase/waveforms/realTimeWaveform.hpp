@@ -0,0 +1,153 @@
+#ifndef QPHASE_WAVEFORMS_REAL_TIME_WAVEFORM_HPP
+#define QPHASE_WAVEFORMS_REAL_TIME_WAVEFORM_HPP
+#include <chrono>
+#include <cstdint>
+#include <memory>
+namespace QPhase::Waveforms
+{
+template<class T> class Segment;
+template<class T> class Waveform;
+}
+namespace QPhase::Waveforms
+{
+/// @class RealTimeWaveform "realTimeWaveform.hpp" "qphase/waveforms/realTimeWaveform.hpp"
+/// @brief A fixed capacity waveform for continuously arriving data packets.
+///        Samples live in a ring buffer on a grid defined by the sampling
+///        rate and the start time of the first packet so appending a packet
+///        costs only the copy of its samples.  Data older than the
+///        retention window relative to the latest sample are overwritten
+///        as new data arrive.
+/// @note Packets may arrive out of order.  Each packet is placed at the
+///       grid index nearest its start time so a late packet fills its gap.
+///       Samples already received are not overwritten so duplicate packets
+///       are harmless.  Packets older than the retention window are dropped.
+/// @note There may be one writer (the thread calling \c append() and
+///       \c evict()) and any number of readers.  Readers take snapshots
+///       without locking and never block the writer; a sample being written
+///       while it is read is reported as not yet received.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+template<class T = double>
+class RealTimeWaveform
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    RealTimeWaveform();
+    /// @brief Move constructor.
+    /// @param[in,out] waveform  The waveform from which to initialize this
+    ///                          class.  On exit, waveform's behavior is
+    ///                          undefined.
+    RealTimeWaveform(RealTimeWaveform &&waveform) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Move assignment.
+    /// @param[in,out] waveform  The waveform whose memory will be moved to
+    ///                          this.  On exit, waveform's behavior is
+    ///                          undefined.
+    /// @result The memory from waveform moved to this.
+    RealTimeWaveform& operator=(RealTimeWaveform &&waveform) noexcept;
+    /// @}
+
+    /// @name Initialization
+    /// @{
+
+    /// @brief Initializes the buffer.
+    /// @param[in] samplingRate  The sampling rate of the packets in Hz.
+    /// @param[in] retention     The duration of data to retain.
+    /// @throws std::invalid_argument if the sampling rate or retention is
+    ///         not positive or the buffer would be too large.
+    void initialize(double samplingRate,
+                    const std::chrono::microseconds &retention);
+    /// @brief Initializes the buffer with an exact sampling rate.
+    /// @param[in] numerator    The numerator of the sampling rate in Hz.
+    /// @param[in] denominator  The denominator of the sampling rate in Hz.
+    /// @param[in] retention    The duration of data to retain.
+    /// @throws std::invalid_argument if the numerator, denominator, or
+    ///         retention is not positive or the buffer would be too large.
+    void initialize(int64_t numerator, int64_t denominator,
+                    const std::chrono::microseconds &retention);
+    /// @result True indicates the class is initialized.
+    [[nodiscard]] bool isInitialized() const noexcept;
+    /// @result The number of samples the buffer holds.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getCapacity() const;
+    /// @result The sampling rate in Hz.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] double getSamplingRate() const;
+    /// @}
+
+    /// @name Writer
+    /// @{
+
+    /// @brief Appends a packet.
+    /// @param[in] packet  The packet.  Its sampling rate must match the
+    ///                    buffer's sampling rate.
+    /// @result The number of samples that were stored.  Samples that were
+    ///         already received or are older than the retention window or
+    ///         the eviction time are not stored.
+    /// @throws std::invalid_argument if the sampling rate does not match.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    int append(const Segment<T> &packet);
+    /// @brief Appends a packet.
+    /// @param[in] startTime  The time (UTC) of the first sample in
+    ///                       microseconds since the epoch.
+    /// @param[in] nSamples   The number of samples in the packet.
+    /// @param[in] data       The samples.  This is an array whose dimension
+    ///                       is [nSamples].
+    /// @result The number of samples that were stored.
+    /// @throws std::invalid_argument if data is NULL.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    int append(const std::chrono::microseconds &startTime,
+               int nSamples, const T *data);
+    /// @brief Discards all samples before the given time.  Packets that
+    ///        arrive later for times before this are dropped.  This is O(1).
+    /// @param[in] time  The eviction time (UTC) in microseconds since the
+    ///                  epoch.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void evict(const std::chrono::microseconds &time);
+    /// @result The number of samples that were dropped because they arrived
+    ///         after they had left the retention window or were evicted.
+    [[nodiscard]] int64_t getNumberOfDroppedSamples() const noexcept;
+    /// @}
+
+    /// @name Reader
+    /// @{
+
+    /// @result True indicates a packet was received.
+    [[nodiscard]] bool haveData() const noexcept;
+    /// @result The time (UTC) of the most recent sample in microseconds
+    ///         since the epoch.
+    /// @throws std::runtime_error if \c haveData() is false.
+    [[nodiscard]] std::chrono::microseconds getLatestTime() const;
+    /// @result A copy of the retained samples.  Each contiguous run of
+    ///         received samples is a segment.
+    [[nodiscard]] Waveform<T> getSnapshot() const;
+    /// @result A copy of the retained samples in [startTime, endTime].
+    /// @throws std::invalid_argument if the start time exceeds the end time.
+    [[nodiscard]] Waveform<T> getSnapshot(const std::chrono::microseconds &startTime,
+                                          const std::chrono::microseconds &endTime) const;
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class and releases memory.  This must not be called
+    ///        while other threads use the class.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~RealTimeWaveform();
+    /// @}
+
+    RealTimeWaveform(const RealTimeWaveform &) = delete;
+    RealTimeWaveform& operator=(const RealTimeWaveform &) = delete;
+private:
+    class RealTimeWaveformImpl;
+    std::unique_ptr<RealTimeWaveformImpl> pImpl;
+};
+}
+#endif
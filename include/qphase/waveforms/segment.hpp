@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <utility>
 namespace QPhase::Waveforms
 {
 /// @brief This defines a waveform segment.  A waveform segment is a continuous
@@ -51,8 +52,15 @@ public:
     /// @param[in] data      The waveform data for this segment to set.
     ///                      This is an array with dimension [nSamples].
     template<typename U> void setData(int nSamples, const U *data);
+    /// @param[in,out] data  The waveform data to set for this segment.
+    ///                      On exit, data's behavior is undefined.
+    void setData(std::vector<T> &&data);
     /// @result A pointer to the waveform data for this segment. 
     const T *getDataPointer() const noexcept;
+    /// @result A mutable pointer to the waveform data for this segment.
+    ///         This exists for in-place processing; the number of samples
+    ///         cannot be changed through it.
+    T *getDataPointer() noexcept;
     /// @result The waveform data for thsi segment.
     std::vector<T> getData() const noexcept;
  
@@ -64,16 +72,34 @@ public:
     /// @{
 
     /// @brief Sets the sampling rate.
-    /// @param[in] samplingRate  The sampling rate in Hz.
+    /// @param[in] samplingRate  The sampling rate in Hz.  Internally, this is
+    ///                          represented as the simplest fraction within
+    ///                          a relative tolerance of 10^-7 of the given
+    ///                          rate so that, e.g., a single-precision 
+    ///                          sampling period of 0.025 s yields exactly
+    ///                          40 Hz.
     /// @throws std::invalid_argument if the sampling rate is not positive.
     void setSamplingRate(double samplingRate);
+    /// @brief Sets the sampling rate as the exact fraction
+    ///        numerator/denominator Hz.  Sample times are computed from
+    ///        this fraction with integer arithmetic so they do not drift.
+    /// @param[in] numerator    The numerator of the sampling rate.
+    /// @param[in] denominator  The denominator of the sampling rate.
+    /// @throws std::invalid_argument if either is not positive.
+    void setSamplingRate(int64_t numerator, int64_t denominator);
+    /// @result The sampling rate in Hz as the reduced fraction
+    ///         (numerator, denominator).
+    /// @throws std::runtime_error if \c haveSamplingRate() is false.
+    [[nodiscard]] std::pair<int64_t, int64_t> getSamplingRateAsFraction() const;
     /// @result The sampling rate in Hz.
     /// @throws std::runtime_error if \c haveSamplingRate() is false.
     [[nodiscard]] double getSamplingRate() const;
     /// @result The sampling period in seconds.
     /// @throws std::runtime_error if \c haveSamplingRate() is false.
     [[nodiscard]] double getSamplingPeriod() const;
-    /// @result The sampling period in microseconds.
+    /// @result The sampling period rounded to the nearest microsecond.
+    /// @note Use \c getSampleTime() to compute sample times as this
+    ///       rounding accumulates error.
     /// @throws std::runtime_error if \c haveSamplingRate() is false.
     [[nodiscard]] std::chrono::microseconds getSamplingPeriodInMicroSeconds() const;
     /// @result True indicates the sampling rate was set.
@@ -93,10 +119,30 @@ public:
     
     /// @result The start time of the segment in microseconds since the epoch.
     [[nodiscard]] std::chrono::microseconds getStartTime() const noexcept;
-    /// @result The end time of the segment in microseconds since the epoch.
+    /// @result The time of the last sample in the segment, rounded to the
+    ///         nearest microsecond, in microseconds since the epoch.
     [[nodiscard]] std::chrono::microseconds getEndTime() const noexcept;
     /// @}
 
+    /// @name Sample Indexing
+    /// @{
+
+    /// @param[in] time  The time (UTC) in microseconds since the epoch.
+    /// @result The index of the last sample at or before the given time.
+    ///         This is computed exactly from the sampling rate fraction
+    ///         with integer arithmetic and it may be negative
+    ///         or exceed \c getNumberOfSamples() - 1 when the time is
+    ///         outside of the segment.
+    /// @throws std::runtime_error if \c haveSamplingRate() is false.
+    [[nodiscard]] int64_t getSampleIndex(const std::chrono::microseconds &time) const;
+    /// @param[in] index  The sample index.
+    /// @result The time (UTC) of the index'th sample, rounded to the nearest
+    ///         microsecond, in microseconds since the epoch.  This is
+    ///         computed exactly from the sampling rate fraction.
+    /// @throws std::runtime_error if \c haveSamplingRate() is false.
+    [[nodiscard]] std::chrono::microseconds getSampleTime(int64_t index) const;
+    /// @}
+
     /// @name Destructors
     /// @{
 
@@ -3,6 +3,7 @@
 #include <memory>
 #include <chrono>
 #include <vector>
+#include <utility>
 namespace QPhase::Waveforms
 {
 template<class T> class Segment;
@@ -28,6 +29,21 @@ public:
         Unknown,   /*!< Unknown waveform type.  Code will try to figure it out. */
         UNKNOWN = Unknown
     };
+    /// @brief Defines how samples that are covered by more than one segment
+    ///        are resolved when merging.
+    enum class OverlapPolicy
+    {
+        KeepFirst, /*!< Retain the samples of the earlier segment. */
+        KeepLast,  /*!< Retain the samples of the later segment. */
+        Average    /*!< Average the overlapping samples. */
+    };
+    /// @brief The samples of a segment that fall in a time window.
+    struct SampleWindow
+    {
+        int segment{0};    /*!< The index of the segment. */
+        int startIndex{0}; /*!< The first sample in the window. */
+        int endIndex{0};   /*!< One past the last sample in the window. */
+    };
 public:
     /// @name Constructors
     /// @{
@@ -114,6 +130,59 @@ public:
     /// @result The waveform segments.
     [[nodiscard]] std::vector<Segment<T>> getSegments() const noexcept;
 
+    /// @name Time Lookup
+    /// @{
+
+    /// @param[in] time  The time (UTC) in microseconds since the epoch.
+    /// @result The index of the segment whose samples span the given time.
+    ///         If no segment spans this time then this is -1.
+    /// @note This is a binary search over the segment start times.
+    [[nodiscard]] int findSegment(const std::chrono::microseconds &time) const noexcept;
+    /// @param[in] t0  The start time (UTC) of the window in microseconds
+    ///                since the epoch.
+    /// @param[in] t1  The end time (UTC) of the window in microseconds
+    ///                since the epoch.
+    /// @result The half-open range [first, second) of segment indices that
+    ///         can intersect the window [t0, t1].  If no segment intersects
+    ///         the window then first == second.
+    /// @note This is O(log number of segments).
+    [[nodiscard]] std::pair<int, int> getSegmentIndices(const std::chrono::microseconds &t0, const std::chrono::microseconds &t1) const noexcept;
+    /// @param[in] t0  The start time (UTC) of the window in microseconds
+    ///                since the epoch.
+    /// @param[in] t1  The end time (UTC) of the window in microseconds
+    ///                since the epoch.
+    /// @result The sample ranges of each segment that fall in [t0, t1].
+    /// @throws std::invalid_argument if t0 > t1.
+    [[nodiscard]] std::vector<SampleWindow> samplesIn(const std::chrono::microseconds &t0, const std::chrono::microseconds &t1) const;
+    /// @}
+
+    /// @brief Merges the waveform segments in a single pass.  Temporally
+    ///        adjacent segments with the same sampling rate whose start
+    ///        times fall on the sampling grid of the preceding segment
+    ///        are coalesced into one segment.  Segments without samples
+    ///        are removed.
+    /// @param[in] policy     Defines how overlapping samples are resolved.
+    ///                       Segments are taken in order of start time, and
+    ///                       segments with the same start time keep their
+    ///                       order, so with \c KeepFirst the earliest
+    ///                       segment wins and with \c KeepLast the latest
+    ///                       one does.  \c Average weights every segment
+    ///                       covering a sample equally.
+    /// @param[in] tolerance  The allowable misalignment, as a fraction of
+    ///                       a sampling period, for a segment's start time to
+    ///                       be considered on the preceding segment's
+    ///                       sampling grid.  This must be in the
+    ///                       range [0, 0.5).
+    /// @throws std::invalid_argument if the tolerance is out of range.
+    void merge(OverlapPolicy policy = OverlapPolicy::KeepFirst,
+               double tolerance = 0.1);
+    /// @result The gaps in the waveform.  Each gap is given as the time
+    ///         (UTC) of the last sample before the gap and the time (UTC)
+    ///         of the first sample after the gap in microseconds since the
+    ///         epoch.  A gap is reported when consecutive segments are
+    ///         separated by more than one and a half sampling periods.
+    [[nodiscard]] std::vector<std::pair<std::chrono::microseconds, std::chrono::microseconds>> getGaps() const noexcept;
+
     /// @name Waveform Name
     /// @{
     //void setNetwork(const std::string &network);
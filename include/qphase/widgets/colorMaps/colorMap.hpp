@@ -1,5 +1,6 @@
 #ifndef QPHASE_COLOR_MAPS_COLOR_MAP_HPP
 #define QPHASE_COLOR_MAPS_COLOR_MAP_HPP
+#include <utility>
 #include <QColor>
 namespace QPhase::Widgets::ColorMaps
 {
@@ -20,6 +21,8 @@ public:
     virtual ~IColorMap() = default;
     /// @result The interpolated value on the range [x0, x1].
     [[nodiscard]] virtual QColor evaluate(const double x) const = 0;
+    /// @result The range [x0, x1] of the color map.
+    [[nodiscard]] virtual std::pair<double, double> getRange() const = 0;
     /// @result True indicates that class is initialized.
     [[nodiscard]] virtual bool isInitialized() const noexcept = 0;
 };
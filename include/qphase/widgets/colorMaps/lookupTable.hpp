@@ -0,0 +1,105 @@
+#ifndef QPHASE_WIDGETS_COLOR_MAPS_LOOKUP_TABLE_HPP
+#define QPHASE_WIDGETS_COLOR_MAPS_LOOKUP_TABLE_HPP
+#include <memory>
+#include <QColor>
+class QImage;
+namespace QPhase::Widgets::ColorMaps
+{
+class IColorMap;
+/// @class LookupTable "lookupTable.hpp" "qphase/widgets/colorMaps/lookupTable.hpp"
+/// @brief A color map sampled at equally spaced values on its range.  A
+///        value is quantized to the nearest sample so coloring an array is
+///        a multiply, a conversion, and a table read per value which the
+///        vectorized kernels do many values at a time.  This is intended
+///        for coloring images, e.g., spectrograms, where evaluating the
+///        color map for every pixel would be too slow.
+/// @note Values outside the color map's range take the color at the
+///       nearest end.  NaNs are transparent.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class LookupTable
+{
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    LookupTable();
+    /// @brief Copy constructor.
+    /// @param[in] table  The table from which to initialize this class.
+    LookupTable(const LookupTable &table);
+    /// @brief Move constructor.
+    /// @param[in,out] table  The table from which to initialize this class.
+    ///                       On exit, table's behavior is undefined.
+    LookupTable(LookupTable &&table) noexcept;
+    /// @}
+
+    /// @name Operators
+    /// @{
+
+    /// @brief Copy assignment.
+    /// @param[in] table  The table to copy to this.
+    /// @result A deep copy of the input table.
+    LookupTable& operator=(const LookupTable &table);
+    /// @brief Move assignment.
+    /// @param[in,out] table  The table whose memory will be moved to this.
+    ///                       On exit, table's behavior is undefined.
+    /// @result The memory from table moved to this.
+    LookupTable& operator=(LookupTable &&table) noexcept;
+    /// @}
+
+    /// @brief Samples the color map.
+    /// @param[in] colorMap  The initialized color map.
+    /// @param[in] nColors   The number of samples.  The first and last are
+    ///                      at the ends of the color map's range.
+    /// @throws std::invalid_argument if the color map is not initialized or
+    ///         nColors is less than 2.
+    void initialize(const IColorMap &colorMap, int nColors = 1024);
+    /// @result True indicates that class is initialized.
+    [[nodiscard]] bool isInitialized() const noexcept;
+    /// @result The number of colors in the table.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] int getNumberOfColors() const;
+    /// @result The range of values spanned by the table.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] std::pair<double, double> getRange() const;
+
+    /// @result The color of the value.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] QRgb evaluate(double value) const;
+    /// @brief Colors an array.
+    /// @param[in] n        The number of values.
+    /// @param[in] values   The values.  This is an array whose dimension
+    ///                     is [n].
+    /// @param[out] colors  The colors.  This is an array whose dimension is
+    ///                     [n].
+    /// @throws std::invalid_argument if values or colors is NULL.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void evaluate(int n, const float *values, QRgb *colors) const;
+    /// @brief Colors a scanline of an image.
+    /// @param[in] n          The number of values.
+    /// @param[in] values     The values of the pixels in columns [0, n).
+    ///                       This is an array whose dimension is [n].
+    /// @param[in] row        The image row.
+    /// @param[in,out] image  The image.  Its format must be one of the
+    ///                       32 bit RGB formats.  On exit, the first n pixels
+    ///                       of the row are colored.
+    /// @throws std::invalid_argument if image or values is NULL, the format
+    ///         is not 32 bit RGB, the row is out of range, or n exceeds the
+    ///         width.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    void fillScanLine(int n, const float *values, int row, QImage *image) const;
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Resets the class.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~LookupTable();
+    /// @}
+private:
+    class LookupTableImpl;
+    std::unique_ptr<LookupTableImpl> pImpl;
+};
+}
+#endif
@@ -45,6 +45,9 @@ public:
                     InterpolationMethod method = InterpolationMethod::Linear);
     /// @result The interpolated color on the interval.
     [[nodiscard]] QColor evaluate(double x) const override;
+    /// @result The range on which the color map was initialized.
+    /// @throws std::runtime_error if \c isInitialized() is false.
+    [[nodiscard]] std::pair<double, double> getRange() const override;
     /// @result True indicates that class is initialized.
     [[nodiscard]] bool isInitialized() const noexcept override;
 
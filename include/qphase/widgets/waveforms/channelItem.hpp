@@ -1,8 +1,10 @@
 #ifndef QPHASE_WIDGETS_WAVEFORMS_CHANNEL_ITEM_HPP
 #define QPHASE_WIDGETS_WAVEFORMS_CHANNEL_ITEM_HPP
 #include <QGraphicsRectItem>
+#include <chrono>
 #include <memory>
 #include <set>
+#include <vector>
 #include "qphase/widgets/waveforms/enums.hpp"
 QT_BEGIN_NAMESPACE
  class QFont;
@@ -19,6 +21,7 @@ namespace QPhase
  namespace Waveforms
  {
   template<class T> class Channel;
+  template<class T> class Waveform;
  }
  namespace Database::Internal
  {
@@ -42,6 +45,11 @@ public:
                 const QRectF &globalShape,
                 WaveformType waveformType = WaveformType::Seismogram,
                 QGraphicsItem *parent = nullptr);
+    /// @brief Constructor from a shared channel.
+    ChannelItem(std::shared_ptr<const QPhase::Waveforms::Channel<T>> channel,
+                const QRectF &globalShape,
+                WaveformType waveformType = WaveformType::Seismogram,
+                QGraphicsItem *parent = nullptr);
  
     /// @name Name
     /// @{
@@ -66,14 +74,86 @@ public:
     /// @{
 
     /// @brief Sets the channel to plot.
-    /// @param[in] channel       The channel to plot.
+    /// @param[in] channel       The channel to plot.  This is copied.
     /// @param[in] waveformType  The waveform to plot.
     void setWaveform(const QPhase::Waveforms::Channel<T> &channel,
                      WaveformType waveformType = WaveformType::Seismogram);
+    /// @brief Sets the channel to plot without copying its samples.
+    /// @param[in] channel       A handle to the channel to plot.  This may
+    ///                          alias a channel in a larger structure, e.g.,
+    ///                          a station, which the handle keeps alive.
+    ///                          The channel must not be modified while it
+    ///                          is plotted.
+    /// @param[in] waveformType  The waveform to plot.
+    /// @throws std::invalid_argument if channel is NULL.
+    void setWaveform(std::shared_ptr<const QPhase::Waveforms::Channel<T>> channel,
+                     WaveformType waveformType = WaveformType::Seismogram);
     /// @brief Sets the waveform's name.
     void setName(const QString &name);
     /// @}
 
+    /// @name Redrawing
+    /// @{
+
+    /// @brief The lines are generated by the worker pool whenever the data,
+    ///        time limits, or size change.  Until they are finished the
+    ///        previous lines are drawn rescaled to the current plot.
+    /// @result True indicates the displayed lines are not yet those of the
+    ///         latest request.
+    [[nodiscard]] bool isRedrawPending() const;
+    /// @brief Blocks until the lines of the latest request are finished
+    ///        and then displays them.
+    void waitForRedraw();
+    /// @brief Sets whether the traces are drawn from raster tiles held in
+    ///        \c TraceTileCache::globalInstance().  Repaints, e.g., from
+    ///        scrolling or selection, then only copy images and panning only
+    ///        renders the newly exposed strip.  The seismogram is scaled by
+    ///        its range over the whole channel rather than the plot so that
+    ///        a pan does not change the scale, and processing is applied to
+    ///        the whole channel.
+    /// @param[in] enable  True draws from the tiles.  Disable this for
+    ///                    vector output, e.g., printing.
+    void setTileCacheEnabled(bool enable);
+    /// @result True indicates the traces are drawn from raster tiles.  By
+    ///         default this is true.
+    [[nodiscard]] bool isTileCacheEnabled() const noexcept;
+    /// @}
+
+    /// @name Size
+    /// @{
+
+    /// @brief Resizes the item.  The current lines are stretched onto the
+    ///        new size rather than regenerated so this is cheap to call
+    ///        while, e.g., a splitter is dragged.
+    /// @param[in] globalShape  The item's new bounding rectangle.
+    void setGlobalShape(const QRectF &globalShape);
+    /// @brief Call when a resize has settled.  The lines are regenerated if
+    ///        they were made for another pixel width since the width
+    ///        determines the decimation.  Vector lines only differing in
+    ///        height are exact when stretched and are kept whereas raster
+    ///        tiles are redrawn at the new height.
+    void finishResize();
+    /// @}
+
+    /// @name Characteristic Function
+    /// @{
+
+    /// @brief Overlays a detector's characteristic function, e.g., an
+    ///        STA/LTA, on the waveform.  The function is drawn from zero at
+    ///        the bottom of the trace to its maximum at the top and the
+    ///        triggers are shaded.
+    /// @param[in] characteristicFunction  The characteristic function.
+    /// @param[in] triggers  The on and off times (UTC) of the detections.
+    void setCharacteristicFunction(
+        const QPhase::Waveforms::Waveform<T> &characteristicFunction,
+        const std::vector<std::pair<std::chrono::microseconds,
+                                    std::chrono::microseconds>> &triggers = {});
+    /// @result True indicates a characteristic function is overlain.
+    [[nodiscard]] bool haveCharacteristicFunction() const noexcept;
+    /// @brief Removes the characteristic function and its triggers.
+    void clearCharacteristicFunction() noexcept;
+    /// @}
+
     /// @name Arrival
     /// @{
 
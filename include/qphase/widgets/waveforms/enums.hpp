@@ -19,7 +19,10 @@ enum class VisibleChannels
 /// @brief Defines the waveform type to plot.
 enum class WaveformType
 {
-    Seismogram  /*!< This is a seismogram waveform. */
+    Seismogram,            /*!< This is a seismogram waveform. */
+    CharacteristicFunction /*!< This is a detector's characteristic
+                                function, e.g., an STA/LTA, drawn over the
+                                seismogram. */
 };
 /// @brief Defines the ordering of stations in the station view.
 enum class StationOrdering
@@ -1,20 +1,30 @@
 #ifndef QPHASE_WIDGETS_WAVEFORMS_REAL_TIME_CHANNEL_SCENE_HPP
 #define QPHASE_WIDGETS_WAVEFORMS_REAL_TIME_CHANNEL_SCENE_HPP
 #include <QGraphicsScene>
+#include <chrono>
 #include <memory>
+#include <vector>
 #include "qphase/widgets/waveforms/enums.hpp"
 QT_BEGIN_NAMESPACE
  class QGraphicsSceneWheelEvent;
  class QSize;
+ class QString;
 QT_END_NAMESPACE
 namespace QPhase::Waveforms
 {
  template<class T> class Channel;
+ template<class T> class RealTimeWaveform;
 }
 namespace QPhase::Widgets::Waveforms::RealTime
 {
 /// @class ChannelScene "channelScene.hpp" "qphase/widgets/realTime/channelScene.hpp"
-/// @brief This is a QGraphicScene that manages channels.
+/// @brief This is a QGraphicScene that manages channels.  Live channels
+///        scroll from right to left like a drum recorder.  The scene is
+///        refreshed by a timer at a capped frame rate; on each frame the
+///        previously rendered pixel columns are kept and only the columns
+///        covering newly arrived samples are rasterized.
+/// @note Each trace is a raster whose columns are used as a ring so that
+///       scrolling moves the ring's origin rather than any pixels.
 /// @copyright Ben Baker (University of Utah) distributed under the MIT license.
 class ChannelScene : public QGraphicsScene
 {
@@ -37,12 +47,35 @@ public:
     ///                        microseconds since the epoch of the plot.
     void setAbsoluteTimeLimits(const std::pair<std::chrono::microseconds,
                                                std::chrono::microseconds> &plotLimits);
-    /// @brief Sets the time about which to plot relative.
-    /// @param[in] time  The time in UTC seconds since the epoch.  
-    ///                  This will represent the "zero" time.
+    /// @brief Relative time is not supported by the scrolling display so
+    ///        this does nothing; the plot remains on absolute time.  It is
+    ///        kept so the scene has the same interface as the other scenes.
+    /// @param[in] time  The time in UTC microseconds since the epoch that
+    ///                  would represent the "zero" time.
     void setRelativeTimeLimits(const std::chrono::microseconds &time);
     /// @brief Sets the channels to plot.
     void setChannels(std::shared_ptr<std::vector<QPhase::Waveforms::Channel<double>>> &channels);
+    /// @brief Adds a live channel.  While live channels have data the right
+    ///        edge of the plot is the latest sample of all live channels and
+    ///        the plot spans the duration of the time limits.
+    /// @param[in] name      The name to display on the trace - e.g.,
+    ///                      UU.BRTU.HHZ.01.
+    /// @param[in] waveform  The live waveform.  This is read but not
+    ///                      modified by the scene.
+    /// @throws std::invalid_argument if the waveform is NULL or not
+    ///         initialized.
+    void addRealTimeWaveform(const QString &name,
+                             const std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>> &waveform);
+    /// @brief Removes all live channels.
+    void clearRealTimeWaveforms();
+    /// @brief Sets the maximum number of times per second the scene is
+    ///        refreshed.
+    /// @param[in] framesPerSecond  The frame rate cap.  This must be in the
+    ///                             range [1, 120].
+    /// @throws std::invalid_argument if the frame rate is out of range.
+    void setFrameRate(int framesPerSecond);
+    /// @result The maximum number of refreshes per second.
+    [[nodiscard]] int getFrameRate() const noexcept;
 
     ChannelScene(const ChannelScene &) = delete;
     ChannelScene(ChannelScene &&) noexcept = delete;
@@ -6,6 +6,7 @@
 #include "qphase/widgets/waveforms/enums.hpp"
 QT_BEGIN_NAMESPACE
  class QResizeEvent;
+ class QString;
 QT_END_NAMESPACE
 namespace QPhase
 {
@@ -20,10 +21,7 @@ namespace QPhase
  namespace Waveforms
  {
   template<class T> class Channel;
- }
- namespace Widgets::Waveforms
- {
-  class ChannelItem;
+  template<class T> class RealTimeWaveform;
  }
 }
 namespace QPhase::Widgets::Waveforms::RealTime
@@ -49,6 +47,14 @@ public:
     void setTimeLimits(const std::pair<std::chrono::microseconds, std::chrono::microseconds> &plotLimits);
     /// @brief Sets the channels to plot.
     void setChannels(std::shared_ptr<std::vector<QPhase::Waveforms::Channel<double>>> &channel);
+    /// @brief Adds a live channel to the scrolling display.
+    /// @param[in] name      The name of the channel - e.g., UU.BRTU.HHZ.01.
+    /// @param[in] waveform  The live waveform that is appended to by an
+    ///                      ingest thread.
+    /// @throws std::invalid_argument if the waveform is NULL or not
+    ///         initialized.
+    void addRealTimeWaveform(const QString &name,
+                             const std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>> &waveform);
 
     /// @brief Sets the event information.
     /// @param[in] event  The event information that is currently being processed.
@@ -43,11 +43,27 @@ public:
     StationItem(const QPhase::Waveforms::Station<T> &stationWaveforms,
                 const QRectF &globalShape,
                 QGraphicsItem *parent = nullptr);
+    /// @brief Constructor with a shared station.
+    template<typename T>
+    StationItem(std::shared_ptr<const QPhase::Waveforms::Station<T>> stationWaveforms,
+                const QRectF &globalShape,
+                QGraphicsItem *parent = nullptr);
     /// @}
 
     /// @brief Sets the station data to plot.
+    /// @param[in] stationWaveforms  The station.  This is copied once and
+    ///                              the copy is shared by the channels.
     template<typename T>
     void setWaveforms(const QPhase::Waveforms::Station<T> &stationWaveforms); 
+    /// @brief Sets the station data to plot without copying any samples.
+    /// @param[in] stationWaveforms  A handle to the station.  This may alias
+    ///                              a station in a larger collection which
+    ///                              the channel items keep alive.  The
+    ///                              station must not be modified while it is
+    ///                              plotted.
+    /// @throws std::invalid_argument if stationWaveforms is NULL.
+    template<typename T>
+    void setWaveforms(std::shared_ptr<const QPhase::Waveforms::Station<T>> stationWaveforms);
 
     /// @result The name of the station.
     [[nodiscard]] QString getName() const noexcept;
@@ -64,6 +80,14 @@ public:
     void setAbsoluteTimeLimits(const std::pair<std::chrono::microseconds, 
                                                std::chrono::microseconds> &plotLimits);
 
+    /// @brief Resizes the item and restacks its channels without
+    ///        regenerating their lines.
+    /// @param[in] globalShape  The item's new bounding rectangle.
+    void setGlobalShape(const QRectF &globalShape);
+    /// @brief Call when a resize has settled so the channels can regenerate
+    ///        lines whose decimation changed.
+    void finishResize();
+
 
     /// @name Base Class Overrides
     /// @{
@@ -1,6 +1,7 @@
 #ifndef QPHASE_WIDGETS_WAVEFORMS_STATION_SCENE_HPP
 #define QPHASE_WIDGETS_WAVEFORMS_STATION_SCENE_HPP
 #include <QGraphicsScene>
+#include <chrono>
 #include <memory>
 #include "qphase/widgets/waveforms/enums.hpp"
 QT_BEGIN_NAMESPACE
@@ -45,6 +46,49 @@ public:
     void setStations(std::shared_ptr<std::vector<QPhase::Waveforms::Station<double>>> &stations);
     void redrawWaveforms();
 
+    /// @name Virtualization
+    /// @{
+
+    /// @brief When virtualized only the rows in the visible rectangle and a
+    ///        small margin have channel items.  Items are recycled as rows
+    ///        scroll in and out of view so showing many channels costs about
+    ///        the same as showing a few.  Otherwise, every station gets a
+    ///        station item.  By default the scene is not virtualized.
+    /// @param[in] virtualized  True enables virtualization.
+    void setVirtualized(bool virtualized);
+    /// @result True indicates the scene is virtualized.
+    [[nodiscard]] bool isVirtualized() const noexcept;
+    /// @brief Sets the part of the scene shown by the view.  When
+    ///        virtualized this materializes the rows that it covers.
+    /// @param[in] visibleRectangle  The visible rectangle in scene
+    ///                              coordinates.
+    void setVisibleRectangle(const QRectF &visibleRectangle);
+    /// @result The number of channel items in the scene.
+    [[nodiscard]] int getNumberOfChannelItems() const noexcept;
+    /// @}
+
+    /// @name Redraw Scheduling
+    /// @{
+
+    /// @brief Zooming and panning with the wheel only record the new time
+    ///        limits.  At most once per display frame the items are given
+    ///        the latest limits; those in view always and those out of view
+    ///        until the frame's budget is spent.  The rest are deferred to
+    ///        the following frames.  At least one item out of view is
+    ///        updated per frame so they catch up even with a zero budget.
+    /// @param[in] budget  The time per frame spent on items out of view.
+    /// @throws std::invalid_argument if the budget is negative.
+    void setFrameBudget(const std::chrono::microseconds &budget);
+    /// @result The time per frame spent on items out of view.  By default
+    ///         this is 8 milliseconds.
+    [[nodiscard]] std::chrono::microseconds getFrameBudget() const noexcept;
+    /// @result True indicates some items do not yet have the time limits
+    ///         from the latest zoom or pan.
+    [[nodiscard]] bool isTimeLimitUpdatePending() const noexcept;
+    /// @brief Gives all items the latest time limits now.
+    void flushTimeLimits();
+    /// @}
+
     StationScene(const StationScene &) = delete;
     StationScene(StationScene &&) noexcept = delete;
     StationScene& operator=(const StationScene &) = delete;
@@ -68,7 +68,9 @@ public:
     ~StationView() override;
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
 private:
+    void updateVisibleRectangle();
     class StationViewImpl;
     std::unique_ptr<StationViewImpl> pImpl;
 };
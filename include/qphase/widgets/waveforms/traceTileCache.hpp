@@ -0,0 +1,113 @@
+#ifndef QPHASE_WIDGETS_WAVEFORMS_TRACE_TILE_CACHE_HPP
+#define QPHASE_WIDGETS_WAVEFORMS_TRACE_TILE_CACHE_HPP
+#include <cstdint>
+#include <memory>
+class QImage;
+namespace QPhase::Widgets::Waveforms
+{
+/// @class TraceTileCache "traceTileCache.hpp" "qphase/widgets/waveforms/traceTileCache.hpp"
+/// @brief Caches rasterized traces in tiles of a fixed number of pixels.
+///        Tiles sit on a pixel grid anchored at the epoch so that, at a
+///        given pixel scale, panning a trace reuses the tiles that remain
+///        in view and only the newly exposed strip is rendered.
+/// @note The least recently used tiles are evicted once their memory
+///       exceeds the budget.  The cache is thread safe and the tiles are
+///       immutable once inserted.
+/// @copyright Ben Baker (University of Utah) distributed under the MIT license.
+class TraceTileCache
+{
+public:
+    /// @brief Identifies a tile.
+    struct Key
+    {
+        /// The data, e.g., a channel and its processing, from which the tile
+        /// was rendered.  See \c getSourceIdentifier().
+        uint64_t source{0};
+        /// The identifier of the processing applied to the data or 0 if the
+        /// data is unprocessed.  The processing is applied to the whole
+        /// source so it does not depend on the tile's position.
+        uint64_t processing{0};
+        /// The layer, e.g., seismogram or characteristic function.
+        int layer{0};
+        /// The tile's position on the pixel grid.
+        int64_t tile{0};
+        /// The time spanned by a pixel.
+        double microSecondsPerPixel{0};
+        /// The tile's height in pixels.
+        double height{0};
+        /// The fraction of the height spanned by the amplitude range.
+        double heightFraction{0};
+        /// The amplitudes mapped to the bottom and top of the tile.  Unless
+        /// a range is imposed these are the source's extrema, not the
+        /// plot's, so that a pan does not change them.
+        double minimum{0};
+        double maximum{0};
+        [[nodiscard]] bool operator<(const Key &key) const;
+    };
+public:
+    /// @name Constructors
+    /// @{
+
+    /// @brief Constructor.
+    TraceTileCache();
+    /// @result The cache shared by all channel items.
+    [[nodiscard]] static TraceTileCache &globalInstance();
+    /// @}
+
+    /// @name Properties
+    /// @{
+
+    /// @brief Sets the memory budget of the tiles.
+    /// @param[in] bytes  The maximum number of bytes held by the tiles.
+    /// @throws std::invalid_argument if bytes is not positive.
+    void setBudget(int64_t bytes);
+    /// @result The maximum number of bytes held by the tiles.  By default
+    ///         this is 64 MB.
+    [[nodiscard]] int64_t getBudget() const noexcept;
+    /// @result The number of bytes held by the cached tiles.
+    [[nodiscard]] int64_t getMemoryUsage() const noexcept;
+    /// @result The number of cached tiles.
+    [[nodiscard]] int size() const noexcept;
+    /// @result The number of tiles inserted since construction.
+    [[nodiscard]] int64_t getNumberOfInsertions() const noexcept;
+    /// @}
+
+    /// @name Tiles
+    /// @{
+
+    /// @brief Identifies the data from which tiles are rendered.
+    /// @param[in] source  The data, e.g., a channel.  This must not be
+    ///                    modified while its tiles are cached.
+    /// @result An identifier that is the same for as long as the data is
+    ///         alive and is never reused for other data.
+    [[nodiscard]] uint64_t getSourceIdentifier(
+        const std::shared_ptr<const void> &source);
+    /// @param[in] key  The tile to find.
+    /// @result The tile or NULL if it is not cached.
+    [[nodiscard]] std::shared_ptr<const QImage> find(const Key &key);
+    /// @brief Caches a tile.  This may evict other tiles.
+    /// @param[in] key    The tile's key.
+    /// @param[in] image  The rendered tile.
+    /// @throws std::invalid_argument if the image is NULL.
+    void insert(const Key &key, std::shared_ptr<const QImage> image);
+    /// @}
+
+    /// @name Destructors
+    /// @{
+
+    /// @brief Releases the cached tiles.
+    void clear() noexcept;
+    /// @brief Destructor.
+    ~TraceTileCache();
+    /// @}
+
+    TraceTileCache(const TraceTileCache &) = delete;
+    TraceTileCache(TraceTileCache &&) noexcept = delete;
+    TraceTileCache& operator=(const TraceTileCache &) = delete;
+    TraceTileCache& operator=(TraceTileCache &&) noexcept = delete;
+private:
+    class TraceTileCacheImpl;
+    std::unique_ptr<TraceTileCacheImpl> pImpl;
+};
+}
+#endif
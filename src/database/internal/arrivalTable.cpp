@@ -2,6 +2,7 @@
 #include <mutex>
 #include <vector>
 #include <string>
+#include <chrono>
 #include <soci/soci.h>
 #include "qphase/database/internal/arrivalTable.hpp"
 #include "qphase/database/internal/arrival.hpp"
@@ -60,35 +61,44 @@ Arrival::FirstMotion intToFirstMotion(const int fm)
  station VARCHAR(32) NOT NULL,
  channel VARCHAR(32) NOT NULL,
  location_code VARCHAR(32) NOT NULL DEFAULT '01',
- time DOUBLE NOT NULL,
+ time INTEGER NOT NULL,
  phase VARCHAR(8) NOT NULL,
  first_motion INTEGER DEFAULT 0,
  review_status VARCHAR(1) DEFAULT 'A',
 */
 
-template<> struct soci::type_conversion<Arrival>
+namespace
+{
+/// Column-wise buffers for a bulk arrival fetch.
+struct ArrivalRows
 {
-    [[maybe_unused]] typedef values base_type;
-    [[maybe_unused]] static void
-    from_base(const values &v, indicator, Arrival &data)
+    void resize(const size_t n)
     {
-        data.clear();
-        // Required by schema
-        data.setIdentifier(v.get<int> ("arid"));
-        //data.setOrigin(v.get<int> ("origin"));
-
-        data.setNetwork(v.get<std::string> ("network"));
-        data.setStation(v.get<std::string> ("station"));
-        data.setChannel(v.get<std::string> ("channel"));
-        data.setLocationCode(v.get<std::string> ("location_code"));
- 
-        data.setTime(v.get<double> ("time")*1.e-6);
-        data.setPhase(v.get<std::string> ("phase"));
-        data.setFirstMotion(intToFirstMotion(v.get<int> ("first_motion")));
-        data.setCreationMode(
-            stringToCreationMode(v.get<std::string> ("creation_mode")));
+        identifiers.resize(n);
+        networks.resize(n);
+        stations.resize(n);
+        channels.resize(n);
+        locationCodes.resize(n);
+        times.resize(n);
+        phases.resize(n);
+        firstMotions.resize(n);
+        firstMotionIndicators.resize(n);
+        creationModes.resize(n);
+        creationModeIndicators.resize(n);
     }
+    std::vector<long long> identifiers;
+    std::vector<std::string> networks;
+    std::vector<std::string> stations;
+    std::vector<std::string> channels;
+    std::vector<std::string> locationCodes;
+    std::vector<long long> times;
+    std::vector<std::string> phases;
+    std::vector<int> firstMotions;
+    std::vector<soci::indicator> firstMotionIndicators;
+    std::vector<std::string> creationModes;
+    std::vector<soci::indicator> creationModeIndicators;
 };
+}
 
 class ArrivalTable::ArrivalTableImpl
 {
@@ -114,18 +124,54 @@ public:
     {
         std::scoped_lock lock(mMutex);
         auto session = mConnection->getSession();
-        soci::rowset<Arrival>
-           rows(session->prepare
-                << "SELECT "
-                << "  identifier as arid, network, station, channel, "
-                << "  location_code, time, first_motion, phase, "
-                << "  review_status as creation_mode"
-                << " FROM arrival "
-                << "   WHERE origin = " << originIdentifier);
+        ArrivalRows rows;
+        rows.resize(QUERY_BATCH_SIZE);
+        soci::statement statement
+            = (session->prepare
+               << "SELECT "
+               << "  identifier, network, station, channel, "
+               << "  location_code, time, phase, first_motion, review_status"
+               << " FROM arrival "
+               << "   WHERE origin = " << originIdentifier,
+               soci::into(rows.identifiers),
+               soci::into(rows.networks),
+               soci::into(rows.stations),
+               soci::into(rows.channels),
+               soci::into(rows.locationCodes),
+               soci::into(rows.times),
+               soci::into(rows.phases),
+               soci::into(rows.firstMotions, rows.firstMotionIndicators),
+               soci::into(rows.creationModes, rows.creationModeIndicators));
+        statement.execute();
         std::vector<Arrival> arrivals;
-        for (const auto &it : rows)
+        while (statement.fetch())
         {
-            arrivals.push_back(it);
+            auto nRows = rows.identifiers.size();
+            arrivals.reserve(arrivals.size() + nRows);
+            for (size_t i = 0; i < nRows; ++i)
+            {
+                Arrival arrival;
+                arrival.setIdentifier(rows.identifiers[i]);
+                arrival.setOriginIdentifier(originIdentifier);
+                arrival.setNetwork(rows.networks[i]);
+                arrival.setStation(rows.stations[i]);
+                arrival.setChannel(rows.channels[i]);
+                arrival.setLocationCode(rows.locationCodes[i]);
+                arrival.setTime(std::chrono::microseconds {rows.times[i]});
+                arrival.setPhase(rows.phases[i]);
+                if (rows.firstMotionIndicators[i] == soci::i_ok)
+                {
+                    arrival.setFirstMotion(
+                        intToFirstMotion(rows.firstMotions[i]));
+                }
+                if (rows.creationModeIndicators[i] == soci::i_ok)
+                {
+                    arrival.setCreationMode(
+                        stringToCreationMode(rows.creationModes[i]));
+                }
+                arrivals.push_back(std::move(arrival));
+            }
+            rows.resize(QUERY_BATCH_SIZE);
         }
         mArrivals = arrivals;
     }
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <cmath>
 #include <mutex>
+#include <chrono>
 #include <vector>
 #include <soci/soci.h>
 #include "qphase/database/internal/eventTable.hpp"
@@ -10,6 +11,7 @@
 #include "qphase/database/internal/arrivalTable.hpp"
 #include "qphase/database/internal/magnitude.hpp"
 #include "qphase/database/connection/connection.hpp"
+#include "private/database/utilities.hpp"
 
 using namespace QPhase::Database::Internal;
 
@@ -127,8 +129,8 @@ template<> struct soci::type_conversion<Event>
         origin.setLatitude(v.get<double> ("latitude"));
         origin.setLongitude(v.get<double> ("longitude"));
         origin.setDepth(v.get<double> ("depth"));
-        auto originTime = v.get<double> ("origin_time");
-        origin.setTime(originTime*1.e-6);
+        origin.setTime(std::chrono::microseconds
+                       {v.get<long long> ("origin_time")});
 
         Magnitude magnitude;
         magnitude.setIdentifier(v.get<int> ("magid"));
@@ -157,6 +159,39 @@ template<> struct soci::type_conversion<Event>
 };
 
 
+namespace
+{
+/// Column-wise buffers for a bulk event/origin/magnitude fetch.
+struct EventRows
+{
+    void resize(const size_t n)
+    {
+        eventIdentifiers.resize(n);
+        eventTypes.resize(n);
+        reviewStatuses.resize(n);
+        originIdentifiers.resize(n);
+        latitudes.resize(n);
+        longitudes.resize(n);
+        depths.resize(n);
+        originTimes.resize(n);
+        magnitudeIdentifiers.resize(n);
+        magnitudes.resize(n);
+        magnitudeTypes.resize(n);
+    }
+    std::vector<long long> eventIdentifiers;
+    std::vector<std::string> eventTypes;
+    std::vector<std::string> reviewStatuses;
+    std::vector<long long> originIdentifiers;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<double> depths;
+    std::vector<long long> originTimes;
+    std::vector<long long> magnitudeIdentifiers;
+    std::vector<double> magnitudes;
+    std::vector<std::string> magnitudeTypes;
+};
+}
+
 class EventTable::EventTableImpl {
 public:
     /// Get the station data
@@ -188,19 +223,60 @@ public:
     {
         std::scoped_lock lock(mMutex);
         auto session = mConnection->getSession();
-        soci::rowset<Event>
-           rows(session->prepare
-                << "SELECT event.identifier as evid, event.event_type as event_type, event.review_status as event_review_status, "
-                << " origin.identifier as orid, origin.latitude as latitude, origin.longitude as longitude, origin.depth, origin.time as origin_time, "
-                << " magnitude.identifier as magid, magnitude.magnitude as magnitude, magnitude.magnitude_type as magnitude_type "
-                << "FROM "
-                << "   event "
-                << "   INNER JOIN origin ON event.preferred_origin = origin.identifier "
-                << "   INNER JOIN magnitude ON event.preferred_magnitude = magnitude.identifier");
+        EventRows rows;
+        rows.resize(QUERY_BATCH_SIZE);
+        soci::statement statement
+            = (session->prepare
+               << "SELECT event.identifier as evid, event.event_type as event_type, event.review_status as event_review_status, "
+               << " origin.identifier as orid, origin.latitude as latitude, origin.longitude as longitude, origin.depth, origin.time as origin_time, "
+               << " magnitude.identifier as magid, magnitude.magnitude as magnitude, magnitude.magnitude_type as magnitude_type "
+               << "FROM "
+               << "   event "
+               << "   INNER JOIN origin ON event.preferred_origin = origin.identifier "
+               << "   INNER JOIN magnitude ON event.preferred_magnitude = magnitude.identifier",
+               soci::into(rows.eventIdentifiers),
+               soci::into(rows.eventTypes),
+               soci::into(rows.reviewStatuses),
+               soci::into(rows.originIdentifiers),
+               soci::into(rows.latitudes),
+               soci::into(rows.longitudes),
+               soci::into(rows.depths),
+               soci::into(rows.originTimes),
+               soci::into(rows.magnitudeIdentifiers),
+               soci::into(rows.magnitudes),
+               soci::into(rows.magnitudeTypes));
+        statement.execute();
         std::vector<Event> events;
-        for (auto &it : rows)
+        while (statement.fetch())
         {
-            events.push_back(it);
+            auto nRows = rows.eventIdentifiers.size();
+            events.reserve(events.size() + nRows);
+            for (size_t i = 0; i < nRows; ++i)
+            {
+                Event event;
+                event.setIdentifier(rows.eventIdentifiers[i]);
+                event.setType(stringToEventType(rows.eventTypes[i]));
+                event.setReviewStatus(
+                    stringToEventReviewStatus(rows.reviewStatuses[i]));
+
+                Origin origin;
+                origin.setIdentifier(rows.originIdentifiers[i]);
+                origin.setLatitude(rows.latitudes[i]);
+                origin.setLongitude(rows.longitudes[i]);
+                origin.setDepth(rows.depths[i]);
+                origin.setTime(
+                    std::chrono::microseconds {rows.originTimes[i]});
+
+                Magnitude magnitude;
+                magnitude.setIdentifier(rows.magnitudeIdentifiers[i]);
+                magnitude.setValue(rows.magnitudes[i]);
+                magnitude.setType("M" + rows.magnitudeTypes[i]);
+
+                event.setOrigin(origin);
+                event.setMagnitude(magnitude);
+                events.push_back(std::move(event));
+            }
+            rows.resize(QUERY_BATCH_SIZE);
         }
         // Get the arrivals
         ArrivalTable arrivalTable;
@@ -2,62 +2,46 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <chrono>
 #include <soci/soci.h>
 #include "qphase/database/internal/stationDataTable.hpp"
 #include "qphase/database/internal/stationData.hpp"
 #include "qphase/database/connection/connection.hpp"
 #include "qphase/database/connection/sqlite3.hpp"
+#include "private/database/utilities.hpp"
 
 using namespace QPhase::Database::Internal;
 
-/*
-    std::string mNetwork;
-    std::string mStation;
-    std::string mDescription;
-    double mLatitude  = 0;
-    double mLongitude = 0;
-    double mElevation = 0;
-    std::chrono::microseconds mOnDate{0};
-    std::chrono::microseconds mOffDate{0};
-    std::chrono::microseconds mLoadDate{0};
-    bool mHaveLatitude = false;
-    bool mHaveLongitude = false;
-    bool mHaveElevation = false;
-    bool mHaveOnOffDate = false;
-    bool mHaveLoadDate = false;
-};
-*/
-
-template<> struct soci::type_conversion<StationData>
+namespace
 {
-    [[maybe_unused]] typedef values base_type;
-    [[maybe_unused]] static void
-    from_base(const values &v, indicator , StationData &data)
+/// Column-wise buffers for a bulk station data fetch.
+struct StationDataRows
+{
+    void resize(const size_t n)
     {
-        data.clear();
-        // Required by schema
-        data.setNetwork(v.get<std::string> ("network"));
-        data.setStation(v.get<std::string> ("station"));
-        data.setLatitude(v.get<double> ("latitude"));
-        data.setLongitude(v.get<double> ("longitude"));
-        data.setElevation(v.get<double> ("elevation"));
-        auto onDate  = static_cast<int64_t> (v.get<double> ("ondate"));
-        auto offDate = static_cast<int64_t> (v.get<double> ("offdate"));
-        data.setOnOffDate(std::pair(std::chrono::microseconds {onDate},
-                                    std::chrono::microseconds {offDate} ));
-        // Optional
-        std::string description;
-        try
-        {
-            description = v.get<std::string> ("description");
-        }
-        catch (...)
-        {
-            description = "";
-        }
-        data.setDescription(description);
+        networks.resize(n);
+        stations.resize(n);
+        latitudes.resize(n);
+        longitudes.resize(n);
+        elevations.resize(n);
+        elevationIndicators.resize(n);
+        onDates.resize(n);
+        offDates.resize(n);
+        descriptions.resize(n);
+        descriptionIndicators.resize(n);
     }
+    std::vector<std::string> networks;
+    std::vector<std::string> stations;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<double> elevations;
+    std::vector<soci::indicator> elevationIndicators;
+    std::vector<long long> onDates;
+    std::vector<long long> offDates;
+    std::vector<std::string> descriptions;
+    std::vector<soci::indicator> descriptionIndicators;
 };
+}
 
 class StationDataTable::StationDataTableImpl
 {
@@ -90,13 +74,50 @@ public:
     {
         std::scoped_lock lock(mMutex);
         auto session = mConnection->getSession();
-        soci::rowset<StationData>
-           rows(session->prepare
-                << "SELECT network, station, latitude, longitude, elevation, ondate, offdate, description FROM station_data");
+        StationDataRows rows;
+        rows.resize(QUERY_BATCH_SIZE);
+        soci::statement statement
+            = (session->prepare
+               << "SELECT network, station, latitude, longitude, elevation, ondate, offdate, description FROM station_data",
+               soci::into(rows.networks),
+               soci::into(rows.stations),
+               soci::into(rows.latitudes),
+               soci::into(rows.longitudes),
+               soci::into(rows.elevations, rows.elevationIndicators),
+               soci::into(rows.onDates),
+               soci::into(rows.offDates),
+               soci::into(rows.descriptions, rows.descriptionIndicators));
+        statement.execute();
         std::vector<StationData> stations;
-        for (auto &it : rows)
+        while (statement.fetch())
         {
-            stations.push_back(it);
+            auto nRows = rows.networks.size();
+            stations.reserve(stations.size() + nRows);
+            for (size_t i = 0; i < nRows; ++i)
+            {
+                StationData data;
+                data.setNetwork(rows.networks[i]);
+                data.setStation(rows.stations[i]);
+                data.setLatitude(rows.latitudes[i]);
+                data.setLongitude(rows.longitudes[i]);
+                if (rows.elevationIndicators[i] == soci::i_ok)
+                {
+                    data.setElevation(rows.elevations[i]);
+                }
+                data.setOnOffDate(
+                    std::pair {std::chrono::microseconds {rows.onDates[i]},
+                               std::chrono::microseconds {rows.offDates[i]}});
+                if (rows.descriptionIndicators[i] == soci::i_ok)
+                {
+                    data.setDescription(rows.descriptions[i]);
+                }
+                else
+                {
+                    data.setDescription("");
+                }
+                stations.push_back(std::move(data));
+            }
+            rows.resize(QUERY_BATCH_SIZE);
         }
         mStationData = stations;
     }
@@ -7,54 +7,41 @@
 #include "qphase/database/internal/waveformTable.hpp"
 #include "qphase/database/internal/waveform.hpp"
 #include "qphase/database/connection/connection.hpp"
+#include "private/database/utilities.hpp"
 
 using namespace QPhase::Database::Internal;
 
-template<> struct soci::type_conversion<Waveform>
+namespace
+{
+/// Column-wise buffers for a bulk waveform fetch.
+struct WaveformRows
 {
-    [[maybe_unused]] typedef values base_type;
-    [[maybe_unused]] static void
-    from_base(const values &v, indicator, Waveform &data)
+    void resize(const size_t n)
     {
-        data.clear();
-        // Required by schema
-        data.setIdentifier(v.get<int> ("identifier"));
-
-        data.setNetwork(v.get<std::string> ("network"));
-        data.setStation(v.get<std::string> ("station"));
-        data.setChannel(v.get<std::string> ("channel"));
-        data.setLocationCode(v.get<std::string> ("location_code"));
- 
-        auto onTime  = (v.get<double> ("ontime"))*1.e-6;
-        auto offTime = (v.get<double> ("offtime"))*1.e-6;
-        data.setStartAndEndTime(std::pair<double, double> {onTime, offTime});
-        try
-        {
-            data.setEventIdentifier(v.get<int64_t> ("event_identifier"));
-        }
-        catch (...)
-        {
-        }
-        try
-        {
-            data.setFileName(v.get<std::string> ("filename"));
-        }
-        catch (...)
-        {
-        }
-/*
-        data.setTime(v.get<double> ("time")*1.e-6);
-        data.setPhase(v.get<std::string> ("phase"));
-        data.setFirstMotion(intToFirstMotion(v.get<int> ("first_motion")));
-        data.setCreationMode(
-            stringToCreationMode(v.get<std::string> ("creation_mode")));
-*/
-    }   
+        identifiers.resize(n);
+        networks.resize(n);
+        stations.resize(n);
+        channels.resize(n);
+        locationCodes.resize(n);
+        eventIdentifiers.resize(n);
+        eventIdentifierIndicators.resize(n);
+        onTimes.resize(n);
+        offTimes.resize(n);
+        fileNames.resize(n);
+        fileNameIndicators.resize(n);
+    }
+    std::vector<long long> identifiers;
+    std::vector<std::string> networks;
+    std::vector<std::string> stations;
+    std::vector<std::string> channels;
+    std::vector<std::string> locationCodes;
+    std::vector<long long> eventIdentifiers;
+    std::vector<soci::indicator> eventIdentifierIndicators;
+    std::vector<long long> onTimes;
+    std::vector<long long> offTimes;
+    std::vector<std::string> fileNames;
+    std::vector<soci::indicator> fileNameIndicators;
 };
-
-namespace
-{
-
 }
 
 class WaveformTable::WaveformTableImpl
@@ -81,17 +68,61 @@ public:
     {
         std::scoped_lock lock(mMutex);
         auto session = mConnection->getSession();
-        soci::rowset<Waveform>
-           rows(session->prepare
-                << "SELECT "
-                << "  identifier, network, station, channel, "
-                << "  location_code, event_identifier, ontime, offtime, filename "
-                << " FROM waveform "
-                << "   WHERE event_identifier = " << eventIdentifier);
+        WaveformRows rows;
+        rows.resize(QUERY_BATCH_SIZE);
+        soci::statement statement
+            = (session->prepare
+               << "SELECT "
+               << "  identifier, network, station, channel, "
+               << "  location_code, event_identifier, ontime, offtime, filename "
+               << " FROM waveform "
+               << "   WHERE event_identifier = " << eventIdentifier,
+               soci::into(rows.identifiers),
+               soci::into(rows.networks),
+               soci::into(rows.stations),
+               soci::into(rows.channels),
+               soci::into(rows.locationCodes),
+               soci::into(rows.eventIdentifiers,
+                          rows.eventIdentifierIndicators),
+               soci::into(rows.onTimes),
+               soci::into(rows.offTimes),
+               soci::into(rows.fileNames, rows.fileNameIndicators));
+        statement.execute();
         std::vector<Waveform> waveforms;
-        for (const auto &it : rows)
+        while (statement.fetch())
         {
-            if (it.haveFileName()){waveforms.push_back(it);}
+            auto nRows = rows.identifiers.size();
+            waveforms.reserve(waveforms.size() + nRows);
+            for (size_t i = 0; i < nRows; ++i)
+            {
+                // Only waveforms that point to a file are useful
+                if (rows.fileNameIndicators[i] != soci::i_ok){continue;}
+                Waveform waveform;
+                waveform.setIdentifier(rows.identifiers[i]);
+                waveform.setNetwork(rows.networks[i]);
+                waveform.setStation(rows.stations[i]);
+                waveform.setChannel(rows.channels[i]);
+                waveform.setLocationCode(rows.locationCodes[i]);
+                waveform.setStartAndEndTime(
+                    std::pair {std::chrono::microseconds {rows.onTimes[i]},
+                               std::chrono::microseconds {rows.offTimes[i]}});
+                if (rows.eventIdentifierIndicators[i] == soci::i_ok)
+                {
+                    waveform.setEventIdentifier(rows.eventIdentifiers[i]);
+                }
+                try
+                {
+                    waveform.setFileName(rows.fileNames[i]);
+                }
+                catch (...)
+                {
+                }
+                if (waveform.haveFileName())
+                {
+                    waveforms.push_back(std::move(waveform));
+                }
+            }
+            rows.resize(QUERY_BATCH_SIZE);
         }
         mWaveforms = waveforms;
     }
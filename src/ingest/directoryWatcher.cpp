@@ -0,0 +1,573 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "qphase/ingest/directoryWatcher.hpp"
+#include "qphase/database/internal/waveform.hpp"
+#include "qphase/waveforms/realTimeWaveform.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "private/removeBlanksAndCapitalize.hpp"
+
+using namespace QPhase::Ingest;
+using RealTimeWaveform = QPhase::Waveforms::RealTimeWaveform<double>;
+
+namespace
+{
+
+/// Interval at which the watcher checks for shutdown.
+constexpr int POLL_MILLISECONDS{100};
+/// The events that indicate a file in the spool has new data.
+constexpr uint32_t DATA_MASK{IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO};
+/// The events that indicate a file left the spool.
+constexpr uint32_t REMOVAL_MASK{IN_DELETE | IN_MOVED_FROM};
+constexpr uint32_t WATCH_MASK{DATA_MASK | REMOVAL_MASK};
+
+// SAC binary layout: 70 floats, 40 integers and logicals, then 8 byte
+// character fields (KEVNM is 16 bytes) followed by the samples.
+constexpr int SAC_HEADER_LENGTH{632};
+constexpr int SAC_UNDEFINED{-12345};
+constexpr int DELTA{0};
+constexpr int B{5};
+constexpr int NZYEAR{70};
+constexpr int NZJDAY{71};
+constexpr int NZHOUR{72};
+constexpr int NZMIN{73};
+constexpr int NZSEC{74};
+constexpr int NZMSEC{75};
+constexpr int NVHDR{76};
+constexpr int NPTS{79};
+constexpr int IFTYPE{85};
+constexpr int LEVEN{105};
+constexpr int ITIME{1};
+constexpr int KSTNM{440};
+constexpr int KHOLE{464};
+constexpr int KCMPNM{600};
+constexpr int KNETWK{608};
+
+/// The parts of a SAC header needed to ingest its samples.
+struct SACHeader
+{
+    std::string network;
+    std::string station;
+    std::string channel;
+    std::string locationCode;
+    std::chrono::microseconds startTime{0};
+    double samplingRate{0};
+    bool swap{false};
+};
+
+int32_t loadWord(const char *buffer, const int word, const bool swap)
+{
+    uint32_t value;
+    std::memcpy(&value, buffer + 4*word, sizeof(value));
+    if (swap){value = __builtin_bswap32(value);}
+    return static_cast<int32_t> (value);
+}
+
+float loadFloat(const char *buffer, const int word, const bool swap)
+{
+    auto bits = static_cast<uint32_t> (loadWord(buffer, word, swap));
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string loadCode(const char *buffer, const int offset)
+{
+    auto code = removeBlanksAndCapitalize(
+        std::string(buffer + offset, strnlen(buffer + offset, 8)));
+    if (code == std::to_string(SAC_UNDEFINED)){return "";}
+    return code;
+}
+
+/// Parses a SAC header of either byte order.
+SACHeader parseHeader(const char *buffer)
+{
+    SACHeader header;
+    auto version = loadWord(buffer, NVHDR, false);
+    if (version != 6 && version != 7)
+    {
+        header.swap = true;
+        version = loadWord(buffer, NVHDR, true);
+        if (version != 6 && version != 7)
+        {
+            throw std::invalid_argument("Not a SAC file");
+        }
+    }
+    auto swap = header.swap;
+    auto fileType = loadWord(buffer, IFTYPE, swap);
+    auto evenlySpaced = loadWord(buffer, LEVEN, swap);
+    if ((fileType != ITIME && fileType != SAC_UNDEFINED) || evenlySpaced == 0)
+    {
+        throw std::invalid_argument("Not an evenly sampled time series");
+    }
+    auto delta = loadFloat(buffer, DELTA, swap);
+    if (!(delta > 0) || delta == SAC_UNDEFINED)
+    {
+        throw std::invalid_argument("Sampling period must be positive");
+    }
+    header.samplingRate = 1.0/delta;
+    std::array<int32_t, 6> reference;
+    for (int i = 0; i < static_cast<int> (reference.size()); ++i)
+    {
+        reference[i] = loadWord(buffer, NZYEAR + i, swap);
+        if (reference[i] == SAC_UNDEFINED)
+        {
+            throw std::invalid_argument("Reference time not set");
+        }
+    }
+    using namespace std::chrono;
+    auto day = sys_days {year {reference[0]}/January/1}
+             + days {reference[1] - 1};
+    double begin = loadFloat(buffer, B, swap);
+    if (begin == SAC_UNDEFINED){begin = 0;}
+    header.startTime = duration_cast<microseconds> (day.time_since_epoch())
+                     + hours {reference[2]}
+                     + minutes {reference[3]}
+                     + seconds {reference[4]}
+                     + milliseconds {reference[5]}
+                     + microseconds {std::llround(begin*1.e6)};
+    header.network = loadCode(buffer, KNETWK);
+    header.station = loadCode(buffer, KSTNM);
+    header.channel = loadCode(buffer, KCMPNM);
+    header.locationCode = loadCode(buffer, KHOLE);
+    if (header.network.empty() || header.station.empty() ||
+        header.channel.empty())
+    {
+        throw std::invalid_argument("Network, station, or channel not set");
+    }
+    if (header.locationCode.empty()){header.locationCode = "01";}
+    return header;
+}
+
+/// Reads exactly nBytes at the offset.
+void readExactly(const int descriptor, char *buffer,
+                 const size_t nBytes, const off_t offset)
+{
+    size_t nRead = 0;
+    while (nRead < nBytes)
+    {
+        auto n = ::pread(descriptor, buffer + nRead, nBytes - nRead,
+                         offset + static_cast<off_t> (nRead));
+        if (n < 0 && errno == EINTR){continue;}
+        if (n <= 0){throw std::runtime_error("Failed to read file");}
+        nRead = nRead + static_cast<size_t> (n);
+    }
+}
+
+/// Closes the file on scope exit.
+class FileDescriptor
+{
+public:
+    explicit FileDescriptor(const int descriptor) :
+        mDescriptor(descriptor)
+    {
+    }
+    ~FileDescriptor()
+    {
+        if (mDescriptor >= 0){::close(mDescriptor);}
+    }
+    [[nodiscard]] int get() const noexcept{return mDescriptor;}
+    FileDescriptor(const FileDescriptor &) = delete;
+    FileDescriptor& operator=(const FileDescriptor &) = delete;
+private:
+    int mDescriptor{-1};
+};
+
+/// A file named in a burst of events.
+struct PendingFile
+{
+    std::string name;
+    /// The file was moved into the spool or recreated so it is read from
+    /// the start.
+    bool moved{false};
+    /// The file's last event removed it from the spool.
+    bool removed{false};
+};
+
+/// The progress through a file that is being written.
+struct FileState
+{
+    SACHeader header;
+    QPhase::Waveforms::Segment<double> grid;
+    std::string channelName;
+    std::shared_ptr<RealTimeWaveform> waveform;
+    /// The file's inode and size when it was last read.  Another inode or
+    /// a smaller size means the file was replaced.
+    ino_t inode{0};
+    int64_t size{0};
+    int64_t nRead{0};
+    bool haveHeader{false};
+    bool failed{false};
+};
+
+}
+
+class DirectoryWatcher::DirectoryWatcherImpl
+{
+public:
+    /// Reads inotify events and ingests the files they name.
+    void run()
+    {
+        alignas(inotify_event) std::array<char, 64*1024> buffer;
+        std::vector<PendingFile> dirty;
+        std::unordered_map<std::string, size_t> positions;
+        while (mRunning.load(std::memory_order_acquire))
+        {
+            pollfd descriptor{mInotify, POLLIN, 0};
+            if (::poll(&descriptor, 1, POLL_MILLISECONDS) <= 0){continue;}
+            auto nRead = ::read(mInotify, buffer.data(), buffer.size());
+            if (nRead <= 0){continue;}
+            // A file written in many small pieces generates a burst of
+            // events; ingest it once per burst
+            dirty.clear();
+            positions.clear();
+            for (ssize_t offset = 0; offset < nRead;)
+            {
+                const auto *event
+                    = reinterpret_cast<const inotify_event *> (buffer.data()
+                                                             + offset);
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    mErrors.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (event->len > 0 && !(event->mask & IN_ISDIR))
+                {
+                    std::string name{event->name};
+                    bool removed = (event->mask & REMOVAL_MASK) != 0;
+                    bool moved = (event->mask & IN_MOVED_TO) != 0;
+                    auto it = positions.find(name);
+                    if (it == positions.end())
+                    {
+                        positions.emplace(name, dirty.size());
+                        dirty.push_back(PendingFile {std::move(name),
+                                                     moved, removed});
+                    }
+                    else
+                    {
+                        // Data after a removal belongs to a new file
+                        auto &pending = dirty[it->second];
+                        pending.moved = pending.moved || moved
+                                     || (pending.removed && !removed);
+                        pending.removed = removed;
+                    }
+                }
+                offset = offset + static_cast<ssize_t> (sizeof(inotify_event))
+                       + event->len;
+            }
+            for (const auto &pending : dirty)
+            {
+                if (pending.removed)
+                {
+                    // Forget the file so the state of files that passed
+                    // through the spool does not accumulate
+                    mFiles.erase(pending.name);
+                }
+                else
+                {
+                    processFile(pending.name, pending.moved);
+                }
+            }
+        }
+    }
+    /// Ingests what is new in a file.  The progress through a file is kept
+    /// after it is closed so a writer that reopens and appends to it only
+    /// contributes the appended samples; it is forgotten when the file is
+    /// deleted or moved out of the spool.  A file moved into the spool
+    /// replaces whatever had that name and is read from the start.
+    void processFile(const std::string &name, const bool moved)
+    {
+        auto &state = mFiles[name];
+        if (moved){state = FileState {};}
+        if (!state.failed)
+        {
+            try
+            {
+                ingest(name, state);
+            }
+            catch (const std::exception &)
+            {
+                state.failed = true;
+                mErrors.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    void ingest(const std::string &name, FileState &state)
+    {
+        auto path = mDirectory/name;
+        FileDescriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (file.get() < 0)
+        {
+            if (errno == ENOENT){return;} // Removed before we got to it
+            throw std::runtime_error("Failed to open " + path.string());
+        }
+        struct stat status;
+        if (::fstat(file.get(), &status) != 0)
+        {
+            throw std::runtime_error("Failed to stat " + path.string());
+        }
+        int64_t fileSize = status.st_size;
+        if (state.haveHeader &&
+            (status.st_ino != state.inode || fileSize < state.size))
+        {
+            // Rewritten in place or replaced so start over
+            state = FileState {};
+        }
+        state.inode = status.st_ino;
+        state.size = fileSize;
+        if (fileSize < SAC_HEADER_LENGTH){return;}
+        // The header first, then only the newly appended samples
+        std::array<char, SAC_HEADER_LENGTH> header;
+        int32_t nPoints = 0;
+        if (!state.haveHeader)
+        {
+            readExactly(file.get(), header.data(), header.size(), 0);
+            state.header = parseHeader(header.data());
+            state.grid.setSamplingRate(state.header.samplingRate);
+            state.grid.setStartTime(state.header.startTime);
+            state.channelName = state.header.network + "."
+                              + state.header.station + "."
+                              + state.header.channel + "."
+                              + state.header.locationCode;
+            state.waveform = getOrCreateChannel(state.channelName,
+                                                state.grid.getSamplingRate());
+            state.haveHeader = true;
+            nPoints = loadWord(header.data(), NPTS, state.header.swap);
+        }
+        else
+        {
+            // Writers may update the number of points as they append
+            readExactly(file.get(), header.data(), 4, 4*NPTS);
+            nPoints = loadWord(header.data(), 0, state.header.swap);
+        }
+        auto nAvailable = std::min<int64_t> (std::max(0, nPoints),
+                                             (fileSize - SAC_HEADER_LENGTH)/4);
+        if (nAvailable <= state.nRead){return;}
+        auto nNew = nAvailable - state.nRead;
+        mRaw.resize(nNew);
+        readExactly(file.get(), reinterpret_cast<char *> (mRaw.data()),
+                    4*mRaw.size(), SAC_HEADER_LENGTH + 4*state.nRead);
+        mSamples.resize(nNew);
+        for (int64_t i = 0; i < nNew; ++i)
+        {
+            auto bits = mRaw[i];
+            if (state.header.swap){bits = __builtin_bswap32(bits);}
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            mSamples[i] = value;
+        }
+        state.waveform->append(state.grid.getSampleTime(state.nRead),
+                               static_cast<int> (nNew), mSamples.data());
+        if (state.nRead == 0){mNumberOfFiles.fetch_add(1, std::memory_order_relaxed);}
+        state.nRead = nAvailable;
+        mNumberOfSamples.fetch_add(nNew, std::memory_order_relaxed);
+        if (nAvailable < 2){return;}
+        // Extend the file's index entry
+        QPhase::Database::Internal::Waveform entry;
+        entry.setNetwork(state.header.network);
+        entry.setStation(state.header.station);
+        entry.setChannel(state.header.channel);
+        entry.setLocationCode(state.header.locationCode);
+        entry.setStartAndEndTime(
+            std::pair {state.header.startTime,
+                       state.grid.getSampleTime(nAvailable - 1)});
+        entry.setFileName(path.string());
+        UpdateCallback callback;
+        {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIndex.insert_or_assign(name, entry);
+        callback = mCallback;
+        }
+        if (callback){callback(entry);}
+    }
+    std::shared_ptr<RealTimeWaveform>
+        getOrCreateChannel(const std::string &name, const double samplingRate)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mChannels.find(name);
+        if (it != mChannels.end())
+        {
+            if (std::abs(it->second->getSamplingRate() - samplingRate)
+                > 1.e-9*samplingRate)
+            {
+                throw std::invalid_argument("Sampling rate mismatch for "
+                                          + name);
+            }
+            return it->second;
+        }
+        auto waveform = std::make_shared<RealTimeWaveform> ();
+        waveform->initialize(samplingRate, mRetention);
+        mChannels.emplace(name, waveform);
+        return waveform;
+    }
+    mutable std::mutex mMutex;
+    std::map<std::string, std::shared_ptr<RealTimeWaveform>> mChannels;
+    std::map<std::string, QPhase::Database::Internal::Waveform> mIndex;
+    UpdateCallback mCallback;
+    // Only the watcher thread touches these
+    std::unordered_map<std::string, FileState> mFiles;
+    std::vector<uint32_t> mRaw;
+    std::vector<double> mSamples;
+    std::filesystem::path mDirectory;
+    std::thread mThread;
+    std::atomic<bool> mRunning{false};
+    std::atomic<int64_t> mNumberOfFiles{0};
+    std::atomic<int64_t> mNumberOfSamples{0};
+    std::atomic<int64_t> mErrors{0};
+    std::chrono::microseconds mRetention{600000000};
+    int mInotify{-1};
+};
+
+/// Constructor
+DirectoryWatcher::DirectoryWatcher() :
+    pImpl(std::make_unique<DirectoryWatcherImpl> ())
+{
+}
+
+/// Destructor
+DirectoryWatcher::~DirectoryWatcher()
+{
+    stop();
+}
+
+/// Retention
+void DirectoryWatcher::setRetention(const std::chrono::microseconds &retention)
+{
+    if (retention.count() <= 0)
+    {
+        throw std::invalid_argument("Retention must be positive");
+    }
+    if (isRunning()){throw std::runtime_error("Watcher is running");}
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mRetention = retention;
+}
+
+std::chrono::microseconds DirectoryWatcher::getRetention() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mRetention;
+}
+
+/// Callback
+void DirectoryWatcher::setUpdateCallback(const UpdateCallback &callback)
+{
+    if (isRunning()){throw std::runtime_error("Watcher is running");}
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mCallback = callback;
+}
+
+/// Start
+void DirectoryWatcher::start(const std::filesystem::path &directory)
+{
+    if (!std::filesystem::is_directory(directory))
+    {
+        throw std::invalid_argument(directory.string()
+                                  + " is not a directory");
+    }
+    if (isRunning()){throw std::runtime_error("Watcher is running");}
+    auto descriptor = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("Failed to initialize inotify: "
+                               + std::string {std::strerror(errno)});
+    }
+    if (::inotify_add_watch(descriptor, directory.c_str(), WATCH_MASK) < 0)
+    {
+        std::string error{std::strerror(errno)};
+        ::close(descriptor);
+        throw std::runtime_error("Failed to watch " + directory.string()
+                               + ": " + error);
+    }
+    pImpl->mInotify = descriptor;
+    pImpl->mDirectory = directory;
+    pImpl->mRunning.store(true, std::memory_order_release);
+    pImpl->mThread = std::thread(&DirectoryWatcherImpl::run, pImpl.get());
+}
+
+bool DirectoryWatcher::isRunning() const noexcept
+{
+    return pImpl->mRunning.load(std::memory_order_acquire);
+}
+
+/// Stop
+void DirectoryWatcher::stop() noexcept
+{
+    pImpl->mRunning.store(false, std::memory_order_release);
+    if (pImpl->mThread.joinable()){pImpl->mThread.join();}
+    if (pImpl->mInotify >= 0){::close(pImpl->mInotify);}
+    pImpl->mInotify = -1;
+    pImpl->mFiles.clear();
+}
+
+/// Channels
+bool DirectoryWatcher::haveChannel(const std::string &name) const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mChannels.contains(name);
+}
+
+std::vector<std::string> DirectoryWatcher::getChannelNames() const
+{
+    std::vector<std::string> names;
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    names.reserve(pImpl->mChannels.size());
+    for (const auto &channel : pImpl->mChannels)
+    {
+        names.push_back(channel.first);
+    }
+    return names;
+}
+
+std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>>
+    DirectoryWatcher::getWaveform(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    auto it = pImpl->mChannels.find(name);
+    if (it == pImpl->mChannels.end())
+    {
+        throw std::invalid_argument("Channel " + name + " does not exist");
+    }
+    return it->second;
+}
+
+/// Index
+std::vector<QPhase::Database::Internal::Waveform>
+    DirectoryWatcher::getIndex() const
+{
+    std::vector<QPhase::Database::Internal::Waveform> index;
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    index.reserve(pImpl->mIndex.size());
+    for (const auto &entry : pImpl->mIndex)
+    {
+        index.push_back(entry.second);
+    }
+    return index;
+}
+
+int64_t DirectoryWatcher::getNumberOfFiles() const noexcept
+{
+    return pImpl->mNumberOfFiles.load(std::memory_order_relaxed);
+}
+
+int64_t DirectoryWatcher::getNumberOfSamples() const noexcept
+{
+    return pImpl->mNumberOfSamples.load(std::memory_order_relaxed);
+}
+
+int64_t DirectoryWatcher::getNumberOfErrors() const noexcept
+{
+    return pImpl->mErrors.load(std::memory_order_relaxed);
+}
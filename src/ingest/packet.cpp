@@ -0,0 +1,217 @@
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "qphase/ingest/packet.hpp"
+
+using namespace QPhase::Ingest;
+
+namespace
+{
+
+constexpr char MAGIC[4]{'Q', 'P', 'P', 'K'};
+constexpr uint16_t VERSION{1};
+constexpr int CODE_LENGTH{8};
+// Offsets of the header fields
+constexpr int VERSION_OFFSET{4};
+constexpr int DATA_TYPE_OFFSET{6};
+constexpr int CODES_OFFSET{8};
+constexpr int START_TIME_OFFSET{CODES_OFFSET + 4*CODE_LENGTH};
+constexpr int NUMERATOR_OFFSET{START_TIME_OFFSET + 8};
+constexpr int DENOMINATOR_OFFSET{NUMERATOR_OFFSET + 4};
+constexpr int NUMBER_OF_SAMPLES_OFFSET{DENOMINATOR_OFFSET + 4};
+static_assert(NUMBER_OF_SAMPLES_OFFSET + 4 == getFrameHeaderLength());
+
+// The wire format is little-endian which is also the host order on the
+// platforms we build for; memcpy keeps the unaligned accesses well defined.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "Big-endian hosts are not supported");
+
+template<typename U>
+U load(const char *buffer)
+{
+    U value;
+    std::memcpy(&value, buffer, sizeof(U));
+    return value;
+}
+
+template<typename U>
+void store(const U value, char *buffer)
+{
+    std::memcpy(buffer, &value, sizeof(U));
+}
+
+int getSampleSize(const uint8_t dataType)
+{
+    if (dataType == static_cast<uint8_t> (DataType::Integer32)){return 4;}
+    if (dataType == static_cast<uint8_t> (DataType::Float32)){return 4;}
+    if (dataType == static_cast<uint8_t> (DataType::Float64)){return 8;}
+    throw std::invalid_argument("Unknown data type "
+                              + std::to_string(dataType));
+}
+
+void checkHeader(const int nBytes, const char *buffer)
+{
+    if (buffer == nullptr){throw std::invalid_argument("buffer is NULL");}
+    if (nBytes < getFrameHeaderLength())
+    {
+        throw std::invalid_argument("Frame header is truncated");
+    }
+    if (std::memcmp(buffer, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        throw std::invalid_argument("Frame does not start with magic");
+    }
+    if (load<uint16_t> (buffer + VERSION_OFFSET) != VERSION)
+    {
+        throw std::invalid_argument("Unsupported frame version");
+    }
+}
+
+void storeCode(const std::string &code, char *buffer)
+{
+    if (static_cast<int> (code.size()) > CODE_LENGTH)
+    {
+        throw std::invalid_argument("Code " + code + " exceeds "
+                                  + std::to_string(CODE_LENGTH)
+                                  + " characters");
+    }
+    std::memset(buffer, 0, CODE_LENGTH);
+    std::memcpy(buffer, code.data(), code.size());
+}
+
+std::string loadCode(const char *buffer)
+{
+    return std::string(buffer, strnlen(buffer, CODE_LENGTH));
+}
+
+}
+
+std::vector<char> QPhase::Ingest::encode(const Packet &packet,
+                                         const DataType dataType)
+{
+    if (packet.samplingRateNumerator < 1 ||
+        packet.samplingRateDenominator < 1)
+    {
+        throw std::invalid_argument("Sampling rate must be positive");
+    }
+    auto nSamples = static_cast<int> (packet.data.size());
+    if (packet.data.size() > static_cast<size_t> (getMaximumNumberOfSamples()))
+    {
+        throw std::invalid_argument("Too many samples");
+    }
+    auto type = static_cast<uint8_t> (dataType);
+    auto sampleSize = getSampleSize(type);
+    std::vector<char> frame(getFrameHeaderLength()
+                          + static_cast<size_t> (nSamples)*sampleSize);
+    auto buffer = frame.data();
+    std::memcpy(buffer, MAGIC, sizeof(MAGIC));
+    store<uint16_t> (VERSION, buffer + VERSION_OFFSET);
+    store<uint8_t> (type, buffer + DATA_TYPE_OFFSET);
+    storeCode(packet.network,      buffer + CODES_OFFSET);
+    storeCode(packet.station,      buffer + CODES_OFFSET + CODE_LENGTH);
+    storeCode(packet.channel,      buffer + CODES_OFFSET + 2*CODE_LENGTH);
+    storeCode(packet.locationCode, buffer + CODES_OFFSET + 3*CODE_LENGTH);
+    store<int64_t> (packet.startTime.count(), buffer + START_TIME_OFFSET);
+    store<int32_t> (packet.samplingRateNumerator, buffer + NUMERATOR_OFFSET);
+    store<int32_t> (packet.samplingRateDenominator,
+                    buffer + DENOMINATOR_OFFSET);
+    store<int32_t> (nSamples, buffer + NUMBER_OF_SAMPLES_OFFSET);
+    auto payload = buffer + getFrameHeaderLength();
+    if (dataType == DataType::Integer32)
+    {
+        for (int i = 0; i < nSamples; ++i)
+        {
+            auto value = static_cast<int32_t> (std::lround(packet.data[i]));
+            store<int32_t> (value, payload + 4*i);
+        }
+    }
+    else if (dataType == DataType::Float32)
+    {
+        for (int i = 0; i < nSamples; ++i)
+        {
+            store<float> (static_cast<float> (packet.data[i]), payload + 4*i);
+        }
+    }
+    else
+    {
+        std::memcpy(payload, packet.data.data(), 8*packet.data.size());
+    }
+    return frame;
+}
+
+int QPhase::Ingest::getFrameLength(const int nBytes, const char *buffer)
+{
+    if (nBytes < getFrameHeaderLength()){return 0;}
+    checkHeader(nBytes, buffer);
+    auto sampleSize = getSampleSize(load<uint8_t> (buffer + DATA_TYPE_OFFSET));
+    auto nSamples = load<int32_t> (buffer + NUMBER_OF_SAMPLES_OFFSET);
+    if (nSamples < 0 || nSamples > getMaximumNumberOfSamples())
+    {
+        throw std::invalid_argument("Invalid number of samples "
+                                  + std::to_string(nSamples));
+    }
+    return getFrameHeaderLength() + nSamples*sampleSize;
+}
+
+std::string QPhase::Ingest::getName(const int nBytes, const char *buffer)
+{
+    checkHeader(nBytes, buffer);
+    return loadCode(buffer + CODES_OFFSET) + "."
+         + loadCode(buffer + CODES_OFFSET + CODE_LENGTH) + "."
+         + loadCode(buffer + CODES_OFFSET + 2*CODE_LENGTH) + "."
+         + loadCode(buffer + CODES_OFFSET + 3*CODE_LENGTH);
+}
+
+std::string QPhase::Ingest::getName(const Packet &packet)
+{
+    return packet.network + "." + packet.station + "."
+         + packet.channel + "." + packet.locationCode;
+}
+
+Packet QPhase::Ingest::decode(const int nBytes, const char *buffer)
+{
+    auto frameLength = getFrameLength(nBytes, buffer);
+    if (frameLength == 0 || nBytes < frameLength)
+    {
+        throw std::invalid_argument("Frame is truncated");
+    }
+    Packet packet;
+    packet.network      = loadCode(buffer + CODES_OFFSET);
+    packet.station      = loadCode(buffer + CODES_OFFSET + CODE_LENGTH);
+    packet.channel      = loadCode(buffer + CODES_OFFSET + 2*CODE_LENGTH);
+    packet.locationCode = loadCode(buffer + CODES_OFFSET + 3*CODE_LENGTH);
+    packet.startTime
+        = std::chrono::microseconds {load<int64_t> (buffer
+                                                  + START_TIME_OFFSET)};
+    packet.samplingRateNumerator = load<int32_t> (buffer + NUMERATOR_OFFSET);
+    packet.samplingRateDenominator
+        = load<int32_t> (buffer + DENOMINATOR_OFFSET);
+    if (packet.samplingRateNumerator < 1 ||
+        packet.samplingRateDenominator < 1)
+    {
+        throw std::invalid_argument("Sampling rate must be positive");
+    }
+    auto nSamples = load<int32_t> (buffer + NUMBER_OF_SAMPLES_OFFSET);
+    auto type = load<uint8_t> (buffer + DATA_TYPE_OFFSET);
+    auto payload = buffer + getFrameHeaderLength();
+    packet.data.resize(nSamples);
+    if (type == static_cast<uint8_t> (DataType::Integer32))
+    {
+        for (int i = 0; i < nSamples; ++i)
+        {
+            packet.data[i] = load<int32_t> (payload + 4*i);
+        }
+    }
+    else if (type == static_cast<uint8_t> (DataType::Float32))
+    {
+        for (int i = 0; i < nSamples; ++i)
+        {
+            packet.data[i] = load<float> (payload + 4*i);
+        }
+    }
+    else
+    {
+        std::memcpy(packet.data.data(), payload, 8*packet.data.size());
+    }
+    return packet;
+}
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "qphase/ingest/replayer.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include "qphase/waveforms/segment.hpp"
+
+using namespace QPhase::Ingest;
+
+namespace
+{
+
+/// Frames are coalesced into sends of about this many bytes.
+constexpr size_t SEND_BUFFER_SIZE{1 << 16};
+
+/// The time of the last sample in the packet.
+std::chrono::microseconds getEndTime(const Packet &packet)
+{
+    if (packet.data.size() < 2){return packet.startTime;}
+    auto duration = static_cast<double> (packet.data.size() - 1)
+                   *packet.samplingRateDenominator*1.e6
+                   /packet.samplingRateNumerator;
+    return packet.startTime
+         + std::chrono::microseconds {std::llround(duration)};
+}
+
+}
+
+class Replayer::ReplayerImpl
+{
+public:
+    ~ReplayerImpl()
+    {
+        disconnect();
+    }
+    void disconnect() noexcept
+    {
+        if (mSocket >= 0){::close(mSocket);}
+        mSocket = -1;
+    }
+    void send(const std::vector<char> &buffer)
+    {
+        size_t nSent = 0;
+        while (nSent < buffer.size())
+        {
+            auto n = ::send(mSocket, buffer.data() + nSent,
+                            buffer.size() - nSent, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EINTR){continue;}
+                throw std::runtime_error("Failed to send: "
+                                       + std::string {std::strerror(errno)});
+            }
+            nSent = nSent + static_cast<size_t> (n);
+        }
+    }
+    int mSocket{-1};
+};
+
+/// Constructor
+Replayer::Replayer() :
+    pImpl(std::make_unique<ReplayerImpl> ())
+{
+}
+
+/// Move constructor
+Replayer::Replayer(Replayer &&replayer) noexcept
+{
+    *this = std::move(replayer);
+}
+
+/// Move assignment
+Replayer& Replayer::operator=(Replayer &&replayer) noexcept
+{
+    if (&replayer == this){return *this;}
+    pImpl = std::move(replayer.pImpl);
+    return *this;
+}
+
+/// Destructor
+Replayer::~Replayer() = default;
+
+/// Connect
+void Replayer::connect(const uint16_t port, const std::string &address)
+{
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address.c_str(), &server.sin_addr) != 1)
+    {
+        throw std::invalid_argument("Invalid IPv4 address " + address);
+    }
+    disconnect();
+    auto socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socket < 0)
+    {
+        throw std::runtime_error("Failed to create socket: "
+                               + std::string {std::strerror(errno)});
+    }
+    if (::connect(socket, reinterpret_cast<sockaddr *> (&server),
+                  sizeof(server)) != 0)
+    {
+        std::string error{std::strerror(errno)};
+        ::close(socket);
+        throw std::runtime_error("Failed to connect to " + address + ":"
+                               + std::to_string(port) + ": " + error);
+    }
+    int noDelay = 1;
+    ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    pImpl->mSocket = socket;
+}
+
+bool Replayer::isConnected() const noexcept
+{
+    return pImpl->mSocket >= 0;
+}
+
+void Replayer::disconnect() noexcept
+{
+    pImpl->disconnect();
+}
+
+/// Replay
+int64_t Replayer::replay(const std::vector<Packet> &packets,
+                         const double speedFactor,
+                         const DataType dataType)
+{
+    if (!isConnected()){throw std::runtime_error("Not connected");}
+    if (packets.empty()){return 0;}
+    // A digitizer emits a packet once its last sample is recorded
+    std::vector<std::chrono::microseconds> endTimes;
+    endTimes.reserve(packets.size());
+    for (const auto &packet : packets)
+    {
+        endTimes.push_back(::getEndTime(packet));
+    }
+    std::vector<size_t> order(packets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&endTimes](const size_t lhs, const size_t rhs)
+                     {
+                         return endTimes[lhs] < endTimes[rhs];
+                     });
+    auto origin = endTimes[order.front()];
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<char> buffer;
+    buffer.reserve(2*SEND_BUFFER_SIZE);
+    int64_t nBytes = 0;
+    for (const auto index : order)
+    {
+        if (speedFactor > 0)
+        {
+            std::chrono::duration<double, std::micro> elapsed
+                = (endTimes[index] - origin)/speedFactor;
+            auto due = wallStart
+                     + std::chrono::duration_cast<std::chrono::steady_clock::duration>
+                       (elapsed);
+            if (due > std::chrono::steady_clock::now())
+            {
+                pImpl->send(buffer);
+                buffer.clear();
+                std::this_thread::sleep_until(due);
+            }
+        }
+        auto frame = encode(packets[index], dataType);
+        buffer.insert(buffer.end(), frame.begin(), frame.end());
+        nBytes = nBytes + static_cast<int64_t> (frame.size());
+        if (buffer.size() >= SEND_BUFFER_SIZE)
+        {
+            pImpl->send(buffer);
+            buffer.clear();
+        }
+    }
+    pImpl->send(buffer);
+    return nBytes;
+}
+
+/// Packetize a waveform
+std::vector<Packet> Replayer::makePackets(
+    const Waveforms::Waveform<double> &waveform,
+    const std::string &network,
+    const std::string &station,
+    const std::string &channel,
+    const std::string &locationCode,
+    const int samplesPerPacket)
+{
+    if (samplesPerPacket < 1)
+    {
+        throw std::invalid_argument("Samples per packet must be positive");
+    }
+    if (samplesPerPacket > getMaximumNumberOfSamples())
+    {
+        throw std::invalid_argument("Samples per packet exceeds "
+                                  + std::to_string(getMaximumNumberOfSamples()));
+    }
+    constexpr auto maximumRate = std::numeric_limits<int32_t>::max();
+    std::vector<Packet> packets;
+    for (const auto &segment : waveform)
+    {
+        auto nSamples = segment.getNumberOfSamples();
+        if (nSamples < 1){continue;}
+        auto [numerator, denominator] = segment.getSamplingRateAsFraction();
+        if (numerator > maximumRate || denominator > maximumRate)
+        {
+            throw std::invalid_argument(
+                "Sampling rate cannot be represented in a packet");
+        }
+        auto data = segment.getDataPointer();
+        for (int i = 0; i < nSamples; i = i + samplesPerPacket)
+        {
+            auto n = std::min(samplesPerPacket, nSamples - i);
+            Packet packet;
+            packet.network = network;
+            packet.station = station;
+            packet.channel = channel;
+            packet.locationCode = locationCode;
+            packet.startTime = segment.getSampleTime(i);
+            packet.samplingRateNumerator = static_cast<int32_t> (numerator);
+            packet.samplingRateDenominator = static_cast<int32_t> (denominator);
+            packet.data.assign(data + i, data + i + n);
+            packets.push_back(std::move(packet));
+        }
+    }
+    return packets;
+}
@@ -0,0 +1,595 @@
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "qphase/ingest/server.hpp"
+#include "qphase/ingest/packet.hpp"
+#include "qphase/waveforms/realTimeWaveform.hpp"
+#include "private/spscQueue.hpp"
+
+using namespace QPhase::Ingest;
+using RealTimeWaveform = QPhase::Waveforms::RealTimeWaveform<double>;
+
+namespace
+{
+
+using Frame = std::vector<char>;
+/// Frames a connection may have in flight to each decoder.  When a queue
+/// fills the reader stops reading and TCP pushes back on the client.
+constexpr std::size_t QUEUE_CAPACITY{1024};
+/// Frames a decoder takes from one queue before visiting the next.
+constexpr int BATCH_SIZE{64};
+/// Interval at which the acceptor checks for shutdown.
+constexpr int ACCEPT_POLL_MILLISECONDS{100};
+/// Times a decoder with no frames yields before it blocks.
+constexpr int DECODER_SPIN_LIMIT{64};
+/// Interval at which a blocked decoder rechecks its queues unsignaled.
+constexpr int DECODER_WAIT_MILLISECONDS{100};
+
+/// The frames from one connection to one decoder.
+struct Inbox
+{
+    Inbox() :
+        queue(QUEUE_CAPACITY)
+    {
+    }
+    SPSCQueue<Frame> queue;
+    std::atomic<bool> closed{false};
+};
+
+struct Worker
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Inbox>> inboxes;
+    std::atomic<uint64_t> version{0};
+    /// Signaled when frames arrive for a blocked decoder.
+    std::condition_variable wakeUp;
+    /// The number of signals.  This is protected by the mutex.
+    uint64_t nWakeUps{0};
+    std::atomic<bool> sleeping{false};
+    std::thread thread;
+};
+
+struct Connection
+{
+    int socket{-1};
+    std::thread thread;
+    std::atomic<bool> finished{false};
+};
+
+/// Signals the worker's decoder.
+void signal(Worker &worker)
+{
+    {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.nWakeUps = worker.nWakeUps + 1;
+    }
+    worker.wakeUp.notify_one();
+}
+
+/// Signals the worker's decoder if it is blocked.  Call this after pushing
+/// a frame.
+void wake(Worker &worker)
+{
+    // Pairs with the fence in the decoder so that either the decoder sees
+    // the frame or this sees the decoder blocking
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.sleeping.load(std::memory_order_relaxed)){signal(worker);}
+}
+
+/// Yields then sleeps for progressively longer when a thread finds no work.
+void backoff(int &nIdle)
+{
+    nIdle = nIdle + 1;
+    if (nIdle < 64)
+    {
+        std::this_thread::yield();
+        return;
+    }
+    auto wait = std::min(1000, 10*(nIdle - 63));
+    std::this_thread::sleep_for(std::chrono::microseconds {wait});
+}
+
+void closeSocket(int &socket) noexcept
+{
+    if (socket >= 0){::close(socket);}
+    socket = -1;
+}
+
+}
+
+class Server::ServerImpl
+{
+public:
+    /// Waits for connections and starts a reader for each.
+    void acceptLoop()
+    {
+        while (mAccepting.load(std::memory_order_acquire))
+        {
+            reapConnections(false);
+            pollfd descriptor{mListenSocket, POLLIN, 0};
+            auto nReady = ::poll(&descriptor, 1, ACCEPT_POLL_MILLISECONDS);
+            if (nReady <= 0){continue;}
+            auto socket = ::accept(mListenSocket, nullptr, nullptr);
+            if (socket < 0){continue;}
+            // Each connection produces into one queue per decoder
+            std::vector<std::shared_ptr<Inbox>> inboxes;
+            inboxes.reserve(mWorkers.size());
+            for (auto &worker : mWorkers)
+            {
+                auto inbox = std::make_shared<Inbox> ();
+                {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                worker->inboxes.push_back(inbox);
+                }
+                worker->version.fetch_add(1, std::memory_order_release);
+                inboxes.push_back(std::move(inbox));
+            }
+            auto connection = std::make_unique<Connection> ();
+            connection->socket = socket;
+            auto connectionPointer = connection.get();
+            connection->thread = std::thread(&ServerImpl::readLoop, this,
+                                             connectionPointer,
+                                             std::move(inboxes));
+            std::lock_guard<std::mutex> lock(mConnectionsMutex);
+            mConnections.push_back(std::move(connection));
+        }
+    }
+    /// Joins the readers of closed connections.  When force is true all
+    /// connections are shut down first.
+    void reapConnections(const bool force)
+    {
+        std::lock_guard<std::mutex> lock(mConnectionsMutex);
+        for (auto it = mConnections.begin(); it != mConnections.end();)
+        {
+            auto &connection = *it;
+            if (force){::shutdown(connection->socket, SHUT_RDWR);}
+            if (force || connection->finished.load(std::memory_order_acquire))
+            {
+                if (connection->thread.joinable()){connection->thread.join();}
+                closeSocket(connection->socket);
+                it = mConnections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+    /// Splits a connection's byte stream into frames and routes each frame
+    /// to the decoder that owns its channel.
+    void readLoop(Connection *connection,
+                  std::vector<std::shared_ptr<Inbox>> inboxes)
+    {
+        std::hash<std::string> hash;
+        std::vector<char> buffer(1 << 16);
+        size_t nBuffered = 0;
+        bool keepReading = true;
+        while (keepReading && mAccepting.load(std::memory_order_acquire))
+        {
+            auto nRead = ::recv(connection->socket,
+                                buffer.data() + nBuffered,
+                                buffer.size() - nBuffered, 0);
+            if (nRead == 0){break;}
+            if (nRead < 0)
+            {
+                if (errno == EINTR){continue;}
+                break;
+            }
+            nBuffered = nBuffered + static_cast<size_t> (nRead);
+            size_t offset = 0;
+            while (true)
+            {
+                auto nAvailable = static_cast<int> (nBuffered - offset);
+                int frameLength = 0;
+                std::string name;
+                try
+                {
+                    frameLength = getFrameLength(nAvailable,
+                                                 buffer.data() + offset);
+                    if (frameLength > 0)
+                    {
+                        name = getName(nAvailable, buffer.data() + offset);
+                    }
+                }
+                catch (const std::exception &)
+                {
+                    // The stream cannot be resynchronized
+                    mErrors.fetch_add(1, std::memory_order_relaxed);
+                    keepReading = false;
+                    break;
+                }
+                if (frameLength == 0 || nAvailable < frameLength)
+                {
+                    if (static_cast<size_t> (frameLength) > buffer.size())
+                    {
+                        buffer.resize(frameLength);
+                    }
+                    break;
+                }
+                auto first = buffer.begin() + static_cast<ptrdiff_t> (offset);
+                Frame frame(first, first + frameLength);
+                auto index = hash(name) % inboxes.size();
+                auto &inbox = *inboxes[index];
+                int nIdle = 0;
+                while (!inbox.queue.tryPush(std::move(frame)))
+                {
+                    if (!mAccepting.load(std::memory_order_acquire)){break;}
+                    backoff(nIdle);
+                }
+                // The inboxes are in the same order as the workers
+                wake(*mWorkers[index]);
+                offset = offset + static_cast<size_t> (frameLength);
+            }
+            if (offset > 0)
+            {
+                std::memmove(buffer.data(), buffer.data() + offset,
+                             nBuffered - offset);
+                nBuffered = nBuffered - offset;
+            }
+        }
+        for (auto &inbox : inboxes)
+        {
+            inbox->closed.store(true, std::memory_order_release);
+        }
+        for (auto &worker : mWorkers){wake(*worker);}
+        connection->finished.store(true, std::memory_order_release);
+    }
+    /// Blocks an idle decoder until a reader signals it, the server stops,
+    /// or the wait times out.
+    void sleep(Worker *worker, const uint64_t version)
+    {
+        std::unique_lock<std::mutex> lock(worker->mutex);
+        auto nWakeUps = worker->nWakeUps;
+        worker->sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Recheck since a frame may have arrived before the flag was set
+        bool haveWork = !mDecoding.load(std::memory_order_acquire) ||
+                        worker->version.load(std::memory_order_acquire)
+                        != version;
+        for (const auto &inbox : worker->inboxes)
+        {
+            if (!inbox->queue.empty() ||
+                inbox->closed.load(std::memory_order_acquire))
+            {
+                haveWork = true;
+                break;
+            }
+        }
+        if (!haveWork)
+        {
+            worker->wakeUp.wait_for(
+                lock,
+                std::chrono::milliseconds {DECODER_WAIT_MILLISECONDS},
+                [&]()
+                {
+                    return worker->nWakeUps != nWakeUps ||
+                           !mDecoding.load(std::memory_order_acquire);
+                });
+        }
+        worker->sleeping.store(false, std::memory_order_relaxed);
+    }
+    /// Decodes frames and appends them to the channels this worker owns.
+    void decodeLoop(Worker *worker)
+    {
+        std::vector<std::shared_ptr<Inbox>> inboxes;
+        uint64_t version = 0;
+        bool haveInboxes = false;
+        std::unordered_map<std::string, std::shared_ptr<RealTimeWaveform>>
+            channels;
+        int nIdle = 0;
+        while (true)
+        {
+            // Read this before scanning so no frame pushed before the stop
+            // request is missed
+            auto stopping = !mDecoding.load(std::memory_order_acquire);
+            auto currentVersion = worker->version.load(std::memory_order_acquire);
+            if (!haveInboxes || currentVersion != version)
+            {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                inboxes = worker->inboxes;
+                version = worker->version.load(std::memory_order_relaxed);
+                haveInboxes = true;
+            }
+            bool didWork = false;
+            bool haveFinished = false;
+            for (auto &inbox : inboxes)
+            {
+                auto closed = inbox->closed.load(std::memory_order_acquire);
+                for (int i = 0; i < BATCH_SIZE; ++i)
+                {
+                    auto frame = inbox->queue.tryPop();
+                    if (!frame){break;}
+                    process(*frame, channels);
+                    didWork = true;
+                }
+                if (closed && inbox->queue.empty()){haveFinished = true;}
+            }
+            if (haveFinished)
+            {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                auto &all = worker->inboxes;
+                for (auto it = all.begin(); it != all.end();)
+                {
+                    if ((*it)->closed.load(std::memory_order_acquire) &&
+                        (*it)->queue.empty())
+                    {
+                        it = all.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+                worker->version.fetch_add(1, std::memory_order_release);
+            }
+            if (didWork)
+            {
+                nIdle = 0;
+                continue;
+            }
+            if (stopping){break;}
+            // Spin briefly since frames tend to arrive in bursts then block
+            nIdle = nIdle + 1;
+            if (nIdle < DECODER_SPIN_LIMIT)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                sleep(worker, version);
+                nIdle = 0;
+            }
+        }
+    }
+    void process(const Frame &frame,
+                 std::unordered_map<std::string,
+                                    std::shared_ptr<RealTimeWaveform>> &channels)
+    {
+        try
+        {
+            auto packet = decode(static_cast<int> (frame.size()), frame.data());
+            auto name = getName(packet);
+            auto it = channels.find(name);
+            if (it == channels.end())
+            {
+                it = channels.emplace(name, getOrCreateChannel(name, packet))
+                             .first;
+            }
+            auto &waveform = *it->second;
+            auto samplingRate = packet.samplingRateNumerator
+                   /static_cast<double> (packet.samplingRateDenominator);
+            if (std::abs(samplingRate - waveform.getSamplingRate())
+                > 1.e-9*samplingRate)
+            {
+                throw std::invalid_argument("Sampling rate mismatch for "
+                                          + name);
+            }
+            auto nSamples = static_cast<int> (packet.data.size());
+            waveform.append(packet.startTime, nSamples, packet.data.data());
+            mPackets.fetch_add(1, std::memory_order_relaxed);
+            mSamples.fetch_add(nSamples, std::memory_order_relaxed);
+        }
+        catch (const std::exception &)
+        {
+            mErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    std::shared_ptr<RealTimeWaveform>
+        getOrCreateChannel(const std::string &name, const Packet &packet)
+    {
+        std::lock_guard<std::mutex> lock(mChannelsMutex);
+        auto it = mChannels.find(name);
+        if (it != mChannels.end()){return it->second;}
+        auto waveform = std::make_shared<RealTimeWaveform> ();
+        waveform->initialize(packet.samplingRateNumerator,
+                             packet.samplingRateDenominator,
+                             mDefaultRetention);
+        mChannels.emplace(name, waveform);
+        return waveform;
+    }
+    mutable std::mutex mChannelsMutex;
+    std::map<std::string, std::shared_ptr<RealTimeWaveform>> mChannels;
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::mutex mConnectionsMutex;
+    std::list<std::unique_ptr<Connection>> mConnections;
+    std::thread mAcceptor;
+    std::atomic<bool> mAccepting{false};
+    std::atomic<bool> mDecoding{false};
+    std::atomic<bool> mRunning{false};
+    std::atomic<int64_t> mPackets{0};
+    std::atomic<int64_t> mSamples{0};
+    std::atomic<int64_t> mErrors{0};
+    std::chrono::microseconds mDefaultRetention{600000000};
+    int mListenSocket{-1};
+    uint16_t mPort{0};
+};
+
+/// Constructor
+Server::Server() :
+    pImpl(std::make_unique<ServerImpl> ())
+{
+}
+
+/// Destructor
+Server::~Server()
+{
+    stop();
+}
+
+/// Default retention
+void Server::setDefaultRetention(const std::chrono::microseconds &retention)
+{
+    if (retention.count() <= 0)
+    {
+        throw std::invalid_argument("Retention must be positive");
+    }
+    std::lock_guard<std::mutex> lock(pImpl->mChannelsMutex);
+    pImpl->mDefaultRetention = retention;
+}
+
+std::chrono::microseconds Server::getDefaultRetention() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mChannelsMutex);
+    return pImpl->mDefaultRetention;
+}
+
+/// Add a channel
+void Server::addChannel(const std::string &name,
+                        std::shared_ptr<Waveforms::RealTimeWaveform<double>> waveform)
+{
+    if (waveform == nullptr){throw std::invalid_argument("waveform is NULL");}
+    if (!waveform->isInitialized())
+    {
+        throw std::invalid_argument("waveform not initialized");
+    }
+    std::lock_guard<std::mutex> lock(pImpl->mChannelsMutex);
+    if (pImpl->mChannels.contains(name))
+    {
+        throw std::invalid_argument("Channel " + name + " already exists");
+    }
+    pImpl->mChannels.emplace(name, std::move(waveform));
+}
+
+/// Start
+void Server::start(const uint16_t port, const int nWorkers)
+{
+    if (nWorkers < 1)
+    {
+        throw std::invalid_argument("Number of workers must be positive");
+    }
+    if (isRunning()){throw std::runtime_error("Server already running");}
+    auto listenSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0)
+    {
+        throw std::runtime_error("Failed to create socket: "
+                               + std::string {std::strerror(errno)});
+    }
+    int reuse = 1;
+    ::setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR,
+                 &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (::bind(listenSocket, reinterpret_cast<sockaddr *> (&address),
+               length) != 0 ||
+        ::listen(listenSocket, SOMAXCONN) != 0 ||
+        ::getsockname(listenSocket, reinterpret_cast<sockaddr *> (&address),
+                      &length) != 0)
+    {
+        std::string error{std::strerror(errno)};
+        closeSocket(listenSocket);
+        throw std::runtime_error("Failed to listen on port "
+                               + std::to_string(port) + ": " + error);
+    }
+    pImpl->mListenSocket = listenSocket;
+    pImpl->mPort = ntohs(address.sin_port);
+    pImpl->mDecoding.store(true, std::memory_order_release);
+    pImpl->mAccepting.store(true, std::memory_order_release);
+    pImpl->mWorkers.clear();
+    for (int i = 0; i < nWorkers; ++i)
+    {
+        pImpl->mWorkers.push_back(std::make_unique<Worker> ());
+    }
+    for (auto &worker : pImpl->mWorkers)
+    {
+        worker->thread = std::thread(&ServerImpl::decodeLoop, pImpl.get(),
+                                     worker.get());
+    }
+    pImpl->mAcceptor = std::thread(&ServerImpl::acceptLoop, pImpl.get());
+    pImpl->mRunning.store(true, std::memory_order_release);
+}
+
+bool Server::isRunning() const noexcept
+{
+    return pImpl->mRunning.load(std::memory_order_acquire);
+}
+
+uint16_t Server::getPort() const
+{
+    if (!isRunning()){throw std::runtime_error("Server not running");}
+    return pImpl->mPort;
+}
+
+/// Stop
+void Server::stop() noexcept
+{
+    if (!isRunning()){return;}
+    // Stop accepting then close the connections so no more frames arrive
+    pImpl->mAccepting.store(false, std::memory_order_release);
+    if (pImpl->mAcceptor.joinable()){pImpl->mAcceptor.join();}
+    closeSocket(pImpl->mListenSocket);
+    pImpl->reapConnections(true);
+    // The decoders drain their queues before exiting
+    pImpl->mDecoding.store(false, std::memory_order_release);
+    for (auto &worker : pImpl->mWorkers)
+    {
+        signal(*worker);
+        if (worker->thread.joinable()){worker->thread.join();}
+    }
+    pImpl->mWorkers.clear();
+    pImpl->mRunning.store(false, std::memory_order_release);
+}
+
+/// Channels
+bool Server::haveChannel(const std::string &name) const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mChannelsMutex);
+    return pImpl->mChannels.contains(name);
+}
+
+std::vector<std::string> Server::getChannelNames() const
+{
+    std::vector<std::string> names;
+    std::lock_guard<std::mutex> lock(pImpl->mChannelsMutex);
+    names.reserve(pImpl->mChannels.size());
+    for (const auto &channel : pImpl->mChannels)
+    {
+        names.push_back(channel.first);
+    }
+    return names;
+}
+
+std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>>
+    Server::getWaveform(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(pImpl->mChannelsMutex);
+    auto it = pImpl->mChannels.find(name);
+    if (it == pImpl->mChannels.end())
+    {
+        throw std::invalid_argument("Channel " + name + " does not exist");
+    }
+    return it->second;
+}
+
+/// Statistics
+int64_t Server::getNumberOfPackets() const noexcept
+{
+    return pImpl->mPackets.load(std::memory_order_relaxed);
+}
+
+int64_t Server::getNumberOfSamples() const noexcept
+{
+    return pImpl->mSamples.load(std::memory_order_relaxed);
+}
+
+int64_t Server::getNumberOfErrors() const noexcept
+{
+    return pImpl->mErrors.load(std::memory_order_relaxed);
+}
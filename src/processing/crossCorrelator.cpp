@@ -0,0 +1,496 @@
+#include <cmath>
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "qphase/processing/crossCorrelator.hpp"
+#include "qphase/database/internal/arrival.hpp"
+#include "qphase/waveforms/gather.hpp"
+#include "private/processing/fft.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// Windows whose variance is less than this fraction of the channel's
+/// average variance over a template length are treated as constant.
+constexpr double VARIANCE_TOLERANCE{1.e-10};
+
+/// Scratch space for one thread.
+struct Workspace
+{
+    explicit Workspace(const int fftLength, const int nSamples) :
+        signal(fftLength),
+        spectrum(fftLength),
+        sums(nSamples + 1),
+        sumsOfSquares(nSamples + 1),
+        coefficients(nSamples)
+    {
+    }
+    std::vector<std::complex<double>> signal;
+    std::vector<std::complex<double>> spectrum;
+    std::vector<double> sums;
+    std::vector<double> sumsOfSquares;
+    std::vector<double> coefficients;
+};
+
+/// @result The mean of the channel.  This is removed before correlating.
+///         Since the template has zero mean this does not change the
+///         correlation but it keeps the running sums used for the window
+///         variances accurate.
+template<typename T>
+double mean(const int n, const T *x)
+{
+    double sum = 0;
+    for (int i = 0; i < n; ++i){sum = sum + static_cast<double> (x[i]);}
+    return sum/n;
+}
+
+/// @result The conjugate of the zero-padded template's spectrum scaled by
+///         the inverse transform's normalization.  Multiplying a channel's
+///         spectrum by this then inverting yields the correlation.
+std::vector<std::complex<double>>
+    computeTemplateSpectrum(const FFTPlan &plan,
+                            const std::vector<double> &templateSignal)
+{
+    const int fftLength = plan.size();
+    std::vector<std::complex<double>> work(fftLength,
+                                           std::complex<double> {0, 0});
+    std::copy(templateSignal.begin(), templateSignal.end(), work.begin());
+    std::vector<std::complex<double>> spectrum(fftLength);
+    plan.forward(work.data(), spectrum.data());
+    const auto scale = 1.0/fftLength;
+    for (auto &v : spectrum){v = std::conj(v)*scale;}
+    return spectrum;
+}
+
+/// Normalizes the raw correlation of a channel then finds its peak in the
+/// search window.  The raw correlation is read from the real or imaginary
+/// part of the packed inverse transform.
+template<typename T>
+typename CrossCorrelator<T>::Lag
+    findPeak(const int channel,
+             const int nSamples,
+             const int templateLength,
+             const double templateNorm,
+             const std::pair<int, int> &window,
+             const bool imaginaryPart,
+             Workspace &workspace)
+{
+    const auto &signal = workspace.signal;
+    const auto *sums = workspace.sums.data();
+    const auto *sumsOfSquares = workspace.sumsOfSquares.data();
+    auto *coefficients = workspace.coefficients.data();
+    const int m = templateLength;
+    const int lastValidLag = nSamples - m;
+    // Include a neighbor on either side of the window for the interpolation
+    const int i0 = std::max(0, window.first - 1);
+    const int i1 = std::min(lastValidLag, window.second + 1);
+    auto averageVariance = std::max(0.0,
+                                    sumsOfSquares[nSamples]
+                                  - sums[nSamples]*sums[nSamples]/nSamples)
+                          *m/nSamples;
+    auto tolerance = VARIANCE_TOLERANCE*averageVariance;
+    for (int k = i0; k <= i1; ++k)
+    {
+        auto s1 = sums[k + m] - sums[k];
+        auto s2 = sumsOfSquares[k + m] - sumsOfSquares[k];
+        auto variance = s2 - s1*s1/m;
+        auto raw = imaginaryPart ? signal[k].imag() : signal[k].real();
+        coefficients[k] = variance > tolerance ?
+                          raw/(templateNorm*std::sqrt(variance)) : 0;
+    }
+    int peak = window.first;
+    for (int k = window.first + 1; k <= window.second; ++k)
+    {
+        if (coefficients[k] > coefficients[peak]){peak = k;}
+    }
+    typename CrossCorrelator<T>::Lag result;
+    result.channel = channel;
+    result.lag = peak;
+    result.coefficient = coefficients[peak];
+    // Fit a parabola through the peak and its neighbors
+    if (peak > 0 && peak < lastValidLag)
+    {
+        auto cm = coefficients[peak - 1];
+        auto c0 = coefficients[peak];
+        auto cp = coefficients[peak + 1];
+        auto denominator = cm - 2*c0 + cp;
+        if (denominator < 0)
+        {
+            auto shift = std::clamp(0.5*(cm - cp)/denominator, -0.5, 0.5);
+            result.lag = peak + shift;
+            result.coefficient = c0 - 0.25*(cm - cp)*shift;
+        }
+    }
+    result.coefficient = std::clamp(result.coefficient, -1.0, 1.0);
+    return result;
+}
+
+/// Correlates the template with one or two channels.  The second channel
+/// is packed into the imaginary part of the transform.
+template<typename T>
+void correlatePair(const FFTPlan &plan,
+                   const std::vector<std::complex<double>> &templateSpectrum,
+                   const int templateLength,
+                   const double templateNorm,
+                   const int nSamples,
+                   const T *x0, const T *x1,
+                   const int channel0,
+                   const std::pair<int, int> &window0,
+                   const std::pair<int, int> &window1,
+                   Workspace &workspace,
+                   typename CrossCorrelator<T>::Lag *lags)
+{
+    const int fftLength = plan.size();
+    auto &signal = workspace.signal;
+    auto mean0 = mean(nSamples, x0);
+    auto mean1 = x1 ? mean(nSamples, x1) : 0;
+    for (int i = 0; i < nSamples; ++i)
+    {
+        signal[i] = std::complex<double>
+                    (static_cast<double> (x0[i]) - mean0,
+                     x1 ? static_cast<double> (x1[i]) - mean1 : 0);
+    }
+    std::fill(signal.begin() + nSamples, signal.end(),
+              std::complex<double> {0, 0});
+    plan.forward(signal.data(), workspace.spectrum.data());
+    for (int k = 0; k < fftLength; ++k)
+    {
+        workspace.spectrum[k] = multiply(workspace.spectrum[k],
+                                         templateSpectrum[k]);
+    }
+    plan.inverse(workspace.spectrum.data(), signal.data());
+    // Running sums give each window's variance for the normalization
+    for (int c = 0; c < (x1 ? 2 : 1); ++c)
+    {
+        const T *x = (c == 0) ? x0 : x1;
+        auto xMean = (c == 0) ? mean0 : mean1;
+        auto *sums = workspace.sums.data();
+        auto *sumsOfSquares = workspace.sumsOfSquares.data();
+        sums[0] = 0;
+        sumsOfSquares[0] = 0;
+        for (int i = 0; i < nSamples; ++i)
+        {
+            auto xi = static_cast<double> (x[i]) - xMean;
+            sums[i + 1] = sums[i] + xi;
+            sumsOfSquares[i + 1] = sumsOfSquares[i] + xi*xi;
+        }
+        lags[c] = findPeak<T> (channel0 + c, nSamples, templateLength,
+                               templateNorm, (c == 0) ? window0 : window1,
+                               c == 1, workspace);
+    }
+}
+
+}
+
+template<class T>
+class CrossCorrelator<T>::CrossCorrelatorImpl
+{
+public:
+    /// The demeaned template.
+    std::vector<double> mTemplate;
+    /// The L2 norm of the demeaned template.
+    double mTemplateNorm{0};
+    int mThreads{1};
+    bool mHaveTemplate{false};
+};
+
+/// C'tor
+template<class T>
+CrossCorrelator<T>::CrossCorrelator() :
+    pImpl(std::make_unique<CrossCorrelatorImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+CrossCorrelator<T>::CrossCorrelator(const CrossCorrelator &correlator)
+{
+    *this = correlator;
+}
+
+/// Move c'tor
+template<class T>
+CrossCorrelator<T>::CrossCorrelator(CrossCorrelator &&correlator) noexcept
+{
+    *this = std::move(correlator);
+}
+
+/// Copy assignment
+template<class T>
+CrossCorrelator<T>&
+CrossCorrelator<T>::operator=(const CrossCorrelator &correlator)
+{
+    if (&correlator == this){return *this;}
+    pImpl = std::make_unique<CrossCorrelatorImpl> (*correlator.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+CrossCorrelator<T>&
+CrossCorrelator<T>::operator=(CrossCorrelator &&correlator) noexcept
+{
+    if (&correlator == this){return *this;}
+    pImpl = std::move(correlator.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void CrossCorrelator<T>::clear() noexcept
+{
+    pImpl = std::make_unique<CrossCorrelatorImpl> ();
+}
+
+/// D'tor
+template<class T>
+CrossCorrelator<T>::~CrossCorrelator() = default;
+
+/// Template
+template<class T>
+void CrossCorrelator<T>::setTemplate(const int n, const T *x)
+{
+    if (n < 2){throw std::invalid_argument("Template must have 2 samples");}
+    if (x == nullptr){throw std::invalid_argument("Template is NULL");}
+    std::vector<double> work(x, x + n);
+    auto average = std::accumulate(work.begin(), work.end(), 0.0)/n;
+    double norm = 0;
+    for (auto &v : work)
+    {
+        v = v - average;
+        norm = norm + v*v;
+    }
+    norm = std::sqrt(norm);
+    if (!(norm > 0)){throw std::invalid_argument("Template is constant");}
+    pImpl->mTemplate = std::move(work);
+    pImpl->mTemplateNorm = norm;
+    pImpl->mHaveTemplate = true;
+}
+
+template<class T>
+bool CrossCorrelator<T>::haveTemplate() const noexcept
+{
+    return pImpl->mHaveTemplate;
+}
+
+template<class T>
+int CrossCorrelator<T>::getTemplateLength() const
+{
+    if (!haveTemplate()){throw std::runtime_error("Template not set");}
+    return static_cast<int> (pImpl->mTemplate.size());
+}
+
+/// Threads
+template<class T>
+void CrossCorrelator<T>::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pImpl->mThreads = nThreads;
+}
+
+template<class T>
+int CrossCorrelator<T>::getNumberOfThreads() const noexcept
+{
+    return pImpl->mThreads;
+}
+
+/// Correlate
+template<class T>
+std::vector<typename CrossCorrelator<T>::Lag>
+CrossCorrelator<T>::correlate(
+    const int nChannels,
+    const int nSamples,
+    const int leadingDimension,
+    const T *x,
+    const std::vector<std::pair<int, int>> &searchWindows) const
+{
+    if (!haveTemplate()){throw std::runtime_error("Template not set");}
+    auto templateLength = getTemplateLength();
+    if (nChannels < 1){return std::vector<Lag> {};}
+    if (nSamples < templateLength)
+    {
+        throw std::invalid_argument("Channels must have at least "
+                                  + std::to_string(templateLength)
+                                  + " samples");
+    }
+    if (leadingDimension < nSamples)
+    {
+        throw std::invalid_argument("Leading dimension too small");
+    }
+    if (x == nullptr){throw std::invalid_argument("x is NULL");}
+    if (!searchWindows.empty() &&
+        static_cast<int> (searchWindows.size()) != nChannels)
+    {
+        throw std::invalid_argument("Number of search windows must be "
+                                  + std::to_string(nChannels));
+    }
+    // Clip the search windows to the lags at which the template fits
+    const int lastValidLag = nSamples - templateLength;
+    std::vector<std::pair<int, int>> windows(nChannels,
+                                             std::pair {0, lastValidLag});
+    for (int c = 0; c < static_cast<int> (searchWindows.size()); ++c)
+    {
+        auto first = std::max(0, searchWindows[c].first);
+        auto last = std::min(lastValidLag, searchWindows[c].second);
+        if (first > last)
+        {
+            throw std::invalid_argument("Search window of channel "
+                                      + std::to_string(c) + " is empty");
+        }
+        windows[c] = std::pair {first, last};
+    }
+    // Lags only run to nSamples - templateLength so the circular
+    // correlation of a transform of at least nSamples does not wrap
+    auto plan = getFFTPlan(nextFFTLength(nSamples));
+    const int fftLength = plan->size();
+    auto templateSpectrum = computeTemplateSpectrum(*plan, pImpl->mTemplate);
+    // Divide the channel pairs among the threads
+    std::vector<Lag> lags(nChannels);
+    const int nPairs = (nChannels + 1)/2;
+    const int nThreads = std::min(pImpl->mThreads, nPairs);
+    const auto templateNorm = pImpl->mTemplateNorm;
+    std::vector<Workspace> workspaces;
+    workspaces.reserve(nThreads);
+    for (int i = 0; i < nThreads; ++i)
+    {
+        workspaces.emplace_back(fftLength, nSamples);
+    }
+    auto work = [&](const int thread)
+    {
+        auto pair0 = static_cast<int> (static_cast<int64_t> (nPairs)*thread/nThreads);
+        auto pair1 = static_cast<int> (static_cast<int64_t> (nPairs)*(thread + 1)/nThreads);
+        for (int pair = pair0; pair < pair1; ++pair)
+        {
+            auto c0 = 2*pair;
+            auto c1 = c0 + 1;
+            const T *x0 = x + static_cast<size_t> (c0)*leadingDimension;
+            const T *x1 = c1 < nChannels ?
+                          x + static_cast<size_t> (c1)*leadingDimension :
+                          nullptr;
+            correlatePair<T> (*plan, templateSpectrum, templateLength,
+                              templateNorm, nSamples, x0, x1, c0,
+                              windows[c0], x1 ? windows[c1] : windows[c0],
+                              workspaces[thread], lags.data() + c0);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int thread = 1; thread < nThreads; ++thread)
+    {
+        threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (auto &thread : threads){thread.join();}
+    return lags;
+}
+
+template<class T>
+std::vector<typename CrossCorrelator<T>::Lag>
+CrossCorrelator<T>::correlate(
+    const QPhase::Waveforms::Gather<T> &gather,
+    const std::vector<std::pair<int, int>> &searchWindows) const
+{
+    if (gather.getNumberOfChannels() < 1 || gather.getNumberOfSamples() < 1)
+    {
+        throw std::invalid_argument("Gather is empty");
+    }
+    return correlate(gather.getNumberOfChannels(),
+                     gather.getNumberOfSamples(),
+                     gather.getLeadingDimension(),
+                     gather.getDataPointer(),
+                     searchWindows);
+}
+
+/// Arrivals
+template<class T>
+int QPhase::Processing::updateArrivals(
+    const std::vector<typename CrossCorrelator<T>::Lag> &lags,
+    const QPhase::Waveforms::Gather<T> &gather,
+    const QPhase::Database::Internal::Arrival::Phase phase,
+    const std::chrono::microseconds &templatePickOffset,
+    const double minimumCoefficient,
+    std::vector<QPhase::Database::Internal::Arrival> *arrivals)
+{
+    if (arrivals == nullptr){throw std::invalid_argument("Arrivals is NULL");}
+    auto nChannels = gather.getNumberOfChannels();
+    std::vector<const typename CrossCorrelator<T>::Lag *> lagOfRow(nChannels,
+                                                                   nullptr);
+    for (const auto &lag : lags)
+    {
+        if (lag.channel < 0 || lag.channel >= nChannels)
+        {
+            throw std::invalid_argument("Lag channel "
+                                      + std::to_string(lag.channel)
+                                      + " not in gather");
+        }
+        lagOfRow[lag.channel] = &lag;
+    }
+    if (lags.empty()){return 0;}
+    const auto samplingRate = gather.getSamplingRate();
+    // Use the arrival's own naming of the phase
+    QPhase::Database::Internal::Arrival phaseArrival;
+    phaseArrival.setPhase(phase);
+    const auto phaseName = phaseArrival.getPhase();
+    int nUpdated = 0;
+    for (auto &arrival : *arrivals)
+    {
+        if (!arrival.haveNetwork() ||
+            !arrival.haveStation() ||
+            !arrival.haveChannel() ||
+            !arrival.havePhase())
+        {
+            continue;
+        }
+        if (arrival.getPhase() != phaseName){continue;}
+        auto locationCode = arrival.getLocationCode();
+        auto row = gather.findChannel(arrival.getNetwork(),
+                                      arrival.getStation(),
+                                      arrival.getChannel(),
+                                      locationCode);
+        // SEED writes a blank location code as --
+        if (row < 0 && (locationCode == "--" || locationCode.empty()))
+        {
+            row = gather.findChannel(arrival.getNetwork(),
+                                     arrival.getStation(),
+                                     arrival.getChannel(),
+                                     locationCode.empty() ? "--" : "");
+        }
+        if (row < 0 || lagOfRow[row] == nullptr){continue;}
+        const auto &lag = *lagOfRow[row];
+        if (lag.coefficient < minimumCoefficient){continue;}
+        auto shift = std::chrono::microseconds
+                     {std::llround(lag.lag/samplingRate*1.e6)};
+        arrival.setTime(gather.getStartTime() + shift + templatePickOffset);
+        nUpdated = nUpdated + 1;
+    }
+    return nUpdated;
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::CrossCorrelator<double>;
+template class QPhase::Processing::CrossCorrelator<float>;
+template int QPhase::Processing::updateArrivals<double>(
+    const std::vector<typename CrossCorrelator<double>::Lag> &,
+    const QPhase::Waveforms::Gather<double> &,
+    QPhase::Database::Internal::Arrival::Phase,
+    const std::chrono::microseconds &,
+    double,
+    std::vector<QPhase::Database::Internal::Arrival> *);
+template int QPhase::Processing::updateArrivals<float>(
+    const std::vector<typename CrossCorrelator<float>::Lag> &,
+    const QPhase::Waveforms::Gather<float> &,
+    QPhase::Database::Internal::Arrival::Phase,
+    const std::chrono::microseconds &,
+    double,
+    std::vector<QPhase::Database::Internal::Arrival> *);
@@ -0,0 +1,649 @@
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/segment.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QPHASE_HAVE_X86_SIMD 1
+#endif
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// The per-instruction set function table.
+template<typename T>
+struct Kernels
+{
+    std::pair<T, T> (*minMax)(int, const T *){nullptr};
+    T (*absoluteMaximum)(int, const T *){nullptr};
+    double (*sum)(int, const T *){nullptr};
+    double (*sumOfSquares)(int, const T *){nullptr};
+    double (*indexWeightedSum)(int, const T *){nullptr};
+    void (*addAffine)(int, double, double, T *){nullptr};
+    void (*scale)(int, T, T *){nullptr};
+};
+
+struct Conversions
+{
+    void (*floatToDouble)(int, const float *, double *){nullptr};
+    void (*doubleToFloat)(int, const double *, float *){nullptr};
+};
+
+///--------------------------------------------------------------------------///
+///                                  Scalar                                  ///
+///--------------------------------------------------------------------------///
+namespace Scalar
+{
+/// The scalar "register" is a double so float signals are accumulated in
+/// double precision.
+template<typename U>
+struct Traits
+{
+    using value_type = U;
+    static constexpr int width{1};
+    static double load(const U *x){return *x;}
+    static void store(U *x, const double v){*x = static_cast<U> (v);}
+    static double set1(const double v){return v;}
+    static double zero(){return 0;}
+    static double iota(){return 0;}
+    static double add(const double a, const double b){return a + b;}
+    static double mul(const double a, const double b){return a*b;}
+    static double fmadd(const double a, const double b, const double c)
+    {
+        return a*b + c;
+    }
+    static double min(const double a, const double b){return std::min(a, b);}
+    static double max(const double a, const double b){return std::max(a, b);}
+    static double abs(const double a){return std::abs(a);}
+    static double reduceAdd(const double a){return a;}
+    static U reduceMin(const double a){return static_cast<U> (a);}
+    static U reduceMax(const double a){return static_cast<U> (a);}
+};
+#include "private/processing/simdKernels.hpp"
+template<typename U, typename V>
+void convert(const int n, const U *__restrict__ x, V *__restrict__ y)
+{
+    for (int i = 0; i < n; ++i){y[i] = static_cast<V> (x[i]);}
+}
+const Kernels<double> doubleKernels = makeKernels<Traits<double>> ();
+const Kernels<float> floatKernels = makeKernels<Traits<float>> ();
+const Conversions conversions{&convert<float, double>,
+                              &convert<double, float>};
+}
+
+#ifdef QPHASE_HAVE_X86_SIMD
+///--------------------------------------------------------------------------///
+///                                   AVX2                                   ///
+///--------------------------------------------------------------------------///
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+namespace AVX2
+{
+struct DoubleTraits
+{
+    using value_type = double;
+    static constexpr int width{4};
+    static __m256d load(const double *x){return _mm256_loadu_pd(x);}
+    static void store(double *x, const __m256d v){_mm256_storeu_pd(x, v);}
+    static __m256d set1(const double v){return _mm256_set1_pd(v);}
+    static __m256d zero(){return _mm256_setzero_pd();}
+    static __m256d iota(){return _mm256_set_pd(3, 2, 1, 0);}
+    static __m256d add(const __m256d a, const __m256d b){return _mm256_add_pd(a, b);}
+    static __m256d mul(const __m256d a, const __m256d b){return _mm256_mul_pd(a, b);}
+    static __m256d fmadd(const __m256d a, const __m256d b, const __m256d c)
+    {
+        return _mm256_fmadd_pd(a, b, c);
+    }
+    static __m256d min(const __m256d a, const __m256d b){return _mm256_min_pd(a, b);}
+    static __m256d max(const __m256d a, const __m256d b){return _mm256_max_pd(a, b);}
+    static __m256d abs(const __m256d a)
+    {
+        return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);
+    }
+    static double reduceAdd(const __m256d a)
+    {
+        auto s = _mm_add_pd(_mm256_castpd256_pd128(a),
+                            _mm256_extractf128_pd(a, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+    static double reduceMin(const __m256d a)
+    {
+        auto s = _mm_min_pd(_mm256_castpd256_pd128(a),
+                            _mm256_extractf128_pd(a, 1));
+        return _mm_cvtsd_f64(_mm_min_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+    static double reduceMax(const __m256d a)
+    {
+        auto s = _mm_max_pd(_mm256_castpd256_pd128(a),
+                            _mm256_extractf128_pd(a, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+};
+struct FloatTraits
+{
+    using value_type = float;
+    static constexpr int width{8};
+    static __m256 load(const float *x){return _mm256_loadu_ps(x);}
+    static void store(float *x, const __m256 v){_mm256_storeu_ps(x, v);}
+    static __m256 set1(const float v){return _mm256_set1_ps(v);}
+    static __m256 zero(){return _mm256_setzero_ps();}
+    static __m256 iota(){return _mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0);}
+    static __m256 add(const __m256 a, const __m256 b){return _mm256_add_ps(a, b);}
+    static __m256 mul(const __m256 a, const __m256 b){return _mm256_mul_ps(a, b);}
+    static __m256 fmadd(const __m256 a, const __m256 b, const __m256 c)
+    {
+        return _mm256_fmadd_ps(a, b, c);
+    }
+    static __m256 min(const __m256 a, const __m256 b){return _mm256_min_ps(a, b);}
+    static __m256 max(const __m256 a, const __m256 b){return _mm256_max_ps(a, b);}
+    static __m256 abs(const __m256 a)
+    {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+    }
+    static float reduceAdd(const __m256 a)
+    {
+        auto s = _mm_add_ps(_mm256_castps256_ps128(a),
+                            _mm256_extractf128_ps(a, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55)));
+    }
+    static float reduceMin(const __m256 a)
+    {
+        auto s = _mm_min_ps(_mm256_castps256_ps128(a),
+                            _mm256_extractf128_ps(a, 1));
+        s = _mm_min_ps(s, _mm_movehl_ps(s, s));
+        return _mm_cvtss_f32(_mm_min_ss(s, _mm_shuffle_ps(s, s, 0x55)));
+    }
+    static float reduceMax(const __m256 a)
+    {
+        auto s = _mm_max_ps(_mm256_castps256_ps128(a),
+                            _mm256_extractf128_ps(a, 1));
+        s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+        return _mm_cvtss_f32(_mm_max_ss(s, _mm_shuffle_ps(s, s, 0x55)));
+    }
+};
+#include "private/processing/simdKernels.hpp"
+void floatToDouble(const int n, const float *__restrict__ x,
+                   double *__restrict__ y)
+{
+    int i = 0;
+    for (; i + 4 <= n; i = i + 4)
+    {
+        _mm256_storeu_pd(y + i, _mm256_cvtps_pd(_mm_loadu_ps(x + i)));
+    }
+    for (; i < n; ++i){y[i] = static_cast<double> (x[i]);}
+}
+void doubleToFloat(const int n, const double *__restrict__ x,
+                   float *__restrict__ y)
+{
+    int i = 0;
+    for (; i + 4 <= n; i = i + 4)
+    {
+        _mm_storeu_ps(y + i, _mm256_cvtpd_ps(_mm256_loadu_pd(x + i)));
+    }
+    for (; i < n; ++i){y[i] = static_cast<float> (x[i]);}
+}
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+///--------------------------------------------------------------------------///
+///                                 AVX-512                                  ///
+///--------------------------------------------------------------------------///
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// GCC 12's _mm512_undefined_* trips -Wmaybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace AVX512
+{
+struct DoubleTraits
+{
+    using value_type = double;
+    static constexpr int width{8};
+    static __m512d load(const double *x){return _mm512_loadu_pd(x);}
+    static void store(double *x, const __m512d v){_mm512_storeu_pd(x, v);}
+    static __m512d set1(const double v){return _mm512_set1_pd(v);}
+    static __m512d zero(){return _mm512_setzero_pd();}
+    static __m512d iota(){return _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);}
+    static __m512d add(const __m512d a, const __m512d b){return _mm512_add_pd(a, b);}
+    static __m512d mul(const __m512d a, const __m512d b){return _mm512_mul_pd(a, b);}
+    static __m512d fmadd(const __m512d a, const __m512d b, const __m512d c)
+    {
+        return _mm512_fmadd_pd(a, b, c);
+    }
+    static __m512d min(const __m512d a, const __m512d b){return _mm512_min_pd(a, b);}
+    static __m512d max(const __m512d a, const __m512d b){return _mm512_max_pd(a, b);}
+    static __m512d abs(const __m512d a){return _mm512_abs_pd(a);}
+    static double reduceAdd(const __m512d a){return _mm512_reduce_add_pd(a);}
+    static double reduceMin(const __m512d a){return _mm512_reduce_min_pd(a);}
+    static double reduceMax(const __m512d a){return _mm512_reduce_max_pd(a);}
+};
+struct FloatTraits
+{
+    using value_type = float;
+    static constexpr int width{16};
+    static __m512 load(const float *x){return _mm512_loadu_ps(x);}
+    static void store(float *x, const __m512 v){_mm512_storeu_ps(x, v);}
+    static __m512 set1(const float v){return _mm512_set1_ps(v);}
+    static __m512 zero(){return _mm512_setzero_ps();}
+    static __m512 iota()
+    {
+        return _mm512_set_ps(15, 14, 13, 12, 11, 10, 9, 8,
+                              7,  6,  5,  4,  3,  2, 1, 0);
+    }
+    static __m512 add(const __m512 a, const __m512 b){return _mm512_add_ps(a, b);}
+    static __m512 mul(const __m512 a, const __m512 b){return _mm512_mul_ps(a, b);}
+    static __m512 fmadd(const __m512 a, const __m512 b, const __m512 c)
+    {
+        return _mm512_fmadd_ps(a, b, c);
+    }
+    static __m512 min(const __m512 a, const __m512 b){return _mm512_min_ps(a, b);}
+    static __m512 max(const __m512 a, const __m512 b){return _mm512_max_ps(a, b);}
+    static __m512 abs(const __m512 a){return _mm512_abs_ps(a);}
+    static float reduceAdd(const __m512 a){return _mm512_reduce_add_ps(a);}
+    static float reduceMin(const __m512 a){return _mm512_reduce_min_ps(a);}
+    static float reduceMax(const __m512 a){return _mm512_reduce_max_ps(a);}
+};
+#include "private/processing/simdKernels.hpp"
+void floatToDouble(const int n, const float *__restrict__ x,
+                   double *__restrict__ y)
+{
+    int i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        _mm512_storeu_pd(y + i, _mm512_cvtps_pd(_mm256_loadu_ps(x + i)));
+    }
+    for (; i < n; ++i){y[i] = static_cast<double> (x[i]);}
+}
+void doubleToFloat(const int n, const double *__restrict__ x,
+                   float *__restrict__ y)
+{
+    int i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        _mm256_storeu_ps(y + i, _mm512_cvtpd_ps(_mm512_loadu_pd(x + i)));
+    }
+    for (; i < n; ++i){y[i] = static_cast<float> (x[i]);}
+}
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+// The tables are built outside of the target regions since they run on
+// every CPU at load time.
+namespace AVX2
+{
+const Kernels<double> doubleKernels = makeKernels<DoubleTraits> ();
+const Kernels<float> floatKernels = makeKernels<FloatTraits> ();
+const Conversions conversions{&floatToDouble, &doubleToFloat};
+}
+namespace AVX512
+{
+const Kernels<double> doubleKernels = makeKernels<DoubleTraits> ();
+const Kernels<float> floatKernels = makeKernels<FloatTraits> ();
+const Conversions conversions{&floatToDouble, &doubleToFloat};
+}
+#endif
+
+///--------------------------------------------------------------------------///
+///                                 Dispatch                                 ///
+///--------------------------------------------------------------------------///
+[[nodiscard]] bool cpuSupports(const InstructionSet instructionSet) noexcept
+{
+    if (instructionSet == InstructionSet::Scalar){return true;}
+#ifdef QPHASE_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (instructionSet == InstructionSet::AVX2)
+    {
+        return __builtin_cpu_supports("avx2") &&
+               __builtin_cpu_supports("fma");
+    }
+    if (instructionSet == InstructionSet::AVX512)
+    {
+        return __builtin_cpu_supports("avx512f");
+    }
+#endif
+    return false;
+}
+
+[[nodiscard]] InstructionSet detectInstructionSet() noexcept
+{
+    if (cpuSupports(InstructionSet::AVX512)){return InstructionSet::AVX512;}
+    if (cpuSupports(InstructionSet::AVX2)){return InstructionSet::AVX2;}
+    return InstructionSet::Scalar;
+}
+
+[[nodiscard]] std::atomic<InstructionSet> &instructionSetReference() noexcept
+{
+    static std::atomic<InstructionSet> instructionSet{detectInstructionSet()};
+    return instructionSet;
+}
+
+template<typename T> const Kernels<T> &getKernels() noexcept;
+
+template<>
+const Kernels<double> &getKernels() noexcept
+{
+#ifdef QPHASE_HAVE_X86_SIMD
+    auto instructionSet = instructionSetReference().load();
+    if (instructionSet == InstructionSet::AVX512)
+    {
+        return AVX512::doubleKernels;
+    }
+    if (instructionSet == InstructionSet::AVX2){return AVX2::doubleKernels;}
+#endif
+    return Scalar::doubleKernels;
+}
+
+template<>
+const Kernels<float> &getKernels() noexcept
+{
+#ifdef QPHASE_HAVE_X86_SIMD
+    auto instructionSet = instructionSetReference().load();
+    if (instructionSet == InstructionSet::AVX512)
+    {
+        return AVX512::floatKernels;
+    }
+    if (instructionSet == InstructionSet::AVX2){return AVX2::floatKernels;}
+#endif
+    return Scalar::floatKernels;
+}
+
+[[nodiscard]] const Conversions &getConversions() noexcept
+{
+#ifdef QPHASE_HAVE_X86_SIMD
+    auto instructionSet = instructionSetReference().load();
+    if (instructionSet == InstructionSet::AVX512)
+    {
+        return AVX512::conversions;
+    }
+    if (instructionSet == InstructionSet::AVX2){return AVX2::conversions;}
+#endif
+    return Scalar::conversions;
+}
+
+template<typename T>
+void checkSignal(const int n, const T *x)
+{
+    if (n < 1){throw std::invalid_argument("No samples");}
+    if (x == nullptr){throw std::invalid_argument("Signal is NULL");}
+}
+
+template<typename T>
+void checkInPlaceSignal(const int n, const T *x)
+{
+    if (n > 0 && x == nullptr)
+    {
+        throw std::invalid_argument("Signal is NULL");
+    }
+}
+
+template<typename T>
+QPhase::Waveforms::Segment<T> &checkSegment(
+    QPhase::Waveforms::Segment<T> *segment)
+{
+    if (segment == nullptr){throw std::invalid_argument("Segment is NULL");}
+    return *segment;
+}
+
+}
+
+/// Instruction set
+InstructionSet QPhase::Processing::getInstructionSet() noexcept
+{
+    return instructionSetReference().load();
+}
+
+bool QPhase::Processing::isSupported(
+    const InstructionSet instructionSet) noexcept
+{
+    return cpuSupports(instructionSet);
+}
+
+void QPhase::Processing::setInstructionSet(
+    const InstructionSet instructionSet)
+{
+    if (!isSupported(instructionSet))
+    {
+        throw std::invalid_argument("Instruction set not supported");
+    }
+    instructionSetReference().store(instructionSet);
+}
+
+/// Min/max
+template<typename T>
+std::pair<T, T> QPhase::Processing::minMax(const int n, const T *x)
+{
+    checkSignal(n, x);
+    return getKernels<T>().minMax(n, x);
+}
+
+/// Absolute maximum
+template<typename T>
+T QPhase::Processing::absoluteMaximum(const int n, const T *x)
+{
+    checkSignal(n, x);
+    return getKernels<T>().absoluteMaximum(n, x);
+}
+
+/// Mean
+template<typename T>
+double QPhase::Processing::mean(const int n, const T *x)
+{
+    checkSignal(n, x);
+    return getKernels<T>().sum(n, x)/n;
+}
+
+/// RMS
+template<typename T>
+double QPhase::Processing::rms(const int n, const T *x)
+{
+    checkSignal(n, x);
+    return std::sqrt(getKernels<T>().sumOfSquares(n, x)/n);
+}
+
+/// Demean
+template<typename T>
+void QPhase::Processing::demean(const int n, T *x)
+{
+    checkInPlaceSignal(n, x);
+    if (n < 1){return;}
+    const auto &kernels = getKernels<T>();
+    auto average = kernels.sum(n, x)/n;
+    kernels.addAffine(n, -average, 0, x);
+}
+
+/// Detrend.  With c = (n - 1)/2 the least-squares line is
+/// mean + b (i - c) where b = (sum i x_i - c sum x_i)/(n (n^2 - 1)/12).
+template<typename T>
+void QPhase::Processing::detrend(const int n, T *x)
+{
+    checkInPlaceSignal(n, x);
+    if (n < 1){return;}
+    const auto &kernels = getKernels<T>();
+    auto sum = kernels.sum(n, x);
+    auto average = sum/n;
+    double slope{0};
+    if (n > 1)
+    {
+        auto c = 0.5*(n - 1);
+        auto nd = static_cast<double> (n);
+        auto sxx = nd*(nd*nd - 1)/12;
+        slope = (kernels.indexWeightedSum(n, x) - c*sum)/sxx;
+        kernels.addAffine(n, -(average - slope*c), -slope, x);
+    }
+    else
+    {
+        kernels.addAffine(n, -average, 0, x);
+    }
+}
+
+/// Scale
+template<typename T>
+void QPhase::Processing::scale(const int n, const T alpha, T *x)
+{
+    checkInPlaceSignal(n, x);
+    if (n < 1){return;}
+    getKernels<T>().scale(n, alpha, x);
+}
+
+/// Taper.  The Hann weights w_k = (1 - cos(pi k/m))/2 are generated with
+/// the recurrence cos((k+1) theta) = 2 cos(theta) cos(k theta)
+///                                 - cos((k-1) theta).
+template<typename T>
+void QPhase::Processing::taper(const int n, const double fraction, T *x)
+{
+    if (fraction < 0 || fraction > 0.5)
+    {
+        throw std::invalid_argument("Fraction must be in range [0,0.5]");
+    }
+    checkInPlaceSignal(n, x);
+    auto m = static_cast<int> (fraction*n);
+    if (m < 1){return;}
+    auto theta = M_PI/m;
+    auto twoCosTheta = 2*std::cos(theta);
+    double cosPrevious = std::cos(-theta);
+    double cosCurrent = 1;
+    for (int k = 0; k < m; ++k)
+    {
+        auto weight = static_cast<T> (0.5*(1 - cosCurrent));
+        x[k] = weight*x[k];
+        x[n - 1 - k] = weight*x[n - 1 - k];
+        auto cosNext = twoCosTheta*cosCurrent - cosPrevious;
+        cosPrevious = cosCurrent;
+        cosCurrent = cosNext;
+    }
+}
+
+/// Conversions
+void QPhase::Processing::convert(const int n, const float *x, double *y)
+{
+    if (n < 1){return;}
+    if (x == nullptr){throw std::invalid_argument("x is NULL");}
+    if (y == nullptr){throw std::invalid_argument("y is NULL");}
+    getConversions().floatToDouble(n, x, y);
+}
+
+void QPhase::Processing::convert(const int n, const double *x, float *y)
+{
+    if (n < 1){return;}
+    if (x == nullptr){throw std::invalid_argument("x is NULL");}
+    if (y == nullptr){throw std::invalid_argument("y is NULL");}
+    getConversions().doubleToFloat(n, x, y);
+}
+
+/// Segments
+template<typename T>
+std::pair<T, T> QPhase::Processing::minMax(
+    const QPhase::Waveforms::Segment<T> &segment)
+{
+    return minMax(segment.getNumberOfSamples(), segment.getDataPointer());
+}
+
+template<typename T>
+T QPhase::Processing::absoluteMaximum(
+    const QPhase::Waveforms::Segment<T> &segment)
+{
+    return absoluteMaximum(segment.getNumberOfSamples(),
+                           segment.getDataPointer());
+}
+
+template<typename T>
+double QPhase::Processing::mean(const QPhase::Waveforms::Segment<T> &segment)
+{
+    return mean(segment.getNumberOfSamples(), segment.getDataPointer());
+}
+
+template<typename T>
+double QPhase::Processing::rms(const QPhase::Waveforms::Segment<T> &segment)
+{
+    return rms(segment.getNumberOfSamples(), segment.getDataPointer());
+}
+
+template<typename T>
+void QPhase::Processing::demean(QPhase::Waveforms::Segment<T> *segment)
+{
+    auto &s = checkSegment(segment);
+    demean(s.getNumberOfSamples(), s.getDataPointer());
+}
+
+template<typename T>
+void QPhase::Processing::detrend(QPhase::Waveforms::Segment<T> *segment)
+{
+    auto &s = checkSegment(segment);
+    detrend(s.getNumberOfSamples(), s.getDataPointer());
+}
+
+template<typename T>
+void QPhase::Processing::scale(const T alpha,
+                               QPhase::Waveforms::Segment<T> *segment)
+{
+    auto &s = checkSegment(segment);
+    scale(s.getNumberOfSamples(), alpha, s.getDataPointer());
+}
+
+template<typename T>
+void QPhase::Processing::taper(const double fraction,
+                               QPhase::Waveforms::Segment<T> *segment)
+{
+    auto &s = checkSegment(segment);
+    taper(s.getNumberOfSamples(), fraction, s.getDataPointer());
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template std::pair<double, double> QPhase::Processing::minMax(int, const double *);
+template std::pair<float, float> QPhase::Processing::minMax(int, const float *);
+template double QPhase::Processing::absoluteMaximum(int, const double *);
+template float QPhase::Processing::absoluteMaximum(int, const float *);
+template double QPhase::Processing::mean(int, const double *);
+template double QPhase::Processing::mean(int, const float *);
+template double QPhase::Processing::rms(int, const double *);
+template double QPhase::Processing::rms(int, const float *);
+template void QPhase::Processing::demean(int, double *);
+template void QPhase::Processing::demean(int, float *);
+template void QPhase::Processing::detrend(int, double *);
+template void QPhase::Processing::detrend(int, float *);
+template void QPhase::Processing::scale(int, double, double *);
+template void QPhase::Processing::scale(int, float, float *);
+template void QPhase::Processing::taper(int, double, double *);
+template void QPhase::Processing::taper(int, double, float *);
+
+template std::pair<double, double> QPhase::Processing::minMax(const QPhase::Waveforms::Segment<double> &);
+template std::pair<float, float> QPhase::Processing::minMax(const QPhase::Waveforms::Segment<float> &);
+template double QPhase::Processing::absoluteMaximum(const QPhase::Waveforms::Segment<double> &);
+template float QPhase::Processing::absoluteMaximum(const QPhase::Waveforms::Segment<float> &);
+template double QPhase::Processing::mean(const QPhase::Waveforms::Segment<double> &);
+template double QPhase::Processing::mean(const QPhase::Waveforms::Segment<float> &);
+template double QPhase::Processing::rms(const QPhase::Waveforms::Segment<double> &);
+template double QPhase::Processing::rms(const QPhase::Waveforms::Segment<float> &);
+template void QPhase::Processing::demean(QPhase::Waveforms::Segment<double> *);
+template void QPhase::Processing::demean(QPhase::Waveforms::Segment<float> *);
+template void QPhase::Processing::detrend(QPhase::Waveforms::Segment<double> *);
+template void QPhase::Processing::detrend(QPhase::Waveforms::Segment<float> *);
+template void QPhase::Processing::scale(double, QPhase::Waveforms::Segment<double> *);
+template void QPhase::Processing::scale(float, QPhase::Waveforms::Segment<float> *);
+template void QPhase::Processing::taper(double, QPhase::Waveforms::Segment<double> *);
+template void QPhase::Processing::taper(double, QPhase::Waveforms::Segment<float> *);
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "qphase/processing/pipeline.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/processing/sosFilter.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+enum class OperationType
+{
+    Demean,
+    Detrend,
+    Taper,
+    Scale,
+    Normalize,
+    Filter
+};
+
+/// @result A new pipeline identifier.  Identifiers are never reused so a
+///         memoized result can not be confused with that of another chain.
+uint64_t nextIdentifier() noexcept
+{
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/// @result A copy of the samples of the waveform in [t0, t1].
+template<typename T>
+QPhase::Waveforms::Waveform<T>
+    extract(const QPhase::Waveforms::Waveform<T> &waveform,
+            const std::chrono::microseconds &t0,
+            const std::chrono::microseconds &t1)
+{
+    std::vector<QPhase::Waveforms::Segment<T>> segments;
+    auto windows = waveform.samplesIn(t0, t1);
+    segments.reserve(windows.size());
+    for (const auto &window : windows)
+    {
+        const auto &segment = waveform[window.segment];
+        auto [numerator, denominator] = segment.getSamplingRateAsFraction();
+        QPhase::Waveforms::Segment<T> slice;
+        slice.setSamplingRate(numerator, denominator);
+        slice.setStartTime(segment.getSampleTime(window.startIndex));
+        slice.setData(window.endIndex - window.startIndex,
+                      segment.getDataPointer() + window.startIndex);
+        segments.push_back(std::move(slice));
+    }
+    QPhase::Waveforms::Waveform<T> result;
+    if (!segments.empty()){result.setSegments(std::move(segments));}
+    return result;
+}
+
+/// @result The segment reduced to the minimum and maximum, in time order, of
+///         consecutive runs of runLength samples.
+template<typename T>
+QPhase::Waveforms::Segment<T>
+    reduceToEnvelope(const QPhase::Waveforms::Segment<T> &segment,
+                     const int runLength)
+{
+    auto nSamples = segment.getNumberOfSamples();
+    const auto x = segment.getDataPointer();
+    auto nRuns = (nSamples + runLength - 1)/runLength;
+    std::vector<T> y(2*static_cast<size_t> (nRuns));
+    for (int run = 0; run < nRuns; ++run)
+    {
+        auto i0 = run*runLength;
+        auto i1 = std::min(nSamples, i0 + runLength);
+        auto [minIt, maxIt] = std::minmax_element(x + i0, x + i1);
+        y[2*run]     = (minIt < maxIt) ? *minIt : *maxIt;
+        y[2*run + 1] = (minIt < maxIt) ? *maxIt : *minIt;
+    }
+    // Two samples per run so the samples are half a run apart
+    auto [numerator, denominator] = segment.getSamplingRateAsFraction();
+    QPhase::Waveforms::Segment<T> result;
+    result.setSamplingRate(2*numerator, denominator*runLength);
+    result.setStartTime(segment.getStartTime());
+    result.setData(std::move(y));
+    return result;
+}
+
+}
+
+template<class T>
+class Pipeline<T>::PipelineImpl
+{
+public:
+    struct Operation
+    {
+        OperationType type;
+        double parameter{0};
+        std::shared_ptr<const SOSFilter<T>> filter{nullptr};
+        bool zeroPhase{false};
+    };
+    void add(Operation &&operation)
+    {
+        mOperations.push_back(std::move(operation));
+        mIdentifier = nextIdentifier();
+    }
+    void apply(const Operation &operation,
+               QPhase::Waveforms::Waveform<T> *waveform) const
+    {
+        if (operation.type == OperationType::Filter)
+        {
+            operation.filter->filter(waveform, operation.zeroPhase);
+            return;
+        }
+        if (operation.type == OperationType::Normalize)
+        {
+            T peak = 0;
+            for (const auto &segment : *waveform)
+            {
+                if (segment.getNumberOfSamples() < 1){continue;}
+                peak = std::max(peak, absoluteMaximum(segment));
+            }
+            if (peak == 0){return;}
+            for (auto &segment : *waveform)
+            {
+                scale(static_cast<T> (1./peak), &segment);
+            }
+            return;
+        }
+        for (auto &segment : *waveform)
+        {
+            if (segment.getNumberOfSamples() < 1){continue;}
+            if (operation.type == OperationType::Demean)
+            {
+                demean(&segment);
+            }
+            else if (operation.type == OperationType::Detrend)
+            {
+                detrend(&segment);
+            }
+            else if (operation.type == OperationType::Taper)
+            {
+                // The pipeline's fraction is the total; taper() is per end
+                taper(0.5*operation.parameter, &segment);
+            }
+            else if (operation.type == OperationType::Scale)
+            {
+                scale(static_cast<T> (operation.parameter), &segment);
+            }
+        }
+    }
+    std::vector<Operation> mOperations;
+    std::chrono::microseconds mPadding{0};
+    uint64_t mIdentifier{nextIdentifier()};
+};
+
+/// C'tor
+template<class T>
+Pipeline<T>::Pipeline() :
+    pImpl(std::make_unique<PipelineImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+Pipeline<T>::Pipeline(const Pipeline &pipeline)
+{
+    *this = pipeline;
+}
+
+/// Move c'tor
+template<class T>
+Pipeline<T>::Pipeline(Pipeline &&pipeline) noexcept
+{
+    *this = std::move(pipeline);
+}
+
+/// Copy assignment
+template<class T>
+Pipeline<T>& Pipeline<T>::operator=(const Pipeline &pipeline)
+{
+    if (&pipeline == this){return *this;}
+    pImpl = std::make_unique<PipelineImpl> (*pipeline.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+Pipeline<T>& Pipeline<T>::operator=(Pipeline &&pipeline) noexcept
+{
+    if (&pipeline == this){return *this;}
+    pImpl = std::move(pipeline.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void Pipeline<T>::clear() noexcept
+{
+    pImpl = std::make_unique<PipelineImpl> ();
+}
+
+/// Destructor
+template<class T>
+Pipeline<T>::~Pipeline() = default;
+
+/// Operations
+template<class T>
+void Pipeline<T>::addDemean()
+{
+    pImpl->add(typename PipelineImpl::Operation {OperationType::Demean});
+}
+
+template<class T>
+void Pipeline<T>::addDetrend()
+{
+    pImpl->add(typename PipelineImpl::Operation {OperationType::Detrend});
+}
+
+template<class T>
+void Pipeline<T>::addTaper(const double fraction)
+{
+    if (fraction < 0 || fraction > 1)
+    {
+        throw std::invalid_argument("fraction = " + std::to_string(fraction)
+                                  + " must be in range [0,1]");
+    }
+    pImpl->add(typename PipelineImpl::Operation {OperationType::Taper,
+                                                 fraction});
+}
+
+template<class T>
+void Pipeline<T>::addScale(const double factor)
+{
+    pImpl->add(typename PipelineImpl::Operation {OperationType::Scale,
+                                                 factor});
+}
+
+template<class T>
+void Pipeline<T>::addNormalize()
+{
+    pImpl->add(typename PipelineImpl::Operation {OperationType::Normalize});
+}
+
+template<class T>
+void Pipeline<T>::addFilter(const SOSFilter<T> &filter,
+                            const bool zeroPhase,
+                            const std::chrono::microseconds &warmUp)
+{
+    if (!filter.isInitialized())
+    {
+        throw std::invalid_argument("Filter not initialized");
+    }
+    if (warmUp.count() < 0)
+    {
+        throw std::invalid_argument("Warm-up must be non-negative");
+    }
+    typename PipelineImpl::Operation operation{OperationType::Filter};
+    operation.filter = std::make_shared<const SOSFilter<T>> (filter);
+    operation.zeroPhase = zeroPhase;
+    pImpl->add(std::move(operation));
+    // Padding accumulates since each filter's transient enters the next
+    pImpl->mPadding = pImpl->mPadding + warmUp;
+}
+
+template<class T>
+int Pipeline<T>::getNumberOfOperations() const noexcept
+{
+    return static_cast<int> (pImpl->mOperations.size());
+}
+
+template<class T>
+std::chrono::microseconds Pipeline<T>::getPadding() const noexcept
+{
+    return pImpl->mPadding;
+}
+
+template<class T>
+uint64_t Pipeline<T>::getIdentifier() const noexcept
+{
+    return pImpl->mIdentifier;
+}
+
+/// Evaluate
+template<class T>
+QPhase::Waveforms::Waveform<T> Pipeline<T>::evaluate(
+    const QPhase::Waveforms::Waveform<T> &waveform,
+    const std::chrono::microseconds &startTime,
+    const std::chrono::microseconds &endTime,
+    const double resolution) const
+{
+    if (startTime > endTime)
+    {
+        throw std::invalid_argument("Start time exceeds end time");
+    }
+    auto padding = pImpl->mPadding;
+    auto result = extract(waveform, startTime - padding, endTime + padding);
+    for (const auto &operation : pImpl->mOperations)
+    {
+        pImpl->apply(operation, &result);
+    }
+    if (padding.count() > 0)
+    {
+        result = extract(result, startTime, endTime);
+    }
+    if (resolution > 0 && result.getNumberOfSegments() > 0)
+    {
+        // The reduced segments end at different times so rebuild the
+        // waveform rather than edit its segments in place
+        auto segments = result.getSegments();
+        for (auto &segment : segments)
+        {
+            auto runLength
+                = static_cast<int> (std::ceil(2*segment.getSamplingRate()
+                                             /resolution));
+            // Runs shorter than 4 samples would not shrink the segment much
+            if (runLength < 4 || segment.getNumberOfSamples() < 1)
+            {
+                continue;
+            }
+            segment = reduceToEnvelope(segment, runLength);
+        }
+        result.setSegments(std::move(segments));
+    }
+    return result;
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::Pipeline<double>;
+template class QPhase::Processing::Pipeline<float>;
@@ -0,0 +1,357 @@
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "qphase/processing/resampler.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// The filter spans this many output or input periods, whichever is
+/// longer, on each side of its center.
+constexpr int HALF_LENGTH_FACTOR{10};
+/// The Kaiser window shape parameter.
+constexpr double KAISER_BETA{5};
+/// Bounds the filter length and the design cache.
+constexpr int MAXIMUM_FACTOR{1000};
+
+/// @result The zeroth order modified Bessel function of the first kind
+///         evaluated with its power series.
+double besselI0(const double x)
+{
+    double term = 1;
+    double sum = 1;
+    auto x2 = 0.25*x*x;
+    for (int k = 1; k < 500; ++k)
+    {
+        term = term*x2/(static_cast<double> (k)*k);
+        sum = sum + term;
+        if (term < 1.e-17*sum){break;}
+    }
+    return sum;
+}
+
+/// @result The Kaiser windowed sinc lowpass filter for the factors L and M.
+///         The cutoff is the lesser of the input and output Nyquist
+///         frequencies and the passband gain is L so that the zeros
+///         stuffed in by upsampling do not reduce the amplitude.
+std::vector<double> design(const int upFactor, const int downFactor)
+{
+    auto factor = std::max(upFactor, downFactor);
+    auto halfLength = HALF_LENGTH_FACTOR*factor;
+    auto nTaps = 2*halfLength + 1;
+    auto cutoff = 1./factor; // Fraction of the upsampled Nyquist frequency
+    auto i0Beta = besselI0(KAISER_BETA);
+    std::vector<double> taps(nTaps);
+    for (int i = 0; i < nTaps; ++i)
+    {
+        auto t = static_cast<double> (i - halfLength);
+        auto sinc = (t == 0) ? 1 : std::sin(M_PI*cutoff*t)/(M_PI*cutoff*t);
+        auto r = t/halfLength;
+        auto window = besselI0(KAISER_BETA*std::sqrt(std::max(0., 1 - r*r)))
+                     /i0Beta;
+        taps[i] = cutoff*sinc*window;
+    }
+    // Normalize to unit DC gain then apply the interpolation gain
+    auto sum = std::accumulate(taps.begin(), taps.end(), 0.0);
+    for (auto &tap : taps){tap = upFactor*tap/sum;}
+    return taps;
+}
+
+/// @result The cached filter for the factors.  Designs are shared by all
+///         resamplers and are never evicted; the number of distinct ratios
+///         in an application is small.
+std::shared_ptr<const std::vector<double>> getDesign(const int upFactor,
+                                                     const int downFactor)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>,
+                    std::shared_ptr<const std::vector<double>>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::pair {upFactor, downFactor};
+    auto it = cache.find(key);
+    if (it != cache.end()){return it->second;}
+    auto taps = std::make_shared<const std::vector<double>>
+                (design(upFactor, downFactor));
+    cache.insert(std::pair {key, taps});
+    return taps;
+}
+
+}
+
+template<class T>
+class Resampler<T>::ResamplerImpl
+{
+public:
+    /// Splits the taps into L phases.  Each phase is padded to the same
+    /// length and reversed so an output sample is a contiguous dot product
+    /// with the input.
+    void makePhases()
+    {
+        const auto &taps = *mTaps;
+        auto nTaps = static_cast<int> (taps.size());
+        mPhaseLength = (nTaps + mUpFactor - 1)/mUpFactor;
+        mPhases.assign(static_cast<size_t> (mUpFactor)*mPhaseLength, 0);
+        for (int phase = 0; phase < mUpFactor; ++phase)
+        {
+            auto g = mPhases.data() + phase*mPhaseLength;
+            for (int r = 0; r < mPhaseLength; ++r)
+            {
+                auto t = phase + (mPhaseLength - 1 - r)*mUpFactor;
+                if (t < nTaps){g[r] = static_cast<T> (taps[t]);}
+            }
+        }
+        mDelay = (nTaps - 1)/2;
+    }
+    std::shared_ptr<const std::vector<double>> mTaps;
+    std::vector<T> mPhases;
+    int mUpFactor{0};
+    int mDownFactor{0};
+    int mPhaseLength{0};
+    int mDelay{0};
+};
+
+/// C'tor
+template<class T>
+Resampler<T>::Resampler() :
+    pImpl(std::make_unique<ResamplerImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+Resampler<T>::Resampler(const Resampler &resampler)
+{
+    *this = resampler;
+}
+
+/// Move c'tor
+template<class T>
+Resampler<T>::Resampler(Resampler &&resampler) noexcept
+{
+    *this = std::move(resampler);
+}
+
+/// Copy assignment
+template<class T>
+Resampler<T>& Resampler<T>::operator=(const Resampler &resampler)
+{
+    if (&resampler == this){return *this;}
+    pImpl = std::make_unique<ResamplerImpl> (*resampler.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+Resampler<T>& Resampler<T>::operator=(Resampler &&resampler) noexcept
+{
+    if (&resampler == this){return *this;}
+    pImpl = std::move(resampler.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void Resampler<T>::clear() noexcept
+{
+    pImpl = std::make_unique<ResamplerImpl> ();
+}
+
+/// Destructor
+template<class T>
+Resampler<T>::~Resampler() = default;
+
+/// Initialize
+template<class T>
+void Resampler<T>::initialize(const int upFactor, const int downFactor)
+{
+    if (upFactor < 1){throw std::invalid_argument("upFactor must be positive");}
+    if (downFactor < 1)
+    {
+        throw std::invalid_argument("downFactor must be positive");
+    }
+    auto divisor = std::gcd(upFactor, downFactor);
+    auto up = upFactor/divisor;
+    auto down = downFactor/divisor;
+    if (up > MAXIMUM_FACTOR || down > MAXIMUM_FACTOR)
+    {
+        throw std::invalid_argument("Reduced factors " + std::to_string(up)
+                                  + "/" + std::to_string(down)
+                                  + " exceed "
+                                  + std::to_string(MAXIMUM_FACTOR));
+    }
+    clear();
+    pImpl->mUpFactor = up;
+    pImpl->mDownFactor = down;
+    pImpl->mTaps = getDesign(up, down);
+    pImpl->makePhases();
+}
+
+template<class T>
+void Resampler<T>::initializeFromSamplingRates(const double inputSamplingRate,
+                                               const double outputSamplingRate)
+{
+    if (inputSamplingRate <= 0)
+    {
+        throw std::invalid_argument("Input sampling rate must be positive");
+    }
+    if (outputSamplingRate <= 0)
+    {
+        throw std::invalid_argument("Output sampling rate must be positive");
+    }
+    // Rates are specified to at most micro-Hz
+    auto input = std::llround(inputSamplingRate*1.e6);
+    auto output = std::llround(outputSamplingRate*1.e6);
+    if (input < 1 || output < 1)
+    {
+        throw std::invalid_argument("Sampling rates must be at least 1 uHz");
+    }
+    auto divisor = std::gcd(input, output);
+    auto up = output/divisor;
+    auto down = input/divisor;
+    if (up > MAXIMUM_FACTOR || down > MAXIMUM_FACTOR)
+    {
+        throw std::invalid_argument("Ratio of sampling rates is too complex");
+    }
+    initialize(static_cast<int> (up), static_cast<int> (down));
+}
+
+/// Initialized?
+template<class T>
+bool Resampler<T>::isInitialized() const noexcept
+{
+    return pImpl->mTaps != nullptr;
+}
+
+/// Factors
+template<class T>
+int Resampler<T>::getUpFactor() const
+{
+    if (!isInitialized()){throw std::runtime_error("Resampler not initialized");}
+    return pImpl->mUpFactor;
+}
+
+template<class T>
+int Resampler<T>::getDownFactor() const
+{
+    if (!isInitialized()){throw std::runtime_error("Resampler not initialized");}
+    return pImpl->mDownFactor;
+}
+
+template<class T>
+int Resampler<T>::getMaximumFactor() noexcept
+{
+    return MAXIMUM_FACTOR;
+}
+
+/// Filter
+template<class T>
+std::vector<double> Resampler<T>::getFilterCoefficients() const
+{
+    if (!isInitialized()){throw std::runtime_error("Resampler not initialized");}
+    return *pImpl->mTaps;
+}
+
+/// Output length
+template<class T>
+int Resampler<T>::getOutputLength(const int n) const
+{
+    if (!isInitialized()){throw std::runtime_error("Resampler not initialized");}
+    if (n < 1){return 0;}
+    auto up = static_cast<int64_t> (pImpl->mUpFactor);
+    auto down = static_cast<int64_t> (pImpl->mDownFactor);
+    return static_cast<int> ((static_cast<int64_t> (n - 1)*up)/down + 1);
+}
+
+/// Resample.  Output k is sample j = kM + D of the filtered, upsampled
+/// signal.  Only the taps h[t] with t = j (mod L) meet nonzero samples so
+///   y[k] = sum_r g_phi[r] x[j/L - (P - 1) + r]
+/// where phi = j mod L and g_phi is the reversed phase.
+template<class T>
+void Resampler<T>::apply(const int n, const T *x, const int nY, T *y) const
+{
+    auto nOut = getOutputLength(n);
+    if (nOut == 0){return;}
+    if (x == nullptr){throw std::invalid_argument("x is NULL");}
+    if (y == nullptr){throw std::invalid_argument("y is NULL");}
+    if (nY < nOut)
+    {
+        throw std::invalid_argument("nY must be at least "
+                                  + std::to_string(nOut));
+    }
+    const auto up = static_cast<int64_t> (pImpl->mUpFactor);
+    const auto down = static_cast<int64_t> (pImpl->mDownFactor);
+    const auto phaseLength = pImpl->mPhaseLength;
+    const auto delay = static_cast<int64_t> (pImpl->mDelay);
+    const T *__restrict__ phases = pImpl->mPhases.data();
+    for (int k = 0; k < nOut; ++k)
+    {
+        auto j = k*down + delay;
+        auto phase = static_cast<int> (j%up);
+        auto i0 = static_cast<int> (j/up) - (phaseLength - 1);
+        const T *__restrict__ g = phases + phase*phaseLength;
+        // Clip the dot product to the signal
+        auto r0 = std::max(0, -i0);
+        auto r1 = std::min(phaseLength, n - i0);
+        T y0 = 0;
+        T y1 = 0;
+        int r = r0;
+        for (; r + 1 < r1; r = r + 2)
+        {
+            y0 = y0 + g[r]*x[i0 + r];
+            y1 = y1 + g[r + 1]*x[i0 + r + 1];
+        }
+        if (r < r1){y0 = y0 + g[r]*x[i0 + r];}
+        y[k] = y0 + y1;
+    }
+}
+
+template<class T>
+QPhase::Waveforms::Segment<T> Resampler<T>::apply(
+    const QPhase::Waveforms::Segment<T> &segment) const
+{
+    if (!isInitialized()){throw std::runtime_error("Resampler not initialized");}
+    if (!segment.haveSamplingRate())
+    {
+        throw std::invalid_argument("Segment sampling rate not set");
+    }
+    auto [numerator, denominator] = segment.getSamplingRateAsFraction();
+    auto nSamples = segment.getNumberOfSamples();
+    std::vector<T> y(getOutputLength(nSamples));
+    apply(nSamples, segment.getDataPointer(),
+          static_cast<int> (y.size()), y.data());
+    QPhase::Waveforms::Segment<T> result;
+    result.setSamplingRate(numerator*pImpl->mUpFactor,
+                           denominator*pImpl->mDownFactor);
+    result.setStartTime(segment.getStartTime());
+    result.setData(std::move(y));
+    return result;
+}
+
+template<class T>
+QPhase::Waveforms::Waveform<T> Resampler<T>::apply(
+    const QPhase::Waveforms::Waveform<T> &waveform) const
+{
+    std::vector<QPhase::Waveforms::Segment<T>> segments;
+    segments.reserve(waveform.getNumberOfSegments());
+    for (const auto &segment : waveform)
+    {
+        segments.push_back(apply(segment));
+    }
+    QPhase::Waveforms::Waveform<T> result;
+    if (!segments.empty()){result.setSegments(std::move(segments));}
+    return result;
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::Resampler<double>;
+template class QPhase::Processing::Resampler<float>;
@@ -0,0 +1,573 @@
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "qphase/processing/rotator.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/gather.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// Horizontals whose dips differ from 0 by more than this in degrees are
+/// not horizontal.
+constexpr double DIP_TOLERANCE{1};
+/// Horizontals whose azimuths are closer to parallel than this in degrees
+/// cannot be rotated.
+constexpr double MINIMUM_SEPARATION{10};
+
+///--------------------------------------------------------------------------///
+///                                 Kernels                                  ///
+///--------------------------------------------------------------------------///
+
+/// A vector register of W elements of T.  This is a member typedef since
+/// attributes on alias templates are dropped.
+template<typename T, int W>
+struct Vector
+{
+    typedef T type __attribute__((vector_size(W*sizeof(T))));
+};
+
+/// @brief Applies the 2 x 2 matrix [m00 m01; m10 m11] to the samples of two
+///        rows in place.  Both samples are loaded before either is stored
+///        so one pass over the rows suffices.
+template<typename T, int W>
+[[gnu::always_inline]] inline
+void rotateLanes(const int n,
+                 const T m00, const T m01, const T m10, const T m11,
+                 T *__restrict__ x1, T *__restrict__ x2)
+{
+    using V = typename Vector<T, W>::type;
+    int i = 0;
+    for (; i + W <= n; i = i + W)
+    {
+        V a;
+        V b;
+        std::memcpy(&a, x1 + i, sizeof(V));
+        std::memcpy(&b, x2 + i, sizeof(V));
+        V y1 = m00*a + m01*b;
+        V y2 = m10*a + m11*b;
+        std::memcpy(x1 + i, &y1, sizeof(V));
+        std::memcpy(x2 + i, &y2, sizeof(V));
+    }
+    for (; i < n; ++i)
+    {
+        auto a = x1[i];
+        auto b = x2[i];
+        x1[i] = m00*a + m01*b;
+        x2[i] = m10*a + m11*b;
+    }
+}
+
+template<typename T>
+using RotateKernel = void (*)(int, T, T, T, T, T *, T *);
+
+void rotateBaseline(const int n, const double m00, const double m01,
+                    const double m10, const double m11,
+                    double *x1, double *x2)
+{
+    rotateLanes<double, 2>(n, m00, m01, m10, m11, x1, x2);
+}
+
+void rotateBaseline(const int n, const float m00, const float m01,
+                    const float m10, const float m11,
+                    float *x1, float *x2)
+{
+    rotateLanes<float, 4>(n, m00, m01, m10, m11, x1, x2);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QPHASE_HAVE_X86_SIMD 1
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+void rotateAVX2(const int n, const double m00, const double m01,
+                const double m10, const double m11,
+                double *x1, double *x2)
+{
+    rotateLanes<double, 4>(n, m00, m01, m10, m11, x1, x2);
+}
+
+void rotateAVX2(const int n, const float m00, const float m01,
+                const float m10, const float m11,
+                float *x1, float *x2)
+{
+    rotateLanes<float, 8>(n, m00, m01, m10, m11, x1, x2);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+void rotateAVX512(const int n, const double m00, const double m01,
+                  const double m10, const double m11,
+                  double *x1, double *x2)
+{
+    rotateLanes<double, 8>(n, m00, m01, m10, m11, x1, x2);
+}
+
+void rotateAVX512(const int n, const float m00, const float m01,
+                  const float m10, const float m11,
+                  float *x1, float *x2)
+{
+    rotateLanes<float, 16>(n, m00, m01, m10, m11, x1, x2);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+
+/// @result The rotation kernel for the current instruction set.
+template<typename T>
+RotateKernel<T> getKernel() noexcept
+{
+#ifdef QPHASE_HAVE_X86_SIMD
+    auto instructionSet = getInstructionSet();
+    if (instructionSet == InstructionSet::AVX512)
+    {
+        return static_cast<RotateKernel<T>> (&rotateAVX512);
+    }
+    if (instructionSet == InstructionSet::AVX2)
+    {
+        return static_cast<RotateKernel<T>> (&rotateAVX2);
+    }
+#endif
+    return static_cast<RotateKernel<T>> (&rotateBaseline);
+}
+
+///--------------------------------------------------------------------------///
+///                                 Geometry                                 ///
+///--------------------------------------------------------------------------///
+
+/// @result The angle in degrees in the range [0, 360).
+double normalizeAngle(const double angle)
+{
+    auto result = std::fmod(angle, 360.0);
+    if (result < 0){result = result + 360;}
+    return result;
+}
+
+/// @result The azimuth of a horizontal in degrees.  If it is unknown then
+///         it is inferred from a channel code ending in N or E.  Otherwise
+///         this is NaN.
+template<class T>
+double getAzimuth(const typename QPhase::Waveforms::Gather<T>::ChannelMetadata &metadata)
+{
+    if (std::isfinite(metadata.azimuth)){return metadata.azimuth;}
+    if (!metadata.channel.empty())
+    {
+        if (metadata.channel.back() == 'N'){return 0;}
+        if (metadata.channel.back() == 'E'){return 90;}
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+/// @result The azimuths of a sensor's horizontals in rows row + 1 and
+///         row + 2 of the gather.
+/// @throws std::invalid_argument if a horizontal is not horizontal, an
+///         azimuth is unknown, or the horizontals are nearly parallel.
+template<class T>
+std::pair<double, double> getHorizontalAzimuths(
+    const std::vector<typename QPhase::Waveforms::Gather<T>::ChannelMetadata> &metadata,
+    const int row)
+{
+    auto name = metadata[row].network + "." + metadata[row].station
+              + "." + metadata[row].locationCode;
+    for (int k = 1; k <= 2; ++k)
+    {
+        auto dip = metadata[row + k].dip;
+        if (std::isfinite(dip) && std::abs(dip) > DIP_TOLERANCE)
+        {
+            throw std::invalid_argument(name + "." + metadata[row + k].channel
+                                      + " is not horizontal");
+        }
+    }
+    auto a1 = getAzimuth<T> (metadata[row + 1]);
+    auto a2 = getAzimuth<T> (metadata[row + 2]);
+    if (!std::isfinite(a1) || !std::isfinite(a2))
+    {
+        throw std::invalid_argument("Horizontal azimuths of " + name
+                                  + " are unknown");
+    }
+    auto separation = std::abs(std::sin((a2 - a1)*std::numbers::pi/180));
+    if (separation < std::sin(MINIMUM_SEPARATION*std::numbers::pi/180))
+    {
+        throw std::invalid_argument("Horizontals of " + name
+                                  + " are nearly parallel");
+    }
+    return std::pair {a1, a2};
+}
+
+/// @result The back-azimuth in degrees from a station to an event on a
+///         sphere.
+double computeBackAzimuth(const double stationLatitude,
+                          const double stationLongitude,
+                          const double eventLatitude,
+                          const double eventLongitude)
+{
+    constexpr double toRadians{std::numbers::pi/180};
+    auto phi1 = stationLatitude*toRadians;
+    auto phi2 = eventLatitude*toRadians;
+    auto dLambda = (eventLongitude - stationLongitude)*toRadians;
+    auto y = std::sin(dLambda)*std::cos(phi2);
+    auto x = std::cos(phi1)*std::sin(phi2)
+           - std::sin(phi1)*std::cos(phi2)*std::cos(dLambda);
+    return normalizeAngle(std::atan2(y, x)/toRadians);
+}
+
+/// @brief The matrix that takes horizontals at azimuths (a1, a2) to
+///        horizontals at azimuths (b1, b2).  A horizontal at azimuth a
+///        records cos(a) N + sin(a) E so this is B A^{-1} where the rows
+///        of A and B are (cos, sin) of the azimuths.
+struct Rotation
+{
+    Rotation(const double a1, const double a2,
+             const double b1, const double b2)
+    {
+        constexpr double toRadians{std::numbers::pi/180};
+        auto determinant = std::sin((a2 - a1)*toRadians);
+        m00 = std::sin((a2 - b1)*toRadians)/determinant;
+        m01 = std::sin((b1 - a1)*toRadians)/determinant;
+        m10 = std::sin((a2 - b2)*toRadians)/determinant;
+        m11 = std::sin((b2 - a1)*toRadians)/determinant;
+    }
+    double m00{1};
+    double m01{0};
+    double m10{0};
+    double m11{1};
+};
+
+}
+
+template<class T>
+class Rotator<T>::RotatorImpl
+{
+public:
+    std::vector<int> mVerticalRows;
+    std::vector<std::pair<double, double>> mLocations;
+    std::vector<double> mBackAzimuths;
+    int mChannels{0};
+    int mThreads{1};
+    bool mInitialized{false};
+    bool mHaveBackAzimuths{false};
+};
+
+/// C'tor
+template<class T>
+Rotator<T>::Rotator() :
+    pImpl(std::make_unique<RotatorImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+Rotator<T>::Rotator(const Rotator &rotator)
+{
+    *this = rotator;
+}
+
+/// Move c'tor
+template<class T>
+Rotator<T>::Rotator(Rotator &&rotator) noexcept
+{
+    *this = std::move(rotator);
+}
+
+/// Copy assignment
+template<class T>
+Rotator<T>& Rotator<T>::operator=(const Rotator &rotator)
+{
+    if (&rotator == this){return *this;}
+    pImpl = std::make_unique<RotatorImpl> (*rotator.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+Rotator<T>& Rotator<T>::operator=(Rotator &&rotator) noexcept
+{
+    if (&rotator == this){return *this;}
+    pImpl = std::move(rotator.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void Rotator<T>::clear() noexcept
+{
+    pImpl = std::make_unique<RotatorImpl> ();
+}
+
+/// D'tor
+template<class T>
+Rotator<T>::~Rotator() = default;
+
+/// Initialize
+template<class T>
+void Rotator<T>::initialize(const QPhase::Waveforms::Gather<T> &gather)
+{
+    using Component = typename QPhase::Waveforms::Gather<T>::Component;
+    const auto &metadata = gather.getMetadataReference();
+    std::vector<int> verticalRows;
+    std::vector<std::pair<double, double>> locations;
+    auto nChannels = static_cast<int> (metadata.size());
+    for (int row = 0; row + 2 < nChannels; ++row)
+    {
+        if (metadata[row].component != Component::Vertical ||
+            metadata[row + 1].component != Component::Horizontal1 ||
+            metadata[row + 2].component != Component::Horizontal2)
+        {
+            continue;
+        }
+        static_cast<void> (getHorizontalAzimuths<T> (metadata, row));
+        verticalRows.push_back(row);
+        locations.push_back(std::pair {metadata[row].latitude,
+                                       metadata[row].longitude});
+        row = row + 2;
+    }
+    auto nThreads = getNumberOfThreads();
+    clear();
+    pImpl->mThreads = nThreads;
+    pImpl->mVerticalRows = std::move(verticalRows);
+    pImpl->mLocations = std::move(locations);
+    pImpl->mChannels = nChannels;
+    pImpl->mInitialized = true;
+}
+
+template<class T>
+bool Rotator<T>::isInitialized() const noexcept
+{
+    return pImpl->mInitialized;
+}
+
+template<class T>
+int Rotator<T>::getNumberOfSensors() const
+{
+    if (!isInitialized()){throw std::runtime_error("Rotator not initialized");}
+    return static_cast<int> (pImpl->mVerticalRows.size());
+}
+
+template<class T>
+std::vector<int> Rotator<T>::getVerticalRows() const
+{
+    if (!isInitialized()){throw std::runtime_error("Rotator not initialized");}
+    return pImpl->mVerticalRows;
+}
+
+/// Back-azimuths
+template<class T>
+void Rotator<T>::setBackAzimuths(const std::vector<double> &backAzimuths)
+{
+    auto nSensors = getNumberOfSensors();
+    if (static_cast<int> (backAzimuths.size()) != nSensors)
+    {
+        throw std::invalid_argument("Number of back-azimuths must be "
+                                  + std::to_string(nSensors));
+    }
+    for (const auto &backAzimuth : backAzimuths)
+    {
+        if (!std::isfinite(backAzimuth))
+        {
+            throw std::invalid_argument("Back-azimuths must be finite");
+        }
+    }
+    pImpl->mBackAzimuths.resize(nSensors);
+    std::transform(backAzimuths.begin(), backAzimuths.end(),
+                   pImpl->mBackAzimuths.begin(), normalizeAngle);
+    pImpl->mHaveBackAzimuths = true;
+}
+
+template<class T>
+void Rotator<T>::setEventLocation(const double latitude,
+                                  const double longitude)
+{
+    if (!isInitialized()){throw std::runtime_error("Rotator not initialized");}
+    if (latitude < -90 || latitude > 90)
+    {
+        throw std::invalid_argument("Latitude must be in range [-90,90]");
+    }
+    std::vector<double> backAzimuths;
+    backAzimuths.reserve(pImpl->mLocations.size());
+    for (int i = 0; i < static_cast<int> (pImpl->mLocations.size()); ++i)
+    {
+        auto [stationLatitude, stationLongitude] = pImpl->mLocations[i];
+        if (!std::isfinite(stationLatitude) ||
+            !std::isfinite(stationLongitude))
+        {
+            throw std::invalid_argument("Location of sensor "
+                                      + std::to_string(i) + " is unknown");
+        }
+        backAzimuths.push_back(computeBackAzimuth(stationLatitude,
+                                                  stationLongitude,
+                                                  latitude, longitude));
+    }
+    setBackAzimuths(backAzimuths);
+}
+
+template<class T>
+std::vector<double> Rotator<T>::getBackAzimuths() const
+{
+    if (!haveBackAzimuths())
+    {
+        throw std::runtime_error("Back-azimuths not set");
+    }
+    return pImpl->mBackAzimuths;
+}
+
+template<class T>
+bool Rotator<T>::haveBackAzimuths() const noexcept
+{
+    return pImpl->mHaveBackAzimuths;
+}
+
+/// Threads
+template<class T>
+void Rotator<T>::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pImpl->mThreads = nThreads;
+}
+
+template<class T>
+int Rotator<T>::getNumberOfThreads() const noexcept
+{
+    return pImpl->mThreads;
+}
+
+/// Rotate
+template<class T>
+void Rotator<T>::rotate(const Orientation orientation,
+                        QPhase::Waveforms::Gather<T> *gather) const
+{
+    using Component = typename QPhase::Waveforms::Gather<T>::Component;
+    if (!isInitialized()){throw std::runtime_error("Rotator not initialized");}
+    if (gather == nullptr){throw std::invalid_argument("Gather is NULL");}
+    if (orientation == Orientation::RadialTransverse && !haveBackAzimuths())
+    {
+        throw std::runtime_error("Back-azimuths not set");
+    }
+    const auto &metadata = gather->getMetadataReference();
+    if (static_cast<int> (metadata.size()) != pImpl->mChannels)
+    {
+        throw std::invalid_argument("Gather does not match initialization");
+    }
+    // Find each sensor's rotation from its current orientation
+    auto nSensors = static_cast<int> (pImpl->mVerticalRows.size());
+    std::vector<Rotation> rotations;
+    std::vector<std::pair<double, double>> targets;
+    rotations.reserve(nSensors);
+    targets.reserve(nSensors);
+    for (int i = 0; i < nSensors; ++i)
+    {
+        auto row = pImpl->mVerticalRows[i];
+        if (metadata[row].component != Component::Vertical ||
+            metadata[row + 1].component != Component::Horizontal1 ||
+            metadata[row + 2].component != Component::Horizontal2)
+        {
+            throw std::invalid_argument(
+                "Gather does not match initialization");
+        }
+        auto [a1, a2] = getHorizontalAzimuths<T> (metadata, row);
+        double b1 = 0;
+        double b2 = 90;
+        if (orientation == Orientation::RadialTransverse)
+        {
+            b1 = normalizeAngle(pImpl->mBackAzimuths[i] + 180);
+            b2 = normalizeAngle(pImpl->mBackAzimuths[i] + 270);
+        }
+        rotations.emplace_back(a1, a2, b1, b2);
+        targets.push_back(std::pair {b1, b2});
+    }
+    // Rotate the samples and merge the gap masks.  The sensors are divided
+    // among the threads.
+    const auto kernel = getKernel<T> ();
+    const int nSamples = gather->getNumberOfSamples();
+    auto work = [&](const int sensor0, const int sensor1)
+    {
+        for (int i = sensor0; i < sensor1; ++i)
+        {
+            auto row = pImpl->mVerticalRows[i];
+            const auto &rotation = rotations[i];
+            kernel(nSamples,
+                   static_cast<T> (rotation.m00),
+                   static_cast<T> (rotation.m01),
+                   static_cast<T> (rotation.m10),
+                   static_cast<T> (rotation.m11),
+                   gather->getRowPointer(row + 1),
+                   gather->getRowPointer(row + 2));
+            // A rotated sample needs both inputs and gaps are zero
+            auto x1 = gather->getRowPointer(row + 1);
+            auto x2 = gather->getRowPointer(row + 2);
+            auto mask1 = gather->getMaskRowPointer(row + 1);
+            auto mask2 = gather->getMaskRowPointer(row + 2);
+            for (int j = 0; j < nSamples; ++j)
+            {
+                auto valid = static_cast<uint8_t> (mask1[j] & mask2[j]);
+                mask1[j] = valid;
+                mask2[j] = valid;
+                if (valid == 0)
+                {
+                    x1[j] = 0;
+                    x2[j] = 0;
+                }
+            }
+        }
+    };
+    const int nThreads = std::max(1, std::min(pImpl->mThreads, nSensors));
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int thread = 1; thread < nThreads; ++thread)
+    {
+        threads.emplace_back(work,
+                             static_cast<int> (static_cast<int64_t> (nSensors)*thread/nThreads),
+                             static_cast<int> (static_cast<int64_t> (nSensors)*(thread + 1)/nThreads));
+    }
+    work(0, nSensors/nThreads);
+    for (auto &thread : threads){thread.join();}
+    // Describe the new orientation
+    const char code1 = orientation == Orientation::NorthEast ? 'N' : 'R';
+    const char code2 = orientation == Orientation::NorthEast ? 'E' : 'T';
+    for (int i = 0; i < nSensors; ++i)
+    {
+        auto row = pImpl->mVerticalRows[i];
+        for (int k = 1; k <= 2; ++k)
+        {
+            auto rowMetadata = metadata[row + k];
+            rowMetadata.azimuth = (k == 1) ? targets[i].first :
+                                             targets[i].second;
+            rowMetadata.dip = 0;
+            if (!rowMetadata.channel.empty())
+            {
+                rowMetadata.channel.back() = (k == 1) ? code1 : code2;
+            }
+            auto mask = gather->getMaskRowPointer(row + k);
+            rowMetadata.numberOfValidSamples
+                = static_cast<int> (std::count(mask, mask + nSamples, 1));
+            gather->setMetadata(row + k, rowMetadata);
+        }
+    }
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::Rotator<double>;
+template class QPhase::Processing::Rotator<float>;
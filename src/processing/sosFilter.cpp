@@ -0,0 +1,787 @@
+#include <cmath>
+#include <chrono>
+#include <complex>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "qphase/processing/sosFilter.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// Samples are filtered in blocks of this many samples per channel.  An
+/// interleaved block of 16 channels fits in the L1 cache.
+constexpr int BLOCK_SIZE{256};
+
+using Complex = std::complex<double>;
+
+///--------------------------------------------------------------------------///
+///                                  Design                                  ///
+///--------------------------------------------------------------------------///
+
+/// @brief Tracks the normalized section coefficients.
+struct Sections
+{
+    std::vector<double> b;
+    std::vector<double> a;
+    int n{0};
+};
+
+/// @result The left half-plane poles of the analog Butterworth prototype
+///         with unit cutoff.
+std::vector<Complex> butterworthPrototype(const int order)
+{
+    std::vector<Complex> poles;
+    poles.reserve(order);
+    for (int k = 0; k < order; ++k)
+    {
+        auto theta = M_PI*(2*k + 1 + order)/(2.*order);
+        poles.push_back(std::polar(1.0, theta));
+    }
+    return poles;
+}
+
+/// @result The analog frequency in rad/s that the bilinear transform maps
+///         to the digital frequency f.
+double prewarp(const double f, const double samplingRate)
+{
+    return 2*samplingRate*std::tan(M_PI*f/samplingRate);
+}
+
+/// @result The bilinear transform of the analog pole s.
+Complex bilinear(const Complex s, const double samplingRate)
+{
+    auto fs2 = 2*samplingRate;
+    return (fs2 + s)/(fs2 - s);
+}
+
+/// @result The magnitude of a section's response at the digital frequency
+///         omega in radians/sample.
+double sectionMagnitude(const double *b, const double *a, const double omega)
+{
+    auto z1 = std::polar(1.0, -omega);
+    auto z2 = z1*z1;
+    auto numerator = b[0] + b[1]*z1 + b[2]*z2;
+    auto denominator = a[0] + a[1]*z1 + a[2]*z2;
+    return std::abs(numerator/denominator);
+}
+
+/// @brief Pairs the digital poles into sections.  Complex poles are paired
+///        with their conjugates and real poles are paired with each other.
+///        Each second order section receives the zeros zero1 and zero2
+///        while a trailing first order section receives zero1.  Finally,
+///        each section has unit gain at the reference frequency.
+Sections makeSections(const std::vector<Complex> &poles,
+                      const double zero1, const double zero2,
+                      const double referenceFrequency)
+{
+    std::vector<Complex> complexPoles;
+    std::vector<double> realPoles;
+    for (const auto &p : poles)
+    {
+        if (std::abs(p.imag()) > 1.e-12*std::max(1.0, std::abs(p)))
+        {
+            if (p.imag() > 0){complexPoles.push_back(p);}
+        }
+        else
+        {
+            realPoles.push_back(p.real());
+        }
+    }
+    std::sort(realPoles.begin(), realPoles.end());
+    Sections sections;
+    auto addSection = [&](const double b1, const double b2,
+                          const double a1, const double a2)
+    {
+        sections.b.insert(sections.b.end(), {1, b1, b2});
+        sections.a.insert(sections.a.end(), {1, a1, a2});
+        sections.n = sections.n + 1;
+    };
+    for (const auto &p : complexPoles)
+    {
+        addSection(-(zero1 + zero2), zero1*zero2, -2*p.real(), std::norm(p));
+    }
+    int i = 0;
+    for (; i + 1 < static_cast<int> (realPoles.size()); i = i + 2)
+    {
+        addSection(-(zero1 + zero2), zero1*zero2,
+                   -(realPoles[i] + realPoles[i + 1]),
+                   realPoles[i]*realPoles[i + 1]);
+    }
+    if (i < static_cast<int> (realPoles.size()))
+    {
+        addSection(-zero1, 0, -realPoles[i], 0);
+    }
+    for (int k = 0; k < sections.n; ++k)
+    {
+        auto magnitude = sectionMagnitude(sections.b.data() + 3*k,
+                                          sections.a.data() + 3*k,
+                                          referenceFrequency);
+        for (int j = 0; j < 3; ++j)
+        {
+            sections.b[3*k + j] = sections.b[3*k + j]/magnitude;
+        }
+    }
+    return sections;
+}
+
+void checkDesign(const int order, const double corner,
+                 const double samplingRate)
+{
+    if (order < 1){throw std::invalid_argument("Order must be positive");}
+    if (samplingRate <= 0)
+    {
+        throw std::invalid_argument("Sampling rate must be positive");
+    }
+    if (corner <= 0 || corner >= samplingRate/2)
+    {
+        throw std::invalid_argument("Corner = " + std::to_string(corner)
+                                  + " must be in range (0,"
+                                  + std::to_string(samplingRate/2) + ")");
+    }
+}
+
+///--------------------------------------------------------------------------///
+///                                 Filtering                                ///
+///--------------------------------------------------------------------------///
+
+/// @brief Applies the sections to an interleaved block of W channels.  The
+///        sections are the outer loop so each recursion runs over the whole
+///        block while the lane loop maps onto the vector registers.
+/// @param[in,out] x      The interleaved signals.  This is an array whose
+///                       dimension is [nSamples x W].
+/// @param[in,out] state  The per-lane filter state.  This is an array whose
+///                       dimension is [nSections x 2 x W].
+template<int W>
+[[gnu::always_inline]] inline
+void filterLanes(const int nSections,
+                 const double *__restrict__ b, const double *__restrict__ a,
+                 const int nSamples,
+                 double *__restrict__ x, double *__restrict__ state)
+{
+    for (int k = 0; k < nSections; ++k)
+    {
+        const auto b0 = b[3*k];
+        const auto b1 = b[3*k + 1];
+        const auto b2 = b[3*k + 2];
+        const auto a1 = a[3*k + 1];
+        const auto a2 = a[3*k + 2];
+        double z1[W];
+        double z2[W];
+        for (int l = 0; l < W; ++l)
+        {
+            z1[l] = state[2*k*W + l];
+            z2[l] = state[(2*k + 1)*W + l];
+        }
+        for (int i = 0; i < nSamples; ++i)
+        {
+            double *__restrict__ xi = x + i*W;
+            for (int l = 0; l < W; ++l)
+            {
+                auto xl = xi[l];
+                auto y = b0*xl + z1[l];
+                z1[l] = b1*xl - a1*y + z2[l];
+                z2[l] = b2*xl - a2*y;
+                xi[l] = y;
+            }
+        }
+        for (int l = 0; l < W; ++l)
+        {
+            state[2*k*W + l] = z1[l];
+            state[(2*k + 1)*W + l] = z2[l];
+        }
+    }
+}
+
+using Kernel = void (*)(int, const double *, const double *, int,
+                        double *, double *);
+
+void filterScalar(const int nSections, const double *b, const double *a,
+                  const int nSamples, double *x, double *state)
+{
+    filterLanes<1>(nSections, b, a, nSamples, x, state);
+}
+
+// Two vectors of lanes are in flight so the latency of one recursion is
+// hidden behind the other.
+void filterBaseline(const int nSections, const double *b, const double *a,
+                    const int nSamples, double *x, double *state)
+{
+    filterLanes<4>(nSections, b, a, nSamples, x, state);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QPHASE_HAVE_X86_SIMD 1
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+void filterAVX2(const int nSections, const double *b, const double *a,
+                const int nSamples, double *x, double *state)
+{
+    filterLanes<8>(nSections, b, a, nSamples, x, state);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+void filterAVX512(const int nSections, const double *b, const double *a,
+                  const int nSamples, double *x, double *state)
+{
+    filterLanes<16>(nSections, b, a, nSamples, x, state);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+
+/// @result The multichannel kernel and its number of lanes for the
+///         current instruction set.
+std::pair<Kernel, int> getMultiChannelKernel() noexcept
+{
+#ifdef QPHASE_HAVE_X86_SIMD
+    auto instructionSet = getInstructionSet();
+    if (instructionSet == InstructionSet::AVX512)
+    {
+        return std::pair {&filterAVX512, 16};
+    }
+    if (instructionSet == InstructionSet::AVX2)
+    {
+        return std::pair {&filterAVX2, 8};
+    }
+#endif
+    return std::pair {&filterBaseline, 4};
+}
+
+/// @brief A channel's samples viewed as one continuous signal through its
+///        segments, traversed either forward or backward.
+template<typename T>
+class Stream
+{
+public:
+    /// @brief Appends a segment's samples.  When restart is true the
+    ///        segment does not abut the previous one so the filter must
+    ///        not carry its state into (or, in reverse, out of) it.
+    void add(T *x, const int n, const bool restart)
+    {
+        if (n > 0){mSpans.push_back(Span {x, n, restart || mSpans.empty()});}
+    }
+    void start(const bool reverse) noexcept
+    {
+        mReverse = reverse;
+        mSpan = 0;
+        mOffset = 0;
+    }
+    /// @result True indicates the cursor is at the first sample of a run
+    ///        of abutting segments so the filter must restart from rest.
+    [[nodiscard]] bool isAtRestart() const noexcept
+    {
+        return mOffset == 0 && isRestart(mSpan);
+    }
+    /// @brief Copies up to n samples at the cursor to y with the given
+    ///        stride.  This stops before the next restart.  The cursor is
+    ///        not moved.
+    /// @result The number of samples copied.
+    int read(int n, double *__restrict__ y, const int stride) const
+    {
+        auto nSpans = static_cast<int> (mSpans.size());
+        if (mSpan < nSpans)
+        {
+            auto nAvailable = length(mSpan) - mOffset;
+            for (int span = mSpan + 1;
+                 span < nSpans && nAvailable < n && !isRestart(span);
+                 ++span)
+            {
+                nAvailable = nAvailable + length(span);
+            }
+            n = std::min(n, nAvailable);
+        }
+        return walk(n, [&](const T *__restrict__ x, const int nCopy,
+                           const int i)
+                       {
+                           auto yi = y + i*stride;
+                           if (mReverse)
+                           {
+                               for (int j = 0; j < nCopy; ++j)
+                               {
+                                   yi[j*stride] = x[-j];
+                               }
+                           }
+                           else
+                           {
+                               for (int j = 0; j < nCopy; ++j)
+                               {
+                                   yi[j*stride] = x[j];
+                               }
+                           }
+                       });
+    }
+    /// @brief Copies n samples from y with the given stride to the cursor
+    ///        then advances the cursor.
+    void write(const int n, const double *__restrict__ y, const int stride)
+    {
+        walk(n, [&](T *__restrict__ x, const int nCopy, const int i)
+                {
+                    auto yi = y + i*stride;
+                    if (mReverse)
+                    {
+                        for (int j = 0; j < nCopy; ++j)
+                        {
+                            x[-j] = static_cast<T> (yi[j*stride]);
+                        }
+                    }
+                    else
+                    {
+                        for (int j = 0; j < nCopy; ++j)
+                        {
+                            x[j] = static_cast<T> (yi[j*stride]);
+                        }
+                    }
+                });
+        advance(n);
+    }
+private:
+    struct Span
+    {
+        T *x{nullptr};
+        int length{0};
+        bool restart{true};
+    };
+    /// @result The span at the given position in the traversal order.
+    [[nodiscard]] const Span &at(const int span) const noexcept
+    {
+        auto nSpans = static_cast<int> (mSpans.size());
+        return mSpans[mReverse ? nSpans - 1 - span : span];
+    }
+    [[nodiscard]] int length(const int span) const noexcept
+    {
+        return at(span).length;
+    }
+    /// @result True indicates the filter restarts at the given position in
+    ///         the traversal order.  In reverse a span starts a run when
+    ///         the span after it in time does not abut it.
+    [[nodiscard]] bool isRestart(const int span) const noexcept
+    {
+        auto nSpans = static_cast<int> (mSpans.size());
+        if (span >= nSpans){return false;}
+        if (!mReverse){return mSpans[span].restart;}
+        auto next = nSpans - span;
+        return next == nSpans || mSpans[next].restart;
+    }
+    /// @brief Visits up to n samples from the cursor span by span.  The
+    ///        function receives the first sample, the number of samples in
+    ///        this span, and the number of samples already visited.
+    template<typename F>
+    int walk(const int n, F &&f) const
+    {
+        int nVisited = 0;
+        auto span = mSpan;
+        auto offset = mOffset;
+        auto nSpans = static_cast<int> (mSpans.size());
+        while (nVisited < n && span < nSpans)
+        {
+            const auto &current = at(span);
+            auto nCopy = std::min(n - nVisited, current.length - offset);
+            auto first = mReverse ?
+                         current.x + (current.length - 1 - offset) :
+                         current.x + offset;
+            f(first, nCopy, nVisited);
+            nVisited = nVisited + nCopy;
+            offset = offset + nCopy;
+            if (offset == current.length)
+            {
+                span = span + 1;
+                offset = 0;
+            }
+        }
+        return nVisited;
+    }
+    void advance(int n) noexcept
+    {
+        auto nSpans = static_cast<int> (mSpans.size());
+        while (n > 0 && mSpan < nSpans)
+        {
+            auto nAdvance = std::min(n, length(mSpan) - mOffset);
+            n = n - nAdvance;
+            mOffset = mOffset + nAdvance;
+            if (mOffset == length(mSpan))
+            {
+                mSpan = mSpan + 1;
+                mOffset = 0;
+            }
+        }
+    }
+    std::vector<Span> mSpans;
+    int mSpan{0};
+    int mOffset{0};
+    bool mReverse{false};
+};
+
+/// @result A stream through all segments of the waveform.
+template<typename T>
+Stream<T> makeStream(QPhase::Waveforms::Waveform<T> *waveform)
+{
+    Stream<T> stream;
+    std::optional<std::chrono::microseconds> previousEnd;
+    for (auto &segment : *waveform)
+    {
+        auto nSamples = segment.getNumberOfSamples();
+        if (nSamples < 1){continue;}
+        // Abutting segments continue on the sample grid: the next sample
+        // is one period after the previous segment's last sample.
+        bool restart{true};
+        if (previousEnd && segment.haveSamplingRate())
+        {
+            auto dt = segment.getSamplingPeriodInMicroSeconds();
+            auto step = segment.getStartTime() - *previousEnd;
+            restart = step <= dt/2 || step > (3*dt)/2;
+        }
+        stream.add(segment.getDataPointer(), nSamples, restart);
+        previousEnd = segment.getEndTime();
+    }
+    return stream;
+}
+
+/// @brief Filters the streams.  The state is carried across segments that
+///        abut on the sample grid and the filter restarts from rest after
+///        each gap or overlap.  Streams are processed in groups
+///        of the kernel's lane width; lanes whose run or stream is
+///        exhausted are fed zeros and their output is discarded.
+template<typename T>
+void filterStreams(const Sections &sections,
+                   std::vector<Stream<T>> &streams,
+                   const bool reverse)
+{
+    auto nStreams = static_cast<int> (streams.size());
+    if (nStreams == 0){return;}
+    auto [kernel, lanes] = getMultiChannelKernel();
+    if (nStreams == 1)
+    {
+        kernel = &filterScalar;
+        lanes = 1;
+    }
+    std::vector<double> buffer(BLOCK_SIZE*lanes);
+    std::vector<double> state(2*sections.n*lanes);
+    std::vector<int> nRead(lanes);
+    for (int g = 0; g < nStreams; g = g + lanes)
+    {
+        auto nLanes = std::min(lanes, nStreams - g);
+        for (int l = 0; l < nLanes; ++l){streams[g + l].start(reverse);}
+        while (true)
+        {
+            int nBlock = 0;
+            for (int l = 0; l < nLanes; ++l)
+            {
+                if (streams[g + l].isAtRestart())
+                {
+                    for (int j = 0; j < 2*sections.n; ++j)
+                    {
+                        state[j*lanes + l] = 0;
+                    }
+                }
+                nRead[l] = streams[g + l].read(BLOCK_SIZE,
+                                               buffer.data() + l, lanes);
+                nBlock = std::max(nBlock, nRead[l]);
+            }
+            if (nBlock == 0){break;}
+            for (int l = 0; l < lanes; ++l)
+            {
+                auto nFilled = l < nLanes ? nRead[l] : 0;
+                for (int i = nFilled; i < nBlock; ++i)
+                {
+                    buffer[i*lanes + l] = 0;
+                }
+            }
+            kernel(sections.n, sections.b.data(), sections.a.data(),
+                   nBlock, buffer.data(), state.data());
+            for (int l = 0; l < nLanes; ++l)
+            {
+                streams[g + l].write(nRead[l], buffer.data() + l, lanes);
+            }
+        }
+    }
+}
+
+}
+
+template<class T>
+class SOSFilter<T>::SOSFilterImpl
+{
+public:
+    Sections mSections;
+    std::vector<double> mState;
+    std::vector<double> mBuffer;
+    bool mInitialized{false};
+};
+
+/// C'tor
+template<class T>
+SOSFilter<T>::SOSFilter() :
+    pImpl(std::make_unique<SOSFilterImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+SOSFilter<T>::SOSFilter(const SOSFilter &filter)
+{
+    *this = filter;
+}
+
+/// Move c'tor
+template<class T>
+SOSFilter<T>::SOSFilter(SOSFilter &&filter) noexcept
+{
+    *this = std::move(filter);
+}
+
+/// Copy assignment
+template<class T>
+SOSFilter<T>& SOSFilter<T>::operator=(const SOSFilter &filter)
+{
+    if (&filter == this){return *this;}
+    pImpl = std::make_unique<SOSFilterImpl> (*filter.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+SOSFilter<T>& SOSFilter<T>::operator=(SOSFilter &&filter) noexcept
+{
+    if (&filter == this){return *this;}
+    pImpl = std::move(filter.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void SOSFilter<T>::clear() noexcept
+{
+    pImpl = std::make_unique<SOSFilterImpl> ();
+}
+
+/// Destructor
+template<class T>
+SOSFilter<T>::~SOSFilter() = default;
+
+/// Initialize from coefficients
+template<class T>
+void SOSFilter<T>::initialize(const std::vector<double> &numerators,
+                              const std::vector<double> &denominators)
+{
+    if (numerators.empty() || numerators.size()%3 != 0)
+    {
+        throw std::invalid_argument("numerators.size() must be a positive "
+                                  + std::string {"multiple of 3"});
+    }
+    if (denominators.size() != numerators.size())
+    {
+        throw std::invalid_argument(
+           "denominators.size() must equal numerators.size()");
+    }
+    Sections sections;
+    sections.n = static_cast<int> (numerators.size()/3);
+    sections.b = numerators;
+    sections.a = denominators;
+    for (int k = 0; k < sections.n; ++k)
+    {
+        auto a0 = sections.a[3*k];
+        if (a0 == 0)
+        {
+            throw std::invalid_argument("Leading denominator coefficient of "
+                                      + std::string {"section "}
+                                      + std::to_string(k) + " is zero");
+        }
+        for (int j = 0; j < 3; ++j)
+        {
+            sections.b[3*k + j] = sections.b[3*k + j]/a0;
+            sections.a[3*k + j] = sections.a[3*k + j]/a0;
+        }
+    }
+    clear();
+    pImpl->mSections = std::move(sections);
+    pImpl->mState.resize(2*pImpl->mSections.n, 0);
+    pImpl->mInitialized = true;
+}
+
+/// Lowpass
+template<class T>
+void SOSFilter<T>::initializeLowpass(const int order, const double corner,
+                                     const double samplingRate)
+{
+    checkDesign(order, corner, samplingRate);
+    auto omega = prewarp(corner, samplingRate);
+    std::vector<Complex> poles;
+    for (const auto &p : butterworthPrototype(order))
+    {
+        poles.push_back(bilinear(omega*p, samplingRate));
+    }
+    // Zeros at infinity map to z = -1
+    auto sections = makeSections(poles, -1, -1, 0);
+    initialize(sections.b, sections.a);
+}
+
+/// Highpass
+template<class T>
+void SOSFilter<T>::initializeHighpass(const int order, const double corner,
+                                      const double samplingRate)
+{
+    checkDesign(order, corner, samplingRate);
+    auto omega = prewarp(corner, samplingRate);
+    std::vector<Complex> poles;
+    for (const auto &p : butterworthPrototype(order))
+    {
+        poles.push_back(bilinear(omega/p, samplingRate));
+    }
+    // Zeros at s = 0 map to z = 1
+    auto sections = makeSections(poles, 1, 1, M_PI);
+    initialize(sections.b, sections.a);
+}
+
+/// Bandpass
+template<class T>
+void SOSFilter<T>::initializeBandpass(const int order,
+                                      const std::pair<double, double> &corners,
+                                      const double samplingRate)
+{
+    checkDesign(order, corners.first, samplingRate);
+    checkDesign(order, corners.second, samplingRate);
+    if (corners.first >= corners.second)
+    {
+        throw std::invalid_argument("corners.first must be less than "
+                                  + std::string {"corners.second"});
+    }
+    auto omega1 = prewarp(corners.first,  samplingRate);
+    auto omega2 = prewarp(corners.second, samplingRate);
+    auto bandwidth = omega2 - omega1;
+    auto omega0 = std::sqrt(omega1*omega2);
+    // Each prototype pole p maps to the roots of s^2 - p B s + w0^2
+    std::vector<Complex> poles;
+    for (const auto &p : butterworthPrototype(order))
+    {
+        auto halfPB = 0.5*p*bandwidth;
+        auto root = std::sqrt(halfPB*halfPB - omega0*omega0);
+        poles.push_back(bilinear(halfPB + root, samplingRate));
+        poles.push_back(bilinear(halfPB - root, samplingRate));
+    }
+    // Half the zeros are at s = 0 (z = 1) and half are at infinity (z = -1)
+    auto center = 2*std::atan(omega0/(2*samplingRate));
+    auto sections = makeSections(poles, 1, -1, center);
+    initialize(sections.b, sections.a);
+}
+
+/// Initialized?
+template<class T>
+bool SOSFilter<T>::isInitialized() const noexcept
+{
+    return pImpl->mInitialized;
+}
+
+/// Number of sections
+template<class T>
+int SOSFilter<T>::getNumberOfSections() const
+{
+    if (!isInitialized()){throw std::runtime_error("Filter not initialized");}
+    return pImpl->mSections.n;
+}
+
+/// Coefficients
+template<class T>
+std::vector<double> SOSFilter<T>::getNumeratorCoefficients() const
+{
+    if (!isInitialized()){throw std::runtime_error("Filter not initialized");}
+    return pImpl->mSections.b;
+}
+
+template<class T>
+std::vector<double> SOSFilter<T>::getDenominatorCoefficients() const
+{
+    if (!isInitialized()){throw std::runtime_error("Filter not initialized");}
+    return pImpl->mSections.a;
+}
+
+/// Reset state
+template<class T>
+void SOSFilter<T>::resetInitialConditions() noexcept
+{
+    std::fill(pImpl->mState.begin(), pImpl->mState.end(), 0);
+}
+
+/// Streaming
+template<class T>
+void SOSFilter<T>::apply(const int n, T *x)
+{
+    if (!isInitialized()){throw std::runtime_error("Filter not initialized");}
+    if (n < 1){return;}
+    if (x == nullptr){throw std::invalid_argument("x is NULL");}
+    const auto &sections = pImpl->mSections;
+    pImpl->mBuffer.resize(BLOCK_SIZE);
+    auto buffer = pImpl->mBuffer.data();
+    for (int i0 = 0; i0 < n; i0 = i0 + BLOCK_SIZE)
+    {
+        auto nBlock = std::min(BLOCK_SIZE, n - i0);
+        std::copy(x + i0, x + i0 + nBlock, buffer);
+        filterScalar(sections.n, sections.b.data(), sections.a.data(),
+                     nBlock, buffer, pImpl->mState.data());
+        for (int i = 0; i < nBlock; ++i)
+        {
+            x[i0 + i] = static_cast<T> (buffer[i]);
+        }
+    }
+}
+
+template<class T>
+void SOSFilter<T>::apply(QPhase::Waveforms::Segment<T> *segment)
+{
+    if (segment == nullptr){throw std::invalid_argument("Segment is NULL");}
+    apply(segment->getNumberOfSamples(), segment->getDataPointer());
+}
+
+/// Waveforms
+template<class T>
+void SOSFilter<T>::filter(QPhase::Waveforms::Waveform<T> *waveform,
+                          const bool zeroPhase) const
+{
+    filter(std::vector<QPhase::Waveforms::Waveform<T> *> {waveform},
+           zeroPhase);
+}
+
+template<class T>
+void SOSFilter<T>::filter(
+    const std::vector<QPhase::Waveforms::Waveform<T> *> &waveforms,
+    const bool zeroPhase) const
+{
+    if (!isInitialized()){throw std::runtime_error("Filter not initialized");}
+    std::vector<Stream<T>> streams;
+    streams.reserve(waveforms.size());
+    for (auto &waveform : waveforms)
+    {
+        if (waveform == nullptr)
+        {
+            throw std::invalid_argument("Waveform is NULL");
+        }
+        streams.push_back(makeStream(waveform));
+    }
+    filterStreams(pImpl->mSections, streams, false);
+    if (zeroPhase){filterStreams(pImpl->mSections, streams, true);}
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::SOSFilter<double>;
+template class QPhase::Processing::SOSFilter<float>;
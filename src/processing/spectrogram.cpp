@@ -0,0 +1,353 @@
+#include <cmath>
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "qphase/processing/spectrogram.hpp"
+#include "private/processing/fft.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// The taper does not depend on the precision.
+using Window = Spectrogram<double>::Window;
+
+/// @result The taper of the given length.
+std::vector<double> makeTaper(const Window window, const int n)
+{
+    std::vector<double> taper(n, 1.0);
+    const double denominator = n - 1;
+    for (int i = 0; i < n; ++i)
+    {
+        auto phase = 2*std::numbers::pi*i/denominator;
+        if (window == Window::Hann)
+        {
+            taper[i] = 0.5 - 0.5*std::cos(phase);
+        }
+        else if (window == Window::Hamming)
+        {
+            taper[i] = 0.54 - 0.46*std::cos(phase);
+        }
+        else if (window == Window::Blackman)
+        {
+            taper[i] = 0.42 - 0.5*std::cos(phase) + 0.08*std::cos(2*phase);
+        }
+    }
+    return taper;
+}
+
+/// @result The cached taper.  Like the FFT plans these are shared by all
+///         callers and never evicted.
+std::shared_ptr<const std::vector<double>> getTaper(const Window window,
+                                                    const int n)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>,
+                    std::shared_ptr<const std::vector<double>>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto key = std::pair {static_cast<int> (window), n};
+    auto it = cache.find(key);
+    if (it != cache.end()){return it->second;}
+    auto taper = std::make_shared<const std::vector<double>>
+                 (makeTaper(window, n));
+    cache.insert(std::pair {key, taper});
+    return taper;
+}
+
+/// Scratch space for one thread.
+struct Workspace
+{
+    explicit Workspace(const int fftLength) :
+        signal(fftLength),
+        spectrum(fftLength)
+    {
+    }
+    std::vector<std::complex<double>> signal;
+    std::vector<std::complex<double>> spectrum;
+};
+
+/// Transforms one or two frames.  The second frame is packed into the
+/// imaginary part and the two spectra are separated with the conjugate
+/// symmetry of a real signal's transform.
+template<typename T>
+void transformPair(const FFTPlan &plan,
+                   const std::vector<double> &taper,
+                   const std::vector<double> &scales,
+                   const T *x0, const T *x1,
+                   float *magnitudes0, float *magnitudes1,
+                   Workspace &workspace)
+{
+    const int fftLength = plan.size();
+    const int windowLength = static_cast<int> (taper.size());
+    const int nFrequencies = static_cast<int> (scales.size());
+    auto &signal = workspace.signal;
+    auto &spectrum = workspace.spectrum;
+    for (int i = 0; i < windowLength; ++i)
+    {
+        signal[i] = std::complex<double>
+                    (taper[i]*static_cast<double> (x0[i]),
+                     x1 ? taper[i]*static_cast<double> (x1[i]) : 0);
+    }
+    std::fill(signal.begin() + windowLength, signal.end(),
+              std::complex<double> {0, 0});
+    plan.forward(signal.data(), spectrum.data());
+    if (x1 == nullptr)
+    {
+        for (int k = 0; k < nFrequencies; ++k)
+        {
+            magnitudes0[k] = static_cast<float> (scales[k]*std::abs(spectrum[k]));
+        }
+        return;
+    }
+    for (int k = 0; k < nFrequencies; ++k)
+    {
+        auto zk = spectrum[k];
+        auto zc = std::conj(spectrum[(fftLength - k)%fftLength]);
+        // X0 = (Z_k + conj(Z_{n-k}))/2 and X1 = (Z_k - conj(Z_{n-k}))/(2i)
+        magnitudes0[k] = static_cast<float> (0.5*scales[k]*std::abs(zk + zc));
+        magnitudes1[k] = static_cast<float> (0.5*scales[k]*std::abs(zk - zc));
+    }
+}
+
+}
+
+template<class T>
+class Spectrogram<T>::SpectrogramImpl
+{
+public:
+    std::shared_ptr<const std::vector<double>> mTaper;
+    std::shared_ptr<const FFTPlan> mPlan;
+    /// The amplitude normalization at each frequency.
+    std::vector<double> mScales;
+    Window mWindow{Window::Hann};
+    int mHopLength{0};
+    int mThreads{1};
+    bool mInitialized{false};
+};
+
+/// C'tor
+template<class T>
+Spectrogram<T>::Spectrogram() :
+    pImpl(std::make_unique<SpectrogramImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+Spectrogram<T>::Spectrogram(const Spectrogram &spectrogram)
+{
+    *this = spectrogram;
+}
+
+/// Move c'tor
+template<class T>
+Spectrogram<T>::Spectrogram(Spectrogram &&spectrogram) noexcept
+{
+    *this = std::move(spectrogram);
+}
+
+/// Copy assignment
+template<class T>
+Spectrogram<T>& Spectrogram<T>::operator=(const Spectrogram &spectrogram)
+{
+    if (&spectrogram == this){return *this;}
+    pImpl = std::make_unique<SpectrogramImpl> (*spectrogram.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+Spectrogram<T>& Spectrogram<T>::operator=(Spectrogram &&spectrogram) noexcept
+{
+    if (&spectrogram == this){return *this;}
+    pImpl = std::move(spectrogram.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void Spectrogram<T>::clear() noexcept
+{
+    pImpl = std::make_unique<SpectrogramImpl> ();
+}
+
+/// D'tor
+template<class T>
+Spectrogram<T>::~Spectrogram() = default;
+
+/// Initialize
+template<class T>
+void Spectrogram<T>::initialize(const int windowLength,
+                                const int hopLength,
+                                const Window window,
+                                const int fftLength)
+{
+    if (windowLength < 2)
+    {
+        throw std::invalid_argument("Window length must be at least 2");
+    }
+    if (hopLength < 1)
+    {
+        throw std::invalid_argument("Hop length must be positive");
+    }
+    if (fftLength > 0 && fftLength < windowLength)
+    {
+        throw std::invalid_argument("FFT length must be at least "
+                                  + std::to_string(windowLength));
+    }
+    auto taper = getTaper(static_cast<::Window> (window), windowLength);
+    auto plan = getFFTPlan(fftLength > 0 ?
+                           fftLength : nextFFTLength(windowLength));
+    auto nFrequencies = plan->size()/2 + 1;
+    double sum = 0;
+    for (const auto &v : *taper){sum = sum + v;}
+    std::vector<double> scales(nFrequencies, 2/sum);
+    scales[0] = 1/sum;
+    if (plan->size()%2 == 0){scales.back() = 1/sum;}
+    auto nThreads = getNumberOfThreads();
+    clear();
+    pImpl->mThreads = nThreads;
+    pImpl->mTaper = std::move(taper);
+    pImpl->mPlan = std::move(plan);
+    pImpl->mScales = std::move(scales);
+    pImpl->mWindow = window;
+    pImpl->mHopLength = hopLength;
+    pImpl->mInitialized = true;
+}
+
+template<class T>
+bool Spectrogram<T>::isInitialized() const noexcept
+{
+    return pImpl->mInitialized;
+}
+
+template<class T>
+int Spectrogram<T>::getWindowLength() const
+{
+    if (!isInitialized()){throw std::runtime_error("Spectrogram not initialized");}
+    return static_cast<int> (pImpl->mTaper->size());
+}
+
+template<class T>
+int Spectrogram<T>::getHopLength() const
+{
+    if (!isInitialized()){throw std::runtime_error("Spectrogram not initialized");}
+    return pImpl->mHopLength;
+}
+
+template<class T>
+int Spectrogram<T>::getFFTLength() const
+{
+    if (!isInitialized()){throw std::runtime_error("Spectrogram not initialized");}
+    return pImpl->mPlan->size();
+}
+
+template<class T>
+typename Spectrogram<T>::Window Spectrogram<T>::getWindow() const
+{
+    if (!isInitialized()){throw std::runtime_error("Spectrogram not initialized");}
+    return pImpl->mWindow;
+}
+
+template<class T>
+int Spectrogram<T>::getNumberOfFrequencies() const
+{
+    if (!isInitialized()){throw std::runtime_error("Spectrogram not initialized");}
+    return static_cast<int> (pImpl->mScales.size());
+}
+
+template<class T>
+int Spectrogram<T>::getNumberOfFrames(const int nSamples) const
+{
+    auto windowLength = getWindowLength();
+    if (nSamples < windowLength){return 0;}
+    return (nSamples - windowLength)/pImpl->mHopLength + 1;
+}
+
+/// Threads
+template<class T>
+void Spectrogram<T>::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads must be positive");
+    }
+    pImpl->mThreads = nThreads;
+}
+
+template<class T>
+int Spectrogram<T>::getNumberOfThreads() const noexcept
+{
+    return pImpl->mThreads;
+}
+
+/// Transform
+template<class T>
+void Spectrogram<T>::compute(const int nSamples, const T *x,
+                             const int firstFrame, const int nFrames,
+                             float *magnitudes) const
+{
+    if (!isInitialized()){throw std::runtime_error("Spectrogram not initialized");}
+    if (nFrames < 1){return;}
+    if (x == nullptr){throw std::invalid_argument("x is NULL");}
+    if (magnitudes == nullptr)
+    {
+        throw std::invalid_argument("magnitudes is NULL");
+    }
+    auto nAvailable = getNumberOfFrames(nSamples);
+    if (firstFrame < 0 || firstFrame + nFrames > nAvailable)
+    {
+        throw std::invalid_argument("Frames must be in range [0,"
+                                  + std::to_string(nAvailable) + ")");
+    }
+    const auto &plan = *pImpl->mPlan;
+    const auto &taper = *pImpl->mTaper;
+    const auto &scales = pImpl->mScales;
+    const int hopLength = pImpl->mHopLength;
+    const int nFrequencies = getNumberOfFrequencies();
+    // Divide the frame pairs among the threads
+    const int nPairs = (nFrames + 1)/2;
+    const int nThreads = std::min(pImpl->mThreads, nPairs);
+    auto work = [&](const int thread)
+    {
+        Workspace workspace(plan.size());
+        auto pair0 = static_cast<int> (static_cast<int64_t> (nPairs)*thread/nThreads);
+        auto pair1 = static_cast<int> (static_cast<int64_t> (nPairs)*(thread + 1)/nThreads);
+        for (int pair = pair0; pair < pair1; ++pair)
+        {
+            auto f0 = 2*pair;
+            auto f1 = f0 + 1;
+            const T *x0 = x + static_cast<size_t> (firstFrame + f0)*hopLength;
+            const T *x1 = f1 < nFrames ?
+                          x + static_cast<size_t> (firstFrame + f1)*hopLength :
+                          nullptr;
+            auto *magnitudes0 = magnitudes
+                              + static_cast<size_t> (f0)*nFrequencies;
+            transformPair<T> (plan, taper, scales, x0, x1,
+                              magnitudes0, magnitudes0 + nFrequencies,
+                              workspace);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int thread = 1; thread < nThreads; ++thread)
+    {
+        threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (auto &thread : threads){thread.join();}
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::Spectrogram<double>;
+template class QPhase::Processing::Spectrogram<float>;
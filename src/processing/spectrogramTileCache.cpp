@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <list>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include "qphase/processing/spectrogramTileCache.hpp"
+#include "qphase/processing/spectrogram.hpp"
+#include "qphase/waveforms/segment.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// Identifies a tile.
+struct TileKey
+{
+    std::string channel;
+    int window{0};
+    int windowLength{0};
+    int fftLength{0};
+    int hopLength{0};
+    int64_t segmentStartTime{0};
+    int64_t tile{0};
+    [[nodiscard]] bool operator<(const TileKey &key) const
+    {
+        return std::tie(channel, window, windowLength, fftLength, hopLength,
+                        segmentStartTime, tile)
+             < std::tie(key.channel, key.window, key.windowLength,
+                        key.fftLength, key.hopLength, key.segmentStartTime,
+                        key.tile);
+    }
+};
+
+/// @result floor(a/b) for positive b.
+int64_t floorDivide(const int64_t a, const int64_t b)
+{
+    auto quotient = a/b;
+    if (a%b != 0 && a < 0){quotient = quotient - 1;}
+    return quotient;
+}
+
+}
+
+template<class T>
+class SpectrogramTileCache<T>::SpectrogramTileCacheImpl
+{
+public:
+    using TileList = std::list<TileKey>;
+    struct Entry
+    {
+        std::shared_ptr<const Tile> tile;
+        /// The entry's position in the recently used list.
+        typename TileList::iterator position;
+    };
+    SpectrogramTileCacheImpl() = default;
+    SpectrogramTileCacheImpl(const SpectrogramTileCacheImpl &impl)
+    {
+        std::lock_guard<std::mutex> lock(impl.mMutex);
+        // Rebuild the list so the entries point into this copy's list
+        for (const auto &key : impl.mRecentlyUsed)
+        {
+            auto position = mRecentlyUsed.insert(mRecentlyUsed.end(), key);
+            mEntries.insert(std::pair {key,
+                                       Entry {impl.mEntries.at(key).tile,
+                                              position}});
+        }
+        mComputedTiles = impl.mComputedTiles;
+        mFramesPerTile = impl.mFramesPerTile;
+        mCapacity = impl.mCapacity;
+    }
+    /// Evicts the least recently used tiles.  The mutex must be held.
+    void evict()
+    {
+        while (static_cast<int> (mEntries.size()) > mCapacity)
+        {
+            mEntries.erase(mRecentlyUsed.back());
+            mRecentlyUsed.pop_back();
+        }
+    }
+    mutable std::mutex mMutex;
+    std::map<TileKey, Entry> mEntries;
+    /// Keys from most to least recently used.
+    TileList mRecentlyUsed;
+    int64_t mComputedTiles{0};
+    int mFramesPerTile{128};
+    int mCapacity{512};
+};
+
+/// C'tor
+template<class T>
+SpectrogramTileCache<T>::SpectrogramTileCache() :
+    pImpl(std::make_unique<SpectrogramTileCacheImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+SpectrogramTileCache<T>::SpectrogramTileCache(
+    const SpectrogramTileCache &cache)
+{
+    *this = cache;
+}
+
+/// Move c'tor
+template<class T>
+SpectrogramTileCache<T>::SpectrogramTileCache(
+    SpectrogramTileCache &&cache) noexcept
+{
+    *this = std::move(cache);
+}
+
+/// Copy assignment
+template<class T>
+SpectrogramTileCache<T>&
+SpectrogramTileCache<T>::operator=(const SpectrogramTileCache &cache)
+{
+    if (&cache == this){return *this;}
+    pImpl = std::make_unique<SpectrogramTileCacheImpl> (*cache.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+SpectrogramTileCache<T>&
+SpectrogramTileCache<T>::operator=(SpectrogramTileCache &&cache) noexcept
+{
+    if (&cache == this){return *this;}
+    pImpl = std::move(cache.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void SpectrogramTileCache<T>::clear() noexcept
+{
+    pImpl = std::make_unique<SpectrogramTileCacheImpl> ();
+}
+
+/// D'tor
+template<class T>
+SpectrogramTileCache<T>::~SpectrogramTileCache() = default;
+
+/// Frames per tile
+template<class T>
+void SpectrogramTileCache<T>::setFramesPerTile(const int nFrames)
+{
+    if (nFrames < 1)
+    {
+        throw std::invalid_argument("Frames per tile must be positive");
+    }
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mEntries.clear();
+    pImpl->mRecentlyUsed.clear();
+    pImpl->mFramesPerTile = nFrames;
+}
+
+template<class T>
+int SpectrogramTileCache<T>::getFramesPerTile() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mFramesPerTile;
+}
+
+/// Capacity
+template<class T>
+void SpectrogramTileCache<T>::setCapacity(const int nTiles)
+{
+    if (nTiles < 1){throw std::invalid_argument("Capacity must be positive");}
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mCapacity = nTiles;
+    pImpl->evict();
+}
+
+template<class T>
+int SpectrogramTileCache<T>::getCapacity() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mCapacity;
+}
+
+template<class T>
+int SpectrogramTileCache<T>::size() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return static_cast<int> (pImpl->mEntries.size());
+}
+
+template<class T>
+int64_t SpectrogramTileCache<T>::getNumberOfComputedTiles() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mComputedTiles;
+}
+
+/// Erase a channel
+template<class T>
+void SpectrogramTileCache<T>::erase(const std::string &channel)
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    for (auto it = pImpl->mEntries.begin(); it != pImpl->mEntries.end();)
+    {
+        if (it->first.channel == channel)
+        {
+            pImpl->mRecentlyUsed.erase(it->second.position);
+            it = pImpl->mEntries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+/// Tiles
+template<class T>
+std::vector<std::shared_ptr<const typename SpectrogramTileCache<T>::Tile>>
+SpectrogramTileCache<T>::getTiles(
+    const std::string &channel,
+    const Spectrogram<T> &spectrogram,
+    const QPhase::Waveforms::Segment<T> &segment,
+    const std::chrono::microseconds &startTime,
+    const std::chrono::microseconds &endTime)
+{
+    if (!spectrogram.isInitialized())
+    {
+        throw std::invalid_argument("Spectrogram not initialized");
+    }
+    if (!segment.haveSamplingRate())
+    {
+        throw std::invalid_argument("Segment sampling rate not set");
+    }
+    if (startTime > endTime)
+    {
+        throw std::invalid_argument("Start time cannot exceed end time");
+    }
+    std::vector<std::shared_ptr<const Tile>> result;
+    const int nSamples = segment.getNumberOfSamples();
+    const int nFrames = spectrogram.getNumberOfFrames(nSamples);
+    if (nFrames < 1){return result;}
+    // Find the frames [f0, f1] that overlap the time range
+    const int windowLength = spectrogram.getWindowLength();
+    const int hopLength = spectrogram.getHopLength();
+    auto i0 = segment.getSampleIndex(startTime);
+    auto i1 = segment.getSampleIndex(endTime);
+    auto f0 = std::max<int64_t> (0,
+                                 floorDivide(i0 - windowLength, hopLength) + 1);
+    auto f1 = std::min<int64_t> (nFrames - 1, floorDivide(i1, hopLength));
+    if (f0 > f1){return result;}
+    TileKey key;
+    key.channel = channel;
+    key.window = static_cast<int> (spectrogram.getWindow());
+    key.windowLength = windowLength;
+    key.fftLength = spectrogram.getFFTLength();
+    key.hopLength = hopLength;
+    key.segmentStartTime = segment.getStartTime().count();
+    // Look up the cached tiles.  A short tile at the end of the segment is
+    // stale if the segment now has more frames.
+    std::vector<int64_t> missing;
+    std::unique_lock<std::mutex> lock(pImpl->mMutex);
+    const int framesPerTile = pImpl->mFramesPerTile;
+    const auto tile0 = f0/framesPerTile;
+    const auto tile1 = f1/framesPerTile;
+    result.resize(tile1 - tile0 + 1);
+    for (auto tile = tile0; tile <= tile1; ++tile)
+    {
+        key.tile = tile;
+        auto expectedFrames
+            = std::min<int64_t> (framesPerTile, nFrames - tile*framesPerTile);
+        auto it = pImpl->mEntries.find(key);
+        if (it != pImpl->mEntries.end() &&
+            it->second.tile->nFrames == expectedFrames)
+        {
+            pImpl->mRecentlyUsed.splice(pImpl->mRecentlyUsed.begin(),
+                                        pImpl->mRecentlyUsed,
+                                        it->second.position);
+            result[tile - tile0] = it->second.tile;
+        }
+        else
+        {
+            missing.push_back(tile);
+        }
+    }
+    lock.unlock();
+    if (missing.empty()){return result;}
+    // Compute the missing tiles outside of the lock
+    const auto samplingRate = segment.getSamplingRate();
+    const int nFrequencies = spectrogram.getNumberOfFrequencies();
+    for (const auto tile : missing)
+    {
+        auto newTile = std::make_shared<Tile> ();
+        newTile->firstFrame = tile*framesPerTile;
+        newTile->nFrames
+            = static_cast<int> (std::min<int64_t> (framesPerTile,
+                                                   nFrames - newTile->firstFrame));
+        newTile->nFrequencies = nFrequencies;
+        newTile->startTime
+            = segment.getSampleTime(newTile->firstFrame*hopLength);
+        newTile->frameInterval = hopLength/samplingRate;
+        newTile->frequencySpacing = samplingRate/key.fftLength;
+        newTile->magnitudes.resize(static_cast<size_t> (newTile->nFrames)
+                                  *nFrequencies);
+        spectrogram.compute(nSamples, segment.getDataPointer(),
+                            static_cast<int> (newTile->firstFrame),
+                            newTile->nFrames,
+                            newTile->magnitudes.data());
+        result[tile - tile0] = newTile;
+    }
+    lock.lock();
+    // The tiles are stale if the tiling changed while they were computed
+    if (pImpl->mFramesPerTile != framesPerTile){return result;}
+    for (const auto tile : missing)
+    {
+        key.tile = tile;
+        auto it = pImpl->mEntries.find(key);
+        if (it != pImpl->mEntries.end())
+        {
+            pImpl->mRecentlyUsed.erase(it->second.position);
+            pImpl->mEntries.erase(it);
+        }
+        auto position = pImpl->mRecentlyUsed.insert(
+            pImpl->mRecentlyUsed.begin(), key);
+        pImpl->mEntries.insert(std::pair {key,
+                                          typename SpectrogramTileCacheImpl::Entry
+                                          {result[tile - tile0], position}});
+    }
+    pImpl->mComputedTiles = pImpl->mComputedTiles
+                          + static_cast<int64_t> (missing.size());
+    pImpl->evict();
+    return result;
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::SpectrogramTileCache<double>;
+template class QPhase::Processing::SpectrogramTileCache<float>;
@@ -0,0 +1,829 @@
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "qphase/processing/staLta.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/gather.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+
+using namespace QPhase::Processing;
+
+namespace
+{
+
+/// Samples are processed in tiles of this many samples per channel.  A
+/// transposed tile of a channel group fits in the L1 cache.
+constexpr int BLOCK_SIZE{128};
+/// Channels are transposed in groups of this many so that the state layout
+/// does not depend on the instruction set.  This is the widest kernel.
+constexpr int GROUP_SIZE{16};
+
+///--------------------------------------------------------------------------///
+///                                 Kernels                                  ///
+///--------------------------------------------------------------------------///
+
+/// A vector register of W doubles.  This is a member typedef since
+/// attributes on alias templates are dropped.
+template<int W>
+struct Vector
+{
+    typedef double type __attribute__((vector_size(W*sizeof(double))));
+};
+template<int W> using Lanes = typename Vector<W>::type;
+
+/// Unaligned loads and stores.  The vector is passed by reference since
+/// the calling convention for vector values depends on the target.
+template<int W>
+[[gnu::always_inline]] inline
+void load(const double *x, Lanes<W> &v) noexcept
+{
+    std::memcpy(&v, x, sizeof(v));
+}
+
+template<int W>
+[[gnu::always_inline]] inline
+void store(const Lanes<W> &v, double *x) noexcept
+{
+    std::memcpy(x, &v, sizeof(v));
+}
+
+/// @brief Computes the recursive STA/LTA of N vectors of W lanes of a
+///        transposed tile.  Several vectors are in flight so the latency of
+///        one recursion is hidden behind the others.
+/// @param[in] sampleIndex  The index of the tile's first sample since the
+///                         last reset.
+/// @param[in] nWarmUp      Samples before this index have a zero STA/LTA.
+/// @param[in,out] x        On input, the signals.  On exit, the STA/LTA.
+///                         This is an array whose dimension is
+///                         [nSamples x GROUP_SIZE].
+/// @param[in,out] sta      The lanes' short-term averages.
+/// @param[in,out] lta      The lanes' long-term averages.
+/// @param[out] maximum     The lanes' largest STA/LTA in the tile.
+template<int W, int N>
+[[gnu::always_inline]] inline
+void recursiveLanes(const int nSamples, const int64_t sampleIndex,
+                    const int64_t nWarmUp,
+                    const double cSta, const double cLta,
+                    double *__restrict__ x,
+                    double *__restrict__ sta, double *__restrict__ lta,
+                    double *__restrict__ maximum)
+{
+    const Lanes<W> zero{};
+    Lanes<W> s[N];
+    Lanes<W> l[N];
+    Lanes<W> peak[N];
+    for (int k = 0; k < N; ++k)
+    {
+        load<W> (sta + k*W, s[k]);
+        load<W> (lta + k*W, l[k]);
+        peak[k] = zero;
+    }
+    const auto dSta = 1 - cSta;
+    const auto dLta = 1 - cLta;
+    // The warm-up is split off so the steady-state loop has no test
+    auto nCold = static_cast<int> (std::clamp<int64_t> (nWarmUp - sampleIndex,
+                                                        0, nSamples));
+    for (int i = 0; i < nCold; ++i)
+    {
+        for (int k = 0; k < N; ++k)
+        {
+            Lanes<W> xi;
+            load<W> (x + i*GROUP_SIZE + k*W, xi);
+            auto x2 = xi*xi;
+            s[k] = cSta*x2 + dSta*s[k];
+            l[k] = cLta*x2 + dLta*l[k];
+            store<W> (zero, x + i*GROUP_SIZE + k*W);
+        }
+    }
+    for (int i = nCold; i < nSamples; ++i)
+    {
+        for (int k = 0; k < N; ++k)
+        {
+            Lanes<W> xi;
+            load<W> (x + i*GROUP_SIZE + k*W, xi);
+            auto x2 = xi*xi;
+            s[k] = cSta*x2 + dSta*s[k];
+            l[k] = cLta*x2 + dLta*l[k];
+            Lanes<W> cf = l[k] > zero ? s[k]/l[k] : zero;
+            peak[k] = peak[k] > cf ? peak[k] : cf;
+            store<W> (cf, x + i*GROUP_SIZE + k*W);
+        }
+    }
+    for (int k = 0; k < N; ++k)
+    {
+        store<W> (s[k], sta + k*W);
+        store<W> (l[k], lta + k*W);
+        store<W> (peak[k], maximum + k*W);
+    }
+}
+
+/// @brief Computes the classic STA/LTA of N vectors of W lanes of a
+///        transposed tile.  The running sums are updated with the squared
+///        sample entering and the squared samples leaving the windows, and
+///        are recomputed exactly from the history each time the ring wraps
+///        so round-off cannot accumulate over long streams.
+/// @param[in,out] history  The ring of squared samples.  This is an array
+///                         whose dimension is [nLta x GROUP_SIZE].
+template<int W, int N>
+[[gnu::always_inline]] inline
+void classicLanes(const int nSamples, const int64_t sampleIndex,
+                  const int nSta, const int nLta,
+                  double *__restrict__ x,
+                  double *__restrict__ history,
+                  double *__restrict__ staSum, double *__restrict__ ltaSum,
+                  double *__restrict__ maximum)
+{
+    const Lanes<W> zero{};
+    Lanes<W> s[N];
+    Lanes<W> l[N];
+    Lanes<W> peak[N];
+    for (int k = 0; k < N; ++k)
+    {
+        load<W> (staSum + k*W, s[k]);
+        load<W> (ltaSum + k*W, l[k]);
+        peak[k] = zero;
+    }
+    const double ratio = static_cast<double> (nLta)/nSta;
+    auto position = static_cast<int> (sampleIndex%nLta);
+    auto staPosition = position - nSta;
+    if (staPosition < 0){staPosition = staPosition + nLta;}
+    for (int i = 0; i < nSamples; ++i)
+    {
+        const bool warm = sampleIndex + i >= nLta - 1;
+        for (int k = 0; k < N; ++k)
+        {
+            Lanes<W> xi;
+            Lanes<W> oldest;
+            Lanes<W> staOldest;
+            load<W> (x + i*GROUP_SIZE + k*W, xi);
+            load<W> (history + position*GROUP_SIZE + k*W, oldest);
+            load<W> (history + staPosition*GROUP_SIZE + k*W, staOldest);
+            auto x2 = xi*xi;
+            s[k] = s[k] + (x2 - staOldest);
+            l[k] = l[k] + (x2 - oldest);
+            store<W> (x2, history + position*GROUP_SIZE + k*W);
+            Lanes<W> cf = l[k] > zero ? ratio*s[k]/l[k] : zero;
+            if (!warm){cf = zero;}
+            peak[k] = peak[k] > cf ? peak[k] : cf;
+            store<W> (cf, x + i*GROUP_SIZE + k*W);
+        }
+        position = position + 1;
+        staPosition = staPosition + 1;
+        if (staPosition == nLta){staPosition = 0;}
+        if (position == nLta)
+        {
+            position = 0;
+            for (int k = 0; k < N; ++k)
+            {
+                s[k] = zero;
+                l[k] = zero;
+                for (int j = 0; j < nLta; ++j)
+                {
+                    Lanes<W> hj;
+                    load<W> (history + j*GROUP_SIZE + k*W, hj);
+                    l[k] = l[k] + hj;
+                    if (j >= nLta - nSta){s[k] = s[k] + hj;}
+                }
+            }
+        }
+    }
+    for (int k = 0; k < N; ++k)
+    {
+        store<W> (s[k], staSum + k*W);
+        store<W> (l[k], ltaSum + k*W);
+        store<W> (peak[k], maximum + k*W);
+    }
+}
+
+using RecursiveKernel = void (*)(int, int64_t, int64_t, double, double,
+                                 double *, double *, double *, double *);
+using ClassicKernel = void (*)(int, int64_t, int, int,
+                               double *, double *, double *, double *,
+                               double *);
+
+struct Kernels
+{
+    RecursiveKernel recursive{nullptr};
+    ClassicKernel classic{nullptr};
+    int lanes{1};
+};
+
+void recursiveBaseline(const int nSamples, const int64_t sampleIndex,
+                       const int64_t nWarmUp,
+                       const double cSta, const double cLta,
+                       double *x, double *sta, double *lta, double *maximum)
+{
+    recursiveLanes<2, 2>(nSamples, sampleIndex, nWarmUp, cSta, cLta,
+                         x, sta, lta, maximum);
+}
+
+void classicBaseline(const int nSamples, const int64_t sampleIndex,
+                     const int nSta, const int nLta,
+                     double *x, double *history, double *sta, double *lta,
+                     double *maximum)
+{
+    classicLanes<2, 2>(nSamples, sampleIndex, nSta, nLta,
+                       x, history, sta, lta, maximum);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QPHASE_HAVE_X86_SIMD 1
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+void recursiveAVX2(const int nSamples, const int64_t sampleIndex,
+                   const int64_t nWarmUp,
+                   const double cSta, const double cLta,
+                   double *x, double *sta, double *lta, double *maximum)
+{
+    recursiveLanes<4, 2>(nSamples, sampleIndex, nWarmUp, cSta, cLta,
+                         x, sta, lta, maximum);
+}
+
+void classicAVX2(const int nSamples, const int64_t sampleIndex,
+                 const int nSta, const int nLta,
+                 double *x, double *history, double *sta, double *lta,
+                 double *maximum)
+{
+    classicLanes<4, 2>(nSamples, sampleIndex, nSta, nLta,
+                       x, history, sta, lta, maximum);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+void recursiveAVX512(const int nSamples, const int64_t sampleIndex,
+                     const int64_t nWarmUp,
+                     const double cSta, const double cLta,
+                     double *x, double *sta, double *lta, double *maximum)
+{
+    recursiveLanes<8, 2>(nSamples, sampleIndex, nWarmUp, cSta, cLta,
+                         x, sta, lta, maximum);
+}
+
+void classicAVX512(const int nSamples, const int64_t sampleIndex,
+                   const int nSta, const int nLta,
+                   double *x, double *history, double *sta, double *lta,
+                   double *maximum)
+{
+    classicLanes<8, 2>(nSamples, sampleIndex, nSta, nLta,
+                       x, history, sta, lta, maximum);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+
+/// @result The kernels and their number of lanes for the current
+///         instruction set.
+Kernels getKernels() noexcept
+{
+#ifdef QPHASE_HAVE_X86_SIMD
+    auto instructionSet = getInstructionSet();
+    if (instructionSet == InstructionSet::AVX512)
+    {
+        return Kernels{&recursiveAVX512, &classicAVX512, 16};
+    }
+    if (instructionSet == InstructionSet::AVX2)
+    {
+        return Kernels{&recursiveAVX2, &classicAVX2, 8};
+    }
+#endif
+    return Kernels{&recursiveBaseline, &classicBaseline, 4};
+}
+
+/// @result The window length in samples.
+int toSamples(const double window, const double samplingRate)
+{
+    return static_cast<int> (std::lround(window*samplingRate));
+}
+
+}
+
+template<class T>
+class STALTA<T>::STALTAImpl
+{
+public:
+    /// @brief Zeros the averages and open triggers.
+    void resetState(const std::chrono::microseconds &startTime) noexcept
+    {
+        std::fill(mSta.begin(), mSta.end(), 0);
+        std::fill(mLta.begin(), mLta.end(), 0);
+        std::fill(mHistory.begin(), mHistory.end(), 0);
+        std::fill(mTriggered.begin(), mTriggered.end(), 0);
+        mGrid.setStartTime(startTime);
+        mSampleIndex = 0;
+    }
+    /// @brief Updates the triggers of a channel from a transposed tile of
+    ///        its STA/LTA.
+    void updateTriggers(const int channel, const int64_t sampleIndex,
+                        const int nSamples, const double *cf)
+    {
+        auto triggered = mTriggered[channel] != 0;
+        auto onIndex = mOnIndex[channel];
+        auto maximum = mMaximum[channel];
+        for (int i = 0; i < nSamples; ++i)
+        {
+            auto value = cf[i*GROUP_SIZE];
+            if (!triggered)
+            {
+                if (value >= mOnThreshold)
+                {
+                    triggered = true;
+                    onIndex = sampleIndex + i;
+                    maximum = value;
+                }
+            }
+            else
+            {
+                maximum = std::max(maximum, value);
+                if (value < mOffThreshold)
+                {
+                    triggered = false;
+                    addTrigger(channel, onIndex, sampleIndex + i, maximum);
+                }
+            }
+        }
+        mTriggered[channel] = triggered ? 1 : 0;
+        mOnIndex[channel] = onIndex;
+        mMaximum[channel] = maximum;
+    }
+    void addTrigger(const int channel, const int64_t onIndex,
+                    const int64_t offIndex, const double maximum)
+    {
+        Trigger trigger;
+        trigger.channel = channel;
+        trigger.onTime = mGrid.getSampleTime(onIndex);
+        trigger.offTime = mGrid.getSampleTime(offIndex);
+        trigger.maximum = maximum;
+        mTriggers.push_back(std::move(trigger));
+    }
+    /// Per-channel averages or running sums.  These are padded to a whole
+    /// number of groups.
+    std::vector<double> mSta;
+    std::vector<double> mLta;
+    /// The classic detector's rings of squared samples.  This is an array
+    /// whose dimension is [nGroups x nLta x GROUP_SIZE].
+    std::vector<double> mHistory;
+    /// The transposed tile.
+    std::vector<double> mBuffer;
+    /// Per-channel open triggers.
+    std::vector<uint8_t> mTriggered;
+    std::vector<int64_t> mOnIndex;
+    std::vector<double> mMaximum;
+    std::vector<Trigger> mTriggers;
+    /// The start time and sampling rate of the stream.
+    QPhase::Waveforms::Segment<double> mGrid;
+    int64_t mSampleIndex{0};
+    double mSamplingRate{0};
+    double mOnThreshold{3};
+    double mOffThreshold{1.5};
+    int mChannels{0};
+    int mGroups{0};
+    int mShortWindow{0};
+    int mLongWindow{0};
+    Type mType{Type::Recursive};
+    bool mInitialized{false};
+};
+
+/// C'tor
+template<class T>
+STALTA<T>::STALTA() :
+    pImpl(std::make_unique<STALTAImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+STALTA<T>::STALTA(const STALTA &detector)
+{
+    *this = detector;
+}
+
+/// Move c'tor
+template<class T>
+STALTA<T>::STALTA(STALTA &&detector) noexcept
+{
+    *this = std::move(detector);
+}
+
+/// Copy assignment
+template<class T>
+STALTA<T>& STALTA<T>::operator=(const STALTA &detector)
+{
+    if (&detector == this){return *this;}
+    pImpl = std::make_unique<STALTAImpl> (*detector.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+STALTA<T>& STALTA<T>::operator=(STALTA &&detector) noexcept
+{
+    if (&detector == this){return *this;}
+    pImpl = std::move(detector.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void STALTA<T>::clear() noexcept
+{
+    pImpl = std::make_unique<STALTAImpl> ();
+}
+
+/// D'tor
+template<class T>
+STALTA<T>::~STALTA() = default;
+
+/// Initialize
+template<class T>
+void STALTA<T>::initialize(const int nChannels, const double samplingRate,
+                           const double shortWindow, const double longWindow,
+                           const Type type)
+{
+    if (nChannels < 1)
+    {
+        throw std::invalid_argument("Number of channels must be positive");
+    }
+    if (samplingRate <= 0)
+    {
+        throw std::invalid_argument("Sampling rate must be positive");
+    }
+    auto nSta = toSamples(shortWindow, samplingRate);
+    auto nLta = toSamples(longWindow, samplingRate);
+    if (nSta < 1)
+    {
+        throw std::invalid_argument("Short window must be at least 1 sample");
+    }
+    if (nLta <= nSta)
+    {
+        throw std::invalid_argument(
+            "Long window must be longer than short window");
+    }
+    auto thresholds = getTriggerThresholds();
+    clear();
+    pImpl->mOnThreshold = thresholds.first;
+    pImpl->mOffThreshold = thresholds.second;
+    pImpl->mChannels = nChannels;
+    pImpl->mGroups = (nChannels + GROUP_SIZE - 1)/GROUP_SIZE;
+    pImpl->mSamplingRate = samplingRate;
+    pImpl->mShortWindow = nSta;
+    pImpl->mLongWindow = nLta;
+    pImpl->mType = type;
+    auto nPadded = static_cast<size_t> (pImpl->mGroups*GROUP_SIZE);
+    pImpl->mSta.resize(nPadded, 0);
+    pImpl->mLta.resize(nPadded, 0);
+    if (type == Type::Classic)
+    {
+        pImpl->mHistory.resize(nPadded*static_cast<size_t> (nLta), 0);
+    }
+    pImpl->mBuffer.resize(BLOCK_SIZE*GROUP_SIZE, 0);
+    pImpl->mTriggered.resize(nChannels, 0);
+    pImpl->mOnIndex.resize(nChannels, 0);
+    pImpl->mMaximum.resize(nChannels, 0);
+    pImpl->mGrid.setSamplingRate(samplingRate);
+    pImpl->resetState(std::chrono::microseconds {0});
+    pImpl->mInitialized = true;
+}
+
+template<class T>
+bool STALTA<T>::isInitialized() const noexcept
+{
+    return pImpl->mInitialized;
+}
+
+template<class T>
+int STALTA<T>::getNumberOfChannels() const
+{
+    if (!isInitialized()){throw std::runtime_error("STA/LTA not initialized");}
+    return pImpl->mChannels;
+}
+
+template<class T>
+double STALTA<T>::getSamplingRate() const
+{
+    if (!isInitialized()){throw std::runtime_error("STA/LTA not initialized");}
+    return pImpl->mSamplingRate;
+}
+
+template<class T>
+std::pair<int, int> STALTA<T>::getWindowLengths() const
+{
+    if (!isInitialized()){throw std::runtime_error("STA/LTA not initialized");}
+    return std::pair {pImpl->mShortWindow, pImpl->mLongWindow};
+}
+
+/// Thresholds
+template<class T>
+void STALTA<T>::setTriggerThresholds(const double onThreshold,
+                                     const double offThreshold)
+{
+    if (offThreshold <= 0)
+    {
+        throw std::invalid_argument("Off threshold must be positive");
+    }
+    if (offThreshold > onThreshold)
+    {
+        throw std::invalid_argument(
+            "Off threshold cannot exceed on threshold");
+    }
+    pImpl->mOnThreshold = onThreshold;
+    pImpl->mOffThreshold = offThreshold;
+}
+
+template<class T>
+std::pair<double, double> STALTA<T>::getTriggerThresholds() const noexcept
+{
+    return std::pair {pImpl->mOnThreshold, pImpl->mOffThreshold};
+}
+
+/// Reset
+template<class T>
+void STALTA<T>::reset(const std::chrono::microseconds &startTime) noexcept
+{
+    pImpl->resetState(startTime);
+}
+
+/// Streaming
+template<class T>
+void STALTA<T>::process(const int nSamples, const int leadingDimension,
+                        const T *x, T *characteristicFunction)
+{
+    if (!isInitialized()){throw std::runtime_error("STA/LTA not initialized");}
+    if (nSamples < 1){return;}
+    if (leadingDimension < nSamples)
+    {
+        throw std::invalid_argument("Leading dimension too small");
+    }
+    if (x == nullptr){throw std::invalid_argument("x is NULL");}
+    if (characteristicFunction == nullptr)
+    {
+        throw std::invalid_argument("Characteristic function is NULL");
+    }
+    auto kernels = getKernels();
+    auto nChannels = pImpl->mChannels;
+    auto nSta = pImpl->mShortWindow;
+    auto nLta = pImpl->mLongWindow;
+    auto cSta = 1./nSta;
+    auto cLta = 1./nLta;
+    auto buffer = pImpl->mBuffer.data();
+    double maximum[GROUP_SIZE];
+    auto ld = static_cast<size_t> (leadingDimension);
+    auto nTriggers = static_cast<ptrdiff_t> (pImpl->mTriggers.size());
+    for (int g = 0; g < pImpl->mGroups; ++g)
+    {
+        auto c0 = g*GROUP_SIZE;
+        auto nLanes = std::min(GROUP_SIZE, nChannels - c0);
+        auto history = pImpl->mHistory.data()
+                     + static_cast<size_t> (c0)*static_cast<size_t> (nLta);
+        for (int i0 = 0; i0 < nSamples; i0 = i0 + BLOCK_SIZE)
+        {
+            auto nBlock = std::min(BLOCK_SIZE, nSamples - i0);
+            auto sampleIndex = pImpl->mSampleIndex + i0;
+            // Transpose the tile so the channels are the fast dimension.
+            // Lanes without a channel are fed zeros.
+            for (int l = 0; l < GROUP_SIZE; ++l)
+            {
+                if (l < nLanes)
+                {
+                    const T *__restrict__ row = x + (c0 + l)*ld + i0;
+                    for (int i = 0; i < nBlock; ++i)
+                    {
+                        buffer[i*GROUP_SIZE + l] = static_cast<double> (row[i]);
+                    }
+                }
+                else
+                {
+                    for (int i = 0; i < nBlock; ++i)
+                    {
+                        buffer[i*GROUP_SIZE + l] = 0;
+                    }
+                }
+            }
+            for (int l = 0; l < nLanes; l = l + kernels.lanes)
+            {
+                if (pImpl->mType == Type::Recursive)
+                {
+                    kernels.recursive(nBlock, sampleIndex, nLta - 1,
+                                      cSta, cLta, buffer + l,
+                                      pImpl->mSta.data() + c0 + l,
+                                      pImpl->mLta.data() + c0 + l,
+                                      maximum + l);
+                }
+                else
+                {
+                    kernels.classic(nBlock, sampleIndex, nSta, nLta,
+                                    buffer + l, history + l,
+                                    pImpl->mSta.data() + c0 + l,
+                                    pImpl->mLta.data() + c0 + l,
+                                    maximum + l);
+                }
+            }
+            for (int l = 0; l < nLanes; ++l)
+            {
+                // Only a lane that is on or crosses the on threshold in
+                // this tile needs the sample-by-sample scan
+                if (pImpl->mTriggered[c0 + l] != 0 ||
+                    maximum[l] >= pImpl->mOnThreshold)
+                {
+                    pImpl->updateTriggers(c0 + l, sampleIndex, nBlock,
+                                          buffer + l);
+                }
+                T *__restrict__ row = characteristicFunction + (c0 + l)*ld + i0;
+                for (int i = 0; i < nBlock; ++i)
+                {
+                    row[i] = static_cast<T> (buffer[i*GROUP_SIZE + l]);
+                }
+            }
+        }
+    }
+    pImpl->mSampleIndex = pImpl->mSampleIndex + nSamples;
+    // The groups are visited in turn so order this chunk's triggers by time
+    std::stable_sort(pImpl->mTriggers.begin() + nTriggers,
+                     pImpl->mTriggers.end(),
+                     [](const Trigger &lhs, const Trigger &rhs)
+                     {
+                         return lhs.offTime < rhs.offTime;
+                     });
+}
+
+/// Triggers
+template<class T>
+void STALTA<T>::closeTriggers()
+{
+    if (pImpl->mSampleIndex < 1){return;}
+    for (int channel = 0; channel < pImpl->mChannels; ++channel)
+    {
+        if (pImpl->mTriggered[channel] != 0)
+        {
+            pImpl->addTrigger(channel, pImpl->mOnIndex[channel],
+                              pImpl->mSampleIndex - 1,
+                              pImpl->mMaximum[channel]);
+            pImpl->mTriggered[channel] = 0;
+        }
+    }
+}
+
+template<class T>
+std::vector<typename STALTA<T>::Trigger> STALTA<T>::getTriggers() const
+{
+    return pImpl->mTriggers;
+}
+
+template<class T>
+void STALTA<T>::clearTriggers() noexcept
+{
+    pImpl->mTriggers.clear();
+}
+
+template<class T>
+int64_t STALTA<T>::getNumberOfProcessedSamples() const noexcept
+{
+    return pImpl->mSampleIndex;
+}
+
+/// Batch
+template<class T>
+QPhase::Waveforms::Gather<T>
+STALTA<T>::process(const QPhase::Waveforms::Gather<T> &gather)
+{
+    if (!isInitialized()){throw std::runtime_error("STA/LTA not initialized");}
+    if (gather.getNumberOfChannels() != pImpl->mChannels)
+    {
+        throw std::invalid_argument("Gather has "
+                                  + std::to_string(gather.getNumberOfChannels())
+                                  + " channels; expected "
+                                  + std::to_string(pImpl->mChannels));
+    }
+    if (std::abs(gather.getSamplingRate() - pImpl->mSamplingRate)
+        > 1.e-6*pImpl->mSamplingRate)
+    {
+        throw std::invalid_argument("Gather sampling rate does not match");
+    }
+    auto result = gather;
+    auto nSamples = result.getNumberOfSamples();
+    auto nTriggers = static_cast<ptrdiff_t> (pImpl->mTriggers.size());
+    reset(gather.getStartTime());
+    process(nSamples, result.getLeadingDimension(),
+            result.getDataPointer(), result.getDataPointer());
+    closeTriggers();
+    // A channel with gaps is redone one recorded run at a time so that each
+    // run restarts the averages and warm-up.  The characteristic function
+    // is zero in the gaps.
+    STALTA<T> runDetector;
+    std::vector<uint8_t> hasGaps(pImpl->mChannels, 0);
+    std::vector<Trigger> runTriggers;
+    for (int channel = 0; channel < pImpl->mChannels; ++channel)
+    {
+        const auto mask = gather.getMaskRowPointer(channel);
+        if (std::all_of(mask, mask + nSamples,
+                        [](const uint8_t m){return m != 0;}))
+        {
+            continue;
+        }
+        hasGaps[channel] = 1;
+        if (!runDetector.isInitialized())
+        {
+            runDetector.initialize(1, pImpl->mSamplingRate,
+                                   pImpl->mShortWindow/pImpl->mSamplingRate,
+                                   pImpl->mLongWindow/pImpl->mSamplingRate,
+                                   pImpl->mType);
+            runDetector.setTriggerThresholds(pImpl->mOnThreshold,
+                                             pImpl->mOffThreshold);
+        }
+        const T *x = gather.getRowPointer(channel);
+        T *cf = result.getRowPointer(channel);
+        int i0 = 0;
+        while (i0 < nSamples)
+        {
+            if (mask[i0] == 0)
+            {
+                cf[i0] = 0;
+                i0 = i0 + 1;
+                continue;
+            }
+            auto i1 = static_cast<int> (std::find(mask + i0, mask + nSamples, 0)
+                                      - mask);
+            runDetector.reset(pImpl->mGrid.getSampleTime(i0));
+            runDetector.process(i1 - i0, i1 - i0, x + i0, cf + i0);
+            runDetector.closeTriggers();
+            i0 = i1;
+        }
+        for (auto trigger : runDetector.getTriggers())
+        {
+            trigger.channel = channel;
+            runTriggers.push_back(std::move(trigger));
+        }
+        runDetector.clearTriggers();
+    }
+    if (runDetector.isInitialized())
+    {
+        auto &triggers = pImpl->mTriggers;
+        triggers.erase(std::remove_if(triggers.begin() + nTriggers,
+                                      triggers.end(),
+                                      [&](const Trigger &trigger)
+                                      {
+                                          return hasGaps[trigger.channel] != 0;
+                                      }),
+                       triggers.end());
+        triggers.insert(triggers.end(),
+                        runTriggers.begin(), runTriggers.end());
+        std::stable_sort(triggers.begin() + nTriggers, triggers.end(),
+                         [](const Trigger &lhs, const Trigger &rhs)
+                         {
+                             return lhs.offTime < rhs.offTime;
+                         });
+    }
+    return result;
+}
+
+template<class T>
+QPhase::Waveforms::Waveform<T>
+STALTA<T>::process(const QPhase::Waveforms::Waveform<T> &waveform)
+{
+    if (!isInitialized()){throw std::runtime_error("STA/LTA not initialized");}
+    if (pImpl->mChannels != 1)
+    {
+        throw std::invalid_argument("Detector must have one channel");
+    }
+    std::vector<QPhase::Waveforms::Segment<T>> segments;
+    segments.reserve(waveform.getNumberOfSegments());
+    for (const auto &segment : waveform)
+    {
+        if (std::abs(segment.getSamplingRate() - pImpl->mSamplingRate)
+            > 1.e-6*pImpl->mSamplingRate)
+        {
+            throw std::invalid_argument(
+                "Segment sampling rate does not match");
+        }
+        auto result = segment;
+        auto nSamples = result.getNumberOfSamples();
+        reset(segment.getStartTime());
+        process(nSamples, nSamples,
+                result.getDataPointer(), result.getDataPointer());
+        closeTriggers();
+        segments.push_back(std::move(result));
+    }
+    QPhase::Waveforms::Waveform<T> result;
+    result.setSegments(std::move(segments));
+    return result;
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Processing::STALTA<double>;
+template class QPhase::Processing::STALTA<float>;
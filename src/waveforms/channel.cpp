@@ -1,9 +1,12 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <mutex>
+#include <vector>
 #include "qphase/waveforms/channel.hpp"
 #include "qphase/waveforms/waveform.hpp"
 #include "qphase/waveforms/simpleResponse.hpp"
+#include "qphase/processing/pipeline.hpp"
 
 using namespace QPhase::Waveforms;
 
@@ -17,6 +20,74 @@ namespace
     std::transform(result.begin(), result.end(), result.begin(), ::toupper);
     return result;
 }
+
+/// @brief Memoizes the most recently processed windows of a channel.  The
+///        cache is not copied with the channel since a copy may be given
+///        a different waveform or pipeline.
+template<typename T>
+class ProcessedWaveformCache
+{
+public:
+    struct Entry
+    {
+        uint64_t pipeline{0};
+        std::chrono::microseconds startTime{0};
+        std::chrono::microseconds endTime{0};
+        double resolution{0};
+        std::shared_ptr<const Waveform<T>> waveform;
+    };
+    ProcessedWaveformCache() = default;
+    ProcessedWaveformCache(const ProcessedWaveformCache &)
+    {
+    }
+    ProcessedWaveformCache& operator=(const ProcessedWaveformCache &)
+    {
+        clear();
+        return *this;
+    }
+    /// @result The memoized waveform or NULL if it is not in the cache.
+    [[nodiscard]] std::shared_ptr<const Waveform<T>>
+        find(const uint64_t pipeline,
+             const std::chrono::microseconds &startTime,
+             const std::chrono::microseconds &endTime,
+             const double resolution) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it)
+        {
+            if (it->pipeline == pipeline &&
+                it->startTime == startTime &&
+                it->endTime == endTime &&
+                it->resolution == resolution)
+            {
+                // Keep the most recently used entry in front
+                std::rotate(mEntries.begin(), it, it + 1);
+                return mEntries.front().waveform;
+            }
+        }
+        return nullptr;
+    }
+    void insert(Entry &&entry) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (static_cast<int> (mEntries.size()) >= CAPACITY)
+        {
+            mEntries.pop_back();
+        }
+        mEntries.insert(mEntries.begin(), std::move(entry));
+    }
+    void clear() noexcept
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries.clear();
+    }
+private:
+    /// A few windows suffice for toggling between zoom levels.
+    static constexpr int CAPACITY{4};
+    mutable std::mutex mMutex;
+    mutable std::vector<Entry> mEntries;
+};
+
 }
 
 template<class T>
@@ -24,6 +95,8 @@ class Channel<T>::ChannelImpl
 {
 public:
     Waveform<T> mWaveform;
+    QPhase::Processing::Pipeline<T> mPipeline;
+    ProcessedWaveformCache<T> mProcessedWaveforms;
     SimpleResponse mSimpleResponse;
     std::string mChannelCode;
     double mDip{0}; 
@@ -220,6 +293,7 @@ void Channel<T>::setWaveform(Waveform<T> &&waveform)
 {
     pImpl->mWaveform = std::move(waveform);
     pImpl->mHaveWaveform = true;
+    pImpl->mProcessedWaveforms.clear();
 }
 
 template<class T>
@@ -227,6 +301,7 @@ void Channel<T>::setWaveform(const Waveform<T> &waveform)
 {
     pImpl->mWaveform = waveform;
     pImpl->mHaveWaveform = true;
+    pImpl->mProcessedWaveforms.clear();
 }
 
 template<class T>
@@ -249,6 +324,56 @@ bool Channel<T>::haveWaveform() const noexcept
     return pImpl->mHaveWaveform;
 }
 
+/// Processing
+template<class T>
+void Channel<T>::setProcessingPipeline(
+    const QPhase::Processing::Pipeline<T> &pipeline)
+{
+    pImpl->mPipeline = pipeline;
+    pImpl->mProcessedWaveforms.clear();
+}
+
+template<class T>
+const QPhase::Processing::Pipeline<T>&
+    Channel<T>::getProcessingPipelineReference() const noexcept
+{
+    return pImpl->mPipeline;
+}
+
+template<class T>
+bool Channel<T>::haveProcessingPipeline() const noexcept
+{
+    return pImpl->mPipeline.getNumberOfOperations() > 0;
+}
+
+template<class T>
+std::shared_ptr<const Waveform<T>>
+    Channel<T>::getProcessedWaveform(const std::chrono::microseconds &startTime,
+                                     const std::chrono::microseconds &endTime,
+                                     const double resolution) const
+{
+    if (!haveWaveform()){throw std::runtime_error("Waveform not set");}
+    if (startTime > endTime)
+    {
+        throw std::invalid_argument("Start time exceeds end time");
+    }
+    auto identifier = pImpl->mPipeline.getIdentifier();
+    auto result = pImpl->mProcessedWaveforms.find(identifier,
+                                                  startTime, endTime,
+                                                  resolution);
+    if (result){return result;}
+    // Process outside of the lock; two threads may race to compute the same
+    // window but both get the same answer
+    result = std::make_shared<const Waveform<T>>
+             (pImpl->mPipeline.evaluate(pImpl->mWaveform,
+                                        startTime, endTime, resolution));
+    pImpl->mProcessedWaveforms.insert(
+        typename ProcessedWaveformCache<T>::Entry {identifier,
+                                                   startTime, endTime,
+                                                   resolution, result});
+    return result;
+}
+
 /// Simple response
 template<class T>
 void Channel<T>::setSimpleResponse(const SimpleResponse &response)
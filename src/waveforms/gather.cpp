@@ -0,0 +1,457 @@
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "qphase/waveforms/gather.hpp"
+#include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/threeChannelSensor.hpp"
+#include "qphase/waveforms/singleChannelSensor.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/processing/resampler.hpp"
+#include "private/alignedAllocator.hpp"
+
+using namespace QPhase::Waveforms;
+
+namespace
+{
+
+constexpr std::size_t ALIGNMENT{64};
+const double NaN{std::numeric_limits<double>::quiet_NaN()};
+
+/// @result True indicates the rates are the same to within round-off.
+[[nodiscard]] bool sameRate(const double rate1, const double rate2)
+{
+    return std::abs(rate1 - rate2) <= 1.e-9*std::max(rate1, rate2);
+}
+
+template<class T>
+struct RowSource
+{
+    typename Gather<T>::ChannelMetadata metadata;
+    const Channel<T> *channel{nullptr};
+};
+
+template<class T, class Sensor>
+void setSensorMetadata(const Sensor &sensor,
+                       typename Gather<T>::ChannelMetadata *metadata)
+{
+    metadata->locationCode = sensor.getLocationCode();
+    metadata->latitude = sensor.haveLatitude() ? sensor.getLatitude() : NaN;
+    metadata->longitude = sensor.haveLongitude() ? sensor.getLongitude() : NaN;
+    metadata->elevation = sensor.haveElevation() ? sensor.getElevation() : NaN;
+}
+
+template<class T>
+void addChannel(const Channel<T> &channel,
+                typename Gather<T>::ChannelMetadata metadata,
+                const typename Gather<T>::Component component,
+                std::vector<RowSource<T>> *sources)
+{
+    metadata.component = component;
+    metadata.channel
+        = channel.haveChannelCode() ? channel.getChannelCode() : "";
+    metadata.dip = channel.haveDip() ? channel.getDip() : NaN;
+    metadata.azimuth = channel.haveAzimuth() ? channel.getAzimuth() : NaN;
+    sources->push_back(RowSource<T> {std::move(metadata), &channel});
+}
+
+/// @result The channels of the stations in gather order.
+template<class T>
+std::vector<RowSource<T>> getRowSources(const std::vector<Station<T>> &stations)
+{
+    std::vector<RowSource<T>> sources;
+    for (const auto &station : stations)
+    {
+        typename Gather<T>::ChannelMetadata stationMetadata;
+        if (station.haveNetworkCode())
+        {
+            stationMetadata.network = station.getNetworkCode();
+        }
+        if (station.haveName()){stationMetadata.station = station.getName();}
+        for (const auto &sensor : station.getThreeChannelSensorsReference())
+        {
+            auto metadata = stationMetadata;
+            setSensorMetadata<T>(sensor, &metadata);
+            addChannel(sensor.getVerticalChannelReference(), metadata,
+                       Gather<T>::Component::Vertical, &sources);
+            addChannel(sensor.getNorthChannelReference(), metadata,
+                       Gather<T>::Component::Horizontal1, &sources);
+            addChannel(sensor.getEastChannelReference(), metadata,
+                       Gather<T>::Component::Horizontal2, &sources);
+        }
+        for (const auto &sensor :
+             station.getSingleChannelVerticalSensorsReference())
+        {
+            auto metadata = stationMetadata;
+            setSensorMetadata<T>(sensor, &metadata);
+            addChannel(sensor.getVerticalChannelReference(), metadata,
+                       Gather<T>::Component::Vertical, &sources);
+        }
+        for (const auto &sensor : station.getSingleChannelSensorsReference())
+        {
+            auto metadata = stationMetadata;
+            setSensorMetadata<T>(sensor, &metadata);
+            addChannel(sensor.getChannelReference(), metadata,
+                       Gather<T>::Component::Unknown, &sources);
+        }
+    }
+    return sources;
+}
+
+}
+
+template<class T>
+class Gather<T>::GatherImpl
+{
+public:
+    /// @result The column nearest the given time.
+    [[nodiscard]] int64_t toColumn(const std::chrono::microseconds &time) const
+    {
+        auto dt = static_cast<double> ((time - mStartTime).count())*1.e-6;
+        return std::llround(dt*mSamplingRate);
+    }
+    /// @brief Copies n samples to the row starting at the given column
+    ///        and clips to the gather.
+    void copy(const int row, const int64_t column, const int n, const T *x)
+    {
+        auto c0 = std::max(static_cast<int64_t> (0), column);
+        auto c1 = std::min(static_cast<int64_t> (mSamples), column + n);
+        if (c0 >= c1){return;}
+        auto offset = static_cast<std::size_t> (row)*mLeadingDimension;
+        std::copy(x + (c0 - column), x + (c1 - column),
+                  mData.data() + offset + c0);
+        std::fill(mMask.data() + offset + c0, mMask.data() + offset + c1, 1);
+    }
+    /// @brief Packs a window of a segment sampled at the gather rate.
+    void packSegment(const int row, const Segment<T> &segment,
+                     const typename Waveform<T>::SampleWindow &window)
+    {
+        auto column = toColumn(segment.getSampleTime(window.startIndex));
+        copy(row, column, window.endIndex - window.startIndex,
+             segment.getDataPointer() + window.startIndex);
+    }
+    /// @brief Resamples a window of a segment to the gather rate then packs
+    ///        it.  The window is extended by the filter's half length so the
+    ///        packed samples are not affected by the filter's edges.
+    void resampleSegment(const int row, const Segment<T> &segment,
+                         const typename Waveform<T>::SampleWindow &window)
+    {
+        const auto &resampler = getResampler(segment.getSamplingRate());
+        auto up = resampler.getUpFactor();
+        auto nTaps = static_cast<int>
+                     (resampler.getFilterCoefficients().size());
+        auto margin = nTaps/(2*up) + 1;
+        auto i0 = std::max(0, window.startIndex - margin);
+        auto i1 = std::min(segment.getNumberOfSamples(),
+                           window.endIndex + margin);
+        auto nOut = resampler.getOutputLength(i1 - i0);
+        mResampled.resize(std::max(nOut, 1));
+        resampler.apply(i1 - i0, segment.getDataPointer() + i0,
+                        nOut, mResampled.data());
+        // Only keep the output within the recorded samples of the window
+        auto outputColumn = toColumn(segment.getSampleTime(i0));
+        auto firstColumn = std::max(outputColumn,
+                              toColumn(segment.getSampleTime(window.startIndex)));
+        auto lastColumn = std::min(outputColumn + nOut - 1,
+                              toColumn(segment.getSampleTime(window.endIndex - 1)));
+        if (firstColumn > lastColumn){return;}
+        copy(row, firstColumn, static_cast<int> (lastColumn - firstColumn + 1),
+             mResampled.data() + (firstColumn - outputColumn));
+    }
+    /// @result The resampler from the given rate to the gather rate.
+    const QPhase::Processing::Resampler<T> &getResampler(const double rate)
+    {
+        auto key = std::llround(rate*1.e6);
+        auto it = mResamplers.find(key);
+        if (it != mResamplers.end()){return it->second;}
+        QPhase::Processing::Resampler<T> resampler;
+        resampler.initializeFromSamplingRates(rate, mSamplingRate);
+        return mResamplers.insert(std::pair {key, std::move(resampler)})
+                          .first->second;
+    }
+    std::vector<T, AlignedAllocator<T, ALIGNMENT>> mData;
+    std::vector<uint8_t, AlignedAllocator<uint8_t, ALIGNMENT>> mMask;
+    std::vector<ChannelMetadata> mMetadata;
+    std::map<int64_t, QPhase::Processing::Resampler<T>> mResamplers;
+    std::vector<T> mResampled;
+    std::chrono::microseconds mStartTime{0};
+    double mSamplingRate{0};
+    int mChannels{0};
+    int mSamples{0};
+    int mLeadingDimension{0};
+};
+
+/// C'tor
+template<class T>
+Gather<T>::Gather() :
+    pImpl(std::make_unique<GatherImpl> ())
+{
+}
+
+/// Copy c'tor
+template<class T>
+Gather<T>::Gather(const Gather &gather)
+{
+    *this = gather;
+}
+
+/// Move c'tor
+template<class T>
+Gather<T>::Gather(Gather &&gather) noexcept
+{
+    *this = std::move(gather);
+}
+
+/// Copy assignment
+template<class T>
+Gather<T>& Gather<T>::operator=(const Gather &gather)
+{
+    if (&gather == this){return *this;}
+    pImpl = std::make_unique<GatherImpl> (*gather.pImpl);
+    return *this;
+}
+
+/// Move assignment
+template<class T>
+Gather<T>& Gather<T>::operator=(Gather &&gather) noexcept
+{
+    if (&gather == this){return *this;}
+    pImpl = std::move(gather.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void Gather<T>::clear() noexcept
+{
+    pImpl = std::make_unique<GatherImpl> ();
+}
+
+/// Destructor
+template<class T>
+Gather<T>::~Gather() = default;
+
+/// Build
+template<class T>
+void Gather<T>::build(const std::vector<Station<T>> &stations,
+                      const std::chrono::microseconds &startTime,
+                      const std::chrono::microseconds &endTime,
+                      const double samplingRate)
+{
+    if (startTime > endTime)
+    {
+        throw std::invalid_argument("startTime > endTime");
+    }
+    if (samplingRate <= 0)
+    {
+        throw std::invalid_argument("Sampling rate must be positive");
+    }
+    auto duration = static_cast<double> ((endTime - startTime).count())*1.e-6;
+    auto nSamples = static_cast<int64_t>
+                    (std::floor(duration*samplingRate + 1.e-9)) + 1;
+    if (nSamples > std::numeric_limits<int>::max())
+    {
+        throw std::invalid_argument("Too many samples in window");
+    }
+    auto sources = getRowSources(stations);
+    clear();
+    pImpl->mStartTime = startTime;
+    pImpl->mSamplingRate = samplingRate;
+    pImpl->mChannels = static_cast<int> (sources.size());
+    pImpl->mSamples = static_cast<int> (nSamples);
+    constexpr int padding = static_cast<int> (ALIGNMENT/sizeof(T));
+    pImpl->mLeadingDimension
+        = ((pImpl->mSamples + padding - 1)/padding)*padding;
+    auto nElements = static_cast<std::size_t> (pImpl->mChannels)
+                    *pImpl->mLeadingDimension;
+    pImpl->mData.assign(nElements, 0);
+    pImpl->mMask.assign(nElements, 0);
+    pImpl->mMetadata.reserve(sources.size());
+    for (int row = 0; row < pImpl->mChannels; ++row)
+    {
+        const auto &channel = *sources[row].channel;
+        if (channel.haveWaveform())
+        {
+            const auto &waveform = channel.getWaveformReference();
+            for (const auto &window : waveform.samplesIn(startTime, endTime))
+            {
+                const auto &segment = waveform[window.segment];
+                if (sameRate(segment.getSamplingRate(), samplingRate))
+                {
+                    pImpl->packSegment(row, segment, window);
+                }
+                else
+                {
+                    pImpl->resampleSegment(row, segment, window);
+                }
+            }
+        }
+        auto mask = pImpl->mMask.data()
+                  + static_cast<std::size_t> (row)*pImpl->mLeadingDimension;
+        sources[row].metadata.numberOfValidSamples
+            = static_cast<int> (std::count(mask, mask + pImpl->mSamples, 1));
+        pImpl->mMetadata.push_back(std::move(sources[row].metadata));
+    }
+    pImpl->mResamplers.clear();
+    pImpl->mResampled.clear();
+}
+
+/// Dimensions
+template<class T>
+int Gather<T>::getNumberOfChannels() const noexcept
+{
+    return pImpl->mChannels;
+}
+
+template<class T>
+int Gather<T>::getNumberOfSamples() const noexcept
+{
+    return pImpl->mSamples;
+}
+
+template<class T>
+int Gather<T>::getLeadingDimension() const noexcept
+{
+    return pImpl->mLeadingDimension;
+}
+
+/// Time
+template<class T>
+std::chrono::microseconds Gather<T>::getStartTime() const noexcept
+{
+    return pImpl->mStartTime;
+}
+
+template<class T>
+double Gather<T>::getSamplingRate() const
+{
+    if (pImpl->mSamplingRate <= 0)
+    {
+        throw std::runtime_error("Gather not built");
+    }
+    return pImpl->mSamplingRate;
+}
+
+/// Data
+template<class T>
+const T *Gather<T>::getDataPointer() const noexcept
+{
+    return pImpl->mData.data();
+}
+
+template<class T>
+T *Gather<T>::getDataPointer() noexcept
+{
+    return pImpl->mData.data();
+}
+
+template<class T>
+const T *Gather<T>::getRowPointer(const int channel) const
+{
+    if (channel < 0 || channel >= getNumberOfChannels())
+    {
+        throw std::invalid_argument("Channel out of range");
+    }
+    return pImpl->mData.data()
+         + static_cast<std::size_t> (channel)*pImpl->mLeadingDimension;
+}
+
+template<class T>
+T *Gather<T>::getRowPointer(const int channel)
+{
+    if (channel < 0 || channel >= getNumberOfChannels())
+    {
+        throw std::invalid_argument("Channel out of range");
+    }
+    return pImpl->mData.data()
+         + static_cast<std::size_t> (channel)*pImpl->mLeadingDimension;
+}
+
+/// Mask
+template<class T>
+const uint8_t *Gather<T>::getMaskPointer() const noexcept
+{
+    return pImpl->mMask.data();
+}
+
+template<class T>
+const uint8_t *Gather<T>::getMaskRowPointer(const int channel) const
+{
+    if (channel < 0 || channel >= getNumberOfChannels())
+    {
+        throw std::invalid_argument("Channel out of range");
+    }
+    return pImpl->mMask.data()
+         + static_cast<std::size_t> (channel)*pImpl->mLeadingDimension;
+}
+
+template<class T>
+uint8_t *Gather<T>::getMaskRowPointer(const int channel)
+{
+    if (channel < 0 || channel >= getNumberOfChannels())
+    {
+        throw std::invalid_argument("Channel out of range");
+    }
+    return pImpl->mMask.data()
+         + static_cast<std::size_t> (channel)*pImpl->mLeadingDimension;
+}
+
+template<class T>
+bool Gather<T>::isValid(const int channel, const int sample) const
+{
+    if (sample < 0 || sample >= getNumberOfSamples())
+    {
+        throw std::invalid_argument("Sample out of range");
+    }
+    return getMaskRowPointer(channel)[sample] == 1;
+}
+
+/// Metadata
+template<class T>
+const std::vector<typename Gather<T>::ChannelMetadata> &
+Gather<T>::getMetadataReference() const noexcept
+{
+    return pImpl->mMetadata;
+}
+
+template<class T>
+void Gather<T>::setMetadata(const int channel,
+                            const ChannelMetadata &metadata)
+{
+    if (channel < 0 || channel >= getNumberOfChannels())
+    {
+        throw std::invalid_argument("Channel out of range");
+    }
+    pImpl->mMetadata[channel] = metadata;
+}
+
+template<class T>
+int Gather<T>::findChannel(const std::string &network,
+                           const std::string &station,
+                           const std::string &channel,
+                           const std::string &locationCode) const noexcept
+{
+    for (int row = 0; row < static_cast<int> (pImpl->mMetadata.size()); ++row)
+    {
+        const auto &metadata = pImpl->mMetadata[row];
+        if (metadata.network == network &&
+            metadata.station == station &&
+            metadata.channel == channel &&
+            metadata.locationCode == locationCode)
+        {
+            return row;
+        }
+    }
+    return -1;
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Waveforms::Gather<double>;
+template class QPhase::Waveforms::Gather<float>;
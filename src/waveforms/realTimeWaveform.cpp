@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "qphase/waveforms/realTimeWaveform.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+
+using namespace QPhase::Waveforms;
+
+namespace
+{
+/// Marks a slot that holds no sample and the head of an empty buffer.
+constexpr int64_t NO_INDEX{std::numeric_limits<int64_t>::lowest()};
+/// Bounds the allocation to a few gigabytes.
+constexpr int64_t MAXIMUM_CAPACITY{int64_t {1} << 28};
+}
+
+template<class T>
+class RealTimeWaveform<T>::RealTimeWaveformImpl
+{
+public:
+    /// Samples are kept on a grid whose sample i is at the start time of the
+    /// first packet plus i sampling periods.  Grid sample i lives in slot
+    /// i mod capacity and the slot's stamp records i.  A stamp is set after
+    /// its value is written and is cleared before the value is overwritten
+    /// so a reader that sees the same stamp before and after loading the
+    /// value has a consistent sample (a per-sample sequence lock).
+    [[nodiscard]] int64_t toSlot(const int64_t index) const noexcept
+    {
+        auto slot = index%mCapacity;
+        return slot < 0 ? slot + mCapacity : slot;
+    }
+    /// @result The grid index nearest the time.
+    [[nodiscard]] int64_t nearestIndex(const std::chrono::microseconds &time) const
+    {
+        auto index = mGrid.getSampleIndex(time);
+        if (mGrid.getSampleTime(index + 1) - time <
+            time - mGrid.getSampleTime(index))
+        {
+            index = index + 1;
+        }
+        return index;
+    }
+    /// @result The first grid index at or after the time.
+    [[nodiscard]] int64_t ceilIndex(const std::chrono::microseconds &time) const
+    {
+        auto index = mGrid.getSampleIndex(time);
+        if (mGrid.getSampleTime(index) < time){index = index + 1;}
+        return index;
+    }
+    /// @result True if the sample of the given index was read into value.
+    [[nodiscard]] bool read(const int64_t index, T *value) const noexcept
+    {
+        auto slot = toSlot(index);
+        if (mStamps[slot].load(std::memory_order_acquire) != index)
+        {
+            return false;
+        }
+        *value = mValues[slot].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return mStamps[slot].load(std::memory_order_relaxed) == index;
+    }
+    void write(const int64_t index, const T value) noexcept
+    {
+        auto slot = toSlot(index);
+        mStamps[slot].store(NO_INDEX, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mValues[slot].store(value, std::memory_order_relaxed);
+        mStamps[slot].store(index, std::memory_order_release);
+    }
+    /// @result The lowest index a reader or writer may use given the head.
+    [[nodiscard]] int64_t lowestIndex(const int64_t head) const noexcept
+    {
+        return std::max(mTail.load(std::memory_order_acquire),
+                        head - mCapacity + 1);
+    }
+    Waveform<T> snapshot(int64_t i0, int64_t i1) const
+    {
+        auto head = mHead.load(std::memory_order_acquire);
+        if (head == NO_INDEX){return Waveform<T> {};}
+        i0 = std::max(i0, lowestIndex(head));
+        i1 = std::min(i1, head);
+        std::vector<Segment<T>> segments;
+        std::vector<T> run;
+        int64_t runStart{0};
+        auto closeRun = [&]()
+        {
+            if (run.empty()){return;}
+            Segment<T> segment;
+            segment.setSamplingRate(mNumerator, mDenominator);
+            segment.setStartTime(mGrid.getSampleTime(runStart));
+            segment.setData(std::move(run));
+            segments.push_back(std::move(segment));
+            run = std::vector<T> {};
+        };
+        for (auto index = i0; index <= i1; ++index)
+        {
+            T value;
+            if (read(index, &value))
+            {
+                if (run.empty()){runStart = index;}
+                run.push_back(value);
+            }
+            else
+            {
+                closeRun();
+            }
+        }
+        closeRun();
+        // The writer may have wrapped over the oldest samples while they
+        // were copied.  Those reads are consistent but would leave holes at
+        // the front so trim to what is retained now.
+        auto lowest = lowestIndex(mHead.load(std::memory_order_acquire));
+        segments.erase(
+            std::remove_if(segments.begin(), segments.end(),
+                           [&](const Segment<T> &segment)
+                           {
+                               return segment.getEndTime()
+                                    < mGrid.getSampleTime(lowest);
+                           }),
+            segments.end());
+        Waveform<T> result;
+        if (!segments.empty()){result.setSegments(std::move(segments));}
+        return result;
+    }
+    /// The grid holds no data; it only evaluates sample times and indices.
+    Segment<T> mGrid;
+    std::unique_ptr<std::atomic<T>[]> mValues;
+    std::unique_ptr<std::atomic<int64_t>[]> mStamps;
+    std::atomic<int64_t> mHead{NO_INDEX};
+    std::atomic<int64_t> mTail{NO_INDEX};
+    std::atomic<int64_t> mDropped{0};
+    std::optional<std::chrono::microseconds> mPendingEviction;
+    int64_t mNumerator{0};
+    int64_t mDenominator{1};
+    int64_t mCapacity{0};
+};
+
+/// C'tor
+template<class T>
+RealTimeWaveform<T>::RealTimeWaveform() :
+    pImpl(std::make_unique<RealTimeWaveformImpl> ())
+{
+}
+
+/// Move c'tor
+template<class T>
+RealTimeWaveform<T>::RealTimeWaveform(RealTimeWaveform &&waveform) noexcept
+{
+    *this = std::move(waveform);
+}
+
+/// Move assignment
+template<class T>
+RealTimeWaveform<T>&
+    RealTimeWaveform<T>::operator=(RealTimeWaveform &&waveform) noexcept
+{
+    if (&waveform == this){return *this;}
+    pImpl = std::move(waveform.pImpl);
+    return *this;
+}
+
+/// Reset class
+template<class T>
+void RealTimeWaveform<T>::clear() noexcept
+{
+    pImpl = std::make_unique<RealTimeWaveformImpl> ();
+}
+
+/// Destructor
+template<class T>
+RealTimeWaveform<T>::~RealTimeWaveform() = default;
+
+/// Initialize
+template<class T>
+void RealTimeWaveform<T>::initialize(const double samplingRate,
+                                     const std::chrono::microseconds &retention)
+{
+    Segment<T> grid;
+    grid.setSamplingRate(samplingRate);
+    auto [numerator, denominator] = grid.getSamplingRateAsFraction();
+    initialize(numerator, denominator, retention);
+}
+
+template<class T>
+void RealTimeWaveform<T>::initialize(const int64_t numerator,
+                                     const int64_t denominator,
+                                     const std::chrono::microseconds &retention)
+{
+    if (retention.count() <= 0)
+    {
+        throw std::invalid_argument("Retention must be positive");
+    }
+    Segment<T> grid;
+    grid.setSamplingRate(numerator, denominator);
+    grid.setStartTime(std::chrono::microseconds {0});
+    auto capacity = grid.getSampleIndex(retention) + 1;
+    if (capacity > MAXIMUM_CAPACITY)
+    {
+        throw std::invalid_argument("Retention of "
+                                  + std::to_string(capacity)
+                                  + " samples exceeds "
+                                  + std::to_string(MAXIMUM_CAPACITY));
+    }
+    clear();
+    auto [p, q] = grid.getSamplingRateAsFraction();
+    pImpl->mGrid = std::move(grid);
+    pImpl->mNumerator = p;
+    pImpl->mDenominator = q;
+    pImpl->mCapacity = capacity;
+    pImpl->mValues = std::make_unique<std::atomic<T>[]> (capacity);
+    pImpl->mStamps = std::make_unique<std::atomic<int64_t>[]> (capacity);
+    for (int64_t i = 0; i < capacity; ++i)
+    {
+        pImpl->mValues[i].store(0, std::memory_order_relaxed);
+        pImpl->mStamps[i].store(NO_INDEX, std::memory_order_relaxed);
+    }
+}
+
+template<class T>
+bool RealTimeWaveform<T>::isInitialized() const noexcept
+{
+    return pImpl->mCapacity > 0;
+}
+
+template<class T>
+int RealTimeWaveform<T>::getCapacity() const
+{
+    if (!isInitialized()){throw std::runtime_error("Not initialized");}
+    return static_cast<int> (pImpl->mCapacity);
+}
+
+template<class T>
+double RealTimeWaveform<T>::getSamplingRate() const
+{
+    if (!isInitialized()){throw std::runtime_error("Not initialized");}
+    return pImpl->mGrid.getSamplingRate();
+}
+
+/// Append
+template<class T>
+int RealTimeWaveform<T>::append(const Segment<T> &packet)
+{
+    if (!isInitialized()){throw std::runtime_error("Not initialized");}
+    auto [numerator, denominator] = packet.getSamplingRateAsFraction();
+    if (numerator != pImpl->mNumerator || denominator != pImpl->mDenominator)
+    {
+        throw std::invalid_argument("Packet sampling rate "
+                                  + std::to_string(packet.getSamplingRate())
+                                  + " does not match buffer sampling rate "
+                                  + std::to_string(getSamplingRate()));
+    }
+    auto nSamples = packet.getNumberOfSamples();
+    if (nSamples < 1){return 0;}
+    return append(packet.getStartTime(), nSamples, packet.getDataPointer());
+}
+
+template<class T>
+int RealTimeWaveform<T>::append(const std::chrono::microseconds &startTime,
+                                const int nSamples, const T *data)
+{
+    if (!isInitialized()){throw std::runtime_error("Not initialized");}
+    if (nSamples < 1){return 0;}
+    if (data == nullptr){throw std::invalid_argument("data is NULL");}
+    auto head = pImpl->mHead.load(std::memory_order_relaxed);
+    int64_t i0{0};
+    if (head == NO_INDEX)
+    {
+        // The first packet defines the grid.  Readers only use the grid after
+        // seeing a head so publishing the head below publishes the grid.
+        pImpl->mGrid.setStartTime(startTime);
+        if (pImpl->mPendingEviction)
+        {
+            pImpl->mTail.store(pImpl->ceilIndex(*pImpl->mPendingEviction),
+                               std::memory_order_release);
+            pImpl->mPendingEviction.reset();
+        }
+    }
+    else
+    {
+        i0 = pImpl->nearestIndex(startTime);
+    }
+    auto i1 = i0 + nSamples - 1;
+    // Publish the new head first so readers stop trusting the slots about
+    // to be overwritten
+    auto newHead = (head == NO_INDEX) ? i1 : std::max(head, i1);
+    if (newHead != head)
+    {
+        pImpl->mHead.store(newHead, std::memory_order_release);
+    }
+    auto lowest = pImpl->lowestIndex(newHead);
+    int nStored{0};
+    for (int i = 0; i < nSamples; ++i)
+    {
+        auto index = i0 + i;
+        if (index < lowest){continue;}
+        // Keep the first arrival of a sample
+        auto slot = pImpl->toSlot(index);
+        if (pImpl->mStamps[slot].load(std::memory_order_relaxed) == index)
+        {
+            continue;
+        }
+        pImpl->write(index, data[i]);
+        nStored = nStored + 1;
+    }
+    auto nTooOld = std::clamp(lowest - i0, int64_t {0},
+                              static_cast<int64_t> (nSamples));
+    if (nTooOld > 0)
+    {
+        pImpl->mDropped.fetch_add(nTooOld, std::memory_order_relaxed);
+    }
+    return nStored;
+}
+
+/// Evict
+template<class T>
+void RealTimeWaveform<T>::evict(const std::chrono::microseconds &time)
+{
+    if (!isInitialized()){throw std::runtime_error("Not initialized");}
+    if (!haveData())
+    {
+        if (!pImpl->mPendingEviction || *pImpl->mPendingEviction < time)
+        {
+            pImpl->mPendingEviction = time;
+        }
+        return;
+    }
+    auto tail = pImpl->ceilIndex(time);
+    if (tail > pImpl->mTail.load(std::memory_order_relaxed))
+    {
+        pImpl->mTail.store(tail, std::memory_order_release);
+    }
+}
+
+template<class T>
+int64_t RealTimeWaveform<T>::getNumberOfDroppedSamples() const noexcept
+{
+    return pImpl->mDropped.load(std::memory_order_relaxed);
+}
+
+/// Reader
+template<class T>
+bool RealTimeWaveform<T>::haveData() const noexcept
+{
+    return pImpl->mHead.load(std::memory_order_acquire) != NO_INDEX;
+}
+
+template<class T>
+std::chrono::microseconds RealTimeWaveform<T>::getLatestTime() const
+{
+    auto head = pImpl->mHead.load(std::memory_order_acquire);
+    if (head == NO_INDEX){throw std::runtime_error("No data");}
+    return pImpl->mGrid.getSampleTime(head);
+}
+
+template<class T>
+Waveform<T> RealTimeWaveform<T>::getSnapshot() const
+{
+    return pImpl->snapshot(NO_INDEX, std::numeric_limits<int64_t>::max());
+}
+
+template<class T>
+Waveform<T> RealTimeWaveform<T>::getSnapshot(
+    const std::chrono::microseconds &startTime,
+    const std::chrono::microseconds &endTime) const
+{
+    if (startTime > endTime)
+    {
+        throw std::invalid_argument("Start time exceeds end time");
+    }
+    if (!haveData()){return Waveform<T> {};}
+    return pImpl->snapshot(pImpl->ceilIndex(startTime),
+                           pImpl->mGrid.getSampleIndex(endTime));
+}
+
+///--------------------------------------------------------------------------///
+///                           Template Instantiation                         ///
+///--------------------------------------------------------------------------///
+template class QPhase::Waveforms::RealTimeWaveform<double>;
+template class QPhase::Waveforms::RealTimeWaveform<float>;
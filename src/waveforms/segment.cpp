@@ -1,27 +1,103 @@
 #include <cmath>
+#include <numeric>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include "qphase/waveforms/segment.hpp"
+#include "qphase/processing/kernels.hpp"
 
 using namespace QPhase::Waveforms;
 
+namespace
+{
+using Int128 = __int128;
+
+/// @result floor(a/b) for b > 0.
+Int128 floorDivide(const Int128 a, const Int128 b)
+{
+    auto q = a/b;
+    if (a%b != 0 && a < 0){q = q - 1;}
+    return q;
+}
+
+/// @brief Approximates a sampling rate by the simplest fraction p/q that
+///        is within a relative tolerance of the rate.  The tolerance is
+///        loose enough to absorb single precision sampling periods (e.g.,
+///        a SAC delta of 0.025f becomes 40/1) but tight enough to keep
+///        genuinely non-integral rates.
+std::pair<int64_t, int64_t> toFraction(const double samplingRate)
+{
+    constexpr double relativeTolerance{1.e-7};
+    constexpr int64_t maximumDenominator{1000000000};
+    int64_t p0{0};
+    int64_t q0{1};
+    int64_t p1{1};
+    int64_t q1{0};
+    double r = samplingRate;
+    for (int k = 0; k < 64; ++k)
+    {
+        auto a = static_cast<int64_t> (std::floor(r));
+        auto p2 = a*p1 + p0;
+        auto q2 = a*q1 + q0;
+        if (q2 > maximumDenominator){break;}
+        p0 = p1;
+        q0 = q1;
+        p1 = p2;
+        q1 = q2;
+        if (p1 > 0 &&
+            std::abs(static_cast<double> (p1)/q1 - samplingRate)
+            <= relativeTolerance*samplingRate)
+        {
+            break;
+        }
+        auto fraction = r - a;
+        if (fraction <= 0){break;}
+        r = 1/fraction;
+    }
+    if (p1 < 1 || q1 < 1)
+    {
+        throw std::invalid_argument("Sampling rate is too small");
+    }
+    return std::pair {p1, q1};
+}
+}
+
 template<class T>
 class Segment<T>::SegmentImpl
 {
 public:
+    /// The sampling period is 10^6 q/p microseconds so the i'th sample
+    /// is at t_0 + floor(i 10^6 q/p + 1/2) which is evaluated exactly.
+    [[nodiscard]]
+    std::chrono::microseconds getSampleTime(const int64_t index) const
+    {
+        auto numerator = 2*static_cast<Int128> (index)*1000000
+                        *mSamplingRateDenominator
+                       + mSamplingRateNumerator;
+        auto offset = floorDivide(numerator, 2*static_cast<Int128>
+                                             (mSamplingRateNumerator));
+        return mStartTime
+             + std::chrono::microseconds {static_cast<int64_t> (offset)};
+    }
+    /// The largest i such that floor(i 10^6 q/p + 1/2) <= t - t_0, i.e.,
+    /// ceil((2 (t - t_0) + 1) p/(2 10^6 q)) - 1.
+    [[nodiscard]]
+    int64_t getSampleIndex(const std::chrono::microseconds &time) const
+    {
+        auto offset = static_cast<Int128> ((time - mStartTime).count());
+        auto numerator = (2*offset + 1)*mSamplingRateNumerator;
+        auto denominator = 2*static_cast<Int128> (1000000)
+                          *mSamplingRateDenominator;
+        return static_cast<int64_t> (-floorDivide(-numerator, denominator))
+             - 1;
+    }
     void updateEndTime()
     {
         mEndTime = mStartTime;
-        if (mSamplingRate > 0)
+        if (mSamplingRateNumerator > 0)
         {
             auto nSamples = static_cast<int64_t> (mWaveform.size());
-            if (nSamples > 0)
-            {
-                auto dtMuS = static_cast<int64_t> (std::round( 1000000
-                                                              /mSamplingRate ));
-                mEndTime = mStartTime
-                         + std::chrono::microseconds {(nSamples - 1)*dtMuS};
-            }
+            if (nSamples > 0){mEndTime = getSampleTime(nSamples - 1);}
         } 
     }
 //private:
@@ -29,6 +105,8 @@ public:
     std::chrono::microseconds mStartTime{0};
     std::chrono::microseconds mEndTime{0};
     double mSamplingRate{0};
+    int64_t mSamplingRateNumerator{0};
+    int64_t mSamplingRateDenominator{1};
 };
 
 /// C'tor
@@ -103,17 +181,37 @@ void Segment<T>::setData(const int nSamples, const U *__restrict__ data)
         // Copy data
         pImpl->mWaveform.resize(nSamples);
         T *__restrict__ waveformPtr = pImpl->mWaveform.data();
-        std::copy(data, data + nSamples, waveformPtr);
+        if constexpr (std::is_same<T, U>::value)
+        {
+            std::copy(data, data + nSamples, waveformPtr);
+        }
+        else
+        {
+            QPhase::Processing::convert(nSamples, data, waveformPtr);
+        }
     }
     pImpl->updateEndTime();
 }
 
+template<class T>
+void Segment<T>::setData(std::vector<T> &&data)
+{
+    pImpl->mWaveform = std::move(data);
+    pImpl->updateEndTime();
+}
+
 template<class T>
 const T* Segment<T>::getDataPointer() const noexcept
 {
     return pImpl->mWaveform.data();
 }
 
+template<class T>
+T* Segment<T>::getDataPointer() noexcept
+{
+    return pImpl->mWaveform.data();
+}
+
 template<class T>
 std::vector<T> Segment<T>::getData() const noexcept
 {
@@ -135,10 +233,41 @@ void Segment<T>::setSamplingRate(const double samplingRate)
     {
         throw std::invalid_argument("Sampling rate must be positive");
     }
-    pImpl->mSamplingRate = samplingRate;
+    auto [numerator, denominator] = toFraction(samplingRate);
+    setSamplingRate(numerator, denominator);
+}
+
+template<class T>
+void Segment<T>::setSamplingRate(const int64_t numerator,
+                                 const int64_t denominator)
+{
+    if (numerator <= 0)
+    {
+        throw std::invalid_argument("Numerator must be positive");
+    }
+    if (denominator <= 0)
+    {
+        throw std::invalid_argument("Denominator must be positive");
+    }
+    auto divisor = std::gcd(numerator, denominator);
+    pImpl->mSamplingRateNumerator = numerator/divisor;
+    pImpl->mSamplingRateDenominator = denominator/divisor;
+    pImpl->mSamplingRate = static_cast<double> (pImpl->mSamplingRateNumerator)
+                          /pImpl->mSamplingRateDenominator;
     pImpl->updateEndTime();
 }
 
+template<class T>
+std::pair<int64_t, int64_t> Segment<T>::getSamplingRateAsFraction() const
+{
+    if (!haveSamplingRate())
+    {
+        throw std::runtime_error("Sampling rate not set");
+    }
+    return std::pair {pImpl->mSamplingRateNumerator,
+                      pImpl->mSamplingRateDenominator};
+}
+
 template<class T>
 double Segment<T>::getSamplingPeriod() const
 {
@@ -167,7 +296,7 @@ double Segment<T>::getSamplingRate() const
 template<class T>
 bool Segment<T>::haveSamplingRate() const noexcept
 {
-    return (pImpl->mSamplingRate > 0);
+    return (pImpl->mSamplingRateNumerator > 0);
 }
 
 /// Start time
@@ -198,6 +327,28 @@ std::chrono::microseconds Segment<T>::getEndTime() const noexcept
     return pImpl->mEndTime;
 }
 
+/// Sample index at or before a time
+template<class T>
+int64_t Segment<T>::getSampleIndex(const std::chrono::microseconds &time) const
+{
+    if (!haveSamplingRate())
+    {
+        throw std::runtime_error("Sampling rate not set");
+    }
+    return pImpl->getSampleIndex(time);
+}
+
+/// Time of a sample
+template<class T>
+std::chrono::microseconds Segment<T>::getSampleTime(const int64_t index) const
+{
+    if (!haveSamplingRate())
+    {
+        throw std::runtime_error("Sampling rate not set");
+    }
+    return pImpl->getSampleTime(index);
+}
+
 /// Change precision
 /*
 template<typename T, typename U>
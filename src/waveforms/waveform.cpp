@@ -32,7 +32,12 @@ void checkSegments(const std::vector<Segment<T>> &segments)
         checkSegment(s);
     } 
 }
-
+/// @result True indicates the segments share a sampling rate.
+template<class T>
+bool haveSameSamplingRate(const Segment<T> &a, const Segment<T> &b)
+{
+    return a.getSamplingRateAsFraction() == b.getSamplingRateAsFraction();
+}
 }
 
 template<class T>
@@ -43,11 +48,12 @@ public:
     {
         if (mSegments.empty()){return;}
         if (static_cast<int> (mSegments.size()) == 1){return;}
-        std::sort(mSegments.begin(), mSegments.end(),
-                  [](const Segment<T> &a, const Segment<T> &b)
-                  {
-                      return a.getStartTime() < b.getStartTime();
-                  });
+        // Stable so segments starting together keep their order for merge()
+        std::stable_sort(mSegments.begin(), mSegments.end(),
+                         [](const Segment<T> &a, const Segment<T> &b)
+                         {
+                             return a.getStartTime() < b.getStartTime();
+                         });
     }
     void updateCumulativeNumberOfSamples()
     {
@@ -76,21 +82,196 @@ public:
         mEarliestTime = earliestTime;
         mLatestTime = latestTime;
     }
+    void updateGaps()
+    {
+        mGaps.clear();
+        if (mSegments.empty()){return;}
+        // Segments are sorted by start time but may overlap so track the
+        // latest sample seen so far
+        auto latestTime = mSegments[0].getEndTime();
+        for (size_t i = 1; i < mSegments.size(); ++i)
+        {
+            auto dt = mSegments[i - 1].getSamplingPeriodInMicroSeconds();
+            auto startTime = mSegments[i].getStartTime();
+            if (startTime - latestTime > (3*dt)/2)
+            {
+                mGaps.push_back(std::pair {latestTime, startTime});
+            }
+            latestTime = std::max(latestTime, mSegments[i].getEndTime());
+        }
+    }
+    /// The interval index is the sorted start times and the running
+    /// maximum of the end times.  Both are monotonic so a window query is
+    /// two binary searches.
+    void updateIndex()
+    {
+        mStartTimes.resize(mSegments.size());
+        mMaximumEndTimes.resize(mSegments.size());
+        std::chrono::microseconds maximumEndTime{0};
+        for (size_t i = 0; i < mSegments.size(); ++i)
+        {
+            mStartTimes[i] = mSegments[i].getStartTime();
+            auto endTime = mSegments[i].getEndTime();
+            maximumEndTime = (i == 0) ? endTime :
+                             std::max(maximumEndTime, endTime);
+            mMaximumEndTimes[i] = maximumEndTime;
+        }
+    }
+    [[nodiscard]] std::pair<int, int>
+        getSegmentIndices(const std::chrono::microseconds &t0,
+                          const std::chrono::microseconds &t1) const noexcept
+    {
+        // First segment that could end at or after t0
+        auto first = std::lower_bound(mMaximumEndTimes.begin(),
+                                      mMaximumEndTimes.end(), t0)
+                   - mMaximumEndTimes.begin();
+        // One past the last segment that starts at or before t1
+        auto last = std::upper_bound(mStartTimes.begin(),
+                                     mStartTimes.end(), t1)
+                  - mStartTimes.begin();
+        last = std::max(first, last);
+        return std::pair {static_cast<int> (first), static_cast<int> (last)};
+    }
     void update()
     {
         updateEarliestLatestTime();
         updateCumulativeNumberOfSamples();
         sortTemporally();
+        updateGaps();
+        updateIndex();
+    }
+    /// Coalesces the (sorted) segments in one pass.  The run being
+    /// accumulated is only copied into a work buffer once a second
+    /// segment joins it; lone segments are moved through untouched.
+    void merge(const OverlapPolicy policy, const double tolerance)
+    {
+        auto nRemoved = std::erase_if(mSegments, [](const Segment<T> &segment)
+                                      {
+                                          return segment.getNumberOfSamples() < 1;
+                                      });
+        if (mSegments.size() < 2)
+        {
+            if (nRemoved > 0){update();}
+            return;
+        }
+        std::vector<Segment<T>> mergedSegments;
+        mergedSegments.reserve(mSegments.size());
+        std::vector<T> buffer;
+        // The number of segments averaged into each buffered sample
+        std::vector<int> counts;
+        const bool average = (policy == OverlapPolicy::Average);
+        size_t current{0};
+        bool haveBuffer{false};
+        auto flush = [&]()
+        {
+            if (haveBuffer)
+            {
+                Segment<T> segment;
+                segment.setStartTime(mSegments[current].getStartTime());
+                auto [numerator, denominator]
+                    = mSegments[current].getSamplingRateAsFraction();
+                segment.setSamplingRate(numerator, denominator);
+                segment.setData(std::move(buffer));
+                mergedSegments.push_back(std::move(segment));
+                buffer.clear();
+                counts.clear();
+                haveBuffer = false;
+            }
+            else
+            {
+                mergedSegments.push_back(std::move(mSegments[current]));
+            }
+        };
+        for (size_t i = 1; i < mSegments.size(); ++i)
+        {
+            const auto &segment = mSegments[i];
+            auto nNewSamples = segment.getNumberOfSamples();
+            const auto &reference = mSegments[current];
+            auto nSamples = haveBuffer ?
+                            static_cast<int64_t> (buffer.size()) :
+                            static_cast<int64_t> (reference.getNumberOfSamples());
+            bool canMerge{false};
+            int64_t index{0};
+            if (haveSameSamplingRate(reference, segment))
+            {
+                // Where does this segment land on the reference's grid?
+                auto startTime = segment.getStartTime();
+                index = reference.getSampleIndex(startTime);
+                auto misfit = startTime - reference.getSampleTime(index);
+                auto nextMisfit = reference.getSampleTime(index + 1)
+                                - startTime;
+                if (nextMisfit < misfit)
+                {
+                    index = index + 1;
+                    misfit = nextMisfit;
+                }
+                auto allowedMisfit = tolerance*1.e6
+                                    /reference.getSamplingRate();
+                canMerge = (static_cast<double> (misfit.count())
+                            <= allowedMisfit && index <= nSamples);
+            }
+            if (!canMerge)
+            {
+                flush();
+                current = i;
+                continue;
+            }
+            if (!haveBuffer)
+            {
+                const auto *referencePtr = reference.getDataPointer();
+                buffer.reserve(std::max(nSamples, index + nNewSamples));
+                buffer.assign(referencePtr, referencePtr + nSamples);
+                if (average){counts.assign(nSamples, 1);}
+                haveBuffer = true;
+            }
+            // Resolve the overlapping samples then append the remainder
+            const auto *dataPtr = segment.getDataPointer();
+            auto nOverlap = std::min(static_cast<int64_t> (nNewSamples),
+                                     nSamples - index);
+            if (policy == OverlapPolicy::KeepLast)
+            {
+                std::copy(dataPtr, dataPtr + nOverlap, buffer.data() + index);
+            }
+            else if (average)
+            {
+                // Update the running mean so every segment has equal weight
+                auto *bufferPtr = buffer.data() + index;
+                auto *countsPtr = counts.data() + index;
+                for (int64_t j = 0; j < nOverlap; ++j)
+                {
+                    countsPtr[j] = countsPtr[j] + 1;
+                    bufferPtr[j] = bufferPtr[j]
+                                 + (dataPtr[j] - bufferPtr[j])
+                                  /static_cast<T> (countsPtr[j]);
+                }
+            }
+            buffer.insert(buffer.end(), dataPtr + nOverlap,
+                          dataPtr + nNewSamples);
+            if (average)
+            {
+                counts.resize(buffer.size(), 1);
+            }
+        }
+        flush();
+        mSegments = std::move(mergedSegments);
+        update();
     }
     void clear() noexcept
     {
         mSegments.clear();
+        mGaps.clear();
+        mStartTimes.clear();
+        mMaximumEndTimes.clear();
     }
     std::vector<Segment<T>> mSegments;
     //std::string mNetwork;
     //std::string mStation;
     //std::string mChannel;
     //std::string mLocationCode;
+    std::vector<std::pair<std::chrono::microseconds,
+                          std::chrono::microseconds>> mGaps;
+    std::vector<std::chrono::microseconds> mStartTimes;
+    std::vector<std::chrono::microseconds> mMaximumEndTimes;
     std::chrono::microseconds mEarliestTime{0};
     std::chrono::microseconds mLatestTime{0};
     int mCumulativeNumberOfSamples{0};
@@ -153,6 +334,81 @@ std::vector<Segment<T>> Waveform<T>::getSegments() const noexcept
     return pImpl->mSegments;
 }
 
+/// Find the segment containing a time
+template<class T>
+int Waveform<T>::findSegment(const std::chrono::microseconds &time)
+    const noexcept
+{
+    auto [first, last] = pImpl->getSegmentIndices(time, time);
+    for (int i = last - 1; i >= first; --i)
+    {
+        const auto &segment = pImpl->mSegments[i];
+        if (segment.getStartTime() <= time && time <= segment.getEndTime())
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// Segments that may intersect a window
+template<class T>
+std::pair<int, int> Waveform<T>::getSegmentIndices(
+    const std::chrono::microseconds &t0,
+    const std::chrono::microseconds &t1) const noexcept
+{
+    return pImpl->getSegmentIndices(t0, t1);
+}
+
+/// Samples in a window
+template<class T>
+std::vector<typename Waveform<T>::SampleWindow>
+Waveform<T>::samplesIn(const std::chrono::microseconds &t0,
+                       const std::chrono::microseconds &t1) const
+{
+    if (t0 > t1){throw std::invalid_argument("t0 > t1");}
+    std::vector<SampleWindow> windows;
+    auto [first, last] = pImpl->getSegmentIndices(t0, t1);
+    windows.reserve(last - first);
+    for (int i = first; i < last; ++i)
+    {
+        const auto &segment = pImpl->mSegments[i];
+        auto nSamples = static_cast<int64_t> (segment.getNumberOfSamples());
+        if (nSamples < 1){continue;}
+        // First sample at or after t0 and last sample at or before t1
+        auto i0 = segment.getSampleIndex(t0);
+        if (segment.getSampleTime(i0) < t0){i0 = i0 + 1;}
+        auto i1 = segment.getSampleIndex(t1);
+        i0 = std::max(static_cast<int64_t> (0), i0);
+        i1 = std::min(nSamples - 1, i1);
+        if (i0 > i1){continue;}
+        windows.push_back(SampleWindow {i,
+                                        static_cast<int> (i0),
+                                        static_cast<int> (i1 + 1)});
+    }
+    return windows;
+}
+
+/// Merge
+template<class T>
+void Waveform<T>::merge(const Waveform::OverlapPolicy policy,
+                        const double tolerance)
+{
+    if (tolerance < 0 || tolerance >= 0.5)
+    {
+        throw std::invalid_argument("Tolerance must be in range [0,0.5)");
+    }
+    pImpl->merge(policy, tolerance);
+}
+
+/// Gaps
+template<class T>
+std::vector<std::pair<std::chrono::microseconds, std::chrono::microseconds>>
+Waveform<T>::getGaps() const noexcept
+{
+    return pImpl->mGaps;
+}
+
 /// Load wavefofrm
 template<class T>
 void Waveform<T>::load(const std::string &fileName,
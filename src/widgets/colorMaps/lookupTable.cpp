@@ -0,0 +1,289 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <QColor>
+#include <QImage>
+#include "qphase/widgets/colorMaps/lookupTable.hpp"
+#include "qphase/widgets/colorMaps/colorMap.hpp"
+#include "qphase/processing/kernels.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QPHASE_HAVE_X86_SIMD 1
+#endif
+
+using namespace QPhase::Widgets::ColorMaps;
+
+namespace
+{
+
+/// The color of a NaN.
+constexpr QRgb TRANSPARENT{0};
+
+/// Maps a value to the table index floor((value - offset)*scale + 1/2)
+/// clamped to [0, maxIndex].  The offset is subtracted first so a range far
+/// from zero does not lose precision.
+struct Quantizer
+{
+    float offset{0};
+    float scale{1};
+    float maxIndex{0};
+};
+
+using QuantizeKernel = void (*)(int, const float *, const Quantizer &,
+                                const QRgb *, QRgb *);
+
+void quantizeScalar(const int n, const float *values,
+                    const Quantizer &quantizer,
+                    const QRgb *table, QRgb *colors)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        auto value = values[i];
+        if (std::isnan(value))
+        {
+            colors[i] = TRANSPARENT;
+            continue;
+        }
+        auto index = (value - quantizer.offset)*quantizer.scale + 0.5f;
+        index = std::min(std::max(index, 0.0f), quantizer.maxIndex);
+        colors[i] = table[static_cast<int> (index)];
+    }
+}
+
+#ifdef QPHASE_HAVE_X86_SIMD
+// NaNs are masked out of the gathers so they keep the transparent color.
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+void quantizeAVX2(const int n, const float *values,
+                  const Quantizer &quantizer,
+                  const QRgb *table, QRgb *colors)
+{
+    const auto offset = _mm256_set1_ps(quantizer.offset);
+    const auto scale = _mm256_set1_ps(quantizer.scale);
+    const auto half = _mm256_set1_ps(0.5f);
+    const auto maxIndex = _mm256_set1_ps(quantizer.maxIndex);
+    const auto zero = _mm256_setzero_ps();
+    const auto transparent = _mm256_set1_epi32(static_cast<int> (TRANSPARENT));
+    const auto *lookup = reinterpret_cast<const int *> (table);
+    int i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto value = _mm256_loadu_ps(values + i);
+        auto isNumber = _mm256_castps_si256(_mm256_cmp_ps(value, value,
+                                                          _CMP_ORD_Q));
+        auto index = _mm256_fmadd_ps(_mm256_sub_ps(value, offset), scale, half);
+        index = _mm256_min_ps(_mm256_max_ps(index, zero), maxIndex);
+        auto color = _mm256_mask_i32gather_epi32(transparent, lookup,
+                                                 _mm256_cvttps_epi32(index),
+                                                 isNumber, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *> (colors + i), color);
+    }
+    quantizeScalar(n - i, values + i, quantizer, table, colors + i);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+void quantizeAVX512(const int n, const float *values,
+                    const Quantizer &quantizer,
+                    const QRgb *table, QRgb *colors)
+{
+    const auto offset = _mm512_set1_ps(quantizer.offset);
+    const auto scale = _mm512_set1_ps(quantizer.scale);
+    const auto half = _mm512_set1_ps(0.5f);
+    const auto maxIndex = _mm512_set1_ps(quantizer.maxIndex);
+    const auto zero = _mm512_setzero_ps();
+    const auto transparent = _mm512_set1_epi32(static_cast<int> (TRANSPARENT));
+    int i = 0;
+    for (; i + 16 <= n; i = i + 16)
+    {
+        auto value = _mm512_loadu_ps(values + i);
+        auto isNumber = _mm512_cmp_ps_mask(value, value, _CMP_ORD_Q);
+        auto index = _mm512_fmadd_ps(_mm512_sub_ps(value, offset), scale, half);
+        index = _mm512_maskz_max_ps(isNumber, index, zero);
+        index = _mm512_maskz_min_ps(isNumber, index, maxIndex);
+        auto color = _mm512_mask_i32gather_epi32(
+                         transparent, isNumber,
+                         _mm512_maskz_cvttps_epi32(isNumber, index), table, 4);
+        _mm512_storeu_si512(colors + i, color);
+    }
+    quantizeScalar(n - i, values + i, quantizer, table, colors + i);
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+
+/// @result The quantization kernel for the current instruction set.
+QuantizeKernel getKernel() noexcept
+{
+#ifdef QPHASE_HAVE_X86_SIMD
+    using QPhase::Processing::InstructionSet;
+    auto instructionSet = QPhase::Processing::getInstructionSet();
+    if (instructionSet == InstructionSet::AVX512){return &quantizeAVX512;}
+    if (instructionSet == InstructionSet::AVX2){return &quantizeAVX2;}
+#endif
+    return &quantizeScalar;
+}
+
+}
+
+class LookupTable::LookupTableImpl
+{
+public:
+    std::vector<QRgb> mTable;
+    std::pair<double, double> mRange{0, 1};
+    Quantizer mQuantizer;
+    bool mInitialized{false};
+};
+
+/// Constructor
+LookupTable::LookupTable() :
+    pImpl(std::make_unique<LookupTableImpl> ())
+{
+}
+
+/// Copy constructor
+LookupTable::LookupTable(const LookupTable &table)
+{
+    *this = table;
+}
+
+/// Move constructor
+LookupTable::LookupTable(LookupTable &&table) noexcept
+{
+    *this = std::move(table);
+}
+
+/// Copy assignment
+LookupTable& LookupTable::operator=(const LookupTable &table)
+{
+    if (&table == this){return *this;}
+    pImpl = std::make_unique<LookupTableImpl> (*table.pImpl);
+    return *this;
+}
+
+/// Move assignment
+LookupTable& LookupTable::operator=(LookupTable &&table) noexcept
+{
+    if (&table == this){return *this;}
+    pImpl = std::move(table.pImpl);
+    return *this;
+}
+
+/// Reset class
+void LookupTable::clear() noexcept
+{
+    pImpl = std::make_unique<LookupTableImpl> ();
+}
+
+/// Destructor
+LookupTable::~LookupTable() = default;
+
+/// Initialize
+void LookupTable::initialize(const IColorMap &colorMap, const int nColors)
+{
+    if (!colorMap.isInitialized())
+    {
+        throw std::invalid_argument("Color map not initialized");
+    }
+    if (nColors < 2)
+    {
+        throw std::invalid_argument("Number of colors must be at least 2");
+    }
+    auto range = colorMap.getRange();
+    std::vector<QRgb> table(nColors);
+    const auto dx = (range.second - range.first)/(nColors - 1);
+    for (int i = 0; i < nColors; ++i)
+    {
+        auto x = (i < nColors - 1) ? range.first + i*dx : range.second;
+        table[i] = colorMap.evaluate(x).rgba();
+    }
+    Quantizer quantizer;
+    quantizer.offset = static_cast<float> (range.first);
+    quantizer.scale = static_cast<float> (1/dx);
+    quantizer.maxIndex = static_cast<float> (nColors - 1);
+    pImpl->mTable = std::move(table);
+    pImpl->mRange = range;
+    pImpl->mQuantizer = quantizer;
+    pImpl->mInitialized = true;
+}
+
+/// Initialized?
+bool LookupTable::isInitialized() const noexcept
+{
+    return pImpl->mInitialized;
+}
+
+/// Number of colors
+int LookupTable::getNumberOfColors() const
+{
+    if (!isInitialized()){throw std::runtime_error("Table not initialized");}
+    return static_cast<int> (pImpl->mTable.size());
+}
+
+/// Range
+std::pair<double, double> LookupTable::getRange() const
+{
+    if (!isInitialized()){throw std::runtime_error("Table not initialized");}
+    return pImpl->mRange;
+}
+
+/// Evaluate one value
+QRgb LookupTable::evaluate(const double value) const
+{
+    if (!isInitialized()){throw std::runtime_error("Table not initialized");}
+    auto x = static_cast<float> (value);
+    QRgb color;
+    quantizeScalar(1, &x, pImpl->mQuantizer, pImpl->mTable.data(), &color);
+    return color;
+}
+
+/// Evaluate many values
+void LookupTable::evaluate(const int n, const float *values,
+                           QRgb *colors) const
+{
+    if (!isInitialized()){throw std::runtime_error("Table not initialized");}
+    if (n < 1){return;}
+    if (values == nullptr){throw std::invalid_argument("values is NULL");}
+    if (colors == nullptr){throw std::invalid_argument("colors is NULL");}
+    getKernel()(n, values, pImpl->mQuantizer, pImpl->mTable.data(), colors);
+}
+
+/// Color a scanline
+void LookupTable::fillScanLine(const int n, const float *values,
+                               const int row, QImage *image) const
+{
+    if (!isInitialized()){throw std::runtime_error("Table not initialized");}
+    if (image == nullptr){throw std::invalid_argument("image is NULL");}
+    auto format = image->format();
+    if (format != QImage::Format_RGB32 &&
+        format != QImage::Format_ARGB32 &&
+        format != QImage::Format_ARGB32_Premultiplied)
+    {
+        throw std::invalid_argument("Image format must be 32 bit RGB");
+    }
+    if (row < 0 || row >= image->height())
+    {
+        throw std::invalid_argument("Row must be in range [0,"
+                                  + std::to_string(image->height()) + ")");
+    }
+    if (n > image->width())
+    {
+        throw std::invalid_argument("n cannot exceed image width "
+                                  + std::to_string(image->width()));
+    }
+    evaluate(n, values, reinterpret_cast<QRgb *> (image->scanLine(row)));
+}
@@ -330,6 +330,13 @@ void Parula::initialize(const std::pair<double, double> &range,
     pImpl->mInitialized = true;
 }
 
+/// Range
+std::pair<double, double> Parula::getRange() const
+{
+    if (!isInitialized()){throw std::runtime_error("Parula not initalized");}
+    return pImpl->mRange;
+}
+
 /// Interpolate
 QColor Parula::evaluate(const double value) const
 {
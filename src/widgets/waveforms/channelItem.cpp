@@ -1,12 +1,22 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QFont>
 #include <QGraphicsSceneMouseEvent>
+#include <QImage>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPen>
 #include <QString>
+#include <QThreadPool>
 #include "qphase/widgets/waveforms/channelItem.hpp"
+#include "qphase/widgets/waveforms/traceTileCache.hpp"
 #include "qphase/waveforms/channel.hpp"
 #include "qphase/waveforms/waveform.hpp"
 #include "qphase/waveforms/segment.hpp"
@@ -26,42 +36,507 @@ namespace
         pen.setWidth(0);
         pen.setStyle(Qt::SolidLine);
     }
+    else if (descriptor == WaveformType::CharacteristicFunction)
+    {
+        pen.setColor(Qt::darkRed);
+        pen.setWidth(0);
+        pen.setStyle(Qt::SolidLine);
+    }
     return pen;
 }
+
+/// The width of a raster tile in pixels.
+constexpr int TILE_WIDTH{256};
+
+/// A raster tile and its position on the pixel grid.
+struct Tile
+{
+    std::shared_ptr<const QImage> image;
+    int64_t index{0};
+};
+
+/// The lines or tiles of one waveform type and the plot for which they were
+/// made.
+struct Geometry
+{
+    WaveformLines lines;
+    std::vector<Tile> tiles;
+    double microSecondsPerPixel{0};
+    std::chrono::microseconds startTime{0};
+    std::chrono::microseconds endTime{0};
+    qreal width{0};
+    qreal height{0};
+    uint64_t generation{0};
+};
+
+/// The state shared by an item and its line generation tasks.  A task
+/// holds this and not the item so the item can be destroyed while its
+/// tasks run.
+class RedrawState : public std::enable_shared_from_this<RedrawState>
+{
+public:
+    /// @result True indicates a newer request for the waveform type was
+    ///         made so the task with this generation can be abandoned.
+    [[nodiscard]] bool isStale(const WaveformType waveformType,
+                               const uint64_t generation) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mRequested.find(waveformType);
+        return it == mRequested.end() || it->second != generation;
+    }
+    /// @result The generation of a new request for the waveform type.
+    [[nodiscard]] uint64_t request(const WaveformType waveformType)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mGeneration = mGeneration + 1;
+        mRequested[waveformType] = mGeneration;
+        return mGeneration;
+    }
+    /// Stores the finished lines unless a newer request was made and asks
+    /// the GUI thread to repaint the item.
+    void finish(const WaveformType waveformType, Geometry &&geometry)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mRequested[waveformType] != geometry.generation)
+            {
+                keepSpare(std::move(geometry));
+                return;
+            }
+            mCompleted[waveformType] = geometry.generation;
+            auto &finished = mFinished[waveformType];
+            keepSpare(std::move(finished));
+            finished = std::move(geometry);
+        }
+        mFinishedCondition.notify_all();
+        auto application = QCoreApplication::instance();
+        if (application == nullptr){return;}
+        std::weak_ptr<RedrawState> weakState = shared_from_this();
+        QMetaObject::invokeMethod(application,
+                                  [weakState]()
+                                  {
+                                      auto state = weakState.lock();
+                                      if (state && state->mItem)
+                                      {
+                                          state->mItem->update();
+                                      }
+                                  },
+                                  Qt::QueuedConnection);
+    }
+    /// Nothing is to be drawn for the waveform type.  Any tasks in flight
+    /// are abandoned.
+    void cancel(const WaveformType waveformType)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mGeneration = mGeneration + 1;
+            mRequested[waveformType] = mGeneration;
+            mCompleted[waveformType] = mGeneration;
+            mFinished.erase(waveformType);
+        }
+        mFinishedCondition.notify_all();
+    }
+    /// Discards finished lines that were not yet displayed.
+    void discard(const WaveformType waveformType)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFinished.erase(waveformType);
+    }
+    /// Moves the finished lines to the displayed lines.
+    void swap(std::map<WaveformType, Geometry> *displayed)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto &finished : mFinished)
+        {
+            auto &geometry = (*displayed)[finished.first];
+            keepSpare(std::move(geometry));
+            geometry = std::move(finished.second);
+        }
+        mFinished.clear();
+    }
+    /// @result Geometry whose buffers can be refilled.  Reusing the buffers
+    ///         of replaced lines avoids allocating while zooming.
+    [[nodiscard]] Geometry takeSpare()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mSpare.empty()){return Geometry {};}
+        auto geometry = std::move(mSpare.back());
+        mSpare.pop_back();
+        return geometry;
+    }
+    /// @result True indicates the lines of a request are not displayed.
+    [[nodiscard]] bool isPending(
+        const std::map<WaveformType, Geometry> &displayed) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto &requested : mRequested)
+        {
+            if (mCompleted.count(requested.first) == 0 ||
+                mCompleted.at(requested.first) != requested.second)
+            {
+                return true;
+            }
+            if (mFinished.count(requested.first) > 0){return true;}
+            auto it = displayed.find(requested.first);
+            if (it != displayed.end() &&
+                it->second.generation != requested.second)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    /// Blocks until the latest requests are finished.
+    void wait() const
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mFinishedCondition.wait(lock, [this]()
+        {
+            return std::all_of(mRequested.begin(), mRequested.end(),
+                               [this](const auto &requested)
+                               {
+                                   auto it = mCompleted.find(requested.first);
+                                   return it != mCompleted.end() &&
+                                          it->second == requested.second;
+                               });
+        });
+    }
+    /// The item to repaint.  This is only accessed on the GUI thread.
+    QGraphicsItem *mItem{nullptr};
+private:
+    mutable std::mutex mMutex;
+    mutable std::condition_variable mFinishedCondition;
+    std::map<WaveformType, uint64_t> mRequested;
+    std::map<WaveformType, uint64_t> mCompleted;
+    std::map<WaveformType, Geometry> mFinished;
+    /// Geometry whose buffers are kept for reuse.
+    std::vector<Geometry> mSpare;
+    uint64_t mGeneration{0};
+    /// Keeps the buffers of geometry that is no longer needed.  The mutex
+    /// must be held.
+    void keepSpare(Geometry &&geometry)
+    {
+        // One in flight, one finished, and one displayed per waveform type
+        constexpr size_t maximumSpare{4};
+        if (geometry.lines.segments.empty() || mSpare.size() >= maximumSpare)
+        {
+            return;
+        }
+        geometry.lines.clear();
+        geometry.tiles.clear();
+        mSpare.push_back(std::move(geometry));
+    }
+};
+
+/// Gets the tiles covering a plot from the tile cache and renders the
+/// missing ones.  Unless a range is given the amplitudes are scaled by the
+/// range over the whole waveform, not the plot, so that adjacent tiles agree
+/// and a pan does not change the tiles' keys.
+/// @param[in] waveform  The waveform to draw.  Processed data must be
+///                      processed over the whole channel so the tiles are
+///                      cut from one result that does not depend on the
+///                      plot.
+/// @param[in] key       Identifies the drawn data, its processing, and the
+///                      layer.  The remaining fields are set here.
+template<typename T>
+void createTiles(const QPhase::Waveforms::Waveform<T> &waveform,
+                 TraceTileCache::Key key,
+                 const WaveformType waveformType,
+                 const qreal heightFraction,
+                 const std::pair<T, T> *range,
+                 Geometry *geometry)
+{
+    auto duration = static_cast<double> ((geometry->endTime
+                                        - geometry->startTime).count());
+    if (duration <= 0 || geometry->width < 1 || geometry->height < 1)
+    {
+        return;
+    }
+    std::pair<T, T> plotRange;
+    if (range != nullptr)
+    {
+        plotRange = *range;
+    }
+    else
+    {
+        if (waveform.getNumberOfSegments() < 1){return;} // No data
+        plotRange = getMinMaxForPlotting(waveform,
+                                         waveform.getEarliestTime(),
+                                         waveform.getLatestTime());
+        if (plotRange.first > plotRange.second){return;} // No data
+    }
+    // The grid is anchored at the epoch so tiles are shared while panning
+    auto microSecondsPerPixel = duration/geometry->width;
+    auto tileDuration = microSecondsPerPixel*TILE_WIDTH;
+    auto tileStartTime = [tileDuration](const int64_t tile)
+    {
+        return std::chrono::microseconds
+               {std::llround(static_cast<double> (tile)*tileDuration)};
+    };
+    auto firstTile = static_cast<int64_t>
+        (std::floor(static_cast<double> (geometry->startTime.count())
+                   /tileDuration));
+    auto lastTile = static_cast<int64_t>
+        (std::ceil(static_cast<double> (geometry->endTime.count())
+                  /tileDuration));
+    auto &cache = TraceTileCache::globalInstance();
+    key.microSecondsPerPixel = microSecondsPerPixel;
+    key.height = geometry->height;
+    key.heightFraction = heightFraction;
+    key.minimum = static_cast<double> (plotRange.first);
+    key.maximum = static_cast<double> (plotRange.second);
+    auto imageHeight = static_cast<int> (std::ceil(geometry->height));
+    geometry->microSecondsPerPixel = microSecondsPerPixel;
+    geometry->tiles.reserve(static_cast<size_t> (lastTile - firstTile));
+    // The tiles are rendered one after another from the same buffers
+    auto &lines = geometry->lines;
+    for (auto tile = firstTile; tile < lastTile; ++tile)
+    {
+        key.tile = tile;
+        auto image = cache.find(key);
+        if (image == nullptr)
+        {
+            auto t0 = tileStartTime(tile);
+            auto t1 = tileStartTime(tile + 1);
+            createLines(waveform, t0, t1,
+                        static_cast<qreal> (TILE_WIDTH),
+                        geometry->height, heightFraction,
+                        &plotRange, &lines);
+            auto tileImage
+                = std::make_shared<QImage> (TILE_WIDTH, imageHeight,
+                                            QImage::Format_ARGB32_Premultiplied);
+            tileImage->fill(Qt::transparent);
+            {
+                QPainter painter(tileImage.get());
+                painter.setRenderHint(QPainter::Antialiasing);
+                painter.setPen(waveformDescriptorToPen(waveformType));
+                drawLines(&painter, lines);
+            }
+            image = std::move(tileImage);
+            cache.insert(key, image);
+        }
+        geometry->tiles.push_back(Tile {std::move(image), tile});
+    }
+    lines.clear();
+}
+
 }
 
 template<class T>
 class ChannelItem<T>::ChannelItemImpl
 {
 public:
+    /// Requests the lines for the current plot limits from the worker pool.
+    /// Until they arrive the previous lines are drawn rescaled.
     void redrawWaveform(const WaveformType waveformType = WaveformType::Seismogram,
                         const std::pair<T, T> *range = nullptr)
     {
-        // Remove old lines
-        mLinesToPlot.erase(
-            std::remove_if(mLinesToPlot.begin(), mLinesToPlot.end(),
-                           [&](const std::pair<WaveformType, QVector<QLineF>> &lines)
-                           {
-                               return lines.first == waveformType;
-                           }),
-                           mLinesToPlot.end());
-        auto plotT0MuS = mPlotStartTime;
-        auto plotT1MuS = mPlotEndTime;
-        auto plotWidth  = static_cast<qreal> (mLocalBounds.width());
-        auto plotHeight = static_cast<qreal> (mLocalBounds.height());
-        auto linesToPlot = createLines(mChannel,
-                                       plotT0MuS, plotT1MuS,
-                                       plotWidth, plotHeight,
-                                       mWaveformHeightFraction,
-                                       range);
-        for (auto &lines : linesToPlot)
+        bool isCharacteristicFunction
+            = (waveformType == WaveformType::CharacteristicFunction);
+        if ((isCharacteristicFunction && !mCharacteristicFunction) ||
+            (!isCharacteristicFunction && !mChannel))
+        {
+            mState->cancel(waveformType);
+            mGeometry.erase(waveformType);
+            return;
+        }
+        // The task gets copies of the plot parameters and handles to the
+        // immutable data so it never touches this item
+        auto geometry = mState->takeSpare();
+        geometry.startTime = mPlotStartTime;
+        geometry.endTime = mPlotEndTime;
+        geometry.width = static_cast<qreal> (mLocalBounds.width());
+        geometry.height = static_cast<qreal> (mLocalBounds.height());
+        geometry.generation = mState->request(waveformType);
+        mLinesWidth = geometry.width;
+        mLinesHeight = geometry.height;
+        std::optional<std::pair<T, T>> plotRange;
+        if (isCharacteristicFunction)
+        {
+            plotRange = mCharacteristicFunctionRange;
+        }
+        else if (range != nullptr)
+        {
+            plotRange = *range;
+        }
+        auto heightFraction = mWaveformHeightFraction;
+        auto useTileCache = mUseTileCache;
+        auto channel = mChannel;
+        auto characteristicFunction
+            = isCharacteristicFunction ? mCharacteristicFunction : nullptr;
+        auto state = mState;
+        QThreadPool::globalInstance()->start(
+            [state, waveformType, geometry = std::move(geometry), plotRange,
+             heightFraction, useTileCache, channel = std::move(channel),
+             characteristicFunction = std::move(characteristicFunction)]()
+            mutable
+            {
+                // Skip requests superseded while they were queued
+                if (state->isStale(waveformType, geometry.generation))
+                {
+                    return;
+                }
+                geometry.lines.clear();
+                geometry.tiles.clear();
+                const std::pair<T, T> *rangePointer
+                    = plotRange ? &*plotRange : nullptr;
+                try
+                {
+                    if (useTileCache)
+                    {
+                        using QPhase::Waveforms::Waveform;
+                        TraceTileCache::Key key;
+                        key.layer = static_cast<int> (waveformType);
+                        std::shared_ptr<const Waveform<T>> waveform;
+                        if (characteristicFunction)
+                        {
+                            key.source = TraceTileCache::globalInstance()
+                                        .getSourceIdentifier(
+                                            characteristicFunction);
+                            waveform = characteristicFunction;
+                        }
+                        else
+                        {
+                            key.source = TraceTileCache::globalInstance()
+                                        .getSourceIdentifier(channel);
+                            const auto &data
+                                = channel->getWaveformReference();
+                            waveform = std::shared_ptr<const Waveform<T>>
+                                (channel, &data);
+                            if (channel->haveProcessingPipeline() &&
+                                data.getNumberOfSegments() > 0)
+                            {
+                                // Process the whole channel once per zoom
+                                // level and cut every tile from it so a pan
+                                // is served by the channel's memo.  Four
+                                // samples per pixel as in createLines.
+                                auto duration
+                                    = std::chrono::duration<double>
+                                      (geometry.endTime - geometry.startTime);
+                                auto resolution
+                                    = 4*geometry.width/duration.count();
+                                waveform = channel->getProcessedWaveform(
+                                               data.getEarliestTime(),
+                                               data.getLatestTime(),
+                                               resolution);
+                                key.processing
+                                    = channel->getProcessingPipelineReference()
+                                             .getIdentifier();
+                            }
+                        }
+                        createTiles(*waveform, key, waveformType,
+                                    heightFraction, rangePointer, &geometry);
+                    }
+                    else if (characteristicFunction)
+                    {
+                        createLines(*characteristicFunction,
+                                    geometry.startTime, geometry.endTime,
+                                    geometry.width, geometry.height,
+                                    heightFraction, rangePointer,
+                                    &geometry.lines);
+                    }
+                    else
+                    {
+                        createLines(*channel,
+                                    geometry.startTime, geometry.endTime,
+                                    geometry.width, geometry.height,
+                                    heightFraction, rangePointer,
+                                    &geometry.lines);
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    qWarning() << "Failed to create lines: " << e.what();
+                }
+                state->finish(waveformType, std::move(geometry));
+            });
+    }
+    /// Requests the seismogram and characteristic function lines.
+    void redrawWaveforms()
+    {
+        redrawWaveform();
+        if (mCharacteristicFunction)
         {
-            mLinesToPlot.push_back(std::pair{waveformType,
-                                             std::move(lines)});
+            redrawWaveform(WaveformType::CharacteristicFunction);
         }
     }
-    QPhase::Waveforms::Channel<T> mChannel;
-    QVector<std::pair<WaveformType, QVector<QLineF>>> mLinesToPlot;
+    /// Draws the lines.  Lines made for other plot limits or sizes are
+    /// mapped onto the current plot.
+    void drawGeometry(QPainter *painter)
+    {
+        mState->swap(&mGeometry);
+        auto width = static_cast<qreal> (mLocalBounds.width());
+        auto height = static_cast<qreal> (mLocalBounds.height());
+        auto duration = static_cast<qreal> ((mPlotEndTime
+                                           - mPlotStartTime).count());
+        for (const auto &[waveformType, geometry] : mGeometry)
+        {
+            bool rescale = (geometry.startTime != mPlotStartTime ||
+                            geometry.endTime != mPlotEndTime ||
+                            geometry.width != width ||
+                            geometry.height != height);
+            painter->save();
+            if (rescale)
+            {
+                auto geometryDuration
+                    = static_cast<qreal> ((geometry.endTime
+                                         - geometry.startTime).count());
+                if (duration <= 0 || geometryDuration <= 0 ||
+                    geometry.width <= 0 || geometry.height <= 0)
+                {
+                    painter->restore();
+                    continue;
+                }
+                auto shift = static_cast<qreal> ((geometry.startTime
+                                                - mPlotStartTime).count());
+                painter->setClipRect(mLocalBounds);
+                painter->translate(width*shift/duration, 0);
+                painter->scale(width*geometryDuration
+                              /(geometry.width*duration),
+                               height/geometry.height);
+            }
+            if (!geometry.tiles.empty())
+            {
+                // The tiles overhang the plot
+                if (!rescale){painter->setClipRect(mLocalBounds);}
+                auto origin = static_cast<double> (geometry.startTime.count())
+                             /geometry.microSecondsPerPixel;
+                for (const auto &tile : geometry.tiles)
+                {
+                    auto x = static_cast<double> (tile.index)*TILE_WIDTH
+                           - origin;
+                    painter->drawImage(QPointF(static_cast<qreal> (x), 0),
+                                       *tile.image);
+                }
+            }
+            else
+            {
+                painter->setPen(waveformDescriptorToPen(waveformType));
+                drawLines(painter, geometry.lines);
+            }
+            painter->restore();
+        }
+    }
+    /// @result The horizontal pixel of the given time clamped to the plot.
+    [[nodiscard]] qreal toPixel(const std::chrono::microseconds &time) const
+    {
+        auto duration = static_cast<double> ((mPlotEndTime
+                                            - mPlotStartTime).count());
+        auto width = static_cast<double> (mLocalBounds.width());
+        auto x = width*static_cast<double> ((time - mPlotStartTime).count())
+                /duration;
+        return static_cast<qreal> (std::clamp(x, 0.0, width));
+    }
+    /// The plotted channel is shared with, e.g., the station so that
+    /// building a scene does not copy the samples.
+    std::shared_ptr<const QPhase::Waveforms::Channel<T>> mChannel;
+    std::shared_ptr<const QPhase::Waveforms::Waveform<T>>
+        mCharacteristicFunction;
+    std::shared_ptr<RedrawState> mState{std::make_shared<RedrawState> ()};
+    std::vector<std::pair<std::chrono::microseconds,
+                          std::chrono::microseconds>> mTriggers;
+    /// The displayed lines of each waveform type.
+    std::map<WaveformType, Geometry> mGeometry;
     QString mName;
     QPen mNamePen{Qt::black};
     QPen mWaveformPen{Qt::black, 0, Qt::SolidLine};
@@ -70,6 +545,7 @@ public:
     QPen mGridPen{Qt::gray, 0, Qt::DashLine};
     QPen mMajorTickPen{Qt::black, 0, Qt::SolidLine};
     QPen mMinorTickPen{Qt::black, 0, Qt::SolidLine};
+    QColor mTriggerColor{255, 0, 0, 40};
     QFont mNameFont{"Monospace", 9, QFont::Normal, false};
     QFont mTimeLabelsFont{"Monospace", 9, QFont::Light, false};
     QRectF mLocalBounds{QRect{0, 0, 1, 1}};
@@ -78,8 +554,15 @@ public:
     qreal mMajorTickHeight = 10;
     qreal mMinorTickHeight = 4;
     qreal mWaveformHeightFraction = 0.95;
+    /// Draw the traces from the tile cache.
+    bool mUseTileCache{true};
+    /// The plot width of the latest line request.
+    qreal mLinesWidth{-1};
+    /// The plot height of the latest line request.
+    qreal mLinesHeight{-1};
     std::chrono::microseconds mPlotStartTime{0};
     std::chrono::microseconds mPlotEndTime{0};
+    std::pair<T, T> mCharacteristicFunctionRange{0, 1};
     int mMajorTicks = 5;
     int mMinorTicks = 2*mMajorTicks - 1;
 };
@@ -97,8 +580,11 @@ ChannelItem<T>::ChannelItem(const QRectF &globalBounds,
     pImpl->mLocalBoundsPainterPath.addRect(pImpl->mLocalBounds);
     // Grapics item can be selected
     setFlag(QGraphicsItem::ItemIsSelectable);
-    // Call paint for all redraws
+    // The traces are cached as tiles which, unlike Qt's item cache, are
+    // reused while panning
     setCacheMode(QGraphicsItem::CacheMode::NoCache);
+    // Finished lines repaint this item
+    pImpl->mState->mItem = this;
 }
 
 /// C'tor
@@ -112,39 +598,94 @@ ChannelItem<T>::ChannelItem(const QPhase::Waveforms::Channel<T> &channel,
     setWaveform(channel, waveformType);
 }
 
+/// C'tor
+template<class T>
+ChannelItem<T>::ChannelItem(
+    std::shared_ptr<const QPhase::Waveforms::Channel<T>> channel,
+    const QRectF &globalShape,
+    const WaveformType waveformType,
+    QGraphicsItem *parent) :
+    ChannelItem(globalShape, parent)
+{
+    setWaveform(std::move(channel), waveformType);
+}
+
 /// Destructor
 template<class T>
-ChannelItem<T>::~ChannelItem() = default;
+ChannelItem<T>::~ChannelItem()
+{
+    // Tasks in flight may still finish but will no longer repaint this
+    pImpl->mState->mItem = nullptr;
+}
 
 /// Set the waveform
 template<class T>
 void ChannelItem<T>::setWaveform(const QPhase::Waveforms::Channel<T> &channel,
                                  const WaveformType waveformType)
 {
-    pImpl->mChannel = channel;
-    //auto plotT0MuS = pImpl->mPlotStartTime;
-    //auto plotT1MuS = pImpl->mPlotEndTime;
-//    auto [vMin, vMax] = getMinMaxForPlotting(channel, plotT0MuS, plotT1MuS);
+    setWaveform(std::make_shared<const QPhase::Waveforms::Channel<T>> (channel),
+                waveformType);
+}
+
+/// Set the waveform from a shared channel
+template<class T>
+void ChannelItem<T>::setWaveform(
+    std::shared_ptr<const QPhase::Waveforms::Channel<T>> channel,
+    const WaveformType waveformType)
+{
+    if (channel == nullptr){throw std::invalid_argument("Channel is NULL");}
+    // Lines of another channel must not be shown while these are made
+    if (channel != pImpl->mChannel)
+    {
+        pImpl->mState->discard(waveformType);
+        pImpl->mGeometry.erase(waveformType);
+    }
+    pImpl->mChannel = std::move(channel);
     const std::pair<T, T> *range = nullptr;
     pImpl->redrawWaveform(waveformType, range);
-/*
-    qreal heightFraction{pImpl->mWaveformHeightFraction};
-    const std::pair<U, U> *range = nullptr;
-
-    // Get plot width/height
-    auto plotWidth  = static_cast<qreal> (pImpl->mLocalBounds.width());
-    auto plotHeight = static_cast<qreal> (pImpl->mLocalBounds.height());
-    auto linesToPlot = createLines(channel,
-                                   plotT0MuS, plotT1MuS,
-                                   plotWidth, plotHeight,
-                                   heightFraction,
-                                   range);
-    for (auto &lines : linesToPlot)
-    {
-        pImpl->mLinesToPlot.push_back(std::pair{waveformType,
-                                                std::move(lines)});
+    update();
+}
+
+/// Characteristic function
+template<class T>
+void ChannelItem<T>::setCharacteristicFunction(
+    const QPhase::Waveforms::Waveform<T> &characteristicFunction,
+    const std::vector<std::pair<std::chrono::microseconds,
+                                std::chrono::microseconds>> &triggers)
+{
+    // Share the scale over all segments so that a trigger's level does not
+    // depend on the plot window
+    T maximum{0};
+    for (const auto &segment : characteristicFunction)
+    {
+        auto n = segment.getNumberOfSamples();
+        if (n < 1){continue;}
+        auto x = segment.getDataPointer();
+        maximum = std::max(maximum, *std::max_element(x, x + n));
     }
-*/
+    if (maximum <= 0){maximum = 1;}
+    pImpl->mCharacteristicFunction
+        = std::make_shared<const QPhase::Waveforms::Waveform<T>>
+          (characteristicFunction);
+    pImpl->mCharacteristicFunctionRange = std::pair<T, T> {0, maximum};
+    pImpl->mTriggers = triggers;
+    pImpl->redrawWaveform(WaveformType::CharacteristicFunction);
+    update();
+}
+
+template<class T>
+bool ChannelItem<T>::haveCharacteristicFunction() const noexcept
+{
+    return pImpl->mCharacteristicFunction != nullptr;
+}
+
+template<class T>
+void ChannelItem<T>::clearCharacteristicFunction() noexcept
+{
+    pImpl->mCharacteristicFunction = nullptr;
+    pImpl->mTriggers.clear();
+    pImpl->redrawWaveform(WaveformType::CharacteristicFunction);
+    update();
 }
 
 /// The shape in local coordinates
@@ -168,11 +709,57 @@ void ChannelItem<T>::paint(QPainter *painter,
 {
     drawGrid(painter);
     drawName(painter);
-    for (const auto &linesToPlot : pImpl->mLinesToPlot)
+    // Shade the triggers beneath the traces
+    if (!pImpl->mTriggers.empty() &&
+        pImpl->mPlotEndTime > pImpl->mPlotStartTime)
     {
-        painter->setPen(waveformDescriptorToPen(linesToPlot.first));
-        painter->drawLines(linesToPlot.second);
+        auto height = pImpl->mLocalBounds.height();
+        for (const auto &trigger : pImpl->mTriggers)
+        {
+            if (trigger.second < pImpl->mPlotStartTime ||
+                trigger.first > pImpl->mPlotEndTime)
+            {
+                continue;
+            }
+            auto x0 = pImpl->toPixel(trigger.first);
+            auto x1 = pImpl->toPixel(trigger.second);
+            painter->fillRect(QRectF(x0, 0, std::max<qreal> (x1 - x0, 1),
+                                     height),
+                              pImpl->mTriggerColor);
+        }
     }
+    pImpl->drawGeometry(painter);
+}
+
+/// Redraw pending?
+template<class T>
+bool ChannelItem<T>::isRedrawPending() const
+{
+    return pImpl->mState->isPending(pImpl->mGeometry);
+}
+
+/// Wait for the lines
+template<class T>
+void ChannelItem<T>::waitForRedraw()
+{
+    pImpl->mState->wait();
+    pImpl->mState->swap(&pImpl->mGeometry);
+}
+
+/// Tile cache
+template<class T>
+void ChannelItem<T>::setTileCacheEnabled(const bool enable)
+{
+    if (enable == pImpl->mUseTileCache){return;}
+    pImpl->mUseTileCache = enable;
+    pImpl->redrawWaveforms();
+    update();
+}
+
+template<class T>
+bool ChannelItem<T>::isTileCacheEnabled() const noexcept
+{
+    return pImpl->mUseTileCache;
 }
 
 /// Set the channel's name
@@ -310,10 +897,40 @@ void ChannelItem<T>::setAbsoluteTimeLimits(
     // Drawing event necessary.  Trigger event.
     if (lRedraw)
     {
-        pImpl->redrawWaveform();
+        pImpl->redrawWaveforms();
+        update();
     }
 }
 
+/// Resize
+template<class T>
+void ChannelItem<T>::setGlobalShape(const QRectF &globalShape)
+{
+    if (globalShape == pImpl->mGlobalBounds){return;}
+    prepareGeometryChange();
+    pImpl->mGlobalBounds = globalShape;
+    pImpl->mLocalBounds  = globalShape;
+    pImpl->mLocalBoundsPainterPath = QPainterPath{};
+    pImpl->mLocalBoundsPainterPath.addRect(pImpl->mLocalBounds);
+    // The current lines are stretched onto the new size until
+    // finishResize() is called
+    update();
+}
+
+/// Resize settled
+template<class T>
+void ChannelItem<T>::finishResize()
+{
+    // Vector lines scale exactly with the height but the decimation depends
+    // on the number of horizontal pixels.  Tiles are rasters so stretching
+    // them blurs the trace and thickens its strokes.
+    bool sameWidth = (pImpl->mLinesWidth == pImpl->mLocalBounds.width());
+    bool sameHeight = (pImpl->mLinesHeight == pImpl->mLocalBounds.height());
+    if (sameWidth && (sameHeight || !pImpl->mUseTileCache)){return;}
+    pImpl->redrawWaveforms();
+    update();
+}
+
 /// Current
 template<class T>
 void ChannelItem<T>::mousePressEvent(QGraphicsSceneMouseEvent *event)
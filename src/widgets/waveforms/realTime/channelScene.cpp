@@ -0,0 +1,623 @@
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <QColor>
+#include <QDebug>
+#include <QFont>
+#include <QGraphicsItem>
+#include <QGraphicsSceneWheelEvent>
+#include <QImage>
+#include <QPainter>
+#include <QPen>
+#include <QSize>
+#include <QString>
+#include <QTimer>
+#include "qphase/widgets/waveforms/realTime/channelScene.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/realTimeWaveform.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include "qphase/processing/kernels.hpp"
+
+using namespace QPhase::Widgets::Waveforms::RealTime;
+
+namespace
+{
+
+/// Marks a column that has not been rendered.
+constexpr int64_t NO_COLUMN{std::numeric_limits<int64_t>::lowest()};
+
+/// @result floor(a/b) for b > 0.
+int64_t floorDivide(const int64_t a, const int64_t b)
+{
+    auto q = a/b;
+    if (a%b != 0 && a < 0){q = q - 1;}
+    return q;
+}
+
+/// @brief The data behind a trace.  This is either a live waveform or a
+///        channel whose waveform is fixed.
+class Source
+{
+public:
+    /// @result A copy of the samples in [t0, t1].
+    [[nodiscard]] QPhase::Waveforms::Waveform<double>
+        fetch(const std::chrono::microseconds &t0,
+              const std::chrono::microseconds &t1) const
+    {
+        if (mRealTimeWaveform){return mRealTimeWaveform->getSnapshot(t0, t1);}
+        QPhase::Waveforms::Waveform<double> result;
+        const auto &channel = mChannels->at(mChannel);
+        if (!channel.haveWaveform()){return result;}
+        const auto &waveform = channel.getWaveformReference();
+        std::vector<QPhase::Waveforms::Segment<double>> segments;
+        for (const auto &window : waveform.samplesIn(t0, t1))
+        {
+            const auto &segment = waveform[window.segment];
+            auto [numerator, denominator]
+                = segment.getSamplingRateAsFraction();
+            QPhase::Waveforms::Segment<double> slice;
+            slice.setSamplingRate(numerator, denominator);
+            slice.setStartTime(segment.getSampleTime(window.startIndex));
+            slice.setData(window.endIndex - window.startIndex,
+                          segment.getDataPointer() + window.startIndex);
+            segments.push_back(std::move(slice));
+        }
+        if (!segments.empty()){result.setSegments(std::move(segments));}
+        return result;
+    }
+    /// @result True if the source has data in which case time is the time
+    ///         of its latest sample.
+    [[nodiscard]] bool getLatestTime(std::chrono::microseconds *time) const
+    {
+        if (mRealTimeWaveform)
+        {
+            if (!mRealTimeWaveform->haveData()){return false;}
+            *time = mRealTimeWaveform->getLatestTime();
+            return true;
+        }
+        const auto &channel = mChannels->at(mChannel);
+        if (!channel.haveWaveform()){return false;}
+        const auto &waveform = channel.getWaveformReference();
+        if (waveform.getNumberOfSegments() < 1){return false;}
+        *time = waveform.getLatestTime();
+        return true;
+    }
+    std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>>
+        mRealTimeWaveform{nullptr};
+    std::shared_ptr<std::vector<QPhase::Waveforms::Channel<double>>>
+        mChannels{nullptr};
+    size_t mChannel{0};
+};
+
+/// @brief Draws one trace.  Absolute pixel column c covers the times
+///        [c dt, (c + 1) dt) and is stored in raster column c mod width so
+///        the raster is a ring of columns whose right edge advances with
+///        time.
+class TraceItem : public QGraphicsItem
+{
+public:
+    TraceItem(Source source, QString name,
+              const int width, const int height,
+              QGraphicsItem *parent = nullptr) :
+        QGraphicsItem(parent),
+        mSource(std::move(source)),
+        mName(std::move(name)),
+        mImage(std::max(1, width), std::max(1, height),
+               QImage::Format_ARGB32_Premultiplied),
+        mLastValues(static_cast<size_t> (std::max(1, width)),
+                    std::numeric_limits<double>::quiet_NaN())
+    {
+        mImage.fill(mBackgroundColor);
+        setCacheMode(QGraphicsItem::CacheMode::NoCache);
+    }
+    [[nodiscard]] QRectF boundingRect() const override
+    {
+        return QRectF(0, 0, mImage.width(), mImage.height());
+    }
+    void paint(QPainter *painter,
+               const QStyleOptionGraphicsItem *,
+               QWidget *) override
+    {
+        auto width = mImage.width();
+        auto height = mImage.height();
+        if (mRightColumn != NO_COLUMN)
+        {
+            // The column after the right edge is the left edge
+            auto x0 = static_cast<int> (toRaster(mRightColumn + 1));
+            painter->drawImage(QPointF(0, 0), mImage,
+                               QRectF(x0, 0, width - x0, height));
+            if (x0 > 0)
+            {
+                painter->drawImage(QPointF(width - x0, 0), mImage,
+                                   QRectF(0, 0, x0, height));
+            }
+        }
+        painter->setPen(mBorderPen);
+        painter->drawLine(QPointF(0, height), QPointF(width, height));
+        painter->setPen(mNamePen);
+        painter->setFont(mNameFont);
+        painter->drawText(QRectF(width*0.005, height - 15, 150, 12),
+                          Qt::AlignLeft | Qt::AlignTop, mName);
+    }
+    /// @brief Moves the right edge to the given column and rasterizes the
+    ///        samples that arrived since the last call.
+    /// @result True if the raster changed.
+    bool advance(const int64_t rightColumn, const int64_t columnDuration)
+    {
+        auto width = static_cast<int64_t> (mImage.width());
+        auto leftColumn = rightColumn - width + 1;
+        std::chrono::microseconds latestTime{0};
+        bool haveData = mSource.getLatestTime(&latestTime);
+        // Redraw everything when the scale or geometry changed or the edge
+        // moved by more than a raster
+        if (mRightColumn == NO_COLUMN ||
+            columnDuration != mColumnDuration ||
+            rightColumn < mRightColumn ||
+            rightColumn - mRightColumn >= width)
+        {
+            mColumnDuration = columnDuration;
+            mRightColumn = rightColumn;
+            mPendingColumn = NO_COLUMN;
+            mLatestTime = latestTime;
+            rasterizeAll(leftColumn, rightColumn, haveData, latestTime);
+            return true;
+        }
+        bool changed = false;
+        // Scroll: the columns entering on the right are blank
+        for (auto column = mRightColumn + 1; column <= rightColumn; ++column)
+        {
+            clearColumn(column);
+            changed = true;
+        }
+        mRightColumn = rightColumn;
+        // Nothing arrived since the last frame
+        if (!haveData || latestTime == mLatestTime){return changed;}
+        mLatestTime = latestTime;
+        auto latestColumn = floorDivide(latestTime.count(), columnDuration);
+        if (mPendingColumn != NO_COLUMN && latestColumn < mPendingColumn)
+        {
+            return changed;
+        }
+        // Only the columns from the previously partial column to the
+        // latest sample need to be rasterized
+        auto first = (mPendingColumn == NO_COLUMN) ?
+                     leftColumn : std::max(leftColumn, mPendingColumn);
+        auto last = std::min(rightColumn, latestColumn);
+        if (first > last)
+        {
+            mPendingColumn = latestColumn;
+            return changed;
+        }
+        for (auto column = first; column <= last; ++column)
+        {
+            clearColumn(column);
+        }
+        if (!rasterize(first, last))
+        {
+            // The new samples are off scale
+            rasterizeAll(leftColumn, rightColumn, haveData, latestTime);
+            return true;
+        }
+        mPendingColumn = latestColumn;
+        return true;
+    }
+private:
+    [[nodiscard]] int64_t toRaster(const int64_t column) const noexcept
+    {
+        auto width = static_cast<int64_t> (mImage.width());
+        auto x = column%width;
+        return x < 0 ? x + width : x;
+    }
+    [[nodiscard]] std::chrono::microseconds
+        toTime(const int64_t column) const noexcept
+    {
+        return std::chrono::microseconds {column*mColumnDuration};
+    }
+    [[nodiscard]] int toY(const double value) const noexcept
+    {
+        auto height = mImage.height();
+        if (mMaximum <= mMinimum){return height/2;}
+        auto y = (mMaximum - value)/(mMaximum - mMinimum)*(height - 1);
+        return std::clamp(static_cast<int> (std::lround(y)), 0, height - 1);
+    }
+    void clearColumn(const int64_t column)
+    {
+        auto x = static_cast<int> (toRaster(column));
+        auto background = mBackgroundColor.rgba();
+        for (int y = 0; y < mImage.height(); ++y)
+        {
+            reinterpret_cast<QRgb *> (mImage.scanLine(y))[x] = background;
+        }
+        mLastValues[x] = std::numeric_limits<double>::quiet_NaN();
+    }
+    /// @brief Sets the amplitude range from all samples in the window and
+    ///        redraws the window.
+    void rasterizeAll(const int64_t leftColumn, const int64_t rightColumn,
+                      const bool haveData,
+                      const std::chrono::microseconds &latestTime)
+    {
+        mImage.fill(mBackgroundColor);
+        std::fill(mLastValues.begin(), mLastValues.end(),
+                  std::numeric_limits<double>::quiet_NaN());
+        if (!haveData){return;}
+        auto waveform = mSource.fetch(toTime(leftColumn),
+                                      toTime(rightColumn + 1)
+                                    - std::chrono::microseconds {1});
+        auto vMin = std::numeric_limits<double>::max();
+        auto vMax = std::numeric_limits<double>::lowest();
+        for (const auto &segment : waveform)
+        {
+            if (segment.getNumberOfSamples() < 1){continue;}
+            auto [v0, v1] = QPhase::Processing::minMax(segment);
+            vMin = std::min(vMin, v0);
+            vMax = std::max(vMax, v1);
+        }
+        if (vMin <= vMax)
+        {
+            // Leave headroom so that modestly larger arrivals fit
+            auto margin = std::max(0.1*(vMax - vMin), 1.e-10);
+            mMinimum = vMin - margin;
+            mMaximum = vMax + margin;
+            draw(waveform, leftColumn, rightColumn);
+        }
+        mPendingColumn = floorDivide(latestTime.count(), mColumnDuration);
+    }
+    /// @result False if a sample is off scale in which case nothing was
+    ///         drawn.
+    bool rasterize(const int64_t firstColumn, const int64_t lastColumn)
+    {
+        auto waveform = mSource.fetch(toTime(firstColumn),
+                                      toTime(lastColumn + 1)
+                                    - std::chrono::microseconds {1});
+        for (const auto &segment : waveform)
+        {
+            if (segment.getNumberOfSamples() < 1){continue;}
+            auto [v0, v1] = QPhase::Processing::minMax(segment);
+            if (v0 < mMinimum || v1 > mMaximum){return false;}
+        }
+        draw(waveform, firstColumn, lastColumn);
+        return true;
+    }
+    /// @brief Draws the min/max of each column's samples as a vertical line
+    ///        that also reaches the previous column's last sample.
+    void draw(const QPhase::Waveforms::Waveform<double> &waveform,
+              const int64_t firstColumn, const int64_t lastColumn)
+    {
+        auto color = mTracePen.color().rgba();
+        for (const auto &segment : waveform)
+        {
+            auto nSamples = static_cast<int64_t> (segment.getNumberOfSamples());
+            if (nSamples < 1){continue;}
+            const auto x = segment.getDataPointer();
+            auto c0 = std::max(firstColumn,
+                               floorDivide(segment.getStartTime().count(),
+                                           mColumnDuration));
+            auto c1 = std::min(lastColumn,
+                               floorDivide(segment.getEndTime().count(),
+                                           mColumnDuration));
+            for (auto column = c0; column <= c1; ++column)
+            {
+                // First sample at or after the column start
+                auto i0 = segment.getSampleIndex(toTime(column)
+                                     - std::chrono::microseconds {1}) + 1;
+                auto i1 = segment.getSampleIndex(toTime(column + 1)
+                                     - std::chrono::microseconds {1}) + 1;
+                i0 = std::max(int64_t {0}, i0);
+                i1 = std::min(nSamples, i1);
+                if (i0 >= i1){continue;}
+                auto [v0, v1]
+                    = QPhase::Processing::minMax(static_cast<int> (i1 - i0),
+                                                 x + i0);
+                double low = v0;
+                double high = v1;
+                // Connect to the previous column within the segment
+                auto previous = mLastValues[toRaster(column - 1)];
+                if (i0 > 0 && !std::isnan(previous))
+                {
+                    low = std::min(low, previous);
+                    high = std::max(high, previous);
+                }
+                auto raster = static_cast<int> (toRaster(column));
+                mLastValues[raster] = x[i1 - 1];
+                for (auto y = toY(high); y <= toY(low); ++y)
+                {
+                    reinterpret_cast<QRgb *> (mImage.scanLine(y))[raster]
+                        = color;
+                }
+            }
+        }
+    }
+    Source mSource;
+    QString mName;
+    QImage mImage;
+    /// The last sample value in each raster column; NaN if it is empty.
+    std::vector<double> mLastValues;
+    QColor mBackgroundColor{Qt::white};
+    QPen mTracePen{Qt::black, 0, Qt::SolidLine};
+    QPen mBorderPen{Qt::black, 1};
+    QPen mNamePen{Qt::black};
+    QFont mNameFont{"Monospace", 9, QFont::Normal, false};
+    double mMinimum{0};
+    double mMaximum{0};
+    int64_t mRightColumn{NO_COLUMN};
+    /// The column holding the latest rasterized sample.  It may be partial
+    /// so it is redrawn with the next samples.
+    int64_t mPendingColumn{NO_COLUMN};
+    int64_t mColumnDuration{0};
+    /// The latest sample time of the source at the last frame.
+    std::chrono::microseconds mLatestTime{0};
+};
+
+}
+
+class ChannelScene::ChannelSceneImpl
+{
+public:
+    ChannelSceneImpl(const int traceWidth,
+                     const int traceHeight) :
+        mTraceWidth(std::max(200, traceWidth)),
+        mTraceHeight(std::max(20, traceHeight))
+    {
+    }
+    [[nodiscard]] int getNumberOfTraces() const noexcept
+    {
+        int nChannels = mChannels ? static_cast<int> (mChannels->size()) : 0;
+        return nChannels + static_cast<int> (mRealTimeWaveforms.size());
+    }
+    /// Recomputes the trace height given the current plot size
+    void recomputeTraceHeight()
+    {
+        auto availableHeight = static_cast<double> (mCurrentSize.height());
+        int denominator = 1;
+        auto nTraces = getNumberOfTraces();
+        if (nTraces > 0)
+        {
+            denominator = std::min(nTraces, mMaxTracesPerScene);
+        }
+        mTraceHeight = std::max(20,
+                                static_cast<int> (std::floor(availableHeight
+                                                            /denominator)));
+    }
+    /// @result The duration of a pixel column in microseconds.
+    [[nodiscard]] int64_t getColumnDuration() const noexcept
+    {
+        auto duration = (mPlotLatestTime - mPlotEarliestTime).count();
+        return std::max(int64_t {1}, duration/std::max(1, mTraceWidth));
+    }
+    /// @result The time at the right edge of the plot.  Live data sets the
+    ///         right edge when present.
+    [[nodiscard]] std::chrono::microseconds getRightEdgeTime() const
+    {
+        bool haveLiveData = false;
+        std::chrono::microseconds rightEdge{0};
+        for (const auto &waveform : mRealTimeWaveforms)
+        {
+            if (!waveform.second->haveData()){continue;}
+            auto latestTime = waveform.second->getLatestTime();
+            rightEdge = haveLiveData ? std::max(rightEdge, latestTime)
+                                     : latestTime;
+            haveLiveData = true;
+        }
+        return haveLiveData ? rightEdge : mPlotLatestTime;
+    }
+    std::shared_ptr<std::vector<QPhase::Waveforms::Channel<double>>> mChannels;
+    std::vector<std::pair<QString,
+                std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>>>>
+        mRealTimeWaveforms;
+    std::vector<TraceItem *> mTraceItems;
+    QTimer *mTimer{nullptr};
+    QSize mCurrentSize;
+    QColor mBackgroundColor{Qt::white};
+    QString mBackgroundName{tr("Real-Time Viewer")};
+    QFont mBackgroundFont{"Helvetica", 22, QFont::Light, false};
+    std::chrono::microseconds mPlotEarliestTime{0};
+    std::chrono::microseconds mPlotLatestTime{600000000};
+    double mZoomFactor{1.1};
+    int mTraceWidth{400};
+    int mTraceHeight{150};
+    int mMaxTracesPerScene = 9;
+    int mFrameRate{20};
+    bool mNormalZoom{true}; // Wheel forward zooms in
+};
+
+/// C'tor
+ChannelScene::ChannelScene(const int traceWidth,
+                           const int traceHeight,
+                           QObject *parent) :
+    QGraphicsScene(parent),
+    pImpl(std::make_unique<ChannelSceneImpl> (traceWidth, traceHeight))
+{
+    pImpl->mCurrentSize = QSize(static_cast<int> (width()),
+                                static_cast<int> (height()));
+    setBackgroundBrush(pImpl->mBackgroundColor);
+    pImpl->mTimer = new QTimer(this);
+    connect(pImpl->mTimer, &QTimer::timeout, this, [this]()
+            {
+                updatePlot();
+            });
+    populateScene();
+}
+
+/// Destructor
+ChannelScene::~ChannelScene() = default;
+
+/// Resize event
+void ChannelScene::resize(const QSize &newSize)
+{
+    pImpl->mCurrentSize = newSize;
+    pImpl->mTraceWidth = std::max(1, newSize.width());
+    pImpl->recomputeTraceHeight();
+    populateScene(); // replot
+}
+
+/// Time limits
+void ChannelScene::setAbsoluteTimeLimits(
+    const std::pair<std::chrono::microseconds, std::chrono::microseconds>
+    &timeLimits)
+{
+    if (timeLimits.first >= timeLimits.second)
+    {
+        throw std::invalid_argument("timeLimits.first >= timeLimits.second");
+    }
+    pImpl->mPlotEarliestTime = timeLimits.first;
+    pImpl->mPlotLatestTime = timeLimits.second;
+    updatePlot();
+}
+
+void ChannelScene::setRelativeTimeLimits(const std::chrono::microseconds &)
+{
+    // Unsupported: the rasters are on absolute columns
+}
+
+/// Frame rate
+void ChannelScene::setFrameRate(const int framesPerSecond)
+{
+    if (framesPerSecond < 1 || framesPerSecond > 120)
+    {
+        throw std::invalid_argument("Frame rate must be in range [1,120]");
+    }
+    pImpl->mFrameRate = framesPerSecond;
+    if (pImpl->mTimer->isActive())
+    {
+        pImpl->mTimer->start(1000/pImpl->mFrameRate);
+    }
+}
+
+int ChannelScene::getFrameRate() const noexcept
+{
+    return pImpl->mFrameRate;
+}
+
+/// Update the plot.  Each trace keeps its raster and only rasterizes the
+/// columns that scrolled in or received samples.
+void ChannelScene::updatePlot()
+{
+    if (pImpl->mTraceItems.empty()){return;}
+    auto columnDuration = pImpl->getColumnDuration();
+    auto rightColumn = floorDivide(pImpl->getRightEdgeTime().count(),
+                                   columnDuration);
+    for (auto &traceItem : pImpl->mTraceItems)
+    {
+        if (traceItem->advance(rightColumn, columnDuration))
+        {
+            traceItem->update();
+        }
+    }
+}
+
+/// Populate scene
+void ChannelScene::populateScene()
+{
+    clear(); // Deletes the trace items
+    pImpl->mTraceItems.clear();
+    auto nTraces = pImpl->getNumberOfTraces();
+    if (nTraces == 0)
+    {
+        pImpl->mTimer->stop();
+        addSimpleText(pImpl->mBackgroundName, pImpl->mBackgroundFont);
+        return;
+    }
+    qDebug() << "Creating new channel scene with " << nTraces << " traces...";
+    int traceWidth = pImpl->mTraceWidth;
+    int traceHeight = pImpl->mTraceHeight;
+    setSceneRect(0, 0, traceWidth, traceHeight*nTraces);
+    auto addTrace = [&](Source &&source, const QString &name)
+    {
+        auto traceItem = new TraceItem(std::move(source), name,
+                                       traceWidth, traceHeight);
+        auto row = static_cast<int> (pImpl->mTraceItems.size());
+        traceItem->setPos(0, row*traceHeight);
+        pImpl->mTraceItems.push_back(traceItem);
+        addItem(traceItem);
+    };
+    if (pImpl->mChannels)
+    {
+        for (size_t i = 0; i < pImpl->mChannels->size(); ++i)
+        {
+            const auto &channel = pImpl->mChannels->at(i);
+            Source source;
+            source.mChannels = pImpl->mChannels;
+            source.mChannel = i;
+            auto name = channel.haveChannelCode() ?
+                        QString::fromStdString(channel.getChannelCode()) :
+                        QString {};
+            addTrace(std::move(source), name);
+        }
+    }
+    for (const auto &waveform : pImpl->mRealTimeWaveforms)
+    {
+        Source source;
+        source.mRealTimeWaveform = waveform.second;
+        addTrace(std::move(source), waveform.first);
+    }
+    updatePlot();
+    // Only live data needs a frame clock
+    if (!pImpl->mRealTimeWaveforms.empty())
+    {
+        pImpl->mTimer->start(1000/pImpl->mFrameRate);
+    }
+    else
+    {
+        pImpl->mTimer->stop();
+    }
+}
+
+/// Wheel event - control zooms the plot's duration in and out
+void ChannelScene::wheelEvent(QGraphicsSceneWheelEvent *event)
+{
+    event->ignore();
+    if (pImpl->mTraceItems.empty()){return;}
+    if (!(event->modifiers() & Qt::ControlModifier)){return;}
+    bool zoomIn = (event->delta() > 0);
+    if (!pImpl->mNormalZoom){zoomIn = !zoomIn;}
+    auto duration
+        = static_cast<double> ((pImpl->mPlotLatestTime
+                              - pImpl->mPlotEarliestTime).count());
+    duration = zoomIn ? duration/pImpl->mZoomFactor
+                      : duration*pImpl->mZoomFactor;
+    // Keep at least one microsecond per pixel
+    duration = std::max(duration, static_cast<double> (pImpl->mTraceWidth));
+    // Zoom about the right edge since that is where new data arrive
+    auto rightEdge = pImpl->getRightEdgeTime();
+    pImpl->mPlotLatestTime = rightEdge;
+    pImpl->mPlotEarliestTime
+        = rightEdge - std::chrono::microseconds
+                      {static_cast<int64_t> (std::round(duration))};
+    updatePlot();
+    event->accept();
+}
+
+/// Sets the channels
+void ChannelScene::setChannels(
+    std::shared_ptr<std::vector<QPhase::Waveforms::Channel<double>>> &channels)
+{
+    if (channels == nullptr){throw std::invalid_argument("Channels is NULL");}
+    pImpl->mChannels = channels;
+    pImpl->recomputeTraceHeight();
+    populateScene();
+}
+
+/// Adds a live waveform
+void ChannelScene::addRealTimeWaveform(
+    const QString &name,
+    const std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>>
+        &waveform)
+{
+    if (waveform == nullptr){throw std::invalid_argument("Waveform is NULL");}
+    if (!waveform->isInitialized())
+    {
+        throw std::invalid_argument("Waveform not initialized");
+    }
+    pImpl->mRealTimeWaveforms.push_back(std::pair {name, waveform});
+    pImpl->recomputeTraceHeight();
+    populateScene();
+}
+
+void ChannelScene::clearRealTimeWaveforms()
+{
+    pImpl->mRealTimeWaveforms.clear();
+    pImpl->recomputeTraceHeight();
+    populateScene();
+}
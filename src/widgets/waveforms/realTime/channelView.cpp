@@ -1,14 +1,17 @@
 #include <cmath>
 #include <chrono>
+#include <stdexcept>
 #include <vector>
 #include <QDebug>
 #include <QGraphicsView>
 #include <QResizeEvent>
 #include <QScrollBar>
+#include <QString>
 #include "qphase/widgets/waveforms/realTime/channelView.hpp"
 #include "qphase/widgets/waveforms/realTime/channelScene.hpp"
 #include "qphase/waveforms/channel.hpp"
 #include "qphase/waveforms/waveform.hpp"
+#include "qphase/waveforms/realTimeWaveform.hpp"
 #include "qphase/waveforms/threeChannelSensor.hpp"
 #include "qphase/waveforms/singleChannelSensor.hpp"
 #include "qphase/database/internal/event.hpp"
@@ -156,6 +159,15 @@ void ChannelView::setChannels(
     redrawScene();
 }
 
+/// Adds a live channel
+void ChannelView::addRealTimeWaveform(
+    const QString &name,
+    const std::shared_ptr<const QPhase::Waveforms::RealTimeWaveform<double>>
+        &waveform)
+{
+    pImpl->mScene->addRealTimeWaveform(name, waveform);
+}
+
 /// Sets the event that is being processed
 void ChannelView::setEvent(const QPhase::Database::Internal::Event &event)
 {
@@ -53,11 +53,39 @@ StationItem::StationItem(
     setWaveforms(stationWaveforms);
 }
 
+/// C'tor with shared waveform
+template<typename U>
+StationItem::StationItem(
+    std::shared_ptr<const QPhase::Waveforms::Station<U>> stationWaveforms,
+    const QRectF &globalBounds,
+    QGraphicsItem *parent) :
+    StationItem(globalBounds, parent)
+{
+    setWaveforms(std::move(stationWaveforms));
+}
+
 /// Sets the station data
 template<typename U>
 void StationItem::setWaveforms(
     const QPhase::Waveforms::Station<U> &stationWaveforms)
 {
+    setWaveforms(std::make_shared<const QPhase::Waveforms::Station<U>>
+                 (stationWaveforms));
+}
+
+/// Sets the shared station data
+template<typename U>
+void StationItem::setWaveforms(
+    std::shared_ptr<const QPhase::Waveforms::Station<U>> station)
+{
+    if (station == nullptr){throw std::invalid_argument("Station is NULL");}
+    const auto &stationWaveforms = *station;
+    // The channel items alias the station's channels rather than copy them
+    auto share = [&station](const QPhase::Waveforms::Channel<U> &channel)
+    {
+        return std::shared_ptr<const QPhase::Waveforms::Channel<U>>
+               (station, &channel);
+    };
     // Set the name
     pImpl->mName.clear();
     try
@@ -70,11 +98,11 @@ void StationItem::setWaveforms(
     {
         qWarning() << "Failed to set name: " << e.what();
     }
-    auto threeComponentSensors
+    const auto &threeComponentSensors
         = stationWaveforms.getThreeChannelSensorsReference();
-    auto singleComponentVerticalSensors
+    const auto &singleComponentVerticalSensors
         = stationWaveforms.getSingleChannelVerticalSensorsReference(); 
-    auto singleComponentSensors
+    const auto &singleComponentSensors
         = stationWaveforms.getSingleChannelSensorsReference();
     auto nChannels = stationWaveforms.getNumberOfChannels();
     pImpl->mNumberOfChannels = nChannels;
@@ -87,45 +115,45 @@ void StationItem::setWaveforms(
     {
         auto nameBase = pImpl->mName;
         auto locationCode = QString::fromStdString(sensor.getLocationCode());
-        auto verticalChannel = sensor.getVerticalChannelReference();
+        const auto &verticalChannel = sensor.getVerticalChannelReference();
         auto name = nameBase + "."
                   + QString::fromStdString(verticalChannel.getChannelCode());
         if (!locationCode.isEmpty()){name = name + "." + locationCode;}
         auto zChannelItem = new ChannelItem<U>(channelPlotArea, this);
         zChannelItem->setAbsoluteTimeLimits(std::pair{pImpl->mPlotEarliestTime,
                                                       pImpl->mPlotLatestTime});
-        zChannelItem->setWaveform(verticalChannel, WaveformType::Seismogram);
+        zChannelItem->setWaveform(share(verticalChannel), WaveformType::Seismogram);
         zChannelItem->setPos(0, iChannel*channelHeight);
         zChannelItem->setName(name);
         iChannel = iChannel + 1;
 
-        auto northChannel = sensor.getNorthChannelReference();
+        const auto &northChannel = sensor.getNorthChannelReference();
         name = nameBase + "." 
              + QString::fromStdString(northChannel.getChannelCode());
         if (!locationCode.isEmpty()){name = name + "." + locationCode;}
         auto nChannelItem = new ChannelItem<U>(channelPlotArea, this);
         nChannelItem->setAbsoluteTimeLimits(std::pair{pImpl->mPlotEarliestTime,
                                                       pImpl->mPlotLatestTime});
-        nChannelItem->setWaveform(northChannel, WaveformType::Seismogram);
+        nChannelItem->setWaveform(share(northChannel), WaveformType::Seismogram);
         nChannelItem->setPos(0, iChannel*channelHeight);
         nChannelItem->setName(name);
         iChannel = iChannel + 1;
 
-        auto eastChannel = sensor.getEastChannelReference();
+        const auto &eastChannel = sensor.getEastChannelReference();
         name = nameBase + "." 
              + QString::fromStdString(eastChannel.getChannelCode());
         if (!locationCode.isEmpty()){name = name + "." + locationCode;}
         auto eChannelItem = new ChannelItem<U>(channelPlotArea, this);
         eChannelItem->setAbsoluteTimeLimits(std::pair{pImpl->mPlotEarliestTime,
                                                       pImpl->mPlotLatestTime});
-        eChannelItem->setWaveform(eastChannel, WaveformType::Seismogram);
+        eChannelItem->setWaveform(share(eastChannel), WaveformType::Seismogram);
         eChannelItem->setPos(0, iChannel*channelHeight);
         eChannelItem->setName(name);
         iChannel = iChannel + 1;
     }
     for (const auto &sensor : singleComponentVerticalSensors)
     {
-        auto verticalChannel = sensor.getVerticalChannelReference();
+        const auto &verticalChannel = sensor.getVerticalChannelReference();
         auto locationCode = QString::fromStdString(sensor.getLocationCode());
         auto name = pImpl->mName + "." 
                   + QString::fromStdString(verticalChannel.getChannelCode());
@@ -133,14 +161,14 @@ void StationItem::setWaveforms(
         auto zChannelItem = new ChannelItem<U>(channelPlotArea, this);
         zChannelItem->setAbsoluteTimeLimits(std::pair{pImpl->mPlotEarliestTime,
                                                       pImpl->mPlotLatestTime});
-        zChannelItem->setWaveform(verticalChannel, WaveformType::Seismogram);
+        zChannelItem->setWaveform(share(verticalChannel), WaveformType::Seismogram);
         zChannelItem->setPos(0, iChannel*channelHeight);
         zChannelItem->setName(name);
         iChannel = iChannel + 1; 
     }
     for (const auto &sensor : singleComponentSensors)
     {
-        auto channel = sensor.getChannelReference();
+        const auto &channel = sensor.getChannelReference();
         auto locationCode = QString::fromStdString(sensor.getLocationCode());
         auto name = pImpl->mName + "." 
                   + QString::fromStdString(channel.getChannelCode());
@@ -148,7 +176,7 @@ void StationItem::setWaveforms(
         auto channelItem = new ChannelItem<U>(channelPlotArea, this);
         channelItem->setAbsoluteTimeLimits(std::pair{pImpl->mPlotEarliestTime,
                                                      pImpl->mPlotLatestTime});
-        channelItem->setWaveform(channel, WaveformType::Seismogram);
+        channelItem->setWaveform(share(channel), WaveformType::Seismogram);
         channelItem->setPos(0, iChannel*channelHeight);
         channelItem->setName(name);
         iChannel = iChannel + 1;
@@ -182,6 +210,40 @@ QRectF StationItem::boundingRect() const
     return pImpl->mGlobalBounds;
 }
 
+/// Resize
+void StationItem::setGlobalShape(const QRectF &globalShape)
+{
+    if (globalShape == pImpl->mGlobalBounds){return;}
+    prepareGeometryChange();
+    pImpl->mGlobalBounds = globalShape;
+    pImpl->mLocalBounds  = globalShape;
+    pImpl->mLocalBoundsPainterPath = QPainterPath{};
+    pImpl->mLocalBoundsPainterPath.addRect(pImpl->mLocalBounds);
+    // Restack the channels in the new height
+    auto channelWidth  = globalShape.width();
+    auto channelHeight = globalShape.height()
+                        /std::max(1, pImpl->mNumberOfChannels);
+    QRectF channelPlotArea{0, 0, channelWidth, channelHeight};
+    int iChannel = 0;
+    for (auto &childItem : childItems())
+    {
+        auto channelItem = reinterpret_cast<ChannelItem<> *> (childItem);
+        channelItem->setGlobalShape(channelPlotArea);
+        channelItem->setPos(0, iChannel*channelHeight);
+        iChannel = iChannel + 1;
+    }
+}
+
+/// Resize settled
+void StationItem::finishResize()
+{
+    for (auto &childItem : childItems())
+    {
+        auto channelItem = reinterpret_cast<ChannelItem<> *> (childItem);
+        channelItem->finishResize();
+    }
+}
+
 /// Limits
 void StationItem::setAbsoluteTimeLimits(
     const std::pair<std::chrono::microseconds, 
@@ -213,5 +275,15 @@ template QPhase::Widgets::Waveforms::StationItem::StationItem(
 template void QPhase::Widgets::Waveforms::StationItem::setWaveforms(
     const QPhase::Waveforms::Station<double> &);
 template void QPhase::Widgets::Waveforms::StationItem::setWaveforms(
-    const QPhase::Waveforms::Station<float> &); 
+    const QPhase::Waveforms::Station<float> &);
+template QPhase::Widgets::Waveforms::StationItem::StationItem(
+    std::shared_ptr<const QPhase::Waveforms::Station<double>>,
+    const QRectF &, QGraphicsItem *);
+template QPhase::Widgets::Waveforms::StationItem::StationItem(
+    std::shared_ptr<const QPhase::Waveforms::Station<float>>,
+    const QRectF &, QGraphicsItem *);
+template void QPhase::Widgets::Waveforms::StationItem::setWaveforms(
+    std::shared_ptr<const QPhase::Waveforms::Station<double>>);
+template void QPhase::Widgets::Waveforms::StationItem::setWaveforms(
+    std::shared_ptr<const QPhase::Waveforms::Station<float>>); 
 
@@ -1,16 +1,45 @@
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include <QColor>
+#include <QElapsedTimer>
 #include <QFont>
 #include <QGraphicsSceneWheelEvent>
 #include <QString>
+#include <QTimer>
 #include "qphase/widgets/waveforms/stationScene.hpp"
 #include "qphase/widgets/waveforms/stationItem.hpp"
+#include "qphase/widgets/waveforms/channelItem.hpp"
 #include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/threeChannelSensor.hpp"
+#include "qphase/waveforms/singleChannelSensor.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
 
 using namespace QPhase::Widgets::Waveforms;
 
+namespace
+{
+/// A trace in the virtualized scene.  The channel aliases the shared
+/// stations so a row holds no samples.
+struct Row
+{
+    std::shared_ptr<const QPhase::Waveforms::Channel<double>> channel;
+    std::string locationCode;
+    int station{0};
+};
+
+/// An item whose time limits lag the plot's.  Exactly one of the items is
+/// set.
+struct PendingItem
+{
+    QPhase::Widgets::Waveforms::StationItem *stationItem{nullptr};
+    QPhase::Widgets::Waveforms::ChannelItem<double> *channelItem{nullptr};
+    bool visible{false};
+};
+}
+
 class StationScene::StationSceneImpl
 {
 public:
@@ -42,6 +71,315 @@ public:
         mTraceHeight
             = static_cast<int> (std::floor(availableHeight/denominator));
     }
+    /// Lists the channels in the order of the station items
+    void buildRows()
+    {
+        mRows.clear();
+        if (!mStations){return;}
+        auto addRow = [&](const QPhase::Waveforms::Channel<double> &channel,
+                          const std::string &locationCode,
+                          const int station)
+        {
+            Row row;
+            row.channel
+                = std::shared_ptr<const QPhase::Waveforms::Channel<double>>
+                  (mStations, &channel);
+            row.locationCode = locationCode;
+            row.station = station;
+            mRows.push_back(std::move(row));
+        };
+        for (int is = 0; is < static_cast<int> (mStations->size()); ++is)
+        {
+            const auto &station = mStations->at(is);
+            for (const auto &sensor : station.getThreeChannelSensorsReference())
+            {
+                auto locationCode = sensor.getLocationCode();
+                addRow(sensor.getVerticalChannelReference(), locationCode, is);
+                addRow(sensor.getNorthChannelReference(), locationCode, is);
+                addRow(sensor.getEastChannelReference(), locationCode, is);
+            }
+            for (const auto &sensor :
+                 station.getSingleChannelVerticalSensorsReference())
+            {
+                addRow(sensor.getVerticalChannelReference(),
+                       sensor.getLocationCode(), is);
+            }
+            for (const auto &sensor :
+                 station.getSingleChannelSensorsReference())
+            {
+                addRow(sensor.getChannelReference(),
+                       sensor.getLocationCode(), is);
+            }
+        }
+    }
+    /// @result The name of the row's trace, e.g., NETWORK.STATION.CHANNEL.LOC
+    [[nodiscard]] QString getRowName(const Row &row) const
+    {
+        QString name;
+        try
+        {
+            const auto &station = mStations->at(row.station);
+            name = QString::fromStdString(station.getNetworkCode() + "."
+                                        + station.getName() + "."
+                                        + row.channel->getChannelCode());
+            if (!row.locationCode.empty())
+            {
+                name = name + "." + QString::fromStdString(row.locationCode);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            qWarning() << "Failed to set name: " << e.what();
+        }
+        return name;
+    }
+    /// Makes items for the rows in the visible rectangle and its margin.
+    /// Items for rows that scrolled away are recycled.
+    void updateVisibleRows(QGraphicsScene *scene)
+    {
+        auto nRows = static_cast<int> (mRows.size());
+        if (!mVirtualized || nRows == 0 || mTraceHeight < 1){return;}
+        auto traceHeight = static_cast<double> (mTraceHeight);
+        auto visibleRectangle = getVisibleRectangle();
+        auto firstRow = static_cast<int> (std::floor(visibleRectangle.top()
+                                                     /traceHeight))
+                      - mRowMargin;
+        auto lastRow = static_cast<int> (std::floor(visibleRectangle.bottom()
+                                                    /traceHeight))
+                     + mRowMargin;
+        firstRow = std::max(0, firstRow);
+        lastRow = std::min(nRows - 1, lastRow);
+        for (auto it = mVisibleRows.begin(); it != mVisibleRows.end();)
+        {
+            if (it->first < firstRow || it->first > lastRow)
+            {
+                it->second->setVisible(false);
+                mItemPool.push_back(it->second);
+                it = mVisibleRows.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        auto timeLimits = std::pair {mPlotEarliestTime, mPlotLatestTime};
+        for (int iRow = firstRow; iRow <= lastRow; ++iRow)
+        {
+            if (mVisibleRows.count(iRow) > 0){continue;}
+            ChannelItem<double> *channelItem{nullptr};
+            if (mItemPool.empty())
+            {
+                QRectF channelPlotArea{0, 0,
+                                       static_cast<qreal> (mTraceWidth),
+                                       static_cast<qreal> (mTraceHeight)};
+                channelItem = new ChannelItem<double> (channelPlotArea);
+                scene->addItem(channelItem);
+            }
+            else
+            {
+                channelItem = mItemPool.back();
+                mItemPool.pop_back();
+                if (channelItem->haveCharacteristicFunction())
+                {
+                    channelItem->clearCharacteristicFunction();
+                }
+            }
+            const auto &row = mRows[iRow];
+            // Set the limits before the waveform so the lines are only
+            // requested once
+            channelItem->setAbsoluteTimeLimits(timeLimits);
+            channelItem->setWaveform(row.channel, WaveformType::Seismogram);
+            channelItem->setName(getRowName(row));
+            channelItem->setPos(0, 1 + iRow*traceHeight);
+            channelItem->setVisible(true);
+            mVisibleRows.insert(std::pair {iRow, channelItem});
+        }
+    }
+    /// Resizes and restacks the existing items.  Their lines are stretched
+    /// until the resize settles.
+    /// @result False indicates there were no items to resize.
+    bool resizeItems(QGraphicsScene *scene)
+    {
+        auto traceWidth = static_cast<qreal> (mTraceWidth);
+        auto traceHeight = static_cast<qreal> (mTraceHeight);
+        if (mVirtualized)
+        {
+            if (mRows.empty()){return false;}
+            scene->setSceneRect(0, 0, traceWidth,
+                                traceHeight*static_cast<qreal> (mRows.size()));
+            QRectF channelPlotArea{0, 0, traceWidth, traceHeight};
+            for (auto &visibleRow : mVisibleRows)
+            {
+                visibleRow.second->setGlobalShape(channelPlotArea);
+                visibleRow.second->setPos(0, 1 + visibleRow.first*traceHeight);
+            }
+            for (auto &channelItem : mItemPool)
+            {
+                channelItem->setGlobalShape(channelPlotArea);
+            }
+            // More or fewer rows may now fit in the view
+            updateVisibleRows(scene);
+            return true;
+        }
+        if (mStationItemList.empty()){return false;}
+        int nTotalChannels = 0;
+        for (auto &stationItem : mStationItemList)
+        {
+            auto nChannels = stationItem->getNumberOfChannels();
+            stationItem->setGlobalShape(QRectF{0, 0, traceWidth,
+                                               traceHeight*nChannels});
+            stationItem->setPos(0, 1 + nTotalChannels*traceHeight);
+            nTotalChannels = nTotalChannels + nChannels;
+        }
+        scene->setSceneRect(0, 0, traceWidth, traceHeight*nTotalChannels);
+        return true;
+    }
+    /// Regenerates the lines whose decimation changed after a resize
+    void finishResize()
+    {
+        for (auto &stationItem : mStationItemList)
+        {
+            stationItem->finishResize();
+        }
+        for (auto &visibleRow : mVisibleRows)
+        {
+            visibleRow.second->finishResize();
+        }
+    }
+    /// @result The part of the scene shown by the view.
+    [[nodiscard]] QRectF getVisibleRectangle() const
+    {
+        // Until the view reports what it shows assume the top of the scene
+        if (mVisibleRectangle.isEmpty())
+        {
+            auto traceHeight = static_cast<double> (mTraceHeight);
+            return QRectF(0, 0, mTraceWidth, mMaxTracesPerScene*traceHeight);
+        }
+        return mVisibleRectangle;
+    }
+    /// Records that the plot's time limits changed.  The items are updated
+    /// on the next frame so the many wheel deltas of, e.g., a touchpad
+    /// gesture cost one update per frame.
+    void scheduleTimeLimits()
+    {
+        mTimeLimitsChanged = true;
+        if (mFrameTimer->isActive()){return;}
+        // Respond at once unless a frame was just drawn
+        qint64 wait{0};
+        if (mLastFrame.isValid())
+        {
+            wait = std::max<qint64> (0, mFrameInterval - mLastFrame.elapsed());
+        }
+        mFrameTimer->start(static_cast<int> (wait));
+    }
+    /// Queues the items, those in view first, for the latest time limits.
+    void queuePendingItems()
+    {
+        mPendingItems.clear();
+        mNextPendingItem = 0;
+        auto visibleRectangle = getVisibleRectangle();
+        auto traceHeight = static_cast<qreal> (mTraceHeight);
+        auto isVisible = [&visibleRectangle](const qreal top,
+                                             const qreal height)
+        {
+            return top < visibleRectangle.bottom() &&
+                   top + height > visibleRectangle.top();
+        };
+        for (auto &stationItem : mStationItemList)
+        {
+            PendingItem pending;
+            pending.stationItem = stationItem;
+            pending.visible
+                = isVisible(stationItem->pos().y(),
+                            traceHeight*stationItem->getNumberOfChannels());
+            mPendingItems.push_back(pending);
+        }
+        for (auto &visibleRow : mVisibleRows)
+        {
+            PendingItem pending;
+            pending.channelItem = visibleRow.second;
+            pending.visible = isVisible(visibleRow.second->pos().y(),
+                                        traceHeight);
+            mPendingItems.push_back(pending);
+        }
+        std::stable_partition(mPendingItems.begin(), mPendingItems.end(),
+                              [](const PendingItem &pending)
+                              {
+                                  return pending.visible;
+                              });
+    }
+    /// Applies the latest time limits to the items in view and then to
+    /// those out of view until the frame's budget is spent.  The rest are
+    /// deferred to the next frame.  At least one item out of view is updated
+    /// per frame so the deferred items always catch up.
+    void applyTimeLimitsFrame(QGraphicsScene *scene)
+    {
+        mLastFrame.start();
+        if (mTimeLimitsChanged)
+        {
+            queuePendingItems();
+            mTimeLimitsChanged = false;
+        }
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+        auto timeLimits = std::pair {mPlotEarliestTime, mPlotLatestTime};
+        auto nItems = mPendingItems.size();
+        bool updatedHiddenItem{false};
+        for (; mNextPendingItem < nItems; ++mNextPendingItem)
+        {
+            const auto &pending = mPendingItems[mNextPendingItem];
+            if (!pending.visible)
+            {
+                if (updatedHiddenItem &&
+                    frameTimer.nsecsElapsed() >= 1000*mFrameBudget.count())
+                {
+                    break;
+                }
+                updatedHiddenItem = true;
+            }
+            if (pending.stationItem != nullptr)
+            {
+                pending.stationItem->setAbsoluteTimeLimits(timeLimits);
+            }
+            else if (pending.channelItem->isVisible())
+            {
+                // Pooled items get the limits when they are reused
+                pending.channelItem->setAbsoluteTimeLimits(timeLimits);
+            }
+        }
+        if (mNextPendingItem < nItems)
+        {
+            mFrameTimer->start(mFrameInterval);
+        }
+        else
+        {
+            mPendingItems.clear();
+            mNextPendingItem = 0;
+        }
+        scene->update();
+    }
+    /// Forgets the scheduled updates, e.g., because the items were
+    /// replaced or given the time limits directly.
+    void cancelScheduledTimeLimits()
+    {
+        mFrameTimer->stop();
+        mPendingItems.clear();
+        mNextPendingItem = 0;
+        mTimeLimitsChanged = false;
+    }
+    /// Sets the time limits of the materialized items
+    void setItemTimeLimits()
+    {
+        auto timeLimits = std::pair {mPlotEarliestTime, mPlotLatestTime};
+        for (auto &stationItem : mStationItems)
+        {
+            stationItem.second->setAbsoluteTimeLimits(timeLimits);
+        }
+        for (auto &visibleRow : mVisibleRows)
+        {
+            visibleRow.second->setAbsoluteTimeLimits(timeLimits);
+        }
+    }
 ///private:
     std::shared_ptr<std::vector<QPhase::Waveforms::Station<double>>> mStations;
     QSize mCurrentSize;
@@ -53,15 +391,43 @@ public:
     std::chrono::microseconds mOriginalEarliestTime{0};
     std::chrono::microseconds mOriginalLatestTime{0};
     std::map<QString, StationItem *> mStationItems;
+    /// The station items from top to bottom.
+    std::vector<StationItem *> mStationItemList;
+    /// The traces of all channels.  Only the rows near the visible
+    /// rectangle have items when virtualized.
+    std::vector<Row> mRows;
+    std::map<int, ChannelItem<double> *> mVisibleRows;
+    /// Hidden items that are reused as rows scroll into view.
+    std::vector<ChannelItem<double> *> mItemPool;
+    QRectF mVisibleRectangle;
+    /// Fires when a resize has settled.
+    QTimer *mResizeTimer{nullptr};
+    /// Fires when the items' time limits are next updated.
+    QTimer *mFrameTimer{nullptr};
+    /// When the items' time limits were last updated.
+    QElapsedTimer mLastFrame;
+    /// The items still to be given the latest time limits.
+    std::vector<PendingItem> mPendingItems;
+    size_t mNextPendingItem{0};
+    /// The time spent per frame on items out of view.
+    std::chrono::microseconds mFrameBudget{8000};
     double mZoomFactor{1.1};
     int mNumberOfZooms{0};
     int mTraceWidth{400};
     int mTraceHeight{150};
     int mMaxTracesPerScene = 9;
+    int mRowMargin = 3;
+    /// Milliseconds without a resize after which lines are regenerated.
+    int mResizeSettleTime = 150;
+    /// Milliseconds between updates of the items' time limits.
+    int mFrameInterval = 16;
     TimeConvention mTimeConvention{TimeConvention::Absolute};
     bool mNormalZoom{true}; // Wheel forward zooms in
     bool mNormalTimeAdvance{true}; // Wheel in goes back in time
     bool mRedraw{true}; // Something was updated that requires a redraw
+    bool mVirtualized{false};
+    /// The time limits changed since the items were queued.
+    bool mTimeLimitsChanged{false};
 };
 
 
@@ -75,6 +441,19 @@ StationScene::StationScene(const int traceWidth,
     pImpl->mCurrentSize = QSize(static_cast<int> (width()),
                                 static_cast<int> (height()));
     setBackgroundBrush(pImpl->mBackgroundColor);
+    pImpl->mResizeTimer = new QTimer(this);
+    pImpl->mResizeTimer->setSingleShot(true);
+    pImpl->mResizeTimer->setInterval(pImpl->mResizeSettleTime);
+    connect(pImpl->mResizeTimer, &QTimer::timeout, this, [this]()
+            {
+                pImpl->finishResize();
+            });
+    pImpl->mFrameTimer = new QTimer(this);
+    pImpl->mFrameTimer->setSingleShot(true);
+    connect(pImpl->mFrameTimer, &QTimer::timeout, this, [this]()
+            {
+                pImpl->applyTimeLimitsFrame(this);
+            });
     populateScene();
 }
 
@@ -87,7 +466,16 @@ void StationScene::resize(const QSize &newSize)
     pImpl->mCurrentSize = newSize;
     pImpl->mTraceWidth = newSize.width();
     pImpl->recomputeTraceHeight();
-    populateScene(); // replot
+    // Stretch the existing items and only regenerate lines once the user
+    // stops resizing
+    if (pImpl->resizeItems(this))
+    {
+        pImpl->mResizeTimer->start();
+    }
+    else
+    {
+        populateScene(); // replot
+    }
 }
 
 /// Time limits
@@ -104,10 +492,8 @@ void StationScene::setAbsoluteTimeLimits(
     pImpl->mOriginalEarliestTime = timeLimits.first;
     pImpl->mOriginalLatestTime = timeLimits.second;
     pImpl->mTimeConvention = TimeConvention::Absolute;
-    for (auto &stationItem : pImpl->mStationItems)
-    {
-        stationItem.second->setAbsoluteTimeLimits(timeLimits);
-    }
+    pImpl->cancelScheduledTimeLimits();
+    pImpl->setItemTimeLimits();
     updatePlot();
 }
 
@@ -155,7 +541,18 @@ void StationScene::populateScene()
         int traceHeight = pImpl->mTraceHeight;
         setSceneRect(0, 0, traceWidth, traceHeight*nTraces);
         clear();
+        pImpl->cancelScheduledTimeLimits();
         pImpl->mStationItems.clear();
+        pImpl->mStationItemList.clear();
+        pImpl->mVisibleRows.clear();
+        pImpl->mItemPool.clear();
+        pImpl->mRows.clear();
+        if (pImpl->mVirtualized)
+        {
+            pImpl->buildRows();
+            pImpl->updateVisibleRows(this);
+            return;
+        }
         int nTotalChannels = 0;
         for (const auto &station : *pImpl->mStations) 
         {
@@ -163,9 +560,14 @@ void StationScene::populateScene()
             QRectF stationPlotArea{0, 0,
                                    static_cast<qreal> (traceWidth),
                                    static_cast<qreal> (traceHeight*nChannels)};
-            auto stationItem = new StationItem(station, stationPlotArea);
+            // Share the station with its items rather than copy the samples
+            std::shared_ptr<const QPhase::Waveforms::Station<double>>
+                sharedStation(pImpl->mStations, &station);
+            auto stationItem = new StationItem(std::move(sharedStation),
+                                               stationPlotArea);
             pImpl->mStationItems.insert(std::pair(stationItem->getName(),
                                                   stationItem));
+            pImpl->mStationItemList.push_back(stationItem);
             stationItem->setPos(0, 1 + nTotalChannels*traceHeight);
             stationItem->setAbsoluteTimeLimits(axisLimits);
             nTotalChannels = nTotalChannels
@@ -323,17 +725,12 @@ void StationScene::wheelEvent(QGraphicsSceneWheelEvent *event)
             }
         }
     }
-    // Actually update the plot?
+    // Actually update the plot?  The items catch up on the next frame.
     if (updatePlot)
     {
         pImpl->mPlotEarliestTime = plotT0;
         pImpl->mPlotLatestTime = plotT1;
-        for (auto &stationItem : pImpl->mStationItems)
-        {
-            stationItem.second->setAbsoluteTimeLimits(
-               std::pair{pImpl->mPlotEarliestTime, pImpl->mPlotLatestTime});
-        }
-        update();
+        pImpl->scheduleTimeLimits();
     }
     // Was the event handled?
     event->ignore();
@@ -345,6 +742,73 @@ void StationScene::redrawWaveforms()
     populateScene();
 }
 
+/// Frame budget
+void StationScene::setFrameBudget(const std::chrono::microseconds &budget)
+{
+    if (budget.count() < 0)
+    {
+        throw std::invalid_argument("Frame budget cannot be negative");
+    }
+    pImpl->mFrameBudget = budget;
+}
+
+std::chrono::microseconds StationScene::getFrameBudget() const noexcept
+{
+    return pImpl->mFrameBudget;
+}
+
+/// Pending time limits?
+bool StationScene::isTimeLimitUpdatePending() const noexcept
+{
+    return pImpl->mTimeLimitsChanged ||
+           pImpl->mNextPendingItem < pImpl->mPendingItems.size();
+}
+
+/// Apply the pending time limits now
+void StationScene::flushTimeLimits()
+{
+    if (!isTimeLimitUpdatePending()){return;}
+    pImpl->cancelScheduledTimeLimits();
+    pImpl->setItemTimeLimits();
+    update();
+}
+
+/// Virtualization
+void StationScene::setVirtualized(const bool virtualized)
+{
+    if (pImpl->mVirtualized == virtualized){return;}
+    pImpl->mVirtualized = virtualized;
+    populateScene();
+}
+
+bool StationScene::isVirtualized() const noexcept
+{
+    return pImpl->mVirtualized;
+}
+
+/// Visible part of the scene
+void StationScene::setVisibleRectangle(const QRectF &visibleRectangle)
+{
+    pImpl->mVisibleRectangle = visibleRectangle;
+    pImpl->updateVisibleRows(this);
+}
+
+/// Number of channel items
+int StationScene::getNumberOfChannelItems() const noexcept
+{
+    if (pImpl->mVirtualized)
+    {
+        return static_cast<int> (pImpl->mVisibleRows.size()
+                               + pImpl->mItemPool.size());
+    }
+    int nItems = 0;
+    for (const auto &stationItem : pImpl->mStationItems)
+    {
+        nItems = nItems + stationItem.second->getNumberOfChannels();
+    }
+    return nItems;
+}
+
 /// Sets the stations
 void StationScene::setStations(
     std::shared_ptr<std::vector<QPhase::Waveforms::Station<double>>> &stations)
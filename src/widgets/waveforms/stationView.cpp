@@ -27,7 +27,7 @@ std::pair<std::chrono::microseconds, std::chrono::microseconds>
 {
     std::chrono::microseconds tMin{std::numeric_limits<int64_t>::max()};
     std::chrono::microseconds tMax{std::numeric_limits<int64_t>::lowest()};
-    auto sensors3C = station.getThreeChannelSensorsReference();
+    const auto &sensors3C = station.getThreeChannelSensorsReference();
     for (const auto &channel : sensors3C)
     {
         try
@@ -61,7 +61,7 @@ std::pair<std::chrono::microseconds, std::chrono::microseconds>
         {
         }
     }
-    auto sensors1C = station.getSingleChannelVerticalSensorsReference();
+    const auto &sensors1C = station.getSingleChannelVerticalSensorsReference();
     for (const auto &channel : sensors1C)
     {
         try
@@ -75,7 +75,7 @@ std::pair<std::chrono::microseconds, std::chrono::microseconds>
         {
         }
     }
-    auto sensors1NVC = station.getSingleChannelSensorsReference();
+    const auto &sensors1NVC = station.getSingleChannelSensorsReference();
     for (const auto &channel : sensors1NVC)
     {
         try
@@ -125,6 +125,8 @@ StationView::StationView(QWidget *parent) :
     int traceWidth  = static_cast<int> (boundingRect.width());
     
     pImpl->mScene = new StationScene(traceWidth, traceHeight);
+    // Only materialize the traces that can be seen
+    pImpl->mScene->setVirtualized(true);
     setScene(pImpl->mScene);
 
     setRenderHint(QPainter::Antialiasing);
@@ -147,6 +149,22 @@ void StationView::resizeEvent(QResizeEvent *event)
     newSize.setWidth(innerWidth);
     if (pImpl->mScene){pImpl->mScene->resize(newSize);}
     QGraphicsView::resizeEvent(event);
+    updateVisibleRectangle();
+}
+
+/// Scroll event
+void StationView::scrollContentsBy(const int dx, const int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    updateVisibleRectangle();
+}
+
+/// Tells the scene what is visible
+void StationView::updateVisibleRectangle()
+{
+    if (pImpl->mScene == nullptr){return;}
+    pImpl->mScene->setVisibleRectangle(
+        mapToScene(viewport()->rect()).boundingRect());
 }
 
 /// Time limits
@@ -216,12 +234,17 @@ void StationView::setStations(
     // Now get a pointer to the stations
     pImpl->mStations = stations;
     pImpl->mScene->setStations(stations);
+    updateVisibleRectangle();
     redrawScene();
 }
 
 void StationView::redrawWaveforms()
 {
-    if (pImpl->mScene != nullptr){pImpl->mScene->populateScene();}
+    if (pImpl->mScene != nullptr)
+    {
+        pImpl->mScene->populateScene();
+        updateVisibleRectangle();
+    }
 }
 
 /// Sets the event that is being processed
@@ -0,0 +1,187 @@
+#include <list>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <QImage>
+#include "qphase/widgets/waveforms/traceTileCache.hpp"
+
+using namespace QPhase::Widgets::Waveforms;
+
+/// Ordering
+bool TraceTileCache::Key::operator<(const Key &key) const
+{
+    return std::tie(source, processing, layer, microSecondsPerPixel, height,
+                    heightFraction, minimum, maximum, tile)
+         < std::tie(key.source, key.processing, key.layer,
+                    key.microSecondsPerPixel, key.height, key.heightFraction,
+                    key.minimum, key.maximum, key.tile);
+}
+
+class TraceTileCache::TraceTileCacheImpl
+{
+public:
+    using TileList = std::list<Key>;
+    struct Entry
+    {
+        std::shared_ptr<const QImage> image;
+        /// The entry's position in the recently used list.
+        TileList::iterator position;
+        int64_t bytes{0};
+    };
+    /// Evicts the least recently used tiles.  The mutex must be held.
+    void evict()
+    {
+        while (mMemoryUsage > mBudget && !mRecentlyUsed.empty())
+        {
+            auto it = mEntries.find(mRecentlyUsed.back());
+            mMemoryUsage = mMemoryUsage - it->second.bytes;
+            mEntries.erase(it);
+            mRecentlyUsed.pop_back();
+        }
+    }
+    /// Forgets the sources that were released.  The mutex must be held.
+    void pruneSources()
+    {
+        for (auto it = mSources.begin(); it != mSources.end();)
+        {
+            if (it->second.first.expired())
+            {
+                it = mSources.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        mSourcesToPrune = 2*static_cast<int> (mSources.size()) + 64;
+    }
+    mutable std::mutex mMutex;
+    std::map<Key, Entry> mEntries;
+    /// Keys from most to least recently used.
+    TileList mRecentlyUsed;
+    /// The identifiers of the live sources.  The weak pointer detects a
+    /// source that was released and whose address was reused.
+    std::map<const void *,
+             std::pair<std::weak_ptr<const void>, uint64_t>> mSources;
+    int64_t mMemoryUsage{0};
+    int64_t mBudget{64*1024*1024};
+    int64_t mInsertions{0};
+    uint64_t mNextSource{1};
+    int mSourcesToPrune{64};
+};
+
+/// C'tor
+TraceTileCache::TraceTileCache() :
+    pImpl(std::make_unique<TraceTileCacheImpl> ())
+{
+}
+
+/// Shared instance
+TraceTileCache &TraceTileCache::globalInstance()
+{
+    static TraceTileCache cache;
+    return cache;
+}
+
+/// Reset class
+void TraceTileCache::clear() noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mEntries.clear();
+    pImpl->mRecentlyUsed.clear();
+    pImpl->mMemoryUsage = 0;
+}
+
+/// D'tor
+TraceTileCache::~TraceTileCache() = default;
+
+/// Budget
+void TraceTileCache::setBudget(const int64_t bytes)
+{
+    if (bytes < 1){throw std::invalid_argument("Budget must be positive");}
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mBudget = bytes;
+    pImpl->evict();
+}
+
+int64_t TraceTileCache::getBudget() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mBudget;
+}
+
+int64_t TraceTileCache::getMemoryUsage() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mMemoryUsage;
+}
+
+int TraceTileCache::size() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return static_cast<int> (pImpl->mEntries.size());
+}
+
+int64_t TraceTileCache::getNumberOfInsertions() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mInsertions;
+}
+
+/// Source identifier
+uint64_t TraceTileCache::getSourceIdentifier(
+    const std::shared_ptr<const void> &source)
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    auto it = pImpl->mSources.find(source.get());
+    if (it != pImpl->mSources.end() && !it->second.first.expired())
+    {
+        return it->second.second;
+    }
+    if (static_cast<int> (pImpl->mSources.size()) >= pImpl->mSourcesToPrune)
+    {
+        pImpl->pruneSources();
+    }
+    auto identifier = pImpl->mNextSource;
+    pImpl->mNextSource = pImpl->mNextSource + 1;
+    pImpl->mSources[source.get()] = std::pair {std::weak_ptr<const void> {source},
+                                               identifier};
+    return identifier;
+}
+
+/// Find a tile
+std::shared_ptr<const QImage> TraceTileCache::find(const Key &key)
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    auto it = pImpl->mEntries.find(key);
+    if (it == pImpl->mEntries.end()){return nullptr;}
+    pImpl->mRecentlyUsed.splice(pImpl->mRecentlyUsed.begin(),
+                                pImpl->mRecentlyUsed, it->second.position);
+    return it->second.image;
+}
+
+/// Insert a tile
+void TraceTileCache::insert(const Key &key,
+                            std::shared_ptr<const QImage> image)
+{
+    if (image == nullptr){throw std::invalid_argument("Image is NULL");}
+    auto bytes = static_cast<int64_t> (image->sizeInBytes());
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    auto it = pImpl->mEntries.find(key);
+    if (it != pImpl->mEntries.end())
+    {
+        pImpl->mMemoryUsage = pImpl->mMemoryUsage - it->second.bytes;
+        pImpl->mRecentlyUsed.erase(it->second.position);
+        pImpl->mEntries.erase(it);
+    }
+    auto position = pImpl->mRecentlyUsed.insert(pImpl->mRecentlyUsed.begin(),
+                                                 key);
+    pImpl->mEntries.insert(std::pair {key,
+                                      TraceTileCacheImpl::Entry {std::move(image),
+                                                                 position,
+                                                                 bytes}});
+    pImpl->mMemoryUsage = pImpl->mMemoryUsage + bytes;
+    pImpl->mInsertions = pImpl->mInsertions + 1;
+    pImpl->evict();
+}
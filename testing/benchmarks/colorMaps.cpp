@@ -0,0 +1,78 @@
+#include <vector>
+#include <random>
+#include <QColor>
+#include <QImage>
+#include "qphase/widgets/colorMaps/parula.hpp"
+#include "qphase/widgets/colorMaps/lookupTable.hpp"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using namespace QPhase::Widgets::ColorMaps;
+
+/// A 1920 x 1080 image
+constexpr int WIDTH{1920};
+constexpr int HEIGHT{1080};
+
+std::vector<float> makeValues()
+{
+    std::mt19937 generator(8675309);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    std::vector<float> values(static_cast<size_t> (WIDTH)*HEIGHT);
+    for (auto &v : values){v = distribution(generator);}
+    return values;
+}
+
+/// Evaluates the color map at every pixel
+void evaluate(benchmark::State &state)
+{
+    auto values = makeValues();
+    Parula parula;
+    parula.initialize(std::pair {-1.0, 1.0});
+    QImage image(WIDTH, HEIGHT, QImage::Format_RGB32);
+    for (auto _ : state)
+    {
+        for (int row = 0; row < HEIGHT; ++row)
+        {
+            auto *scanLine = reinterpret_cast<QRgb *> (image.scanLine(row));
+            const auto *rowValues = values.data()
+                                  + static_cast<size_t> (row)*WIDTH;
+            for (int i = 0; i < WIDTH; ++i)
+            {
+                scanLine[i] = parula.evaluate(rowValues[i]).rgb();
+            }
+        }
+        benchmark::DoNotOptimize(image.scanLine(0));
+    }
+    state.SetItemsProcessed(state.iterations()*WIDTH*HEIGHT);
+}
+
+/// Colors the scanlines from the lookup table
+void lookupTable(benchmark::State &state)
+{
+    auto values = makeValues();
+    Parula parula;
+    parula.initialize(std::pair {-1.0, 1.0});
+    LookupTable table;
+    table.initialize(parula);
+    QImage image(WIDTH, HEIGHT, QImage::Format_RGB32);
+    for (auto _ : state)
+    {
+        for (int row = 0; row < HEIGHT; ++row)
+        {
+            table.fillScanLine(WIDTH,
+                               values.data() + static_cast<size_t> (row)*WIDTH,
+                               row, &image);
+        }
+        benchmark::DoNotOptimize(image.scanLine(0));
+    }
+    state.SetItemsProcessed(state.iterations()*WIDTH*HEIGHT);
+}
+
+BENCHMARK(evaluate)->Unit(benchmark::kMillisecond);
+BENCHMARK(lookupTable)->Unit(benchmark::kMillisecond);
+
+}
+
+BENCHMARK_MAIN();
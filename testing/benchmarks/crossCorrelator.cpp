@@ -0,0 +1,90 @@
+#include <vector>
+#include <cmath>
+#include <random>
+#include "qphase/processing/crossCorrelator.hpp"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+
+/// One minute of 100 sps data per channel
+constexpr int N_SAMPLES{6000};
+/// A two second template
+constexpr int TEMPLATE_LENGTH{200};
+
+template<typename T>
+std::vector<T> makeSignals(const int nChannels, const int nSamples)
+{
+    std::mt19937 generator(8675309);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<T> x(static_cast<size_t> (nChannels)*nSamples);
+    for (auto &v : x){v = static_cast<T> (distribution(generator));}
+    return x;
+}
+
+/// The normalized correlation at every lag evaluated directly then the
+/// peak, one channel at a time
+template<typename T>
+void direct(benchmark::State &state)
+{
+    auto nChannels = static_cast<int> (state.range(0));
+    auto x = makeSignals<T> (nChannels, N_SAMPLES);
+    auto t = makeSignals<T> (1, TEMPLATE_LENGTH);
+    for (auto _ : state)
+    {
+        for (int c = 0; c < nChannels; ++c)
+        {
+            const T *xc = x.data() + static_cast<size_t> (c)*N_SAMPLES;
+            double best =-2;
+            int bestLag = 0;
+            for (int k = 0; k <= N_SAMPLES - TEMPLATE_LENGTH; ++k)
+            {
+                double xy = 0;
+                double xx = 0;
+                for (int i = 0; i < TEMPLATE_LENGTH; ++i)
+                {
+                    xy = xy + static_cast<double> (t[i])*xc[k + i];
+                    xx = xx + static_cast<double> (xc[k + i])*xc[k + i];
+                }
+                auto coefficient = xy/std::sqrt(xx);
+                if (coefficient > best)
+                {
+                    best = coefficient;
+                    bestLag = k;
+                }
+            }
+            benchmark::DoNotOptimize(bestLag);
+        }
+    }
+    state.SetItemsProcessed(state.iterations()*nChannels);
+}
+
+template<typename T>
+void correlator(benchmark::State &state)
+{
+    auto nChannels = static_cast<int> (state.range(0));
+    auto nThreads = static_cast<int> (state.range(1));
+    auto x = makeSignals<T> (nChannels, N_SAMPLES);
+    auto t = makeSignals<T> (1, TEMPLATE_LENGTH);
+    CrossCorrelator<T> crossCorrelator;
+    crossCorrelator.setTemplate(TEMPLATE_LENGTH, t.data());
+    crossCorrelator.setNumberOfThreads(nThreads);
+    for (auto _ : state)
+    {
+        auto lags = crossCorrelator.correlate(nChannels, N_SAMPLES,
+                                              N_SAMPLES, x.data());
+        benchmark::DoNotOptimize(lags.data());
+    }
+    state.SetItemsProcessed(state.iterations()*nChannels);
+}
+
+BENCHMARK(direct<float>)->Arg(64);
+BENCHMARK(correlator<float>)->Args({64, 1})->Args({64, 4})
+                            ->Args({1024, 1})->Args({1024, 4})->UseRealTime();
+BENCHMARK(correlator<double>)->Args({64, 1})->Args({1024, 4})->UseRealTime();
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,112 @@
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "qphase/processing/kernels.hpp"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+
+template<typename T>
+std::vector<T> makeSignal(const int n)
+{
+    std::mt19937 generator(8675309);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<T> x(n);
+    for (auto &v : x){v = static_cast<T> (distribution(generator));}
+    return x;
+}
+
+template<typename T>
+void standardMinMax(benchmark::State &state)
+{
+    auto x = makeSignal<T> (state.range(0));
+    for (auto _ : state)
+    {
+        auto [vMin, vMax] = std::minmax_element(x.begin(), x.end());
+        benchmark::DoNotOptimize(vMin);
+        benchmark::DoNotOptimize(vMax);
+    }
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+
+template<typename T>
+void kernelMinMax(benchmark::State &state)
+{
+    auto instructionSet = static_cast<InstructionSet> (state.range(1));
+    if (!isSupported(instructionSet))
+    {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+    setInstructionSet(instructionSet);
+    auto x = makeSignal<T> (state.range(0));
+    for (auto _ : state)
+    {
+        auto result = minMax(static_cast<int> (x.size()), x.data());
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+
+template<typename T>
+void loopDemean(benchmark::State &state)
+{
+    auto x = makeSignal<T> (state.range(0));
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (const auto &v : x){sum = sum + v;}
+        auto average = static_cast<T> (sum/x.size());
+        for (auto &v : x){v = v - average;}
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+
+template<typename T>
+void kernelDemean(benchmark::State &state)
+{
+    auto instructionSet = static_cast<InstructionSet> (state.range(1));
+    if (!isSupported(instructionSet))
+    {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+    setInstructionSet(instructionSet);
+    auto x = makeSignal<T> (state.range(0));
+    for (auto _ : state)
+    {
+        demean(static_cast<int> (x.size()), x.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+
+void instructionSets(benchmark::internal::Benchmark *benchmark)
+{
+    for (const int n : {1024, 65536, 8640000})
+    {
+        for (const auto instructionSet : {InstructionSet::Scalar,
+                                          InstructionSet::AVX2,
+                                          InstructionSet::AVX512})
+        {
+            benchmark->Args({n, static_cast<int> (instructionSet)});
+        }
+    }
+}
+
+BENCHMARK(standardMinMax<float>)->Arg(1024)->Arg(65536)->Arg(8640000);
+BENCHMARK(kernelMinMax<float>)->Apply(instructionSets);
+BENCHMARK(standardMinMax<double>)->Arg(1024)->Arg(65536)->Arg(8640000);
+BENCHMARK(kernelMinMax<double>)->Apply(instructionSets);
+BENCHMARK(loopDemean<float>)->Arg(1024)->Arg(65536)->Arg(8640000);
+BENCHMARK(kernelDemean<float>)->Apply(instructionSets);
+BENCHMARK(loopDemean<double>)->Arg(1024)->Arg(65536)->Arg(8640000);
+BENCHMARK(kernelDemean<double>)->Apply(instructionSets);
+
+}
+
+BENCHMARK_MAIN();
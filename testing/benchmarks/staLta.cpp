@@ -0,0 +1,103 @@
+#include <vector>
+#include <random>
+#include "qphase/processing/kernels.hpp"
+#include "qphase/processing/staLta.hpp"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+
+/// One minute of 100 sps data per channel
+constexpr int N_SAMPLES{6000};
+
+template<typename T>
+std::vector<T> makeSignals(const int nChannels)
+{
+    std::mt19937 generator(8675309);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<T> x(static_cast<size_t> (nChannels)*N_SAMPLES);
+    for (auto &v : x){v = static_cast<T> (distribution(generator));}
+    return x;
+}
+
+/// The recursive STA/LTA one channel at a time
+template<typename T>
+void loopRecursive(benchmark::State &state)
+{
+    auto nChannels = static_cast<int> (state.range(0));
+    auto x = makeSignals<T> (nChannels);
+    std::vector<T> cf(x.size());
+    constexpr double cSta{1./50};
+    constexpr double cLta{1./500};
+    for (auto _ : state)
+    {
+        for (int c = 0; c < nChannels; ++c)
+        {
+            const T *xc = x.data() + c*N_SAMPLES;
+            T *cfc = cf.data() + c*N_SAMPLES;
+            double sta = 0;
+            double lta = 0;
+            for (int i = 0; i < N_SAMPLES; ++i)
+            {
+                auto x2 = static_cast<double> (xc[i])*xc[i];
+                sta = cSta*x2 + (1 - cSta)*sta;
+                lta = cLta*x2 + (1 - cLta)*lta;
+                cfc[i] = static_cast<T> (i >= 499 ? sta/lta : 0);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+
+template<typename T>
+void detector(benchmark::State &state)
+{
+    auto nChannels = static_cast<int> (state.range(0));
+    auto instructionSet = static_cast<InstructionSet> (state.range(1));
+    auto type = static_cast<typename STALTA<T>::Type> (state.range(2));
+    if (!isSupported(instructionSet))
+    {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+    setInstructionSet(instructionSet);
+    auto x = makeSignals<T> (nChannels);
+    std::vector<T> cf(x.size());
+    STALTA<T> staLta;
+    staLta.initialize(nChannels, 100, 0.5, 5, type);
+    for (auto _ : state)
+    {
+        staLta.process(N_SAMPLES, N_SAMPLES, x.data(), cf.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations()*x.size());
+}
+
+void instructionSets(benchmark::internal::Benchmark *benchmark)
+{
+    for (const int type : {0, 1})
+    {
+        for (const int nChannels : {16, 256})
+        {
+            for (const auto instructionSet : {InstructionSet::Scalar,
+                                              InstructionSet::AVX2,
+                                              InstructionSet::AVX512})
+            {
+                benchmark->Args({nChannels, static_cast<int> (instructionSet),
+                                 type});
+            }
+        }
+    }
+}
+
+BENCHMARK(loopRecursive<float>)->Arg(16)->Arg(256);
+BENCHMARK(detector<float>)->Apply(instructionSets);
+BENCHMARK(loopRecursive<double>)->Arg(16)->Arg(256);
+BENCHMARK(detector<double>)->Apply(instructionSets);
+
+}
+
+BENCHMARK_MAIN();
@@ -8,7 +8,11 @@
 #include "qphase/database/internal/origin.hpp"
 #include "qphase/database/internal/stationData.hpp"
 #include "qphase/database/internal/waveform.hpp"
+#include "qphase/database/internal/stationDataTable.hpp"
+#include "qphase/database/internal/arrivalTable.hpp"
+#include "qphase/database/internal/eventTable.hpp"
 #include "qphase/database/connection/sqlite3.hpp"
+#include "private/database/utilities.hpp"
 #include <gtest/gtest.h>
 
 namespace
@@ -217,7 +221,184 @@ TEST(DatabaseInternal, StationData)
 
 TEST(DatabaseInternal, StationDataTable)
 {
- 
+    const std::string fileName{"dbaseInternalTestStationData.sqlite3"};
+    std::remove(fileName.c_str());
+    auto sqlite3 = std::make_shared<QPhase::Database::Connection::SQLite3> ();
+    sqlite3->setFileName(fileName);
+    sqlite3->setReadWrite();
+    sqlite3->connect();
+    auto session = sqlite3->getSession();
+    createTable(*session);
+    // Times are integer microseconds - 2021-08-12 and the distant future
+    const long long onDate{1628803598123456};
+    const long long offDate{4102444800000000};
+    // Enough rows to span multiple fetch batches
+    const int nStations = static_cast<int> (QUERY_BATCH_SIZE) + 7;
+    for (int i = 0; i < nStations; ++i)
+    {
+        auto station = "S" + std::to_string(i);
+        double latitude = 40.5;
+        double longitude = -112.5;
+        *session << "INSERT INTO station_data(network, station, latitude, longitude, elevation, ondate, offdate) "
+                    "VALUES('UU', :station, :latitude, :longitude, 1500, :ondate, :offdate)",
+                    soci::use(station), soci::use(latitude),
+                    soci::use(longitude), soci::use(onDate),
+                    soci::use(offDate);
+    }
+    std::shared_ptr<QPhase::Database::Connection::IConnection> connection
+        = sqlite3;
+    StationDataTable table;
+    EXPECT_NO_THROW(table.setConnection(connection));
+    EXPECT_TRUE(table.isConnected());
+    EXPECT_NO_THROW(table.queryAll());
+    auto stations = table.getStations();
+    EXPECT_EQ(static_cast<int> (stations.size()), nStations);
+    for (const auto &station : stations)
+    {
+        EXPECT_EQ(station.getNetwork(), "UU");
+        EXPECT_EQ(station.getOnDate(), std::chrono::microseconds {onDate});
+        EXPECT_EQ(station.getOffDate(), std::chrono::microseconds {offDate});
+        EXPECT_NEAR(station.getElevation(), 1500, 1.e-10);
+        EXPECT_TRUE(station.getDescription().empty());
+    }
+    sqlite3->close();
+    std::remove(fileName.c_str());
+}
+
+/// @result A connection to a new database file.
+std::shared_ptr<QPhase::Database::Connection::SQLite3>
+    makeDatabase(const std::string &fileName)
+{
+    std::remove(fileName.c_str());
+    auto sqlite3 = std::make_shared<QPhase::Database::Connection::SQLite3> ();
+    sqlite3->setFileName(fileName);
+    sqlite3->setReadWrite();
+    sqlite3->connect();
+    return sqlite3;
+}
+
+/// Adds an event whose origin has two arrivals.
+void insertEvent(soci::session &session,
+                 const long long originTime,
+                 const long long arrivalTime)
+{
+    session << "INSERT INTO magnitude(identifier, magnitude, magnitude_type) "
+               "VALUES(7, 2.5, 'l')";
+    session << "INSERT INTO origin(identifier, latitude, longitude, depth, time) "
+               "VALUES(5, 40.5, -112.5, 8, :time)",
+               soci::use(originTime);
+    session << "INSERT INTO event(identifier, preferred_origin, preferred_magnitude, event_type, review_status) "
+               "VALUES(3, 5, 7, 'qb', 'F')";
+    for (int i = 0; i < 2; ++i)
+    {
+        long long time = arrivalTime + i;
+        std::string station = "S" + std::to_string(i);
+        session << "INSERT INTO arrival(origin, network, station, channel, time, phase, first_motion, review_status) "
+                   "VALUES(5, 'UU', :station, 'HHZ', :time, 'P', -1, 'M')",
+                   soci::use(station), soci::use(time);
+    }
+}
+
+/// Checks the event added by insertEvent().
+void checkEvent(std::shared_ptr<QPhase::Database::Connection::IConnection> connection,
+                const long long originTime,
+                const long long arrivalTime)
+{
+    ArrivalTable arrivalTable;
+    arrivalTable.setConnection(connection);
+    arrivalTable.query(5);
+    auto arrivals = arrivalTable.getArrivals();
+    ASSERT_EQ(arrivals.size(), 2);
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(arrivals[i].getOriginIdentifier(), 5);
+        EXPECT_EQ(arrivals[i].getStation(), "S" + std::to_string(i));
+        EXPECT_EQ(arrivals[i].getTime(),
+                  std::chrono::microseconds {arrivalTime + i});
+        EXPECT_EQ(arrivals[i].getPhase(), "P");
+        EXPECT_EQ(arrivals[i].getFirstMotion(), Arrival::FirstMotion::Down);
+        EXPECT_EQ(arrivals[i].getCreationMode(),
+                  Arrival::CreationMode::Manual);
+    }
+    EventTable eventTable;
+    eventTable.setConnection(connection);
+    eventTable.queryAll();
+    auto events = eventTable.getEvents();
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].getIdentifier(), 3);
+    EXPECT_EQ(events[0].getType(), Event::Type::QuarryBlast);
+    EXPECT_EQ(events[0].getReviewStatus(), Event::ReviewStatus::Finalized);
+    auto origin = events[0].getOrigin();
+    EXPECT_EQ(origin.getIdentifier(), 5);
+    EXPECT_EQ(origin.getTime(), std::chrono::microseconds {originTime});
+    EXPECT_NEAR(origin.getDepth(), 8, 1.e-10);
+    EXPECT_EQ(origin.getArrivals().size(), 2);
+    EXPECT_NEAR(events[0].getMagnitude().getValue(), 2.5, 1.e-10);
+}
+
+TEST(DatabaseInternal, EventAndArrivalTables)
+{
+    const std::string fileName{"dbaseInternalTestEvent.sqlite3"};
+    auto sqlite3 = makeDatabase(fileName);
+    auto session = sqlite3->getSession();
+    createTable(*session);
+    // Microsecond precision survives the round trip
+    const long long originTime{1628803598123456};
+    const long long arrivalTime{1628803601654321};
+    insertEvent(*session, originTime, arrivalTime);
+    checkEvent(sqlite3, originTime, arrivalTime);
+    sqlite3->close();
+    std::remove(fileName.c_str());
+}
+
+TEST(DatabaseInternal, SchemaMigration)
+{
+    const std::string fileName{"dbaseInternalTestMigration.sqlite3"};
+    auto sqlite3 = makeDatabase(fileName);
+    auto session = sqlite3->getSession();
+    // The first schema stored the microseconds in DOUBLE columns
+    *session << "CREATE TABLE station_data (identifier INTEGER PRIMARY KEY NOT NULL, network VARCHAR(32) NOT NULL, station VARCHAR(32) NOT NULL, latitude DOUBLE PRECISION NOT NULL, longitude DOUBLE PRECISION NOT NULL, elevation DOUBLE PRECISION, ondate DOUBLE NOT NULL, offdate DOUBLE NOT NULL CHECK(ondate < offdate), description VARCHAR(256) DEFAULT '', lddate TIMESTAMP CURRENT_TIMESTAMP);";
+    *session << "CREATE TABLE origin (identifier INTEGER PRIMARY KEY NOT NULL, latitude DOUBLE PRECISION NOT NULL, longitude DOUBLE PRECISION NOT NULL, depth DOUBLE PRECISION NOT NULL, time DOUBLE NOT NULL, authority VARCHAR(128) DEFAULT 'UU', lddate TIMESTAMP CURRENT_TIMESTAMP);";
+    *session << "CREATE TABLE arrival (identifier INTEGER PRIMARY KEY NOT NULL, origin INTEGER NOT NULL, network VARCHAR(32) NOT NULL, station VARCHAR(32) NOT NULL, channel VARCHAR(32) NOT NULL, location_code VARCHAR(32) NOT NULL DEFAULT '01', time DOUBLE NOT NULL, phase VARCHAR(8) NOT NULL, first_motion INTEGER DEFAULT 0, review_status VARCHAR(1) DEFAULT 'A', lddate TIMESTAMP CURRENT_TIMESTAMP, FOREIGN KEY(origin) REFERENCES origin(identifier));";
+    *session << "CREATE TABLE magnitude (identifier INTEGER PRIMARY KEY NOT NULL, magnitude DOUBLE PRECISION NOT NULL, magnitude_type VARCHAR(8) NOT NULL, lddate TIMESTAMP CURRENT_TIMESTAMP);";
+    *session << "CREATE TABLE event (identifier INTEGER PRIMARY KEY NOT NULL, preferred_origin INTEGER NOT NULL, preferred_magnitude INTEGER NOT NULL, event_type VARCHAR(2) NOT NULL DEFAULT 'uk', review_status VARCHAR(8) NOT NULL DEFAULT 'A', lddate TIMESTAMP CURRENT_TIMESTAMP);";
+    const long long originTime{1628803598123456};
+    const long long arrivalTime{1628803601654321};
+    insertEvent(*session, originTime, arrivalTime);
+    const double onDate{1628803598000000};
+    const double offDate{4102444800000000};
+    *session << "INSERT INTO station_data(network, station, latitude, longitude, elevation, ondate, offdate) "
+                "VALUES('UU', 'CTU', 40.5, -112.5, 1500, :ondate, :offdate)",
+                soci::use(onDate), soci::use(offDate);
+    // The times are REAL until the tables are migrated
+    std::string type;
+    *session << "SELECT typeof(time) FROM origin", soci::into(type);
+    EXPECT_EQ(type, "real");
+    createTable(*session);
+    int version{0};
+    *session << "PRAGMA user_version;", soci::into(version);
+    EXPECT_EQ(version, SCHEMA_VERSION);
+    *session << "SELECT typeof(time) FROM origin", soci::into(type);
+    EXPECT_EQ(type, "integer");
+    *session << "SELECT typeof(time) FROM arrival LIMIT 1", soci::into(type);
+    EXPECT_EQ(type, "integer");
+    checkEvent(sqlite3, originTime, arrivalTime);
+    std::shared_ptr<QPhase::Database::Connection::IConnection> connection
+        = sqlite3;
+    StationDataTable stationTable;
+    stationTable.setConnection(connection);
+    stationTable.queryAll();
+    auto stations = stationTable.getStations();
+    ASSERT_EQ(stations.size(), 1);
+    EXPECT_EQ(stations[0].getOnDate(),
+              std::chrono::microseconds {static_cast<int64_t> (onDate)});
+    EXPECT_EQ(stations[0].getOffDate(),
+              std::chrono::microseconds {static_cast<int64_t> (offDate)});
+    // Migrating again does nothing
+    EXPECT_NO_THROW(createTable(*session));
+    checkEvent(sqlite3, originTime, arrivalTime);
+    sqlite3->close();
+    std::remove(fileName.c_str());
 }
 
 TEST(DatabaseInternal, Waveform)
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "qphase/ingest/directoryWatcher.hpp"
+#include "qphase/database/internal/waveform.hpp"
+#include "qphase/waveforms/realTimeWaveform.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Ingest;
+
+/// A scratch spool directory that is removed on exit.
+class SpoolDirectory
+{
+public:
+    SpoolDirectory()
+    {
+        mPath = std::filesystem::temp_directory_path()
+              /("qphaseSpool" + std::to_string(::getpid()));
+        std::filesystem::remove_all(mPath);
+        std::filesystem::create_directories(mPath);
+    }
+    ~SpoolDirectory()
+    {
+        std::filesystem::remove_all(mPath);
+    }
+    const std::filesystem::path &getPath() const noexcept{return mPath;}
+private:
+    std::filesystem::path mPath;
+};
+
+template<typename U>
+void put(std::vector<char> &buffer, const size_t offset, const U value,
+         const bool bigEndian)
+{
+    std::memcpy(buffer.data() + offset, &value, sizeof(U));
+    if (bigEndian)
+    {
+        std::reverse(buffer.begin() + static_cast<ptrdiff_t> (offset),
+                     buffer.begin() + static_cast<ptrdiff_t> (offset + sizeof(U)));
+    }
+}
+
+/// @result A SAC header for a 2023 day 100 waveform starting at the given
+///         second of the day.
+std::vector<char> makeHeader(const std::string &station, const int second,
+                             const float delta, const int nPoints,
+                             const bool bigEndian = false)
+{
+    std::vector<char> header(632);
+    for (int i = 0; i < 70; ++i){put<float> (header, 4*i, -12345, bigEndian);}
+    for (int i = 70; i < 110; ++i)
+    {
+        put<int32_t> (header, 4*i, -12345, bigEndian);
+    }
+    for (int i = 440; i < 632; i = i + 8)
+    {
+        std::memcpy(header.data() + i, "-12345  ", 8);
+    }
+    put<float> (header, 0, delta, bigEndian);
+    put<float> (header, 4*5, 0, bigEndian);
+    std::vector<int32_t> reference{2023, 100, second/3600, (second/60)%60,
+                                   second%60, 0};
+    for (int i = 0; i < 6; ++i)
+    {
+        put<int32_t> (header, 4*(70 + i), reference[i], bigEndian);
+    }
+    put<int32_t> (header, 4*76, 6, bigEndian);
+    put<int32_t> (header, 4*79, nPoints, bigEndian);
+    put<int32_t> (header, 4*85, 1, bigEndian);
+    put<int32_t> (header, 4*105, 1, bigEndian);
+    auto setCode = [&header](const int offset, const std::string &code)
+    {
+        std::memset(header.data() + offset, ' ', 8);
+        std::memcpy(header.data() + offset, code.data(), code.size());
+    };
+    setCode(440, station);
+    setCode(600, "HHZ");
+    setCode(608, "UU");
+    return header;
+}
+
+std::vector<char> makeSamples(const int i0, const int n,
+                              const bool bigEndian = false)
+{
+    std::vector<char> samples(4*n);
+    for (int i = 0; i < n; ++i)
+    {
+        put<float> (samples, 4*i, static_cast<float> (i0 + i), bigEndian);
+    }
+    return samples;
+}
+
+/// 2023 day 100 (April 10) 00:00:00 UTC
+std::chrono::microseconds getDayStart()
+{
+    return std::chrono::microseconds {1681084800000000};
+}
+
+bool waitFor(const std::function<bool ()> &condition,
+             const std::chrono::seconds &timeOut = std::chrono::seconds {60})
+{
+    auto deadline = std::chrono::steady_clock::now() + timeOut;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        if (condition()){return true;}
+        std::this_thread::sleep_for(std::chrono::milliseconds {1});
+    }
+    return false;
+}
+
+TEST(Ingest, DirectoryWatcherIncremental)
+{
+    SpoolDirectory spool;
+    DirectoryWatcher watcher;
+    EXPECT_THROW(watcher.start(spool.getPath()/"missing"),
+                 std::invalid_argument);
+    std::atomic<int> nUpdates{0};
+    watcher.setUpdateCallback(
+        [&nUpdates](const QPhase::Database::Internal::Waveform &)
+        {
+            nUpdates.fetch_add(1);
+        });
+    watcher.start(spool.getPath());
+    EXPECT_TRUE(watcher.isRunning());
+    EXPECT_THROW(watcher.setRetention(std::chrono::minutes {1}),
+                 std::runtime_error);
+
+    // The acquisition writes the header and part of the data then appends
+    auto fileName = spool.getPath()/"UU.BRTU.HHZ.sac";
+    auto header = makeHeader("BRTU", 60, 0.01f, 1000);
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(header.data(), static_cast<std::streamsize> (header.size()));
+    auto samples = makeSamples(0, 300);
+    file.write(samples.data(), static_cast<std::streamsize> (samples.size()));
+    file.flush();
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfSamples() == 300;
+                }));
+    EXPECT_EQ(watcher.getNumberOfFiles(), 1);
+    auto t0 = getDayStart() + std::chrono::seconds {60};
+    auto index = watcher.getIndex();
+    ASSERT_EQ(index.size(), 1);
+    EXPECT_EQ(index[0].getNetwork(), "UU");
+    EXPECT_EQ(index[0].getStation(), "BRTU");
+    EXPECT_EQ(index[0].getChannel(), "HHZ");
+    EXPECT_EQ(index[0].getLocationCode(), "01");
+    EXPECT_EQ(index[0].getStartTime(), t0);
+    EXPECT_EQ(index[0].getEndTime(), t0 + std::chrono::milliseconds {2990});
+    EXPECT_EQ(index[0].getFileName(), fileName.string());
+
+    samples = makeSamples(300, 700);
+    file.write(samples.data(), static_cast<std::streamsize> (samples.size()));
+    file.close();
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfSamples() == 1000;
+                }));
+    EXPECT_EQ(watcher.getNumberOfFiles(), 1);
+    EXPECT_GE(nUpdates.load(), 2);
+    index = watcher.getIndex();
+    ASSERT_EQ(index.size(), 1);
+    EXPECT_EQ(index[0].getEndTime(), t0 + std::chrono::milliseconds {9990});
+    ASSERT_TRUE(watcher.haveChannel("UU.BRTU.HHZ.01"));
+    auto snapshot = watcher.getWaveform("UU.BRTU.HHZ.01")->getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    EXPECT_EQ(snapshot[0].getStartTime(), t0);
+    EXPECT_NEAR(snapshot[0].getSamplingRate(), 100, 1.e-12);
+    auto data = snapshot[0].getData();
+    ASSERT_EQ(data.size(), 1000);
+    for (int i = 0; i < 1000; ++i){EXPECT_EQ(data[i], i);}
+
+    // A big-endian file continuing the channel, moved into the spool
+    header = makeHeader("BRTU", 70, 0.01f, 500, true);
+    samples = makeSamples(1000, 500, true);
+    auto scratchName = spool.getPath().parent_path()/"qphaseScratch.sac";
+    file.open(scratchName, std::ios::binary);
+    file.write(header.data(), static_cast<std::streamsize> (header.size()));
+    file.write(samples.data(), static_cast<std::streamsize> (samples.size()));
+    file.close();
+    std::filesystem::rename(scratchName, spool.getPath()/"next.sac");
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfSamples() == 1500;
+                }));
+    snapshot = watcher.getWaveform("UU.BRTU.HHZ.01")->getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    EXPECT_EQ(snapshot[0].getNumberOfSamples(), 1500);
+    EXPECT_EQ(snapshot[0].getData().back(), 1499);
+    EXPECT_EQ(watcher.getIndex().size(), 2);
+
+    // Not a SAC file
+    std::ofstream garbage(spool.getPath()/"notes.txt");
+    garbage << std::string(1000, 'x');
+    garbage.close();
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfErrors() == 1;
+                }));
+    EXPECT_EQ(watcher.getIndex().size(), 2);
+    watcher.stop();
+    EXPECT_FALSE(watcher.isRunning());
+    EXPECT_EQ(watcher.getChannelNames().size(), 1);
+}
+
+TEST(Ingest, DirectoryWatcherReopen)
+{
+    SpoolDirectory spool;
+    DirectoryWatcher watcher;
+    watcher.start(spool.getPath());
+    // The writer closes the file after each chunk and reopens it to append
+    auto fileName = spool.getPath()/"UU.CTU.HHZ.sac";
+    auto header = makeHeader("CTU", 0, 0.01f, 600);
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(header.data(), static_cast<std::streamsize> (header.size()));
+    auto samples = makeSamples(0, 200);
+    file.write(samples.data(), static_cast<std::streamsize> (samples.size()));
+    file.close();
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfSamples() == 200;
+                }));
+    for (int chunk = 1; chunk < 3; ++chunk)
+    {
+        file.open(fileName, std::ios::binary | std::ios::app);
+        samples = makeSamples(200*chunk, 200);
+        file.write(samples.data(),
+                   static_cast<std::streamsize> (samples.size()));
+        file.close();
+        ASSERT_TRUE(waitFor([&watcher, chunk]()
+                    {
+                        return watcher.getNumberOfSamples() >= 200*(chunk + 1);
+                    }));
+    }
+    // Each sample is ingested once
+    EXPECT_EQ(watcher.getNumberOfSamples(), 600);
+    EXPECT_EQ(watcher.getNumberOfFiles(), 1);
+    auto snapshot = watcher.getWaveform("UU.CTU.HHZ.01")->getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    auto data = snapshot[0].getData();
+    ASSERT_EQ(data.size(), 600);
+    for (int i = 0; i < 600; ++i){EXPECT_EQ(data[i], i);}
+    auto index = watcher.getIndex();
+    ASSERT_EQ(index.size(), 1);
+    EXPECT_EQ(index[0].getEndTime(),
+              getDayStart() + std::chrono::milliseconds {5990});
+    watcher.stop();
+}
+
+TEST(Ingest, DirectoryWatcherReplace)
+{
+    SpoolDirectory spool;
+    DirectoryWatcher watcher;
+    watcher.start(spool.getPath());
+    auto fileName = spool.getPath()/"UU.RPL.HHZ.sac";
+    auto write = [&fileName](const int second, const int i0, const int n)
+    {
+        auto header = makeHeader("RPL", second, 0.01f, n);
+        auto samples = makeSamples(i0, n);
+        std::ofstream file(fileName, std::ios::binary);
+        file.write(header.data(), static_cast<std::streamsize> (header.size()));
+        file.write(samples.data(),
+                   static_cast<std::streamsize> (samples.size()));
+    };
+    write(0, 0, 300);
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfSamples() == 300;
+                }));
+    // A deleted file is forgotten so a new file with its name, and
+    // possibly its inode, is read from the start
+    std::filesystem::remove(fileName);
+    write(3, 300, 500);
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfSamples() == 800;
+                }));
+    EXPECT_EQ(watcher.getNumberOfFiles(), 2);
+    auto snapshot = watcher.getWaveform("UU.RPL.HHZ.01")->getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    auto data = snapshot[0].getData();
+    ASSERT_EQ(data.size(), 800);
+    for (int i = 0; i < 800; ++i){EXPECT_EQ(data[i], i);}
+    watcher.stop();
+    EXPECT_EQ(watcher.getNumberOfErrors(), 0);
+}
+
+TEST(Ingest, DirectoryWatcherThroughput)
+{
+    // Thousands of one second files spread over several stations
+    constexpr int nStations{4};
+    constexpr int nFilesPerStation{500};
+    constexpr int nSamples{100};
+    SpoolDirectory spool;
+    DirectoryWatcher watcher;
+    watcher.start(spool.getPath());
+    auto startTime = std::chrono::steady_clock::now();
+    for (int file = 0; file < nFilesPerStation; ++file)
+    {
+        for (int station = 0; station < nStations; ++station)
+        {
+            auto name = "S" + std::to_string(station);
+            auto header = makeHeader(name, file, 0.01f, nSamples);
+            auto samples = makeSamples(file*nSamples, nSamples);
+            std::ofstream stream(spool.getPath()
+                                /(name + "." + std::to_string(file) + ".sac"),
+                                 std::ios::binary);
+            stream.write(header.data(),
+                         static_cast<std::streamsize> (header.size()));
+            stream.write(samples.data(),
+                         static_cast<std::streamsize> (samples.size()));
+        }
+    }
+    constexpr int64_t nFiles{nStations*nFilesPerStation};
+    ASSERT_TRUE(waitFor([&watcher]()
+                {
+                    return watcher.getNumberOfSamples() == nFiles*nSamples;
+                }));
+    std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - startTime;
+    auto filesPerMinute = nFiles/(elapsed.count()/60);
+    RecordProperty("filesPerMinute", std::to_string(filesPerMinute));
+    EXPECT_EQ(watcher.getNumberOfFiles(), nFiles);
+    EXPECT_EQ(watcher.getNumberOfErrors(), 0);
+    EXPECT_EQ(watcher.getIndex().size(), static_cast<size_t> (nFiles));
+    for (int station = 0; station < nStations; ++station)
+    {
+        auto snapshot = watcher.getWaveform("UU.S" + std::to_string(station)
+                                          + ".HHZ.01")->getSnapshot();
+        ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+        EXPECT_EQ(snapshot[0].getStartTime(), getDayStart());
+        EXPECT_EQ(snapshot[0].getNumberOfSamples(), nFiles/nStations*nSamples);
+    }
+}
+
+}
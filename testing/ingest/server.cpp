@@ -0,0 +1,270 @@
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "qphase/ingest/packet.hpp"
+#include "qphase/ingest/replayer.hpp"
+#include "qphase/ingest/server.hpp"
+#include "qphase/waveforms/realTimeWaveform.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include "private/spscQueue.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Ingest;
+using namespace QPhase::Waveforms;
+
+/// @result A waveform of the given duration whose samples are unique to the
+///         channel and sample index.
+Waveform<double> makeWaveform(const int channel, const int samplingRate,
+                              const int duration,
+                              const std::chrono::microseconds &startTime)
+{
+    std::vector<double> x(samplingRate*duration);
+    for (int i = 0; i < static_cast<int> (x.size()); ++i)
+    {
+        x[i] = channel*1.e7 + i;
+    }
+    Segment<double> segment;
+    segment.setSamplingRate(samplingRate);
+    segment.setStartTime(startTime);
+    segment.setData(std::move(x));
+    Waveform<double> waveform;
+    waveform.setSegments(std::move(segment));
+    return waveform;
+}
+
+/// @result True if the server appended nPackets before the timeout.
+bool waitForPackets(const Server &server, const int64_t nPackets,
+                    const std::chrono::seconds &timeOut = std::chrono::seconds {30})
+{
+    auto deadline = std::chrono::steady_clock::now() + timeOut;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        if (server.getNumberOfPackets() + server.getNumberOfErrors()
+            >= nPackets)
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds {1});
+    }
+    return false;
+}
+
+TEST(Ingest, Packet)
+{
+    Packet packet;
+    packet.network = "UU";
+    packet.station = "BRTU";
+    packet.channel = "HHZ";
+    packet.locationCode = "01";
+    packet.startTime = std::chrono::microseconds {1700000000123456};
+    packet.samplingRateNumerator = 40;
+    packet.samplingRateDenominator = 3;
+    packet.data = {1.25, -2, 3.75, 1.e6, -7.5};
+    EXPECT_EQ(getName(packet), "UU.BRTU.HHZ.01");
+
+    auto frame = encode(packet);
+    auto nBytes = static_cast<int> (frame.size());
+    EXPECT_EQ(nBytes, getFrameHeaderLength() + 8*5);
+    EXPECT_EQ(getFrameLength(nBytes, frame.data()), nBytes);
+    EXPECT_EQ(getFrameLength(getFrameHeaderLength() - 1, frame.data()), 0);
+    EXPECT_EQ(getName(nBytes, frame.data()), "UU.BRTU.HHZ.01");
+    auto copy = decode(nBytes, frame.data());
+    EXPECT_EQ(copy.network, packet.network);
+    EXPECT_EQ(copy.station, packet.station);
+    EXPECT_EQ(copy.channel, packet.channel);
+    EXPECT_EQ(copy.locationCode, packet.locationCode);
+    EXPECT_EQ(copy.startTime, packet.startTime);
+    EXPECT_EQ(copy.samplingRateNumerator, 40);
+    EXPECT_EQ(copy.samplingRateDenominator, 3);
+    EXPECT_EQ(copy.data, packet.data);
+
+    frame = encode(packet, DataType::Float32);
+    EXPECT_EQ(static_cast<int> (frame.size()), getFrameHeaderLength() + 4*5);
+    copy = decode(static_cast<int> (frame.size()), frame.data());
+    EXPECT_EQ(copy.data, packet.data); // All exactly representable
+
+    frame = encode(packet, DataType::Integer32);
+    copy = decode(static_cast<int> (frame.size()), frame.data());
+    std::vector<double> rounded{1, -2, 4, 1.e6, -8};
+    EXPECT_EQ(copy.data, rounded);
+
+    // Malformed frames
+    EXPECT_THROW(static_cast<void> (decode(static_cast<int> (frame.size()) - 1,
+                                         frame.data())),
+                 std::invalid_argument);
+    frame[0] = 'X';
+    EXPECT_THROW(static_cast<void> (getFrameLength(static_cast<int> (frame.size()),
+                                                 frame.data())),
+                 std::invalid_argument);
+    packet.station = "TOOLONGNAME";
+    EXPECT_THROW(static_cast<void> (encode(packet)), std::invalid_argument);
+    packet.station = "BRTU";
+    packet.samplingRateNumerator = 0;
+    EXPECT_THROW(static_cast<void> (encode(packet)), std::invalid_argument);
+}
+
+TEST(Ingest, SPSCQueue)
+{
+    SPSCQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8);
+    EXPECT_TRUE(queue.empty());
+    for (int i = 0; i < 8; ++i){EXPECT_TRUE(queue.tryPush(int {i}));}
+    EXPECT_FALSE(queue.tryPush(8));
+    EXPECT_EQ(*queue.tryPop(), 0);
+    EXPECT_TRUE(queue.tryPush(8));
+    for (int i = 1; i <= 8; ++i){EXPECT_EQ(*queue.tryPop(), i);}
+    EXPECT_FALSE(queue.tryPop().has_value());
+
+    // Elements arrive in order across threads
+    constexpr int n{100000};
+    SPSCQueue<int> shared(64);
+    std::thread producer([&shared]()
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            while (!shared.tryPush(int {i})){std::this_thread::yield();}
+        }
+    });
+    int nOutOfOrder = 0;
+    for (int expected = 0; expected < n;)
+    {
+        auto value = shared.tryPop();
+        if (!value)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (*value != expected){nOutOfOrder = nOutOfOrder + 1;}
+        expected = expected + 1;
+    }
+    producer.join();
+    EXPECT_EQ(nOutOfOrder, 0);
+}
+
+TEST(Ingest, Throughput)
+{
+    // Two clients each stream six 100 Hz channels of 2 minutes as fast as
+    // possible into three decoders
+    constexpr int nClients{2};
+    constexpr int nChannelsPerClient{6};
+    constexpr int samplingRate{100};
+    constexpr int duration{120};
+    const std::chrono::microseconds t0{1700000000000000};
+    std::vector<Waveform<double>> waveforms;
+    std::vector<std::vector<Packet>> packets(nClients);
+    int64_t nPackets = 0;
+    for (int i = 0; i < nClients*nChannelsPerClient; ++i)
+    {
+        waveforms.push_back(makeWaveform(i, samplingRate, duration, t0));
+        auto channelPackets
+            = Replayer::makePackets(waveforms.back(), "UU",
+                                    "S" + std::to_string(i), "HHZ", "01", 100);
+        nPackets = nPackets + static_cast<int64_t> (channelPackets.size());
+        auto &clientPackets = packets[i%nClients];
+        clientPackets.insert(clientPackets.end(),
+                             channelPackets.begin(), channelPackets.end());
+    }
+    EXPECT_EQ(nPackets, nClients*nChannelsPerClient*duration);
+
+    Server server;
+    server.setDefaultRetention(std::chrono::minutes {5});
+    EXPECT_FALSE(server.isRunning());
+    EXPECT_THROW(server.start(0, 0), std::invalid_argument);
+    server.start(0, 3);
+    EXPECT_TRUE(server.isRunning());
+    auto port = server.getPort();
+    EXPECT_GT(port, 0);
+
+    std::vector<std::thread> clients;
+    for (int i = 0; i < nClients; ++i)
+    {
+        clients.emplace_back([&packets, port, i]()
+        {
+            Replayer replayer;
+            replayer.connect(port);
+            replayer.replay(packets[i], 0);
+        });
+    }
+    for (auto &client : clients){client.join();}
+    ASSERT_TRUE(waitForPackets(server, nPackets));
+    EXPECT_EQ(server.getNumberOfErrors(), 0);
+    EXPECT_EQ(server.getNumberOfPackets(), nPackets);
+    EXPECT_EQ(server.getNumberOfSamples(),
+              static_cast<int64_t> (nClients*nChannelsPerClient)
+             *samplingRate*duration);
+    EXPECT_EQ(server.getChannelNames().size(),
+              static_cast<size_t> (nClients*nChannelsPerClient));
+    for (int i = 0; i < nClients*nChannelsPerClient; ++i)
+    {
+        auto name = "UU.S" + std::to_string(i) + ".HHZ.01";
+        ASSERT_TRUE(server.haveChannel(name));
+        auto snapshot = server.getWaveform(name)->getSnapshot();
+        ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+        EXPECT_EQ(snapshot[0].getStartTime(), t0);
+        EXPECT_EQ(snapshot[0].getData(), waveforms[i][0].getData());
+    }
+    EXPECT_THROW(static_cast<void> (server.getWaveform("UU.NONE.HHZ.01")),
+                 std::invalid_argument);
+    server.stop();
+    EXPECT_FALSE(server.isRunning());
+    // Channels survive the server
+    EXPECT_TRUE(server.haveChannel("UU.S0.HHZ.01"));
+}
+
+TEST(Ingest, PacedReplay)
+{
+    // 20 s of data at 100 times real time takes about 0.2 s
+    const std::chrono::microseconds t0{1700000000000000};
+    auto waveform = makeWaveform(0, 100, 20, t0);
+    auto packets = Replayer::makePackets(waveform, "UU", "CTU", "EHZ", "01",
+                                         50);
+    // Pre-registered channels receive their packets
+    auto buffer = std::make_shared<RealTimeWaveform<double>> ();
+    buffer->initialize(100, std::chrono::seconds {60});
+    Server server;
+    server.addChannel("UU.CTU.EHZ.01", buffer);
+    EXPECT_THROW(server.addChannel("UU.CTU.EHZ.01", buffer),
+                 std::invalid_argument);
+    // A channel whose packets disagree with its sampling rate
+    auto mismatched = std::make_shared<RealTimeWaveform<double>> ();
+    mismatched->initialize(40, std::chrono::seconds {60});
+    server.addChannel("UU.CTU.HHZ.01", mismatched);
+    server.start(0, 1);
+
+    Replayer replayer;
+    EXPECT_THROW(replayer.replay(packets, 100), std::runtime_error);
+    replayer.connect(server.getPort());
+    EXPECT_TRUE(replayer.isConnected());
+    auto startTime = std::chrono::steady_clock::now();
+    replayer.replay(packets, 100, DataType::Integer32);
+    std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - startTime;
+    // The last packet ends 19.99 s after the first which ends at 0.49 s.
+    // The decoder idles between the paced packets.
+    EXPECT_GE(elapsed.count(), 0.19);
+    ASSERT_TRUE(waitForPackets(server, static_cast<int64_t> (packets.size())));
+    EXPECT_EQ(server.getNumberOfErrors(), 0);
+    auto snapshot = buffer->getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    EXPECT_EQ(snapshot[0].getData(), waveform[0].getData());
+
+    auto wrongRate = Replayer::makePackets(makeWaveform(1, 100, 1, t0),
+                                           "UU", "CTU", "HHZ", "01", 50);
+    replayer.replay(wrongRate, 0);
+    ASSERT_TRUE(waitForPackets(server,
+                               static_cast<int64_t> (packets.size()
+                                                   + wrongRate.size())));
+    EXPECT_EQ(server.getNumberOfErrors(),
+              static_cast<int64_t> (wrongRate.size()));
+    EXPECT_FALSE(mismatched->haveData());
+    replayer.disconnect();
+    server.stop();
+}
+
+}
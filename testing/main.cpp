@@ -1,7 +1,15 @@
+#include <QApplication>
 #include <gtest/gtest.h>
 
 int main(int argc, char *argv[])
 {
+    // The widget tests make scenes and timers so need an application and
+    // its event loop but not a display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication application(argc, argv);
     testing::InitGoogleTest(&argc, argv);
     auto success = RUN_ALL_TESTS();
     return success;
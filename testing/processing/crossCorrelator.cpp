@@ -0,0 +1,313 @@
+#include <vector>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include "qphase/processing/crossCorrelator.hpp"
+#include "qphase/database/internal/arrival.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/gather.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
+#include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+using namespace QPhase::Waveforms;
+using QPhase::Database::Internal::Arrival;
+
+constexpr double SAMPLING_RATE{100};
+constexpr int TEMPLATE_LENGTH{80};
+
+/// @result A Ricker wavelet with a 5 sample width centered at the given
+///         (fractional) sample.
+double ricker(const double sample, const double center)
+{
+    auto u = (sample - center)/5;
+    return (1 - 2*u*u)*std::exp(-u*u);
+}
+
+/// @result Row-major [nChannels x leadingDimension] channels.  Channel c
+///         holds a wavelet centered at onsets[c] in weak noise.
+template<typename T>
+std::vector<T> makeSignals(const std::vector<double> &onsets,
+                           const int nSamples, const int leadingDimension,
+                           const double noise = 0.02)
+{
+    std::mt19937 generator(4453);
+    std::normal_distribution<double> distribution(0, noise);
+    auto nChannels = static_cast<int> (onsets.size());
+    std::vector<T> x(nChannels*leadingDimension, 0);
+    for (int c = 0; c < nChannels; ++c)
+    {
+        auto amplitude = 1 + c%3;
+        for (int i = 0; i < nSamples; ++i)
+        {
+            x[c*leadingDimension + i]
+                = static_cast<T> (amplitude*ricker(i, onsets[c])
+                                + distribution(generator) + 7);
+        }
+    }
+    return x;
+}
+
+/// @result The template: the wavelet centered in the window.
+template<typename T>
+std::vector<T> makeTemplate()
+{
+    std::vector<T> result(TEMPLATE_LENGTH);
+    for (int i = 0; i < TEMPLATE_LENGTH; ++i)
+    {
+        result[i] = static_cast<T> (ricker(i, TEMPLATE_LENGTH/2));
+    }
+    return result;
+}
+
+/// @result The normalized correlation at each lag computed directly.
+template<typename T>
+std::vector<double> reference(const int n, const T *x,
+                              const std::vector<T> &templateSignal)
+{
+    auto m = static_cast<int> (templateSignal.size());
+    double tMean = 0;
+    for (const auto &v : templateSignal){tMean = tMean + v;}
+    tMean = tMean/m;
+    std::vector<double> result(n - m + 1);
+    for (int k = 0; k <= n - m; ++k)
+    {
+        double xMean = 0;
+        for (int i = 0; i < m; ++i){xMean = xMean + x[k + i];}
+        xMean = xMean/m;
+        double xy = 0;
+        double xx = 0;
+        double yy = 0;
+        for (int i = 0; i < m; ++i)
+        {
+            auto t = templateSignal[i] - tMean;
+            auto xi = x[k + i] - xMean;
+            xy = xy + t*xi;
+            xx = xx + xi*xi;
+            yy = yy + t*t;
+        }
+        result[k] = xy/std::sqrt(xx*yy);
+    }
+    return result;
+}
+
+template<class T>
+class CrossCorrelatorTest : public ::testing::Test
+{
+};
+
+using MyTypes = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(CrossCorrelatorTest, MyTypes);
+
+TYPED_TEST(CrossCorrelatorTest, Template)
+{
+    using T = TypeParam;
+    CrossCorrelator<T> correlator;
+    EXPECT_FALSE(correlator.haveTemplate());
+    EXPECT_THROW(static_cast<void> (correlator.getTemplateLength()),
+                 std::runtime_error);
+    std::vector<T> constant(10, 3);
+    EXPECT_THROW(correlator.setTemplate(1, constant.data()),
+                 std::invalid_argument);
+    EXPECT_THROW(correlator.setTemplate(10, nullptr), std::invalid_argument);
+    EXPECT_THROW(correlator.setTemplate(10, constant.data()),
+                 std::invalid_argument);
+    EXPECT_THROW(correlator.setNumberOfThreads(0), std::invalid_argument);
+    auto templateSignal = makeTemplate<T> ();
+    correlator.setTemplate(TEMPLATE_LENGTH, templateSignal.data());
+    correlator.setNumberOfThreads(2);
+    CrossCorrelator<T> copy(correlator);
+    EXPECT_TRUE(copy.haveTemplate());
+    EXPECT_EQ(copy.getTemplateLength(), TEMPLATE_LENGTH);
+    EXPECT_EQ(copy.getNumberOfThreads(), 2);
+    correlator.clear();
+    EXPECT_FALSE(correlator.haveTemplate());
+    EXPECT_EQ(correlator.getNumberOfThreads(), 1);
+}
+
+TYPED_TEST(CrossCorrelatorTest, Reference)
+{
+    using T = TypeParam;
+    // Noisy channels so the peaks are not trivially 1
+    const int nSamples = 997;
+    const int leadingDimension = 1008;
+    std::vector<double> onsets{300.2, 512.7, 90.5, 901.1, 444.4};
+    auto x = makeSignals<T> (onsets, nSamples, leadingDimension, 0.3);
+    auto templateSignal = makeTemplate<T> ();
+    CrossCorrelator<T> correlator;
+    EXPECT_THROW(auto lags = correlator.correlate(5, nSamples,
+                                                  leadingDimension, x.data()),
+                 std::runtime_error);
+    correlator.setTemplate(TEMPLATE_LENGTH, templateSignal.data());
+    EXPECT_THROW(auto lags = correlator.correlate(5, nSamples, nSamples - 1,
+                                                  x.data()),
+                 std::invalid_argument);
+    EXPECT_THROW(auto lags = correlator.correlate(5, TEMPLATE_LENGTH - 1,
+                                                  leadingDimension, x.data()),
+                 std::invalid_argument);
+    auto lags = correlator.correlate(5, nSamples, leadingDimension, x.data());
+    ASSERT_EQ(lags.size(), onsets.size());
+    for (int c = 0; c < static_cast<int> (onsets.size()); ++c)
+    {
+        auto expected = reference(nSamples, x.data() + c*leadingDimension,
+                                  templateSignal);
+        auto peak = std::distance(expected.begin(),
+                                  std::max_element(expected.begin(),
+                                                   expected.end()));
+        EXPECT_EQ(lags[c].channel, c);
+        EXPECT_LE(std::abs(lags[c].lag - peak), 0.5);
+        // Interpolation only raises the peak
+        EXPECT_GE(lags[c].coefficient, expected[peak] - 1.e-5);
+        EXPECT_LE(lags[c].coefficient, expected[peak] + 0.05);
+        EXPECT_NEAR(lags[c].lag, onsets[c] - TEMPLATE_LENGTH/2, 1);
+    }
+}
+
+TYPED_TEST(CrossCorrelatorTest, SubSample)
+{
+    using T = TypeParam;
+    const int nSamples = 1200;
+    std::vector<double> onsets;
+    for (int c = 0; c < 11; ++c){onsets.push_back(200 + 71.13*c);}
+    auto x = makeSignals<T> (onsets, nSamples, nSamples);
+    auto templateSignal = makeTemplate<T> ();
+    CrossCorrelator<T> correlator;
+    correlator.setTemplate(TEMPLATE_LENGTH, templateSignal.data());
+    auto lags = correlator.correlate(11, nSamples, nSamples, x.data());
+    for (int c = 0; c < 11; ++c)
+    {
+        EXPECT_NEAR(lags[c].lag, onsets[c] - TEMPLATE_LENGTH/2, 0.1);
+        EXPECT_GT(lags[c].coefficient, 0.95);
+    }
+    // Threads divide the channels but do not change the result
+    correlator.setNumberOfThreads(4);
+    auto threadedLags = correlator.correlate(11, nSamples, nSamples,
+                                             x.data());
+    for (int c = 0; c < 11; ++c)
+    {
+        EXPECT_EQ(threadedLags[c].channel, c);
+        EXPECT_EQ(threadedLags[c].lag, lags[c].lag);
+        EXPECT_EQ(threadedLags[c].coefficient, lags[c].coefficient);
+    }
+    // A search window that excludes the wavelet
+    std::vector<std::pair<int, int>> windows(11, std::pair {0, 100});
+    EXPECT_THROW(auto result = correlator.correlate(11, nSamples, nSamples,
+                                                    x.data(),
+                                                    {{0, 100}}),
+                 std::invalid_argument);
+    windows[3] = std::pair {nSamples, nSamples + 10};
+    EXPECT_THROW(auto result = correlator.correlate(11, nSamples, nSamples,
+                                                    x.data(), windows),
+                 std::invalid_argument);
+    windows[3] = std::pair {-10, 100};
+    auto windowedLags = correlator.correlate(11, nSamples, nSamples,
+                                             x.data(), windows);
+    for (int c = 0; c < 11; ++c)
+    {
+        EXPECT_LE(windowedLags[c].lag, 100.5);
+        EXPECT_LT(windowedLags[c].coefficient, lags[c].coefficient);
+    }
+}
+
+TYPED_TEST(CrossCorrelatorTest, Arrivals)
+{
+    using T = TypeParam;
+    const int nStations = 3;
+    const int nSamples = 2000;
+    std::vector<double> onsets{500, 731.4, 1102.8};
+    auto x = makeSignals<T> (onsets, nSamples, nSamples);
+    const std::chrono::microseconds t0{1628803598000000};
+    std::vector<Station<T>> stations;
+    for (int s = 0; s < nStations; ++s)
+    {
+        Segment<T> segment;
+        segment.setSamplingRate(SAMPLING_RATE);
+        segment.setStartTime(t0);
+        segment.setData(nSamples, x.data() + s*nSamples);
+        Waveform<T> waveform;
+        waveform.setSegments(std::move(segment));
+        Channel<T> channel;
+        channel.setChannelCode("EHZ");
+        channel.setDip(-90);
+        channel.setWaveform(waveform);
+        SingleChannelVerticalSensor<T> sensor;
+        sensor.setVerticalChannel(channel);
+        Station<T> station;
+        station.setNetworkCode("UU");
+        station.setName("S" + std::to_string(s));
+        station.add(sensor);
+        stations.push_back(std::move(station));
+    }
+    Gather<T> gather;
+    gather.build(stations, t0,
+                 t0 + std::chrono::microseconds {(nSamples - 1)*10000},
+                 SAMPLING_RATE);
+    // Use the first station's wavelet as the template
+    auto row = gather.getRowPointer(0);
+    CrossCorrelator<T> correlator;
+    correlator.setTemplate(TEMPLATE_LENGTH, row + 500 - TEMPLATE_LENGTH/2);
+    auto lags = correlator.correlate(gather);
+    ASSERT_EQ(lags.size(), nStations);
+    EXPECT_NEAR(lags[0].lag, 500 - TEMPLATE_LENGTH/2, 1.e-3);
+    EXPECT_NEAR(lags[0].coefficient, 1, 1.e-5);
+
+    std::vector<Arrival> arrivals;
+    for (int s = nStations - 1; s >= 0; --s)
+    {
+        Arrival arrival;
+        arrival.setNetwork("UU");
+        arrival.setStation("S" + std::to_string(s));
+        arrival.setChannel("EHZ");
+        arrival.setPhase(Arrival::Phase::P);
+        arrival.setTime(t0);
+        arrivals.push_back(arrival);
+    }
+    // An S pick on a correlated channel is not moved by the P template
+    Arrival sArrival;
+    sArrival.setNetwork("UU");
+    sArrival.setStation("S0");
+    sArrival.setChannel("EHZ");
+    sArrival.setPhase(Arrival::Phase::S);
+    sArrival.setTime(t0);
+    arrivals.push_back(sArrival);
+    Arrival unmatched;
+    unmatched.setNetwork("UU");
+    unmatched.setStation("NOPE");
+    unmatched.setChannel("EHZ");
+    unmatched.setPhase(Arrival::Phase::P);
+    unmatched.setTime(t0);
+    arrivals.push_back(unmatched);
+    const std::chrono::microseconds offset{TEMPLATE_LENGTH/2*10000};
+    EXPECT_THROW(updateArrivals(lags, gather, Arrival::Phase::P, offset, 0.9,
+                                nullptr),
+                 std::invalid_argument);
+    auto nUpdated = updateArrivals(lags, gather, Arrival::Phase::P, offset,
+                                   0.9, &arrivals);
+    EXPECT_EQ(nUpdated, nStations);
+    for (int s = 0; s < nStations; ++s)
+    {
+        auto expected = t0 + std::chrono::microseconds
+                        {std::llround(onsets[s]*10000)};
+        auto error = arrivals.at(nStations - 1 - s).getTime() - expected;
+        EXPECT_LE(std::abs(error.count()), 1000);
+    }
+    EXPECT_EQ(arrivals.at(nStations).getTime(), t0);
+    EXPECT_EQ(arrivals.back().getTime(), t0);
+    // An S template moves only the S pick
+    auto pTime = arrivals.at(nStations - 1).getTime();
+    EXPECT_EQ(updateArrivals(lags, gather, Arrival::Phase::S, offset, 0.9,
+                             &arrivals), 1);
+    EXPECT_EQ(arrivals.at(nStations).getTime(), pTime);
+    EXPECT_EQ(arrivals.at(nStations - 1).getTime(), pTime);
+    // A high threshold leaves the arrivals alone
+    EXPECT_EQ(updateArrivals(lags, gather, Arrival::Phase::P, offset, 1.1,
+                             &arrivals), 0);
+}
+
+}
@@ -0,0 +1,164 @@
+#include <vector>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+
+const std::vector<InstructionSet> instructionSets{InstructionSet::Scalar,
+                                                  InstructionSet::AVX2,
+                                                  InstructionSet::AVX512};
+
+template<typename T>
+std::vector<T> makeSignal(const int n)
+{
+    std::mt19937 generator(8675309);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<T> x(n);
+    for (int i = 0; i < n; ++i)
+    {
+        x[i] = static_cast<T> (3 + 0.001*i + distribution(generator));
+    }
+    return x;
+}
+
+template<class T>
+class KernelsTest : public testing::Test
+{
+protected:
+    KernelsTest() :
+        defaultInstructionSet(getInstructionSet())
+    {
+    }
+    ~KernelsTest() override
+    {
+        setInstructionSet(defaultInstructionSet);
+    }
+    InstructionSet defaultInstructionSet;
+    // Exercise the vector body, the tail, and several accumulation blocks
+    std::vector<int> lengths{1, 3, 8, 17, 100, 4096, 10003};
+    double tol = std::is_same<T, float>::value ? 1.e-4 : 1.e-10;
+};
+
+using MyTypes = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(KernelsTest, MyTypes);
+
+TYPED_TEST(KernelsTest, Reductions)
+{
+    for (const auto &instructionSet : instructionSets)
+    {
+        if (!isSupported(instructionSet)){continue;}
+        setInstructionSet(instructionSet);
+        EXPECT_EQ(getInstructionSet(), instructionSet);
+        for (const auto n : this->lengths)
+        {
+            auto x = makeSignal<TypeParam> (n);
+            x[n/2] =-7;
+            auto [vMinRef, vMaxRef] = std::minmax_element(x.begin(), x.end());
+            auto [vMin, vMax] = minMax(n, x.data());
+            EXPECT_EQ(vMin, *vMinRef);
+            EXPECT_EQ(vMax, *vMaxRef);
+            TypeParam absMaxRef = 0;
+            double sum = 0;
+            double sum2 = 0;
+            for (const auto &v : x)
+            {
+                absMaxRef = std::max(absMaxRef, std::abs(v));
+                sum = sum + v;
+                sum2 = sum2 + static_cast<double> (v)*v;
+            }
+            EXPECT_EQ(absoluteMaximum(n, x.data()), absMaxRef);
+            EXPECT_NEAR(mean(n, x.data()), sum/n, this->tol);
+            EXPECT_NEAR(rms(n, x.data()), std::sqrt(sum2/n), this->tol);
+        }
+    }
+    EXPECT_THROW(static_cast<void> (minMax<TypeParam>(0, nullptr)),
+                 std::invalid_argument);
+}
+
+TYPED_TEST(KernelsTest, InPlace)
+{
+    for (const auto &instructionSet : instructionSets)
+    {
+        if (!isSupported(instructionSet)){continue;}
+        setInstructionSet(instructionSet);
+        for (const auto n : this->lengths)
+        {
+            // Demeaned signal has zero mean
+            auto x = makeSignal<TypeParam> (n);
+            demean(n, x.data());
+            double sum = 0;
+            for (const auto &v : x){sum = sum + v;}
+            EXPECT_NEAR(sum/n, 0, this->tol);
+            // A line is removed exactly
+            std::vector<TypeParam> line(n);
+            for (int i = 0; i < n; ++i)
+            {
+                line[i] = static_cast<TypeParam> (2 - 0.5*i/n);
+            }
+            detrend(n, line.data());
+            for (const auto &v : line){EXPECT_NEAR(v, 0, this->tol);}
+            // Scale
+            auto y = makeSignal<TypeParam> (n);
+            auto yRef = y;
+            scale(n, static_cast<TypeParam> (-2.5), y.data());
+            for (int i = 0; i < n; ++i)
+            {
+                EXPECT_EQ(y[i], static_cast<TypeParam> (-2.5)*yRef[i]);
+            }
+        }
+    }
+}
+
+TYPED_TEST(KernelsTest, Taper)
+{
+    const int n = 101;
+    std::vector<TypeParam> x(n, 1);
+    taper(n, 0.1, x.data());
+    // m = 10 samples on each end
+    EXPECT_NEAR(x[0], 0, 1.e-6);
+    EXPECT_NEAR(x[n - 1], 0, 1.e-6);
+    for (int k = 0; k < 10; ++k)
+    {
+        auto weight = 0.5*(1 - std::cos(M_PI*k/10));
+        EXPECT_NEAR(x[k], weight, 1.e-6);
+        EXPECT_NEAR(x[n - 1 - k], weight, 1.e-6);
+    }
+    for (int i = 10; i < n - 10; ++i){EXPECT_EQ(x[i], 1);}
+    EXPECT_THROW(taper(n, 0.6, x.data()), std::invalid_argument);
+}
+
+TYPED_TEST(KernelsTest, Segment)
+{
+    for (const auto &instructionSet : instructionSets)
+    {
+        if (!isSupported(instructionSet)){continue;}
+        setInstructionSet(instructionSet);
+        // Precision conversion on the way into the segment
+        auto x = makeSignal<double> (1001);
+        QPhase::Waveforms::Segment<TypeParam> segment;
+        segment.setSamplingRate(100);
+        segment.setData(x);
+        for (int i = 0; i < static_cast<int> (x.size()); ++i)
+        {
+            EXPECT_EQ(segment.getDataPointer()[i],
+                      static_cast<TypeParam> (x[i]));
+        }
+        auto [vMin, vMax] = minMax(segment);
+        EXPECT_EQ(vMin, static_cast<TypeParam>
+                        (*std::min_element(x.begin(), x.end())));
+        EXPECT_EQ(vMax, static_cast<TypeParam>
+                        (*std::max_element(x.begin(), x.end())));
+        detrend(&segment);
+        EXPECT_NEAR(mean(segment), 0, this->tol);
+        EXPECT_EQ(segment.getNumberOfSamples(), static_cast<int> (x.size()));
+    }
+}
+
+}
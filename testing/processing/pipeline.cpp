@@ -0,0 +1,234 @@
+#include <vector>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include "qphase/processing/pipeline.hpp"
+#include "qphase/processing/sosFilter.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+using namespace QPhase::Waveforms;
+
+/// @result A 100 Hz waveform of a random walk plus a 1 Hz sine starting
+///         at t = 0.
+template<typename T>
+Waveform<T> makeWaveform(const int n)
+{
+    std::mt19937 generator(3832);
+    std::normal_distribution<double> distribution(0, 1);
+    std::vector<T> x(n);
+    double walk = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        walk = walk + distribution(generator);
+        x[i] = static_cast<T> (walk + 10*std::sin(2*M_PI*i/100.));
+    }
+    Segment<T> segment;
+    segment.setSamplingRate(100);
+    segment.setStartTime(std::chrono::microseconds {0});
+    segment.setData(std::move(x));
+    Waveform<T> waveform;
+    waveform.setSegments(std::move(segment));
+    return waveform;
+}
+
+template<class T>
+class PipelineTest : public testing::Test
+{
+};
+
+using Types = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(PipelineTest, Types);
+
+TYPED_TEST(PipelineTest, Identifier)
+{
+    using T = TypeParam;
+    Pipeline<T> pipeline;
+    EXPECT_EQ(pipeline.getNumberOfOperations(), 0);
+    auto id0 = pipeline.getIdentifier();
+    pipeline.addDemean();
+    auto id1 = pipeline.getIdentifier();
+    EXPECT_NE(id0, id1);
+    // A copy is the same chain
+    auto copy = pipeline;
+    EXPECT_EQ(copy.getIdentifier(), id1);
+    copy.addScale(2);
+    EXPECT_NE(copy.getIdentifier(), id1);
+    EXPECT_EQ(pipeline.getIdentifier(), id1);
+    EXPECT_THROW(pipeline.addTaper(1.5), std::invalid_argument);
+    SOSFilter<T> filter;
+    EXPECT_THROW(pipeline.addFilter(filter, false,
+                                    std::chrono::microseconds {0}),
+                 std::invalid_argument);
+    filter.initializeLowpass(2, 5, 100);
+    pipeline.addFilter(filter, true, std::chrono::seconds {2});
+    pipeline.addFilter(filter, false, std::chrono::seconds {1});
+    EXPECT_EQ(pipeline.getPadding(), std::chrono::seconds {3});
+    EXPECT_EQ(pipeline.getNumberOfOperations(), 3);
+}
+
+TYPED_TEST(PipelineTest, Window)
+{
+    using T = TypeParam;
+    auto waveform = makeWaveform<T>(60000);
+    // Eager: filter everything
+    SOSFilter<T> filter;
+    filter.initializeHighpass(2, 1, 100);
+    auto eager = waveform;
+    filter.filter(&eager, false);
+    // Lazy: only 10 s to 20 s with 30 s of warm-up
+    Pipeline<T> pipeline;
+    pipeline.addFilter(filter, false, std::chrono::seconds {30});
+    pipeline.addScale(2);
+    std::chrono::microseconds t0{10000000};
+    std::chrono::microseconds t1{20000000};
+    auto lazy = pipeline.evaluate(waveform, t0, t1);
+    ASSERT_EQ(lazy.getNumberOfSegments(), 1);
+    EXPECT_EQ(lazy[0].getStartTime(), t0);
+    EXPECT_EQ(lazy[0].getNumberOfSamples(), 1001);
+    const auto y = lazy[0].getDataPointer();
+    const auto yRef = eager[0].getDataPointer() + 1000;
+    for (int i = 0; i < 1001; ++i)
+    {
+        EXPECT_NEAR(y[i], 2*yRef[i], 1.e-2);
+    }
+    // Later window has enough data for full warm-up
+    t0 = std::chrono::microseconds {400000000};
+    t1 = std::chrono::microseconds {401000000};
+    lazy = pipeline.evaluate(waveform, t0, t1);
+    ASSERT_EQ(lazy[0].getNumberOfSamples(), 101);
+    for (int i = 0; i < 101; ++i)
+    {
+        EXPECT_NEAR(lazy[0].getDataPointer()[i],
+                    2*eager[0].getDataPointer()[40000 + i], 1.e-2);
+    }
+    // Outside of the data
+    lazy = pipeline.evaluate(waveform,
+                             std::chrono::microseconds {700000000},
+                             std::chrono::microseconds {800000000});
+    EXPECT_EQ(lazy.getNumberOfSegments(), 0);
+}
+
+TYPED_TEST(PipelineTest, Taper)
+{
+    using T = TypeParam;
+    // A constant so the output is the Hann window itself
+    constexpr int n{1000};
+    Segment<T> segment;
+    segment.setSamplingRate(100);
+    segment.setStartTime(std::chrono::microseconds {0});
+    segment.setData(std::vector<T> (n, 1));
+    Waveform<T> waveform;
+    waveform.setSegments(std::move(segment));
+    Pipeline<T> pipeline;
+    // 20 percent in total -> 100 samples at either end
+    pipeline.addTaper(0.2);
+    auto tapered = pipeline.evaluate(waveform,
+                                     std::chrono::microseconds {0},
+                                     std::chrono::microseconds {9990000});
+    ASSERT_EQ(tapered.getNumberOfSegments(), 1);
+    ASSERT_EQ(tapered[0].getNumberOfSamples(), n);
+    const auto y = tapered[0].getDataPointer();
+    constexpr int m{100};
+    for (int k = 0; k < m; ++k)
+    {
+        auto weight = 0.5*(1 - std::cos(M_PI*k/m));
+        EXPECT_NEAR(y[k], weight, 1.e-5);
+        EXPECT_NEAR(y[n - 1 - k], weight, 1.e-5);
+    }
+    for (int k = m; k < n - m; ++k)
+    {
+        EXPECT_EQ(y[k], 1);
+    }
+    // The whole trace is a full Hann window
+    Pipeline<T> full;
+    full.addTaper(1);
+    tapered = full.evaluate(waveform,
+                            std::chrono::microseconds {0},
+                            std::chrono::microseconds {9990000});
+    ASSERT_EQ(tapered[0].getNumberOfSamples(), n);
+    EXPECT_NEAR(tapered[0].getDataPointer()[0], 0, 1.e-6);
+    EXPECT_NEAR(tapered[0].getDataPointer()[n/4],
+                0.5*(1 - std::cos(M_PI*(n/4)/(n/2))), 1.e-5);
+}
+
+TYPED_TEST(PipelineTest, Resolution)
+{
+    using T = TypeParam;
+    auto waveform = makeWaveform<T>(6000);
+    Pipeline<T> pipeline;
+    pipeline.addNormalize();
+    std::chrono::microseconds t0{0};
+    std::chrono::microseconds t1{59990000};
+    auto full = pipeline.evaluate(waveform, t0, t1);
+    // 10 samples per second -> runs of 20 samples at 100 Hz
+    auto reduced = pipeline.evaluate(waveform, t0, t1, 10);
+    ASSERT_EQ(reduced.getNumberOfSegments(), 1);
+    EXPECT_EQ(reduced[0].getNumberOfSamples(), 600);
+    EXPECT_NEAR(reduced[0].getSamplingRate(), 10, 1.e-12);
+    EXPECT_EQ(reduced[0].getStartTime(), t0);
+    // The envelope is preserved
+    EXPECT_NEAR(absoluteMaximum(full[0]), 1, 1.e-6);
+    auto [fMin, fMax] = minMax(full[0]);
+    auto [rMin, rMax] = minMax(reduced[0]);
+    EXPECT_EQ(fMin, rMin);
+    EXPECT_EQ(fMax, rMax);
+    // Each pair holds the extremes of its run in time order
+    const auto x = full[0].getDataPointer();
+    const auto y = reduced[0].getDataPointer();
+    for (int run = 0; run < 300; ++run)
+    {
+        auto [v0, v1] = minMax(20, x + 20*run);
+        EXPECT_EQ(std::min(y[2*run], y[2*run + 1]), v0);
+        EXPECT_EQ(std::max(y[2*run], y[2*run + 1]), v1);
+    }
+}
+
+TYPED_TEST(PipelineTest, ChannelMemoization)
+{
+    using T = TypeParam;
+    Channel<T> channel;
+    channel.setWaveform(makeWaveform<T>(6000));
+    EXPECT_FALSE(channel.haveProcessingPipeline());
+    std::chrono::microseconds t0{1000000};
+    std::chrono::microseconds t1{2000000};
+    // No processing -> the raw samples
+    auto raw = channel.getProcessedWaveform(t0, t1);
+    ASSERT_EQ(raw->getNumberOfSegments(), 1);
+    EXPECT_EQ(raw->at(0).getDataPointer()[0],
+              channel.getWaveformReference()[0].getDataPointer()[100]);
+    Pipeline<T> pipeline;
+    pipeline.addDemean();
+    channel.setProcessingPipeline(pipeline);
+    EXPECT_TRUE(channel.haveProcessingPipeline());
+    auto first = channel.getProcessedWaveform(t0, t1);
+    EXPECT_NE(first.get(), raw.get());
+    EXPECT_NEAR(mean(first->at(0)), 0, 1.e-4);
+    // Repeated requests are served from the cache
+    auto second = channel.getProcessedWaveform(t0, t1);
+    EXPECT_EQ(first.get(), second.get());
+    auto other = channel.getProcessedWaveform(t0, t1, 10);
+    EXPECT_NE(first.get(), other.get());
+    EXPECT_EQ(channel.getProcessedWaveform(t0, t1).get(), first.get());
+    // Changing the parameters invalidates the cache
+    pipeline.addScale(3);
+    channel.setProcessingPipeline(pipeline);
+    auto third = channel.getProcessedWaveform(t0, t1);
+    EXPECT_NE(first.get(), third.get());
+    EXPECT_NEAR(third->at(0).getDataPointer()[10],
+                3*first->at(0).getDataPointer()[10], 1.e-3);
+    // So does changing the data
+    channel.setWaveform(makeWaveform<T>(3000));
+    EXPECT_NE(channel.getProcessedWaveform(t0, t1).get(), third.get());
+    EXPECT_THROW(static_cast<void> (channel.getProcessedWaveform(t1, t0)),
+                 std::invalid_argument);
+}
+
+}
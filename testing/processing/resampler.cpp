@@ -0,0 +1,111 @@
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include "qphase/processing/resampler.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+using namespace QPhase::Waveforms;
+
+template<typename T>
+Segment<T> makeSinusoid(const double samplingRate, const int n,
+                        const double frequency)
+{
+    std::vector<T> x(n);
+    for (int i = 0; i < n; ++i)
+    {
+        x[i] = static_cast<T> (std::sin(2*M_PI*frequency*i/samplingRate));
+    }
+    Segment<T> segment;
+    segment.setSamplingRate(samplingRate);
+    segment.setStartTime(std::chrono::microseconds {1628803598000000});
+    segment.setData(std::move(x));
+    return segment;
+}
+
+template<class T>
+class ResamplerTest : public testing::Test
+{
+protected:
+    // The Kaiser window (beta = 5) has a passband ripple of a few tenths
+    // of a percent
+    double tol{5.e-3};
+};
+
+using MyTypes = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(ResamplerTest, MyTypes);
+
+TYPED_TEST(ResamplerTest, Initialize)
+{
+    Resampler<TypeParam> resampler;
+    EXPECT_FALSE(resampler.isInitialized());
+    resampler.initialize(4, 10);
+    EXPECT_EQ(resampler.getUpFactor(), 2);
+    EXPECT_EQ(resampler.getDownFactor(), 5);
+    EXPECT_EQ(resampler.getOutputLength(1), 1);
+    EXPECT_EQ(resampler.getOutputLength(11), 5);
+    // The passband gain of the anti-alias filter is L
+    auto taps = resampler.getFilterCoefficients();
+    double sum = 0;
+    for (const auto &tap : taps){sum = sum + tap;}
+    EXPECT_NEAR(sum, 2, 1.e-12);
+
+    resampler.initializeFromSamplingRates(40, 100);
+    EXPECT_EQ(resampler.getUpFactor(), 5);
+    EXPECT_EQ(resampler.getDownFactor(), 2);
+    EXPECT_THROW(resampler.initialize(0, 1), std::invalid_argument);
+    EXPECT_THROW(resampler.initialize(1, 1001), std::invalid_argument);
+}
+
+TYPED_TEST(ResamplerTest, Decimate)
+{
+    // 500 -> 100 sps
+    Resampler<TypeParam> resampler;
+    resampler.initialize(1, 5);
+    const double frequency{3};
+    auto segment = makeSinusoid<TypeParam> (500, 5001, frequency);
+    auto result = resampler.apply(segment);
+    EXPECT_EQ(result.getStartTime(), segment.getStartTime());
+    EXPECT_EQ(result.getSamplingRateAsFraction(),
+              (std::pair<int64_t, int64_t> {100, 1}));
+    EXPECT_EQ(result.getEndTime(), segment.getEndTime());
+    ASSERT_EQ(result.getNumberOfSamples(), 1001);
+    auto y = result.getDataPointer();
+    // Avoid the filter's edge effects
+    for (int k = 20; k < 1001 - 20; ++k)
+    {
+        EXPECT_NEAR(y[k], std::sin(2*M_PI*frequency*k/100), this->tol);
+    }
+}
+
+TYPED_TEST(ResamplerTest, Rational)
+{
+    // 40 -> 100 sps on a gap-split waveform
+    Resampler<TypeParam> resampler;
+    resampler.initializeFromSamplingRates(40, 100);
+    const double frequency{2};
+    auto segment1 = makeSinusoid<TypeParam> (40, 801, frequency);
+    auto segment2 = makeSinusoid<TypeParam> (40, 400, frequency);
+    segment2.setStartTime(segment1.getEndTime()
+                        + std::chrono::microseconds {10000000});
+    Waveform<TypeParam> waveform;
+    waveform.setSegments(std::vector<Segment<TypeParam>> {segment1, segment2});
+    auto result = resampler.apply(waveform);
+    ASSERT_EQ(result.getNumberOfSegments(), 2);
+    EXPECT_EQ(result[0].getNumberOfSamples(), 2001);
+    EXPECT_EQ(result[1].getNumberOfSamples(), 998);
+    EXPECT_EQ(result[1].getStartTime(), segment2.getStartTime());
+    EXPECT_NEAR(result[0].getSamplingRate(), 100, 1.e-12);
+    auto y = result[0].getDataPointer();
+    for (int k = 50; k < 2001 - 50; ++k)
+    {
+        EXPECT_NEAR(y[k], std::sin(2*M_PI*frequency*k/100), this->tol);
+    }
+}
+
+}
@@ -0,0 +1,296 @@
+#include <vector>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <chrono>
+#include "qphase/processing/rotator.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/gather.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
+#include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/threeChannelSensor.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+using namespace QPhase::Waveforms;
+
+constexpr double SAMPLING_RATE{100};
+constexpr int N_SAMPLES{1001};
+const std::chrono::microseconds START_TIME{1628803598000000};
+constexpr double TO_RADIANS{std::numbers::pi/180};
+
+/// Ground motion of one station.
+struct Motion
+{
+    std::vector<double> vertical;
+    std::vector<double> north;
+    std::vector<double> east;
+};
+
+std::vector<Motion> makeMotions(const int nStations)
+{
+    std::mt19937 generator(5309);
+    std::normal_distribution<double> distribution(0, 1);
+    std::vector<Motion> motions(nStations);
+    for (auto &motion : motions)
+    {
+        for (auto *x : {&motion.vertical, &motion.north, &motion.east})
+        {
+            x->resize(N_SAMPLES);
+            for (auto &v : *x){v = distribution(generator);}
+        }
+    }
+    return motions;
+}
+
+template<typename T>
+Channel<T> makeChannel(const std::string &code, const std::vector<double> &x,
+                       const double dip, const double azimuth,
+                       const int nSamples = N_SAMPLES)
+{
+    std::vector<T> samples(x.begin(), x.begin() + nSamples);
+    Segment<T> segment;
+    segment.setSamplingRate(SAMPLING_RATE);
+    segment.setStartTime(START_TIME);
+    segment.setData(samples.size(), samples.data());
+    Waveform<T> waveform;
+    waveform.setSegments(std::move(segment));
+    Channel<T> channel;
+    channel.setChannelCode(code);
+    channel.setDip(dip);
+    if (std::isfinite(azimuth)){channel.setAzimuth(azimuth);}
+    channel.setWaveform(waveform);
+    return channel;
+}
+
+/// @result The stations.  Each has a three-channel sensor whose
+///         horizontals are at the given azimuths; a NaN azimuth is left
+///         unset.  The first station also has a single-channel sensor.
+template<typename T>
+std::vector<Station<T>> makeStations(
+    const std::vector<Motion> &motions,
+    const std::vector<std::pair<double, double>> &azimuths,
+    const int shortEastSamples = N_SAMPLES)
+{
+    std::vector<Station<T>> stations;
+    for (int s = 0; s < static_cast<int> (motions.size()); ++s)
+    {
+        const auto &motion = motions[s];
+        auto [a1, a2] = azimuths[s];
+        auto a1Known = std::isfinite(a1) ? a1 : 0;
+        auto a2Known = std::isfinite(a2) ? a2 : 90;
+        std::vector<double> h1(N_SAMPLES);
+        std::vector<double> h2(N_SAMPLES);
+        for (int i = 0; i < N_SAMPLES; ++i)
+        {
+            h1[i] = std::cos(a1Known*TO_RADIANS)*motion.north[i]
+                  + std::sin(a1Known*TO_RADIANS)*motion.east[i];
+            h2[i] = std::cos(a2Known*TO_RADIANS)*motion.north[i]
+                  + std::sin(a2Known*TO_RADIANS)*motion.east[i];
+        }
+        bool numbered = std::isfinite(a1) && std::abs(a1) > 0;
+        ThreeChannelSensor<T> sensor;
+        sensor.setLatitude(40 + s);
+        sensor.setLongitude(-112 + 0.5*s);
+        sensor.setVerticalChannel(makeChannel<T> ("HHZ", motion.vertical,
+                                                  -90, 0));
+        sensor.setNorthChannel(makeChannel<T> (numbered ? "HH1" : "HHN",
+                                               h1, 0, a1));
+        sensor.setEastChannel(makeChannel<T> (numbered ? "HH2" : "HHE",
+                                              h2, 0, a2,
+                                              s == 0 ? shortEastSamples :
+                                                       N_SAMPLES));
+        Station<T> station;
+        station.setNetworkCode("UU");
+        station.setName("S" + std::to_string(s));
+        station.add(sensor);
+        if (s == 0)
+        {
+            SingleChannelVerticalSensor<T> single;
+            single.setVerticalChannel(makeChannel<T> ("EHZ", motion.north,
+                                                      -90, 0));
+            station.add(single);
+        }
+        stations.push_back(std::move(station));
+    }
+    return stations;
+}
+
+template<typename T>
+Gather<T> makeGather(const std::vector<Station<T>> &stations)
+{
+    Gather<T> gather;
+    gather.build(stations, START_TIME,
+                 START_TIME + std::chrono::microseconds {(N_SAMPLES - 1)*10000},
+                 SAMPLING_RATE);
+    return gather;
+}
+
+template<typename T>
+class RotatorTest : public ::testing::Test
+{
+protected:
+    RotatorTest() :
+        defaultInstructionSet(getInstructionSet())
+    {
+    }
+    ~RotatorTest() override
+    {
+        setInstructionSet(defaultInstructionSet);
+    }
+    InstructionSet defaultInstructionSet;
+};
+
+using MyTypes = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(RotatorTest, MyTypes);
+
+TYPED_TEST(RotatorTest, Initialize)
+{
+    using T = TypeParam;
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    auto motions = makeMotions(3);
+    auto gather = makeGather(makeStations<T> (motions,
+                                              {{0, 90}, {30, 120}, {NaN, NaN}}));
+    using Component = typename Gather<T>::Component;
+    const auto &metadata = gather.getMetadataReference();
+    ASSERT_EQ(metadata.size(), 10);
+    EXPECT_EQ(metadata[0].component, Component::Vertical);
+    EXPECT_EQ(metadata[1].component, Component::Horizontal1);
+    EXPECT_EQ(metadata[2].component, Component::Horizontal2);
+    EXPECT_EQ(metadata[3].component, Component::Vertical);
+    EXPECT_EQ(metadata[3].channel, "EHZ");
+
+    Rotator<T> rotator;
+    EXPECT_FALSE(rotator.isInitialized());
+    EXPECT_THROW(rotator.setNumberOfThreads(0), std::invalid_argument);
+    rotator.setNumberOfThreads(2);
+    rotator.initialize(gather);
+    EXPECT_TRUE(rotator.isInitialized());
+    EXPECT_EQ(rotator.getNumberOfThreads(), 2);
+    EXPECT_EQ(rotator.getNumberOfSensors(), 3);
+    EXPECT_EQ(rotator.getVerticalRows(), (std::vector<int> {0, 4, 7}));
+    EXPECT_FALSE(rotator.haveBackAzimuths());
+    EXPECT_THROW(rotator.rotate(Rotator<T>::Orientation::RadialTransverse,
+                                &gather),
+                 std::runtime_error);
+    EXPECT_THROW(rotator.setBackAzimuths({10, 20}), std::invalid_argument);
+    EXPECT_THROW(rotator.setEventLocation(91, 0), std::invalid_argument);
+    // Back-azimuths on a sphere
+    rotator.setEventLocation(40, -112 + 10);
+    auto backAzimuths = rotator.getBackAzimuths();
+    EXPECT_GT(backAzimuths.at(0), 80);
+    EXPECT_LT(backAzimuths.at(0), 90);
+    rotator.setEventLocation(60, -112);
+    EXPECT_NEAR(rotator.getBackAzimuths().at(0), 0, 1.e-10);
+    rotator.setBackAzimuths({-10, 370, 45});
+    EXPECT_NEAR(rotator.getBackAzimuths().at(0), 350, 1.e-10);
+    EXPECT_NEAR(rotator.getBackAzimuths().at(1), 10, 1.e-10);
+
+    // Parallel horizontals cannot be rotated
+    auto parallel = makeGather(makeStations<T> (motions,
+                                                {{0, 90}, {30, 35}, {0, 90}}));
+    EXPECT_THROW(rotator.initialize(parallel), std::invalid_argument);
+    EXPECT_THROW(rotator.rotate(Rotator<T>::Orientation::NorthEast,
+                                &parallel),
+                 std::invalid_argument);
+}
+
+TYPED_TEST(RotatorTest, Rotate)
+{
+    using T = TypeParam;
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    const int nStations = 5;
+    auto motions = makeMotions(nStations);
+    std::vector<std::pair<double, double>> azimuths{{0, 90}, {30, 120},
+                                                    {NaN, NaN}, {200, 110},
+                                                    {315, 45}};
+    auto stations = makeStations<T> (motions, azimuths, N_SAMPLES - 100);
+    auto original = makeGather(stations);
+    std::vector<double> backAzimuths{10, 95, 181, 270, 359};
+    auto tolerance = std::is_same_v<T, float> ? 1.e-4 : 1.e-10;
+    for (const auto instructionSet : {InstructionSet::Scalar,
+                                      InstructionSet::AVX2,
+                                      InstructionSet::AVX512})
+    {
+        if (!isSupported(instructionSet)){continue;}
+        setInstructionSet(instructionSet);
+        for (const int nThreads : {1, 3})
+        {
+            auto gather = original;
+            Rotator<T> rotator;
+            rotator.setNumberOfThreads(nThreads);
+            rotator.initialize(gather);
+            rotator.setBackAzimuths(backAzimuths);
+            rotator.rotate(Rotator<T>::Orientation::NorthEast, &gather);
+            auto rows = rotator.getVerticalRows();
+            const auto &metadata = gather.getMetadataReference();
+            for (int s = 0; s < nStations; ++s)
+            {
+                auto row = rows[s];
+                EXPECT_EQ(metadata[row + 1].channel, "HHN");
+                EXPECT_EQ(metadata[row + 2].channel, "HHE");
+                EXPECT_NEAR(metadata[row + 1].azimuth, 0, 1.e-12);
+                EXPECT_NEAR(metadata[row + 2].azimuth, 90, 1.e-12);
+                auto z = gather.getRowPointer(row);
+                auto n = gather.getRowPointer(row + 1);
+                auto e = gather.getRowPointer(row + 2);
+                for (int i = 0; i < N_SAMPLES; ++i)
+                {
+                    if (s == 0 && i >= N_SAMPLES - 100)
+                    {
+                        // The east gap is merged into both horizontals
+                        EXPECT_FALSE(gather.isValid(row + 1, i));
+                        EXPECT_FALSE(gather.isValid(row + 2, i));
+                        EXPECT_EQ(n[i], 0);
+                        EXPECT_EQ(e[i], 0);
+                        continue;
+                    }
+                    EXPECT_EQ(z[i], static_cast<T> (motions[s].vertical[i]));
+                    EXPECT_NEAR(n[i], motions[s].north[i], tolerance);
+                    EXPECT_NEAR(e[i], motions[s].east[i], tolerance);
+                }
+            }
+            EXPECT_EQ(metadata[rows[0] + 1].numberOfValidSamples,
+                      N_SAMPLES - 100);
+            // Radial is away from the event and transverse is clockwise
+            rotator.rotate(Rotator<T>::Orientation::RadialTransverse,
+                           &gather);
+            for (int s = 0; s < nStations; ++s)
+            {
+                auto row = rows[s];
+                EXPECT_EQ(metadata[row + 1].channel, "HHR");
+                EXPECT_EQ(metadata[row + 2].channel, "HHT");
+                auto baz = backAzimuths[s]*TO_RADIANS;
+                auto r = gather.getRowPointer(row + 1);
+                auto t = gather.getRowPointer(row + 2);
+                for (int i = 0; i < N_SAMPLES - 100; ++i)
+                {
+                    auto north = motions[s].north[i];
+                    auto east = motions[s].east[i];
+                    EXPECT_NEAR(r[i], -north*std::cos(baz) - east*std::sin(baz),
+                                tolerance);
+                    EXPECT_NEAR(t[i], north*std::sin(baz) - east*std::cos(baz),
+                                tolerance);
+                }
+            }
+            // And back
+            rotator.rotate(Rotator<T>::Orientation::NorthEast, &gather);
+            for (int s = 0; s < nStations; ++s)
+            {
+                auto n = gather.getRowPointer(rows[s] + 1);
+                for (int i = 0; i < N_SAMPLES - 100; ++i)
+                {
+                    EXPECT_NEAR(n[i], motions[s].north[i], tolerance);
+                }
+            }
+        }
+    }
+}
+
+}
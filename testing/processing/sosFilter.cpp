@@ -0,0 +1,270 @@
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <chrono>
+#include "qphase/processing/sosFilter.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+using namespace QPhase::Waveforms;
+
+/// @result |H(f)| of the cascade.
+double magnitude(const SOSFilter<double> &filter,
+                 const double f, const double samplingRate)
+{
+    auto b = filter.getNumeratorCoefficients();
+    auto a = filter.getDenominatorCoefficients();
+    auto z1 = std::polar(1.0, -2*M_PI*f/samplingRate);
+    std::complex<double> h{1, 0};
+    for (int k = 0; k < filter.getNumberOfSections(); ++k)
+    {
+        h = h*(b[3*k] + b[3*k + 1]*z1 + b[3*k + 2]*z1*z1)
+             /(a[3*k] + a[3*k + 1]*z1 + a[3*k + 2]*z1*z1);
+    }
+    return std::abs(h);
+}
+
+template<typename T>
+std::vector<T> makeSignal(const int n, const int seed)
+{
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> distribution(0, 1);
+    std::vector<T> x(n);
+    for (auto &v : x){v = static_cast<T> (distribution(generator));}
+    return x;
+}
+
+/// @result A waveform with the signal split into segments of the given
+///         lengths.  The segments are separated by gaps of the given
+///         duration; zero means the segments abut.
+template<typename T>
+Waveform<T> makeWaveform(const std::vector<T> &x,
+                         const std::vector<int> &lengths,
+                         const int64_t gap = 500000)
+{
+    std::vector<Segment<T>> segments;
+    int i0 = 0;
+    for (const auto &length : lengths)
+    {
+        Segment<T> segment;
+        segment.setSamplingRate(100);
+        auto nSegments = static_cast<int64_t> (segments.size());
+        segment.setStartTime(
+            std::chrono::microseconds {i0*10000 + nSegments*gap});
+        segment.setData(length, x.data() + i0);
+        segments.push_back(std::move(segment));
+        i0 = i0 + length;
+    }
+    Waveform<T> waveform;
+    waveform.setSegments(std::move(segments));
+    return waveform;
+}
+
+template<typename T>
+std::vector<T> concatenate(const Waveform<T> &waveform)
+{
+    std::vector<T> result;
+    for (const auto &segment : waveform)
+    {
+        auto data = segment.getData();
+        result.insert(result.end(), data.begin(), data.end());
+    }
+    return result;
+}
+
+TEST(SOSFilter, Design)
+{
+    const double samplingRate{100};
+    SOSFilter<double> filter;
+    EXPECT_FALSE(filter.isInitialized());
+    // Butterworth filters are -3 dB at the corners and flat in the passband
+    filter.initializeLowpass(5, 10, samplingRate);
+    EXPECT_EQ(filter.getNumberOfSections(), 3);
+    EXPECT_NEAR(magnitude(filter, 0, samplingRate), 1, 1.e-12);
+    EXPECT_NEAR(magnitude(filter, 10, samplingRate), 1/std::sqrt(2.), 1.e-12);
+    EXPECT_NEAR(magnitude(filter, 50, samplingRate), 0, 1.e-12);
+
+    filter.initializeHighpass(4, 2, samplingRate);
+    EXPECT_EQ(filter.getNumberOfSections(), 2);
+    EXPECT_NEAR(magnitude(filter, 50, samplingRate), 1, 1.e-12);
+    EXPECT_NEAR(magnitude(filter, 2, samplingRate), 1/std::sqrt(2.), 1.e-12);
+    EXPECT_NEAR(magnitude(filter, 0, samplingRate), 0, 1.e-12);
+
+    filter.initializeBandpass(3, std::pair {1., 8.}, samplingRate);
+    EXPECT_EQ(filter.getNumberOfSections(), 3);
+    EXPECT_NEAR(magnitude(filter, 1, samplingRate), 1/std::sqrt(2.), 1.e-10);
+    EXPECT_NEAR(magnitude(filter, 8, samplingRate), 1/std::sqrt(2.), 1.e-10);
+    EXPECT_NEAR(magnitude(filter, 0, samplingRate), 0, 1.e-12);
+    EXPECT_NEAR(magnitude(filter, 50, samplingRate), 0, 1.e-12);
+
+    EXPECT_THROW(filter.initializeLowpass(0, 10, samplingRate),
+                 std::invalid_argument);
+    EXPECT_THROW(filter.initializeLowpass(2, 50, samplingRate),
+                 std::invalid_argument);
+    EXPECT_THROW(filter.initializeBandpass(2, std::pair {8., 1.},
+                                           samplingRate),
+                 std::invalid_argument);
+    EXPECT_THROW(filter.initialize({1, 0, 0}, {0, 1, 0}),
+                 std::invalid_argument);
+}
+
+TEST(SOSFilter, Streaming)
+{
+    SOSFilter<double> filter;
+    filter.initializeBandpass(2, std::pair {1., 10.}, 100);
+    auto x = makeSignal<double> (2000, 1);
+    auto yReference = x;
+    filter.apply(static_cast<int> (yReference.size()), yReference.data());
+    // Filtering in pieces continues from the saved state
+    filter.resetInitialConditions();
+    auto y = x;
+    filter.apply(333, y.data());
+    filter.apply(1, y.data() + 333);
+    filter.apply(static_cast<int> (y.size()) - 334, y.data() + 334);
+    for (int i = 0; i < static_cast<int> (y.size()); ++i)
+    {
+        EXPECT_NEAR(y[i], yReference[i], 1.e-12);
+    }
+    // The state is carried across abutting segments so a contiguous split
+    // matches the unsplit signal exactly, forward and zero-phase
+    for (const bool zeroPhase : {false, true})
+    {
+        auto whole = makeWaveform(x, {2000});
+        filter.filter(&whole, zeroPhase);
+        auto split = makeWaveform(x, {700, 1, 1299}, 0);
+        filter.filter(&split, zeroPhase);
+        EXPECT_EQ(concatenate(split), concatenate(whole));
+    }
+    // The filter restarts from rest after each gap
+    auto waveform = makeWaveform(x, {700, 1, 1299});
+    filter.filter(&waveform);
+    auto yWaveform = concatenate(waveform);
+    y = x;
+    int i0 = 0;
+    for (const int length : {700, 1, 1299})
+    {
+        filter.resetInitialConditions();
+        filter.apply(length, y.data() + i0);
+        i0 = i0 + length;
+    }
+    for (int i = 0; i < static_cast<int> (y.size()); ++i)
+    {
+        EXPECT_NEAR(yWaveform[i], y[i], 1.e-12);
+    }
+    // A gap after a contiguous run restarts only there
+    auto mixed = makeWaveform(x, {700, 1}, 0);
+    auto segments = std::vector<Segment<double>> (mixed.begin(), mixed.end());
+    Segment<double> last;
+    last.setSamplingRate(100);
+    last.setStartTime(std::chrono::microseconds {701*10000 + 500000});
+    last.setData(1299, x.data() + 701);
+    segments.push_back(std::move(last));
+    mixed.setSegments(std::move(segments));
+    filter.filter(&mixed);
+    auto yMixed = concatenate(mixed);
+    y = x;
+    filter.resetInitialConditions();
+    filter.apply(701, y.data());
+    filter.resetInitialConditions();
+    filter.apply(1299, y.data() + 701);
+    for (int i = 0; i < static_cast<int> (y.size()); ++i)
+    {
+        EXPECT_NEAR(yMixed[i], y[i], 1.e-12);
+    }
+}
+
+TEST(SOSFilter, ZeroPhase)
+{
+    // The zero-phase response to a centered impulse is symmetric
+    const int n = 1001;
+    std::vector<double> x(n, 0);
+    x[n/2] = 1;
+    SOSFilter<double> filter;
+    filter.initializeBandpass(2, std::pair {2., 10.}, 100);
+    auto waveform = makeWaveform(x, {300, 701});
+    filter.filter(&waveform, true);
+    auto y = concatenate(waveform);
+    double peak = 0;
+    for (const auto &v : y){peak = std::max(peak, std::abs(v));}
+    EXPECT_NEAR(std::abs(y[n/2]), peak, 1.e-14);
+    for (int i = 1; i < 100; ++i)
+    {
+        EXPECT_NEAR(y[n/2 - i], y[n/2 + i], 1.e-10);
+    }
+}
+
+template<class T>
+class SOSFilterTest : public testing::Test
+{
+protected:
+    SOSFilterTest() :
+        defaultInstructionSet(getInstructionSet())
+    {
+    }
+    ~SOSFilterTest() override
+    {
+        setInstructionSet(defaultInstructionSet);
+    }
+    InstructionSet defaultInstructionSet;
+};
+
+using MyTypes = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(SOSFilterTest, MyTypes);
+
+TYPED_TEST(SOSFilterTest, MultiChannel)
+{
+    SOSFilter<TypeParam> filter;
+    filter.initializeBandpass(3, std::pair {1., 15.}, 100);
+    // Channels of different lengths and segmentations
+    const int nChannels = 37;
+    std::vector<Waveform<TypeParam>> references;
+    for (int c = 0; c < nChannels; ++c)
+    {
+        auto x = makeSignal<TypeParam> (500 + 37*c, c);
+        auto waveform = makeWaveform(x, {200 + c, 300 + 36*c});
+        filter.filter(&waveform, c%2 == 0);
+        references.push_back(std::move(waveform));
+    }
+    for (const auto instructionSet : {InstructionSet::Scalar,
+                                      InstructionSet::AVX2,
+                                      InstructionSet::AVX512})
+    {
+        if (!isSupported(instructionSet)){continue;}
+        setInstructionSet(instructionSet);
+        for (const bool zeroPhase : {false, true})
+        {
+            std::vector<Waveform<TypeParam>> waveforms;
+            std::vector<Waveform<TypeParam> *> pointers;
+            for (int c = 0; c < nChannels; ++c)
+            {
+                if (zeroPhase != (c%2 == 0)){continue;}
+                auto x = makeSignal<TypeParam> (500 + 37*c, c);
+                waveforms.push_back(makeWaveform(x, {200 + c, 300 + 36*c}));
+            }
+            for (auto &waveform : waveforms){pointers.push_back(&waveform);}
+            filter.filter(pointers, zeroPhase);
+            int j = 0;
+            for (int c = 0; c < nChannels; ++c)
+            {
+                if (zeroPhase != (c%2 == 0)){continue;}
+                auto y = concatenate(waveforms.at(j));
+                auto yReference = concatenate(references.at(c));
+                ASSERT_EQ(y.size(), yReference.size());
+                for (int i = 0; i < static_cast<int> (y.size()); ++i)
+                {
+                    EXPECT_NEAR(y[i], yReference[i], 1.e-5);
+                }
+                j = j + 1;
+            }
+        }
+    }
+}
+
+}
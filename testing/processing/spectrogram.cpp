@@ -0,0 +1,282 @@
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <random>
+#include <chrono>
+#include "qphase/processing/spectrogram.hpp"
+#include "qphase/processing/spectrogramTileCache.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "private/processing/fft.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+using namespace QPhase::Waveforms;
+
+template<typename T>
+std::vector<T> makeSignal(const int n)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<T> x(n);
+    for (auto &v : x){v = static_cast<T> (distribution(generator));}
+    return x;
+}
+
+/// The Hann-tapered DFT magnitudes of one frame evaluated directly.
+template<typename T>
+std::vector<double> referenceFrame(const T *x, const int windowLength,
+                                   const int fftLength)
+{
+    std::vector<double> taper(windowLength);
+    double sum = 0;
+    for (int i = 0; i < windowLength; ++i)
+    {
+        taper[i] = 0.5 - 0.5*std::cos(2*std::numbers::pi*i/(windowLength - 1));
+        sum = sum + taper[i];
+    }
+    const int nFrequencies = fftLength/2 + 1;
+    std::vector<double> magnitudes(nFrequencies);
+    for (int k = 0; k < nFrequencies; ++k)
+    {
+        std::complex<double> y{0, 0};
+        for (int i = 0; i < windowLength; ++i)
+        {
+            y = y + taper[i]*static_cast<double> (x[i])
+                   *std::polar(1.0, -2*std::numbers::pi*i*k/fftLength);
+        }
+        auto scale = (k == 0 || 2*k == fftLength) ? 1/sum : 2/sum;
+        magnitudes[k] = scale*std::abs(y);
+    }
+    return magnitudes;
+}
+
+template<typename T>
+class SpectrogramTest : public ::testing::Test
+{
+};
+
+using MyTypes = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(SpectrogramTest, MyTypes);
+
+TYPED_TEST(SpectrogramTest, Initialize)
+{
+    using T = TypeParam;
+    Spectrogram<T> spectrogram;
+    EXPECT_FALSE(spectrogram.isInitialized());
+    EXPECT_THROW(spectrogram.initialize(1, 1), std::invalid_argument);
+    EXPECT_THROW(spectrogram.initialize(100, 0), std::invalid_argument);
+    EXPECT_THROW(spectrogram.initialize(100, 10,
+                                        Spectrogram<T>::Window::Hann, 64),
+                 std::invalid_argument);
+    EXPECT_THROW(spectrogram.setNumberOfThreads(0), std::invalid_argument);
+    spectrogram.setNumberOfThreads(2);
+    spectrogram.initialize(100, 25, Spectrogram<T>::Window::Blackman);
+    EXPECT_TRUE(spectrogram.isInitialized());
+    EXPECT_EQ(spectrogram.getNumberOfThreads(), 2);
+    EXPECT_EQ(spectrogram.getWindowLength(), 100);
+    EXPECT_EQ(spectrogram.getHopLength(), 25);
+    EXPECT_EQ(spectrogram.getWindow(), Spectrogram<T>::Window::Blackman);
+    EXPECT_EQ(spectrogram.getFFTLength(), 100);
+    EXPECT_EQ(spectrogram.getNumberOfFrequencies(), 51);
+    EXPECT_EQ(spectrogram.getNumberOfFrames(99), 0);
+    EXPECT_EQ(spectrogram.getNumberOfFrames(100), 1);
+    EXPECT_EQ(spectrogram.getNumberOfFrames(199), 4);
+    EXPECT_EQ(spectrogram.getNumberOfFrames(200), 5);
+    spectrogram.initialize(97, 25);
+    EXPECT_EQ(spectrogram.getFFTLength(), 100);
+    spectrogram.initialize(100, 25, Spectrogram<T>::Window::Hann, 256);
+    EXPECT_EQ(spectrogram.getFFTLength(), 256);
+    EXPECT_EQ(spectrogram.getNumberOfFrequencies(), 129);
+}
+
+TYPED_TEST(SpectrogramTest, Compute)
+{
+    using T = TypeParam;
+    constexpr int N_SAMPLES{2000};
+    constexpr int WINDOW_LENGTH{128};
+    constexpr int HOP_LENGTH{37};
+    const auto x = makeSignal<T> (N_SAMPLES);
+    auto tolerance = std::is_same_v<T, float> ? 1.e-5 : 1.e-6;
+    for (const int fftLength : {128, 150, 256})
+    {
+        for (const int nThreads : {1, 3})
+        {
+            Spectrogram<T> spectrogram;
+            spectrogram.setNumberOfThreads(nThreads);
+            spectrogram.initialize(WINDOW_LENGTH, HOP_LENGTH,
+                                   Spectrogram<T>::Window::Hann, fftLength);
+            auto nFrames = spectrogram.getNumberOfFrames(N_SAMPLES);
+            auto nFrequencies = spectrogram.getNumberOfFrequencies();
+            // An odd number of frames exercises the unpaired frame
+            const int firstFrame = 4;
+            const int nCompute = nFrames - firstFrame;
+            ASSERT_EQ(nCompute%2, 1);
+            std::vector<float> magnitudes(static_cast<size_t> (nCompute)
+                                         *nFrequencies);
+            spectrogram.compute(N_SAMPLES, x.data(), firstFrame, nCompute,
+                                magnitudes.data());
+            for (int f = 0; f < nCompute; ++f)
+            {
+                auto reference
+                    = referenceFrame(x.data() + (firstFrame + f)*HOP_LENGTH,
+                                     WINDOW_LENGTH, fftLength);
+                for (int k = 0; k < nFrequencies; ++k)
+                {
+                    EXPECT_NEAR(magnitudes[f*nFrequencies + k],
+                                reference[k], tolerance);
+                }
+            }
+            EXPECT_THROW(spectrogram.compute(N_SAMPLES, x.data(),
+                                             nFrames - 1, 2,
+                                             magnitudes.data()),
+                         std::invalid_argument);
+        }
+    }
+}
+
+TYPED_TEST(SpectrogramTest, Amplitude)
+{
+    using T = TypeParam;
+    // A sinusoid at a frequency bin reads its amplitude
+    constexpr int WINDOW_LENGTH{200};
+    const double amplitude{3};
+    const int bin{20};
+    std::vector<T> x(WINDOW_LENGTH);
+    for (int i = 0; i < WINDOW_LENGTH; ++i)
+    {
+        x[i] = static_cast<T> (amplitude*std::cos(2*std::numbers::pi*bin*i
+                                                  /WINDOW_LENGTH));
+    }
+    Spectrogram<T> spectrogram;
+    spectrogram.initialize(WINDOW_LENGTH, 1, Spectrogram<T>::Window::Boxcar);
+    std::vector<float> magnitudes(spectrogram.getNumberOfFrequencies());
+    spectrogram.compute(WINDOW_LENGTH, x.data(), 0, 1, magnitudes.data());
+    EXPECT_NEAR(magnitudes[bin], amplitude, 1.e-4);
+    EXPECT_NEAR(magnitudes[bin + 1], 0, 1.e-4);
+}
+
+TYPED_TEST(SpectrogramTest, TileCache)
+{
+    using T = TypeParam;
+    constexpr double SAMPLING_RATE{100};
+    constexpr int N_SAMPLES{6000};
+    const std::chrono::microseconds startTime{1628803598000000};
+    const auto x = makeSignal<T> (N_SAMPLES);
+    Segment<T> segment;
+    segment.setSamplingRate(SAMPLING_RATE);
+    segment.setStartTime(startTime);
+    segment.setData(N_SAMPLES, x.data());
+    Spectrogram<T> spectrogram;
+    spectrogram.initialize(200, 50);
+    auto nFrequencies = spectrogram.getNumberOfFrequencies();
+
+    SpectrogramTileCache<T> cache;
+    EXPECT_THROW(cache.setFramesPerTile(0), std::invalid_argument);
+    EXPECT_THROW(cache.setCapacity(0), std::invalid_argument);
+    cache.setFramesPerTile(10);
+    EXPECT_EQ(cache.getFramesPerTile(), 10);
+    EXPECT_THROW(static_cast<void> (cache.getTiles("UU.FORK.HHZ.01",
+                                                   Spectrogram<T> {},
+                                                   segment, startTime,
+                                                   startTime)),
+                 std::invalid_argument);
+    // 10 s from 5 s covers samples [500, 1500] and frames [7, 30]
+    auto second = std::chrono::microseconds {1000000};
+    auto tiles = cache.getTiles("UU.FORK.HHZ.01", spectrogram, segment,
+                                startTime + 5*second, startTime + 15*second);
+    ASSERT_EQ(tiles.size(), 4);
+    EXPECT_EQ(cache.size(), 4);
+    EXPECT_EQ(cache.getNumberOfComputedTiles(), 4);
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto &tile = *tiles[i];
+        EXPECT_EQ(tile.firstFrame, 10*i);
+        EXPECT_EQ(tile.nFrames, 10);
+        EXPECT_EQ(tile.nFrequencies, nFrequencies);
+        EXPECT_EQ(tile.startTime, startTime + 5*i*second);
+        EXPECT_NEAR(tile.frameInterval, 0.5, 1.e-14);
+        EXPECT_NEAR(tile.frequencySpacing, 0.5, 1.e-14);
+        std::vector<float> magnitudes(tile.magnitudes.size());
+        spectrogram.compute(N_SAMPLES, x.data(), 10*i, 10, magnitudes.data());
+        EXPECT_EQ(tile.magnitudes, magnitudes);
+    }
+    // Panning 5 s only computes the new tile
+    auto panned = cache.getTiles("UU.FORK.HHZ.01", spectrogram, segment,
+                                 startTime + 10*second, startTime + 20*second);
+    ASSERT_EQ(panned.size(), 4);
+    EXPECT_EQ(panned[0].get(), tiles[1].get());
+    EXPECT_EQ(panned[2].get(), tiles[3].get());
+    EXPECT_EQ(cache.getNumberOfComputedTiles(), 5);
+    // Other parameters or channels get their own tiles
+    Spectrogram<T> other;
+    other.initialize(200, 50, Spectrogram<T>::Window::Hann, 256);
+    auto otherTiles = cache.getTiles("UU.FORK.HHZ.01", other, segment,
+                                     startTime, startTime + second);
+    ASSERT_EQ(otherTiles.size(), 1);
+    EXPECT_EQ(otherTiles[0]->nFrequencies, 129);
+    static_cast<void> (cache.getTiles("UU.FORK.HHN.01", spectrogram, segment,
+                                      startTime, startTime + second));
+    EXPECT_EQ(cache.size(), 7);
+    EXPECT_EQ(cache.getNumberOfComputedTiles(), 7);
+    cache.erase("UU.FORK.HHN.01");
+    EXPECT_EQ(cache.size(), 6);
+    // The least recently used tiles are evicted
+    cache.setCapacity(3);
+    EXPECT_EQ(cache.size(), 3);
+    static_cast<void> (cache.getTiles("UU.FORK.HHZ.01", other, segment,
+                                      startTime, startTime + second));
+    EXPECT_EQ(cache.getNumberOfComputedTiles(), 7);
+    // Ranges outside of the segment have no tiles
+    EXPECT_TRUE(cache.getTiles("UU.FORK.HHZ.01", spectrogram, segment,
+                               startTime - 10*second,
+                               startTime - second).empty());
+    // A short tile at the end is recomputed when the segment grows
+    cache.clear();
+    cache.setFramesPerTile(10);
+    Segment<T> head;
+    head.setSamplingRate(SAMPLING_RATE);
+    head.setStartTime(startTime);
+    head.setData(1000, x.data());
+    auto end = startTime + 60*second;
+    auto headTiles = cache.getTiles("UU.FORK.HHZ.01", spectrogram, head,
+                                    startTime, end);
+    ASSERT_EQ(headTiles.size(), 2);
+    EXPECT_EQ(headTiles[1]->nFrames, 7);
+    auto grownTiles = cache.getTiles("UU.FORK.HHZ.01", spectrogram, segment,
+                                     startTime, end);
+    ASSERT_EQ(grownTiles.size(), 12);
+    EXPECT_EQ(grownTiles[0].get(), headTiles[0].get());
+    EXPECT_EQ(grownTiles[1]->nFrames, 10);
+    EXPECT_EQ(grownTiles[11]->nFrames, 7);
+    EXPECT_EQ(cache.getNumberOfComputedTiles(), 13);
+}
+
+
+TEST(FFTPlan, Cache)
+{
+    auto plan = getFFTPlan(60);
+    EXPECT_EQ(plan->size(), 60);
+    EXPECT_EQ(getFFTPlan(60).get(), plan.get());
+    // Keep 60 recently used while filling the cache
+    auto held = getFFTPlan(64);
+    for (int i = 0; i < FFT_PLAN_CACHE_CAPACITY - 1; ++i)
+    {
+        EXPECT_EQ(getFFTPlan(60).get(), plan.get());
+        static_cast<void> (getFFTPlan(100 + i));
+    }
+    // 64 was least recently used so it was evicted but is still usable
+    EXPECT_EQ(held->size(), 64);
+    EXPECT_NE(getFFTPlan(64).get(), held.get());
+    EXPECT_EQ(getFFTPlan(60).get(), plan.get());
+    std::vector<std::complex<double>> x(64, 1);
+    std::vector<std::complex<double>> y(64);
+    held->forward(x.data(), y.data());
+    EXPECT_NEAR(std::abs(y[0]), 64, 1.e-10);
+    EXPECT_NEAR(std::abs(y[1]), 0, 1.e-10);
+}
+
+}
@@ -0,0 +1,441 @@
+#include <vector>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include "qphase/processing/staLta.hpp"
+#include "qphase/processing/kernels.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/gather.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
+#include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Processing;
+using namespace QPhase::Waveforms;
+
+constexpr double SAMPLING_RATE{100};
+constexpr double SHORT_WINDOW{0.5};
+constexpr double LONG_WINDOW{5};
+
+/// @result Row-major [nChannels x leadingDimension] noise.  Channel
+///         burstChannel has a burst with 10 times the amplitude starting at
+///         sample burstStart.
+template<typename T>
+std::vector<T> makeSignals(const int nChannels, const int nSamples,
+                           const int leadingDimension,
+                           const int burstChannel = -1,
+                           const int burstStart = 0)
+{
+    std::mt19937 generator(86754);
+    std::normal_distribution<double> distribution(0, 1);
+    std::vector<T> x(nChannels*leadingDimension, 0);
+    for (int c = 0; c < nChannels; ++c)
+    {
+        auto scale = 1 + c%5;
+        for (int i = 0; i < nSamples; ++i)
+        {
+            auto amplitude = scale*distribution(generator);
+            if (c == burstChannel && i >= burstStart && i < burstStart + 100)
+            {
+                amplitude = 10*amplitude;
+            }
+            x[c*leadingDimension + i] = static_cast<T> (amplitude);
+        }
+    }
+    return x;
+}
+
+/// @result The STA/LTA of one channel computed directly from the
+///         definition.
+template<typename T>
+std::vector<double> reference(const int n, const T *x,
+                              const typename STALTA<T>::Type type)
+{
+    auto nSta = static_cast<int> (std::lround(SHORT_WINDOW*SAMPLING_RATE));
+    auto nLta = static_cast<int> (std::lround(LONG_WINDOW*SAMPLING_RATE));
+    std::vector<double> cf(n, 0);
+    std::vector<double> x2(n);
+    for (int i = 0; i < n; ++i)
+    {
+        x2[i] = static_cast<double> (x[i])*static_cast<double> (x[i]);
+    }
+    double sta{0};
+    double lta{0};
+    for (int i = 0; i < n; ++i)
+    {
+        if (type == STALTA<T>::Type::Recursive)
+        {
+            sta = x2[i]/nSta + (1 - 1./nSta)*sta;
+            lta = x2[i]/nLta + (1 - 1./nLta)*lta;
+        }
+        else
+        {
+            sta = 0;
+            lta = 0;
+            for (int j = std::max(0, i - nSta + 1); j <= i; ++j)
+            {
+                sta = sta + x2[j]/nSta;
+            }
+            for (int j = std::max(0, i - nLta + 1); j <= i; ++j)
+            {
+                lta = lta + x2[j]/nLta;
+            }
+        }
+        if (i >= nLta - 1 && lta > 0){cf[i] = sta/lta;}
+    }
+    return cf;
+}
+
+template<typename T>
+class STALTATest : public ::testing::Test
+{
+protected:
+    STALTATest() :
+        defaultInstructionSet(getInstructionSet())
+    {
+    }
+    ~STALTATest() override
+    {
+        setInstructionSet(defaultInstructionSet);
+    }
+    InstructionSet defaultInstructionSet;
+};
+
+using MyTypes = ::testing::Types<double, float>;
+TYPED_TEST_SUITE(STALTATest, MyTypes);
+
+TYPED_TEST(STALTATest, Initialize)
+{
+    using T = TypeParam;
+    STALTA<T> detector;
+    EXPECT_FALSE(detector.isInitialized());
+    EXPECT_THROW(detector.initialize(0, 100, 1, 10), std::invalid_argument);
+    EXPECT_THROW(detector.initialize(1, 0, 1, 10), std::invalid_argument);
+    EXPECT_THROW(detector.initialize(1, 100, 0.001, 10),
+                 std::invalid_argument);
+    EXPECT_THROW(detector.initialize(1, 100, 1, 1), std::invalid_argument);
+    EXPECT_THROW(detector.setTriggerThresholds(2, 3), std::invalid_argument);
+    EXPECT_THROW(detector.setTriggerThresholds(2, 0), std::invalid_argument);
+    detector.setTriggerThresholds(4, 2);
+    detector.initialize(3, SAMPLING_RATE, SHORT_WINDOW, LONG_WINDOW,
+                        STALTA<T>::Type::Classic);
+    EXPECT_TRUE(detector.isInitialized());
+    EXPECT_EQ(detector.getNumberOfChannels(), 3);
+    EXPECT_NEAR(detector.getSamplingRate(), SAMPLING_RATE, 1.e-14);
+    EXPECT_EQ(detector.getWindowLengths(), (std::pair<int, int> {50, 500}));
+    EXPECT_EQ(detector.getTriggerThresholds(),
+              (std::pair<double, double> {4, 2}));
+    auto copy = detector;
+    EXPECT_EQ(copy.getNumberOfChannels(), 3);
+    std::vector<T> x(10);
+    EXPECT_THROW(detector.process(10, 9, x.data(), x.data()),
+                 std::invalid_argument);
+    EXPECT_THROW(detector.process(10, 10, nullptr, x.data()),
+                 std::invalid_argument);
+}
+
+TYPED_TEST(STALTATest, MultiChannel)
+{
+    using T = TypeParam;
+    // Enough channels for a partial group and enough samples for the
+    // classic detector's ring to wrap several times
+    const int nChannels = 37;
+    const int nSamples = 2600;
+    const int leadingDimension = 2608;
+    auto x = makeSignals<T> (nChannels, nSamples, leadingDimension);
+    auto tolerance = std::is_same_v<T, float> ? 1.e-5 : 1.e-10;
+    for (const auto type : {STALTA<T>::Type::Recursive,
+                            STALTA<T>::Type::Classic})
+    {
+        std::vector<std::vector<double>> references;
+        for (int c = 0; c < nChannels; ++c)
+        {
+            references.push_back(
+                reference(nSamples, x.data() + c*leadingDimension, type));
+        }
+        for (const auto instructionSet : {InstructionSet::Scalar,
+                                          InstructionSet::AVX2,
+                                          InstructionSet::AVX512})
+        {
+            if (!isSupported(instructionSet)){continue;}
+            setInstructionSet(instructionSet);
+            STALTA<T> detector;
+            detector.initialize(nChannels, SAMPLING_RATE,
+                                SHORT_WINDOW, LONG_WINDOW, type);
+            std::vector<T> cf(x.size());
+            detector.process(nSamples, leadingDimension, x.data(), cf.data());
+            EXPECT_EQ(detector.getNumberOfProcessedSamples(), nSamples);
+            EXPECT_TRUE(detector.getTriggers().empty());
+            for (int c = 0; c < nChannels; ++c)
+            {
+                for (int i = 0; i < nSamples; ++i)
+                {
+                    auto value = references[c][i];
+                    EXPECT_NEAR(cf[c*leadingDimension + i], value,
+                                tolerance*std::max(1., value));
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(STALTATest, Streaming)
+{
+    using T = TypeParam;
+    const int nChannels = 20;
+    const int nSamples = 6000;
+    auto x = makeSignals<T> (nChannels, nSamples, nSamples, 17, 3000);
+    const std::chrono::microseconds t0{1628803598000000};
+    for (const auto type : {STALTA<T>::Type::Recursive,
+                            STALTA<T>::Type::Classic})
+    {
+        STALTA<T> batch;
+        batch.initialize(nChannels, SAMPLING_RATE,
+                         SHORT_WINDOW, LONG_WINDOW, type);
+        batch.reset(t0);
+        std::vector<T> cfBatch(x.size());
+        batch.process(nSamples, nSamples, x.data(), cfBatch.data());
+        batch.closeTriggers();
+        // The burst triggers only its channel
+        auto triggers = batch.getTriggers();
+        ASSERT_EQ(triggers.size(), 1);
+        EXPECT_EQ(triggers[0].channel, 17);
+        EXPECT_GE(triggers[0].onTime, t0 + std::chrono::seconds {30});
+        EXPECT_LT(triggers[0].onTime, t0 + std::chrono::milliseconds {30100});
+        EXPECT_GT(triggers[0].offTime, triggers[0].onTime);
+        EXPECT_LT(triggers[0].offTime, t0 + std::chrono::seconds {40});
+        EXPECT_GT(triggers[0].maximum, 5);
+
+        // Feed the same data in uneven chunks
+        STALTA<T> stream;
+        stream.initialize(nChannels, SAMPLING_RATE,
+                          SHORT_WINDOW, LONG_WINDOW, type);
+        stream.reset(t0);
+        std::vector<T> cfStream(x.size());
+        std::vector<T> xChunk;
+        std::vector<T> cfChunk;
+        int i0 = 0;
+        for (int chunk = 0; i0 < nSamples; ++chunk)
+        {
+            auto n = std::min(1 + (chunk*97)%613, nSamples - i0);
+            xChunk.resize(nChannels*n);
+            cfChunk.resize(nChannels*n);
+            for (int c = 0; c < nChannels; ++c)
+            {
+                std::copy(x.data() + c*nSamples + i0,
+                          x.data() + c*nSamples + i0 + n,
+                          xChunk.data() + c*n);
+            }
+            stream.process(n, n, xChunk.data(), cfChunk.data());
+            for (int c = 0; c < nChannels; ++c)
+            {
+                std::copy(cfChunk.data() + c*n, cfChunk.data() + (c + 1)*n,
+                          cfStream.data() + c*nSamples + i0);
+            }
+            i0 = i0 + n;
+        }
+        stream.closeTriggers();
+        EXPECT_EQ(cfStream, cfBatch);
+        auto streamTriggers = stream.getTriggers();
+        ASSERT_EQ(streamTriggers.size(), 1);
+        EXPECT_EQ(streamTriggers[0].onTime, triggers[0].onTime);
+        EXPECT_EQ(streamTriggers[0].offTime, triggers[0].offTime);
+        EXPECT_EQ(streamTriggers[0].maximum, triggers[0].maximum);
+        stream.clearTriggers();
+        EXPECT_TRUE(stream.getTriggers().empty());
+    }
+}
+
+TYPED_TEST(STALTATest, Gather)
+{
+    using T = TypeParam;
+    const int nStations = 3;
+    const int nSamples = 6000;
+    auto x = makeSignals<T> (nStations, nSamples, nSamples, 1, 4000);
+    const std::chrono::microseconds t0{1628803598000000};
+    std::vector<Station<T>> stations;
+    for (int s = 0; s < nStations; ++s)
+    {
+        Segment<T> segment;
+        segment.setSamplingRate(SAMPLING_RATE);
+        segment.setStartTime(t0);
+        segment.setData(nSamples, x.data() + s*nSamples);
+        Waveform<T> waveform;
+        waveform.setSegments(std::move(segment));
+        Channel<T> channel;
+        channel.setChannelCode("EHZ");
+        channel.setDip(-90);
+        channel.setWaveform(waveform);
+        SingleChannelVerticalSensor<T> sensor;
+        sensor.setVerticalChannel(channel);
+        Station<T> station;
+        station.setNetworkCode("UU");
+        station.setName("S" + std::to_string(s));
+        station.add(sensor);
+        stations.push_back(std::move(station));
+    }
+    Gather<T> gather;
+    gather.build(stations, t0,
+                 t0 + std::chrono::microseconds {(nSamples - 1)*10000},
+                 SAMPLING_RATE);
+    ASSERT_EQ(gather.getNumberOfSamples(), nSamples);
+
+    STALTA<T> detector;
+    EXPECT_THROW(auto result = detector.process(gather), std::runtime_error);
+    detector.initialize(nStations + 1, SAMPLING_RATE,
+                        SHORT_WINDOW, LONG_WINDOW);
+    EXPECT_THROW(auto result = detector.process(gather),
+                 std::invalid_argument);
+    detector.initialize(nStations, SAMPLING_RATE, SHORT_WINDOW, LONG_WINDOW);
+    auto cf = detector.process(gather);
+    EXPECT_EQ(cf.getNumberOfChannels(), nStations);
+    EXPECT_EQ(cf.getStartTime(), t0);
+    EXPECT_EQ(cf.getMetadataReference().at(1).station, "S1");
+    auto tolerance = std::is_same_v<T, float> ? 1.e-5 : 1.e-10;
+    for (int s = 0; s < nStations; ++s)
+    {
+        auto expected = reference(nSamples, x.data() + s*nSamples,
+                                  STALTA<T>::Type::Recursive);
+        auto row = cf.getRowPointer(s);
+        for (int i = 0; i < nSamples; ++i)
+        {
+            EXPECT_NEAR(row[i], expected[i],
+                        tolerance*std::max(1., expected[i]));
+        }
+    }
+    auto triggers = detector.getTriggers();
+    ASSERT_EQ(triggers.size(), 1);
+    EXPECT_EQ(triggers[0].channel, 1);
+    EXPECT_GE(triggers[0].onTime, t0 + std::chrono::seconds {40});
+}
+
+TYPED_TEST(STALTATest, GatherWithGap)
+{
+    // Channel 1 has a 60 s gap.  The averages restart after the gap so the
+    // return of the signal does not trigger.
+    using T = TypeParam;
+    const int nStations = 3;
+    const int nSamples = 12000;
+    const int gapStart = 3000;
+    const int gapEnd = 9000;
+    auto x = makeSignals<T> (nStations, nSamples, nSamples);
+    const std::chrono::microseconds t0{1628803598000000};
+    std::vector<Station<T>> stations;
+    for (int s = 0; s < nStations; ++s)
+    {
+        std::vector<Segment<T>> segments;
+        for (const auto &[i0, i1] : s == 1 ?
+                 std::vector<std::pair<int, int>> {{0, gapStart},
+                                                   {gapEnd, nSamples}} :
+                 std::vector<std::pair<int, int>> {{0, nSamples}})
+        {
+            Segment<T> segment;
+            segment.setSamplingRate(SAMPLING_RATE);
+            segment.setStartTime(t0 + std::chrono::microseconds {i0*10000});
+            segment.setData(i1 - i0, x.data() + s*nSamples + i0);
+            segments.push_back(std::move(segment));
+        }
+        Waveform<T> waveform;
+        waveform.setSegments(std::move(segments));
+        Channel<T> channel;
+        channel.setChannelCode("EHZ");
+        channel.setDip(-90);
+        channel.setWaveform(waveform);
+        SingleChannelVerticalSensor<T> sensor;
+        sensor.setVerticalChannel(channel);
+        Station<T> station;
+        station.setNetworkCode("UU");
+        station.setName("S" + std::to_string(s));
+        station.add(sensor);
+        stations.push_back(std::move(station));
+    }
+    Gather<T> gather;
+    gather.build(stations, t0,
+                 t0 + std::chrono::microseconds {(nSamples - 1)*10000},
+                 SAMPLING_RATE);
+    ASSERT_EQ(gather.getNumberOfSamples(), nSamples);
+    ASSERT_FALSE(gather.isValid(1, gapStart));
+
+    STALTA<T> detector;
+    detector.initialize(nStations, SAMPLING_RATE, SHORT_WINDOW, LONG_WINDOW);
+    auto cf = detector.process(gather);
+    auto tolerance = std::is_same_v<T, float> ? 1.e-5 : 1.e-10;
+    auto row = cf.getRowPointer(1);
+    for (const auto &[i0, i1] : {std::pair {0, gapStart},
+                                 std::pair {gapEnd, nSamples}})
+    {
+        auto expected = reference(i1 - i0, x.data() + nSamples + i0,
+                                  STALTA<T>::Type::Recursive);
+        for (int i = i0; i < i1; ++i)
+        {
+            EXPECT_NEAR(row[i], expected[i - i0],
+                        tolerance*std::max(1., expected[i - i0]));
+        }
+    }
+    for (int i = gapStart; i < gapEnd; ++i){EXPECT_EQ(row[i], 0);}
+    // The other channels are unaffected
+    auto expected = reference(nSamples, x.data() + 2*nSamples,
+                              STALTA<T>::Type::Recursive);
+    for (int i = 0; i < nSamples; ++i)
+    {
+        EXPECT_NEAR(cf.getRowPointer(2)[i], expected[i],
+                    tolerance*std::max(1., expected[i]));
+    }
+    EXPECT_TRUE(detector.getTriggers().empty());
+}
+
+TYPED_TEST(STALTATest, Waveform)
+{
+    using T = TypeParam;
+    const int nSamples = 3000;
+    auto x = makeSignals<T> (1, 2*nSamples, 2*nSamples, 0, 1000);
+    const std::chrono::microseconds t0{1628803598000000};
+    std::vector<Segment<T>> segments;
+    for (int k = 0; k < 2; ++k)
+    {
+        Segment<T> segment;
+        segment.setSamplingRate(SAMPLING_RATE);
+        segment.setStartTime(t0 + std::chrono::seconds {60*k});
+        segment.setData(nSamples, x.data() + k*nSamples);
+        segments.push_back(std::move(segment));
+    }
+    Waveform<T> waveform;
+    waveform.setSegments(segments);
+
+    STALTA<T> detector;
+    detector.initialize(2, SAMPLING_RATE, SHORT_WINDOW, LONG_WINDOW);
+    EXPECT_THROW(auto result = detector.process(waveform),
+                 std::invalid_argument);
+    detector.initialize(1, SAMPLING_RATE/2, SHORT_WINDOW, LONG_WINDOW);
+    EXPECT_THROW(auto result = detector.process(waveform),
+                 std::invalid_argument);
+    detector.initialize(1, SAMPLING_RATE, SHORT_WINDOW, LONG_WINDOW,
+                        STALTA<T>::Type::Classic);
+    auto cf = detector.process(waveform);
+    ASSERT_EQ(cf.getNumberOfSegments(), 2);
+    auto tolerance = std::is_same_v<T, float> ? 1.e-5 : 1.e-10;
+    for (int k = 0; k < 2; ++k)
+    {
+        EXPECT_EQ(cf[k].getStartTime(), segments[k].getStartTime());
+        auto expected = reference(nSamples, x.data() + k*nSamples,
+                                  STALTA<T>::Type::Classic);
+        auto data = cf[k].getData();
+        ASSERT_EQ(static_cast<int> (data.size()), nSamples);
+        for (int i = 0; i < nSamples; ++i)
+        {
+            EXPECT_NEAR(data[i], expected[i],
+                        tolerance*std::max(1., expected[i]));
+        }
+    }
+    auto triggers = detector.getTriggers();
+    ASSERT_EQ(triggers.size(), 1);
+    EXPECT_GE(triggers[0].onTime, t0 + std::chrono::seconds {10});
+    EXPECT_LT(triggers[0].offTime, t0 + std::chrono::seconds {30});
+}
+
+}
@@ -4,10 +4,17 @@
 #include <chrono>
 #include <cmath>
 #include <limits>
+#include <atomic>
+#include <thread>
 #include "qphase/waveforms/waveform.hpp"
 #include "qphase/waveforms/segment.hpp"
 #include "qphase/waveforms/channel.hpp"
 #include "qphase/waveforms/simpleResponse.hpp"
+#include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/threeChannelSensor.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
+#include "qphase/waveforms/gather.hpp"
+#include "qphase/waveforms/realTimeWaveform.hpp"
 #include <gtest/gtest.h>
 
 namespace
@@ -123,6 +130,42 @@ TYPED_TEST(SegmentTest, Segment)
     EXPECT_EQ(segmentCopy.getNumberOfSamples(), 0);
 }
 
+TYPED_TEST(SegmentTest, ExactTiming)
+{
+    const std::chrono::microseconds t0{1628803598000000};
+    Segment<TypeParam> segment;
+    segment.setStartTime(t0);
+    // A single precision SAC delta maps to an exact rate
+    segment.setSamplingRate(1./static_cast<double> (0.025f));
+    EXPECT_EQ(segment.getSamplingRateAsFraction(),
+              (std::pair<int64_t, int64_t> {40, 1}));
+    // A day of 250 sps data ends exactly a day later less one sample
+    const int nDay = 250*86400;
+    segment.setSamplingRate(250);
+    segment.setData(std::vector<TypeParam> (nDay, 0));
+    EXPECT_EQ(segment.getEndTime(),
+              t0 + std::chrono::microseconds {86400000000 - 4000});
+    // 3 sps has a non-integral microsecond period.  Rounding the period
+    // then multiplying would put the last sample 86.4 ms early.
+    const int n3 = 3*86400;
+    segment.setSamplingRate(3);
+    segment.setData(std::vector<TypeParam> (n3, 0));
+    EXPECT_EQ(segment.getEndTime(),
+              t0 + std::chrono::microseconds {86400000000 - 333333});
+    EXPECT_EQ(segment.getSampleTime(n3), t0 + std::chrono::seconds {86400});
+    EXPECT_EQ(segment.getSampleIndex(t0 + std::chrono::seconds {86400}), n3);
+    EXPECT_EQ(segment.getSampleIndex(segment.getSampleTime(12345)), 12345);
+    EXPECT_EQ(segment.getSampleIndex(segment.getSampleTime(12345)
+                                   - std::chrono::microseconds {1}), 12344);
+    EXPECT_EQ(segment.getSampleIndex(segment.getSampleTime(-7)), -7);
+    // Rational rates
+    segment.setSamplingRate(200, 6);
+    EXPECT_EQ(segment.getSamplingRateAsFraction(),
+              (std::pair<int64_t, int64_t> {100, 3}));
+    EXPECT_EQ(segment.getSampleTime(100), t0 + std::chrono::seconds {3});
+    EXPECT_THROW(segment.setSamplingRate(0, 1), std::invalid_argument);
+}
+
 //----------------------------------------------------------------------------//
 
 template<class T>
@@ -209,6 +252,407 @@ TYPED_TEST(WaveformTest, Waveform)
 }
 
 
+TYPED_TEST(WaveformTest, Merge)
+{
+    const double samplingRate{100};
+    const std::chrono::microseconds t0{1628803598000000};
+    const std::chrono::microseconds dt{10000};
+    auto makeSegment = [&](const std::chrono::microseconds &startTime,
+                           const std::vector<double> &data)
+    {
+        Segment<TypeParam> segment;
+        segment.setStartTime(startTime);
+        segment.setSamplingRate(samplingRate);
+        segment.setData(data);
+        return segment;
+    };
+    // Contiguous packets (one slightly jittered) followed by a gap
+    std::vector<Segment<TypeParam>> packets{
+        makeSegment(t0,                {1, 2, 3}),
+        makeSegment(t0 + 3*dt + std::chrono::microseconds {400}, {4, 5}),
+        makeSegment(t0 + 5*dt,         {6, 7, 8}),
+        makeSegment(t0 + 20*dt,        {20, 21})};
+    Waveform<TypeParam> waveform;
+    waveform.setSegments(packets);
+    EXPECT_EQ(waveform.getNumberOfSegments(), 4);
+    EXPECT_NO_THROW(waveform.merge());
+    EXPECT_EQ(waveform.getNumberOfSegments(), 2);
+    EXPECT_EQ(waveform.getCumulativeNumberOfSamples(), 10);
+    EXPECT_EQ(waveform[0].getNumberOfSamples(), 8);
+    EXPECT_EQ(waveform[0].getStartTime(), t0);
+    auto data = waveform[0].getData();
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_NEAR(static_cast<double> (data[i]), i + 1, 1.e-14);
+    }
+    auto gaps = waveform.getGaps();
+    ASSERT_EQ(static_cast<int> (gaps.size()), 1);
+    EXPECT_EQ(gaps[0].first,  t0 + 7*dt);
+    EXPECT_EQ(gaps[0].second, t0 + 20*dt);
+    // Overlap policies
+    std::vector<Segment<TypeParam>> overlapping{
+        makeSegment(t0,        {1, 1, 1, 1}),
+        makeSegment(t0 + 2*dt, {3, 3, 3, 3})};
+    for (const auto policy : {Waveform<TypeParam>::OverlapPolicy::KeepFirst,
+                              Waveform<TypeParam>::OverlapPolicy::KeepLast,
+                              Waveform<TypeParam>::OverlapPolicy::Average})
+    {
+        waveform.setSegments(overlapping);
+        waveform.merge(policy);
+        ASSERT_EQ(waveform.getNumberOfSegments(), 1);
+        EXPECT_TRUE(waveform.getGaps().empty());
+        data = waveform[0].getData();
+        ASSERT_EQ(static_cast<int> (data.size()), 6);
+        double overlapValue{1};
+        if (policy == Waveform<TypeParam>::OverlapPolicy::KeepLast)
+        {
+            overlapValue = 3;
+        }
+        else if (policy == Waveform<TypeParam>::OverlapPolicy::Average)
+        {
+            overlapValue = 2;
+        }
+        std::vector<double> reference{1, 1, overlapValue, overlapValue, 3, 3};
+        for (int i = 0; i < 6; ++i)
+        {
+            EXPECT_NEAR(static_cast<double> (data[i]), reference[i], 1.e-14);
+        }
+        EXPECT_EQ(waveform.getLatestTime(), t0 + 5*dt);
+    }
+    // Every overlapping segment has the same weight in the average
+    waveform.setSegments(std::vector<Segment<TypeParam>> {
+        makeSegment(t0,        {0, 0, 0, 0}),
+        makeSegment(t0 + dt,   {3, 3, 3, 3}),
+        makeSegment(t0 + 2*dt, {6, 6})});
+    waveform.merge(Waveform<TypeParam>::OverlapPolicy::Average);
+    ASSERT_EQ(waveform.getNumberOfSegments(), 1);
+    data = waveform[0].getData();
+    std::vector<double> averages{0, 1.5, 3, 3, 3};
+    ASSERT_EQ(data.size(), averages.size());
+    for (int i = 0; i < static_cast<int> (averages.size()); ++i)
+    {
+        EXPECT_NEAR(static_cast<double> (data[i]), averages[i], 1.e-6);
+    }
+    // Segments without samples are removed
+    auto empty = makeSegment(t0, {});
+    waveform.setSegments(std::vector<Segment<TypeParam>> {
+        empty, makeSegment(t0, {1, 2}), empty});
+    EXPECT_EQ(waveform.getNumberOfSegments(), 3);
+    waveform.merge();
+    ASSERT_EQ(waveform.getNumberOfSegments(), 1);
+    EXPECT_EQ(waveform[0].getNumberOfSamples(), 2);
+    // Different sampling rates are never merged
+    auto other = makeSegment(t0 + 4*dt, {5, 6});
+    other.setSamplingRate(50);
+    waveform.setSegments(std::vector<Segment<TypeParam>> {packets[0], other});
+    waveform.merge();
+    EXPECT_EQ(waveform.getNumberOfSegments(), 2);
+    EXPECT_THROW(waveform.merge(Waveform<TypeParam>::OverlapPolicy::KeepFirst,
+                                0.5), std::invalid_argument);
+    // The exact rational sampling rate survives the merge
+    const std::pair<int64_t, int64_t> exactRate{1000000007, 1000000};
+    auto first = makeSegment(t0, {1, 2, 3});
+    first.setSamplingRate(exactRate.first, exactRate.second);
+    auto second = makeSegment(first.getSampleTime(3), {4, 5});
+    second.setSamplingRate(exactRate.first, exactRate.second);
+    waveform.setSegments(std::vector<Segment<TypeParam>> {first, second});
+    waveform.merge();
+    ASSERT_EQ(waveform.getNumberOfSegments(), 1);
+    EXPECT_EQ(waveform[0].getSamplingRateAsFraction(), exactRate);
+    EXPECT_EQ(waveform[0].getSampleTime(4), first.getSampleTime(4));
+}
+
+TYPED_TEST(WaveformTest, TimeLookup)
+{
+    const double samplingRate{100};
+    const std::chrono::microseconds t0{1628803598000000};
+    const std::chrono::microseconds dt{10000};
+    std::vector<Segment<TypeParam>> segments;
+    // Segments of 10 samples every 20 samples -> gaps of 10 samples
+    for (int i = 0; i < 100; ++i)
+    {
+        Segment<TypeParam> segment;
+        segment.setStartTime(t0 + 20*i*dt);
+        segment.setSamplingRate(samplingRate);
+        segment.setData(std::vector<double> (10, i));
+        segments.push_back(std::move(segment));
+    }
+    Waveform<TypeParam> waveform;
+    waveform.setSegments(segments);
+    // Sample indexing is exact in integer microseconds
+    EXPECT_EQ(waveform[0].getSampleIndex(t0 + 3*dt), 3);
+    EXPECT_EQ(waveform[0].getSampleIndex(t0 + 3*dt - std::chrono::microseconds {1}), 2);
+    EXPECT_EQ(waveform[0].getSampleIndex(t0 - std::chrono::microseconds {1}), -1);
+    EXPECT_EQ(waveform[0].getSampleTime(7), t0 + 7*dt);
+    // Segment lookup
+    EXPECT_EQ(waveform.findSegment(t0), 0);
+    EXPECT_EQ(waveform.findSegment(t0 + 20*37*dt + 5*dt), 37);
+    EXPECT_EQ(waveform.findSegment(t0 + 20*37*dt + 15*dt), -1);
+    EXPECT_EQ(waveform.findSegment(t0 - dt), -1);
+    auto [first, last] = waveform.getSegmentIndices(t0 + 20*10*dt + 12*dt,
+                                                    t0 + 20*12*dt + 3*dt);
+    EXPECT_EQ(first, 11);
+    EXPECT_EQ(last,  13);
+    // Windowed access
+    auto windows = waveform.samplesIn(t0 + 20*10*dt + 5*dt - std::chrono::microseconds {1},
+                                      t0 + 20*11*dt + 2*dt);
+    ASSERT_EQ(static_cast<int> (windows.size()), 2);
+    EXPECT_EQ(windows[0].segment, 10);
+    EXPECT_EQ(windows[0].startIndex, 5);
+    EXPECT_EQ(windows[0].endIndex, 10);
+    EXPECT_EQ(windows[1].segment, 11);
+    EXPECT_EQ(windows[1].startIndex, 0);
+    EXPECT_EQ(windows[1].endIndex, 3);
+    EXPECT_TRUE(waveform.samplesIn(t0 + 20*5*dt + 11*dt,
+                                   t0 + 20*5*dt + 19*dt).empty());
+    EXPECT_THROW(auto w = waveform.samplesIn(t0 + dt, t0), std::invalid_argument);
+}
+
+//----------------------------------------------------------------------------//
+
+template<typename T>
+Channel<T> makeGatherChannel(const std::string &code,
+                             const std::vector<Segment<T>> &segments)
+{
+    Channel<T> channel;
+    channel.setChannelCode(code);
+    channel.setDip(code == "HHZ" ? -90 : 0);
+    Waveform<T> waveform;
+    waveform.setSegments(segments);
+    channel.setWaveform(waveform);
+    return channel;
+}
+
+template<typename T>
+Segment<T> makeGatherSegment(const std::chrono::microseconds &startTime,
+                             const double samplingRate, const int nSamples,
+                             const double offset)
+{
+    std::vector<T> x(nSamples);
+    for (int i = 0; i < nSamples; ++i){x[i] = static_cast<T> (offset + i);}
+    Segment<T> segment;
+    segment.setSamplingRate(samplingRate);
+    segment.setStartTime(startTime);
+    segment.setData(std::move(x));
+    return segment;
+}
+
+TYPED_TEST(WaveformTest, Gather)
+{
+    using T = TypeParam;
+    const std::chrono::microseconds t0{1628803598000000};
+    // Three-channel sensor at 100 sps; the north channel has a gap
+    ThreeChannelSensor<T> sensor;
+    sensor.setLocationCode("01");
+    sensor.setLatitude(40.5);
+    sensor.setVerticalChannel(
+        makeGatherChannel<T>("HHZ", {makeGatherSegment<T>(t0, 100, 1000, 0)}));
+    sensor.setNorthChannel(
+        makeGatherChannel<T>("HHN",
+            {makeGatherSegment<T>(t0, 100, 300, 1000),
+             makeGatherSegment<T>(t0 + std::chrono::microseconds {5000000},
+                                  100, 500, 2000)}));
+    sensor.setEastChannel(
+        makeGatherChannel<T>("HHE", {makeGatherSegment<T>(t0, 100, 1000, 3000)}));
+    Station<T> station1;
+    station1.setNetworkCode("UU");
+    station1.setName("BRTU");
+    station1.add(sensor);
+    // Vertical sensor at 50 sps that starts late
+    SingleChannelVerticalSensor<T> verticalSensor;
+    verticalSensor.setVerticalChannel(
+        makeGatherChannel<T>("EHZ",
+            {makeGatherSegment<T>(t0 + std::chrono::microseconds {2000000},
+                                  50, 400, 0)}));
+    Station<T> station2;
+    station2.setNetworkCode("UU");
+    station2.setName("CTU");
+    station2.add(verticalSensor);
+
+    Gather<T> gather;
+    gather.build(std::vector<Station<T>> {station1, station2},
+                 t0 + std::chrono::microseconds {1000000},
+                 t0 + std::chrono::microseconds {8000000}, 100);
+    EXPECT_EQ(gather.getNumberOfChannels(), 4);
+    EXPECT_EQ(gather.getNumberOfSamples(), 701);
+    auto lda = gather.getLeadingDimension();
+    EXPECT_GE(lda, gather.getNumberOfSamples());
+    EXPECT_EQ((lda*sizeof(T))%64, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t> (gather.getDataPointer())%64, 0);
+    const auto &metadata = gather.getMetadataReference();
+    EXPECT_EQ(metadata.at(0).channel, "HHZ");
+    EXPECT_EQ(metadata.at(1).channel, "HHN");
+    EXPECT_EQ(metadata.at(2).channel, "HHE");
+    EXPECT_EQ(metadata.at(3).channel, "EHZ");
+    EXPECT_EQ(metadata.at(0).locationCode, "01");
+    EXPECT_NEAR(metadata.at(0).latitude, 40.5, 1.e-14);
+    EXPECT_TRUE(std::isnan(metadata.at(0).longitude));
+    EXPECT_EQ(gather.findChannel("UU", "BRTU", "HHN", "01"), 1);
+    EXPECT_EQ(gather.findChannel("UU", "CTU", "EHZ", ""), 3);
+    EXPECT_EQ(gather.findChannel("UU", "CTU", "HHZ", ""), -1);
+    // Vertical channel: sample j of the gather is sample 100 + j
+    auto z = gather.getRowPointer(0);
+    EXPECT_EQ(metadata.at(0).numberOfValidSamples, 701);
+    for (int j = 0; j < 701; ++j){EXPECT_EQ(z[j], static_cast<T> (100 + j));}
+    // North channel: 1 to 2.99 s recorded, gap, then 5 to 8 s recorded
+    auto n = gather.getRowPointer(1);
+    EXPECT_EQ(metadata.at(1).numberOfValidSamples, 200 + 301);
+    EXPECT_TRUE(gather.isValid(1, 199));
+    EXPECT_FALSE(gather.isValid(1, 200));
+    EXPECT_FALSE(gather.isValid(1, 399));
+    EXPECT_TRUE(gather.isValid(1, 400));
+    EXPECT_EQ(n[199], static_cast<T> (1299));
+    EXPECT_EQ(n[200], 0);
+    EXPECT_EQ(n[400], static_cast<T> (2000));
+    // Resampled channel: a ramp remains a ramp, to within the anti-alias
+    // filter's passband ripple, away from the edges
+    auto e = gather.getRowPointer(3);
+    EXPECT_FALSE(gather.isValid(3, 99));
+    EXPECT_TRUE(gather.isValid(3, 100));
+    EXPECT_EQ(metadata.at(3).numberOfValidSamples, 601); // 2 s to 8 s
+    for (int j = 150; j < 650; ++j)
+    {
+        EXPECT_NEAR(e[j], 0.5*(j - 100), 2.e-3*(j - 100));
+    }
+}
+
+//----------------------------------------------------------------------------//
+
+template<typename T>
+std::vector<T> makeRamp(const int i0, const int n)
+{
+    std::vector<T> x(n);
+    for (int i = 0; i < n; ++i){x[i] = static_cast<T> (i0 + i);}
+    return x;
+}
+
+TYPED_TEST(WaveformTest, RealTime)
+{
+    using T = TypeParam;
+    RealTimeWaveform<T> buffer;
+    EXPECT_FALSE(buffer.isInitialized());
+    // 10 s at 100 Hz
+    buffer.initialize(100, std::chrono::seconds {10});
+    EXPECT_EQ(buffer.getCapacity(), 1001);
+    EXPECT_FALSE(buffer.haveData());
+    EXPECT_EQ(buffer.getSnapshot().getNumberOfSegments(), 0);
+    // Packets of 1 s; sample i has value i
+    const std::chrono::microseconds t0{1700000000000000};
+    auto packet = [&](const int i0, const int n, const int jitter = 0)
+    {
+        auto x = makeRamp<T>(i0, n);
+        return buffer.append(t0 + std::chrono::microseconds {i0*10000 + jitter},
+                             n, x.data());
+    };
+    EXPECT_EQ(packet(0, 100), 100);
+    EXPECT_EQ(packet(100, 100, 3000), 100); // Jitter snaps to the grid
+    EXPECT_EQ(buffer.getLatestTime(), t0 + std::chrono::microseconds {1990000});
+    // Skip a packet then send it late and send a duplicate
+    EXPECT_EQ(packet(300, 100), 100);
+    auto snapshot = buffer.getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 2);
+    EXPECT_EQ(snapshot[0].getNumberOfSamples(), 200);
+    EXPECT_EQ(snapshot[1].getStartTime(), t0 + std::chrono::seconds {3});
+    EXPECT_EQ(packet(200, 100), 100);
+    EXPECT_EQ(packet(150, 100), 0);
+    snapshot = buffer.getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    ASSERT_EQ(snapshot[0].getNumberOfSamples(), 400);
+    for (int i = 0; i < 400; ++i)
+    {
+        EXPECT_EQ(snapshot[0].getDataPointer()[i], static_cast<T> (i));
+    }
+    // Run past the retention window; the oldest samples are overwritten
+    EXPECT_EQ(packet(1000, 100), 100);
+    snapshot = buffer.getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 2);
+    EXPECT_EQ(snapshot[0].getStartTime(),
+              t0 + std::chrono::microseconds {990000});
+    EXPECT_EQ(snapshot[0].getDataPointer()[0], static_cast<T> (99));
+    EXPECT_EQ(snapshot[1].getNumberOfSamples(), 100);
+    // Too late
+    EXPECT_EQ(packet(0, 50), 0);
+    EXPECT_EQ(buffer.getNumberOfDroppedSamples(), 50);
+    // Windowed snapshot
+    snapshot = buffer.getSnapshot(t0 + std::chrono::seconds {2},
+                                  t0 + std::chrono::microseconds {2495000});
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    EXPECT_EQ(snapshot[0].getNumberOfSamples(), 50);
+    EXPECT_EQ(snapshot[0].getDataPointer()[0], static_cast<T> (200));
+    // Eviction
+    buffer.evict(t0 + std::chrono::seconds {3});
+    snapshot = buffer.getSnapshot();
+    EXPECT_EQ(snapshot[0].getStartTime(), t0 + std::chrono::seconds {3});
+    EXPECT_EQ(packet(250, 10), 0);
+    // Rate mismatch
+    Segment<T> segment;
+    segment.setSamplingRate(40);
+    segment.setStartTime(t0);
+    segment.setData(makeRamp<T>(0, 10));
+    EXPECT_THROW(buffer.append(segment), std::invalid_argument);
+}
+
+TYPED_TEST(WaveformTest, RealTimeConcurrent)
+{
+    using T = TypeParam;
+    RealTimeWaveform<T> buffer;
+    buffer.initialize(100, std::chrono::seconds {5});
+    // The writer appends a ramp of the absolute sample index; every sample a
+    // reader sees must equal its index on the grid.  The indices stay well
+    // below 2^24 so they are exact as floats.
+    constexpr int nPackets{2000};
+    constexpr int packetLength{25};
+    const std::chrono::microseconds t0{0};
+    std::atomic<bool> done{false};
+    std::atomic<int> nSnapshots{0};
+    std::thread writer([&]()
+    {
+        for (int k = 0; k < nPackets; ++k)
+        {
+            // Swap pairs of packets to exercise out of order arrival
+            auto j = (k%2 == 0 && k + 1 < nPackets) ? k + 1 :
+                     (k%2 == 1) ? k - 1 : k;
+            auto x = makeRamp<T>(j*packetLength, packetLength);
+            buffer.append(t0 + std::chrono::microseconds {j*packetLength*10000},
+                          packetLength, x.data());
+            // Let the reader take a snapshot every few packets so that reads
+            // interleave with writes
+            if (k%8 == 7)
+            {
+                auto n = nSnapshots.load();
+                while (nSnapshots.load() == n){std::this_thread::yield();}
+            }
+        }
+        done = true;
+    });
+    int nBad{0};
+    int64_t nSamples{0};
+    while (!done)
+    {
+        auto snapshot = buffer.getSnapshot();
+        for (const auto &segment : snapshot)
+        {
+            auto i0 = static_cast<int> (segment.getStartTime().count()/10000);
+            const auto x = segment.getDataPointer();
+            for (int i = 0; i < segment.getNumberOfSamples(); ++i)
+            {
+                if (x[i] != static_cast<T> (i0 + i)){nBad = nBad + 1;}
+            }
+            nSamples = nSamples + segment.getNumberOfSamples();
+        }
+        nSnapshots = nSnapshots + 1;
+    }
+    writer.join();
+    EXPECT_EQ(nBad, 0);
+    EXPECT_GE(nSnapshots.load(), nPackets/8);
+    EXPECT_GT(nSamples, 0);
+    auto snapshot = buffer.getSnapshot();
+    ASSERT_EQ(snapshot.getNumberOfSegments(), 1);
+    EXPECT_EQ(snapshot[0].getNumberOfSamples(), buffer.getCapacity());
+    EXPECT_EQ(snapshot[0].getDataPointer()[buffer.getCapacity() - 1],
+              static_cast<T> (nPackets*packetLength - 1));
+}
+
 //----------------------------------------------------------------------------//
 
 template<class T>
@@ -0,0 +1,225 @@
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <QRectF>
+#include <QThreadPool>
+#include "qphase/widgets/waveforms/channelItem.hpp"
+#include "qphase/widgets/waveforms/traceTileCache.hpp"
+#include "qphase/processing/pipeline.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Widgets::Waveforms;
+using namespace QPhase::Waveforms;
+
+constexpr int N_SAMPLES{100000};
+const std::chrono::microseconds START_TIME{1628803598000000};
+const std::chrono::microseconds SECOND{1000000};
+
+template<typename T>
+Waveform<T> makeWaveform()
+{
+    std::vector<T> samples(N_SAMPLES);
+    for (int i = 0; i < N_SAMPLES; ++i){samples[i] = static_cast<T> (i%50);}
+    Segment<T> segment;
+    segment.setSamplingRate(100);
+    segment.setStartTime(START_TIME);
+    segment.setData(samples.size(), samples.data());
+    Waveform<T> waveform;
+    waveform.setSegments(std::move(segment));
+    return waveform;
+}
+
+template<typename T>
+std::shared_ptr<const Channel<T>> makeChannel()
+{
+    auto channel = std::make_shared<Channel<T>> ();
+    channel->setChannelCode("HHZ");
+    channel->setWaveform(makeWaveform<T> ());
+    return channel;
+}
+
+TEST(WidgetsWaveforms, ChannelItemRedraw)
+{
+    const QRectF plotArea{0, 0, 800, 100};
+    auto channel = makeChannel<double> ();
+    ChannelItem<double> item(channel, plotArea);
+    EXPECT_THROW(item.setWaveform(std::shared_ptr<const Channel<double>> {}),
+                 std::invalid_argument);
+    item.waitForRedraw();
+    EXPECT_FALSE(item.isRedrawPending());
+    // Zooming faster than the lines are made only displays the last request
+    for (int i = 0; i < 50; ++i)
+    {
+        auto t0 = START_TIME + i*SECOND/10;
+        item.setAbsoluteTimeLimits(std::pair {t0, t0 + 600*SECOND - i*SECOND});
+    }
+    EXPECT_TRUE(item.isRedrawPending());
+    item.waitForRedraw();
+    EXPECT_FALSE(item.isRedrawPending());
+    // The characteristic function is drawn and removed
+    item.setCharacteristicFunction(makeWaveform<double> (),
+                                   {std::pair {START_TIME,
+                                               START_TIME + SECOND}});
+    EXPECT_TRUE(item.haveCharacteristicFunction());
+    item.waitForRedraw();
+    EXPECT_FALSE(item.isRedrawPending());
+    item.clearCharacteristicFunction();
+    EXPECT_FALSE(item.haveCharacteristicFunction());
+    item.waitForRedraw();
+    EXPECT_FALSE(item.isRedrawPending());
+    // Lines requested by a destroyed item are discarded
+    auto transientItem = std::make_unique<ChannelItem<double>> (channel,
+                                                                plotArea);
+    transientItem->setAbsoluteTimeLimits(std::pair {START_TIME,
+                                                    START_TIME + 900*SECOND});
+    transientItem.reset();
+    QThreadPool::globalInstance()->waitForDone();
+    EXPECT_EQ(channel.use_count(), 2);
+}
+
+TEST(WidgetsWaveforms, ChannelItemResize)
+{
+    auto channel = makeChannel<double> ();
+    ChannelItem<double> item(channel, QRectF{0, 0, 800, 100});
+    item.waitForRedraw();
+    // Changing the height only stretches the tiles until it settles and
+    // then they are redrawn at the new height
+    item.setGlobalShape(QRectF{0, 0, 800, 250});
+    EXPECT_EQ(item.boundingRect().height(), 250);
+    EXPECT_FALSE(item.isRedrawPending());
+    item.finishResize();
+    EXPECT_TRUE(item.isRedrawPending());
+    item.waitForRedraw();
+    item.finishResize();
+    EXPECT_FALSE(item.isRedrawPending());
+    // Vector lines are exact when stretched so are kept
+    item.setTileCacheEnabled(false);
+    item.waitForRedraw();
+    item.setGlobalShape(QRectF{0, 0, 800, 200});
+    item.finishResize();
+    EXPECT_FALSE(item.isRedrawPending());
+    item.setGlobalShape(QRectF{0, 0, 800, 250});
+    // Lines are only regenerated once a width change settles
+    item.setGlobalShape(QRectF{0, 0, 1200, 250});
+    item.setGlobalShape(QRectF{0, 0, 1400, 250});
+    EXPECT_FALSE(item.isRedrawPending());
+    item.finishResize();
+    EXPECT_TRUE(item.isRedrawPending());
+    item.waitForRedraw();
+    EXPECT_FALSE(item.isRedrawPending());
+    item.finishResize();
+    EXPECT_FALSE(item.isRedrawPending());
+}
+
+TEST(WidgetsWaveforms, ChannelItemTiles)
+{
+    auto &cache = TraceTileCache::globalInstance();
+    auto channel = makeChannel<double> ();
+    // A 25 s tile at 100 s per 1024 pixels
+    ChannelItem<double> item(channel, QRectF{0, 0, 1024, 100});
+    EXPECT_TRUE(item.isTileCacheEnabled());
+    const auto t0 = START_TIME + 200*SECOND;
+    item.setAbsoluteTimeLimits(std::pair {t0, t0 + 100*SECOND});
+    item.waitForRedraw();
+    auto nInserted = cache.getNumberOfInsertions();
+    EXPECT_GT(cache.size(), 0);
+    // Panning by a tile only renders the newly exposed strip
+    item.setAbsoluteTimeLimits(std::pair {t0 + 25*SECOND, t0 + 125*SECOND});
+    item.waitForRedraw();
+    EXPECT_GT(cache.getNumberOfInsertions(), nInserted);
+    EXPECT_LE(cache.getNumberOfInsertions(), nInserted + 2);
+    // Panning back renders nothing
+    nInserted = cache.getNumberOfInsertions();
+    item.setAbsoluteTimeLimits(std::pair {t0, t0 + 100*SECOND});
+    item.waitForRedraw();
+    EXPECT_EQ(cache.getNumberOfInsertions(), nInserted);
+    // Nor does another item showing the same channel
+    ChannelItem<double> otherItem(channel, QRectF{0, 0, 1024, 100});
+    otherItem.setAbsoluteTimeLimits(std::pair {t0, t0 + 100*SECOND});
+    otherItem.waitForRedraw();
+    EXPECT_EQ(cache.getNumberOfInsertions(), nInserted);
+    // Tiles of processed data are keyed by the processing
+    auto processed = std::make_shared<Channel<double>> (*channel);
+    QPhase::Processing::Pipeline<double> pipeline;
+    pipeline.addDemean();
+    processed->setProcessingPipeline(pipeline);
+    ChannelItem<double> processedItem(processed, QRectF{0, 0, 1024, 100});
+    processedItem.setAbsoluteTimeLimits(std::pair {t0, t0 + 100*SECOND});
+    processedItem.waitForRedraw();
+    nInserted = cache.getNumberOfInsertions();
+    processedItem.setWaveform(
+        std::shared_ptr<const Channel<double>> {processed});
+    processedItem.waitForRedraw();
+    EXPECT_EQ(cache.getNumberOfInsertions(), nInserted);
+    // Another pipeline, even one yielding the same samples, is not served
+    // the old tiles
+    pipeline.addScale(1);
+    processed->setProcessingPipeline(pipeline);
+    processedItem.setWaveform(
+        std::shared_ptr<const Channel<double>> {processed});
+    processedItem.waitForRedraw();
+    EXPECT_GT(cache.getNumberOfInsertions(), nInserted);
+    // Lines are drawn instead
+    item.setTileCacheEnabled(false);
+    EXPECT_FALSE(item.isTileCacheEnabled());
+    item.waitForRedraw();
+    EXPECT_FALSE(item.isRedrawPending());
+    EXPECT_LE(cache.getMemoryUsage(), cache.getBudget());
+}
+
+TEST(WidgetsWaveforms, ChannelItemTilesPanProcessed)
+{
+    // Noise on a trend so that every window has its own extrema and mean
+    std::mt19937 generator(4242);
+    std::normal_distribution<double> distribution(0, 1);
+    std::vector<double> samples(N_SAMPLES);
+    for (int i = 0; i < N_SAMPLES; ++i)
+    {
+        samples[i] = 1.e-3*i + distribution(generator);
+    }
+    Segment<double> segment;
+    segment.setSamplingRate(100);
+    segment.setStartTime(START_TIME);
+    segment.setData(samples.size(), samples.data());
+    Waveform<double> waveform;
+    waveform.setSegments(std::move(segment));
+    auto channel = std::make_shared<Channel<double>> ();
+    channel->setChannelCode("HHZ");
+    channel->setWaveform(waveform);
+    QPhase::Processing::Pipeline<double> pipeline;
+    pipeline.addDemean();
+    pipeline.addNormalize();
+    channel->setProcessingPipeline(pipeline);
+
+    auto &cache = TraceTileCache::globalInstance();
+    ChannelItem<double> item(std::shared_ptr<const Channel<double>> {channel},
+                             QRectF{0, 0, 1024, 100});
+    const auto t0 = START_TIME + 200*SECOND;
+    item.setAbsoluteTimeLimits(std::pair {t0, t0 + 100*SECOND});
+    item.waitForRedraw();
+    // Panning by a tile reuses the tiles that remain in view
+    auto nInserted = cache.getNumberOfInsertions();
+    item.setAbsoluteTimeLimits(std::pair {t0 + 25*SECOND, t0 + 125*SECOND});
+    item.waitForRedraw();
+    EXPECT_GT(cache.getNumberOfInsertions(), nInserted);
+    EXPECT_LE(cache.getNumberOfInsertions(), nInserted + 2);
+    nInserted = cache.getNumberOfInsertions();
+    item.setAbsoluteTimeLimits(std::pair {t0 + 50*SECOND, t0 + 150*SECOND});
+    item.waitForRedraw();
+    EXPECT_LE(cache.getNumberOfInsertions(), nInserted + 2);
+    // Panning back renders nothing
+    nInserted = cache.getNumberOfInsertions();
+    item.setAbsoluteTimeLimits(std::pair {t0, t0 + 100*SECOND});
+    item.waitForRedraw();
+    EXPECT_EQ(cache.getNumberOfInsertions(), nInserted);
+}
+
+}
@@ -1,17 +1,22 @@
 #include <QColor>
+#include <QImage>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <chrono>
 #include <cmath>
 #include <limits>
+#include <random>
 #include "qphase/widgets/colorMaps/parula.hpp"
+#include "qphase/widgets/colorMaps/lookupTable.hpp"
+#include "qphase/processing/kernels.hpp"
 #include <gtest/gtest.h>
 
 namespace
 {
 
 using namespace QPhase::Widgets::ColorMaps;
+using namespace QPhase::Processing;
 
 TEST(WidgetsColorMaps, Parula)
 {
@@ -57,4 +62,85 @@ TEST(WidgetsColorMaps, Parula)
     EXPECT_EQ(c999uNearest, parula.evaluate(x999u));
 }
 
+TEST(WidgetsColorMaps, LookupTable)
+{
+    const std::pair<double, double> range{-2, 2};
+    Parula parula;
+    LookupTable table;
+    EXPECT_THROW(table.initialize(parula), std::invalid_argument);
+    parula.initialize(range, InterpolationMethod::Linear);
+    EXPECT_THROW(table.initialize(parula, 1), std::invalid_argument);
+    EXPECT_NO_THROW(table.initialize(parula, 1025));
+    EXPECT_TRUE(table.isInitialized());
+    EXPECT_EQ(table.getNumberOfColors(), 1025);
+    EXPECT_EQ(table.getRange(), range);
+    // The samples are exact and values round to the nearest sample
+    const double dx = (range.second - range.first)/1024;
+    for (const int i : {0, 1, 100, 409, 410, 1023, 1024})
+    {
+        auto color = parula.evaluate(range.first + i*dx).rgba();
+        EXPECT_EQ(table.evaluate(range.first + i*dx), color);
+        EXPECT_EQ(table.evaluate(range.first + (i + 0.4)*dx),
+                  i < 1024 ? color :
+                  parula.evaluate(range.second).rgba());
+        EXPECT_EQ(table.evaluate(range.first + (i - 0.4)*dx),
+                  i > 0 ? color : parula.evaluate(range.first).rgba());
+    }
+    EXPECT_EQ(table.evaluate(range.first - 1),
+              parula.evaluate(range.first).rgba());
+    EXPECT_EQ(table.evaluate(range.second + 1),
+              parula.evaluate(range.second).rgba());
+    EXPECT_EQ(table.evaluate(std::numeric_limits<double>::quiet_NaN()), 0);
+
+    // The vectorized kernels match the scalar lookup
+    std::mt19937 generator(4096);
+    std::uniform_real_distribution<float> distribution(-2.5, 2.5);
+    std::vector<float> values(1001);
+    for (auto &v : values){v = distribution(generator);}
+    values[3] = std::numeric_limits<float>::quiet_NaN();
+    values[20] = std::numeric_limits<float>::infinity();
+    values[21] =-std::numeric_limits<float>::infinity();
+    values[22] = static_cast<float> (range.second);
+    std::vector<QRgb> reference(values.size());
+    for (int i = 0; i < static_cast<int> (values.size()); ++i)
+    {
+        reference[i] = table.evaluate(values[i]);
+    }
+    auto defaultInstructionSet = getInstructionSet();
+    for (const auto instructionSet : {InstructionSet::Scalar,
+                                      InstructionSet::AVX2,
+                                      InstructionSet::AVX512})
+    {
+        if (!isSupported(instructionSet)){continue;}
+        setInstructionSet(instructionSet);
+        std::vector<QRgb> colors(values.size(), 1);
+        table.evaluate(static_cast<int> (values.size()), values.data(),
+                       colors.data());
+        EXPECT_EQ(colors, reference);
+        // Scanlines
+        QImage image(static_cast<int> (values.size()) + 5, 3,
+                     QImage::Format_ARGB32);
+        image.fill(qRgba(1, 2, 3, 4));
+        table.fillScanLine(static_cast<int> (values.size()), values.data(),
+                           1, &image);
+        const auto *row = reinterpret_cast<const QRgb *> (image.scanLine(1));
+        for (int i = 0; i < static_cast<int> (values.size()); ++i)
+        {
+            EXPECT_EQ(row[i], reference[i]);
+        }
+        EXPECT_EQ(row[values.size()], qRgba(1, 2, 3, 4));
+        EXPECT_EQ(reinterpret_cast<const QRgb *> (image.scanLine(0))[0],
+                  qRgba(1, 2, 3, 4));
+        EXPECT_THROW(table.fillScanLine(1, values.data(), 3, &image),
+                     std::invalid_argument);
+        EXPECT_THROW(table.fillScanLine(image.width() + 1, values.data(), 0,
+                                        &image),
+                     std::invalid_argument);
+        QImage indexed(10, 1, QImage::Format_Indexed8);
+        EXPECT_THROW(table.fillScanLine(1, values.data(), 0, &indexed),
+                     std::invalid_argument);
+    }
+    setInstructionSet(defaultInstructionSet);
+}
+
 }
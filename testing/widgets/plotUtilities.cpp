@@ -0,0 +1,76 @@
+#include <chrono>
+#include <vector>
+#include "private/plotUtilities.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Waveforms;
+
+const std::chrono::microseconds START_TIME{1628803598000000};
+const std::chrono::microseconds SECOND{1000000};
+
+/// 1000 s sampled at 100 Hz
+Waveform<double> makeWaveform()
+{
+    std::vector<double> samples(100000);
+    for (int i = 0; i < static_cast<int> (samples.size()); ++i)
+    {
+        samples[i] = i%10;
+    }
+    Segment<double> segment;
+    segment.setSamplingRate(100);
+    segment.setStartTime(START_TIME);
+    segment.setData(samples.size(), samples.data());
+    Waveform<double> waveform;
+    waveform.setSegments(std::move(segment));
+    return waveform;
+}
+
+TEST(WidgetsWaveforms, CreateLines)
+{
+    auto waveform = makeWaveform();
+    WaveformLines lines;
+    const std::pair<double, double> range{0, 9};
+    // Sparse samples are drawn as one polyline through the samples
+    createLines(waveform, START_TIME, START_TIME + SECOND,
+                800, 100, 1.0, &range, &lines);
+    ASSERT_EQ(lines.nSegments, 1);
+    EXPECT_TRUE(lines.segments[0].lines.isEmpty());
+    ASSERT_EQ(lines.segments[0].polyline.size(), 101);
+    EXPECT_NEAR(lines.segments[0].polyline[0].x(), 0, 1.e-6);
+    EXPECT_NEAR(lines.segments[0].polyline[0].y(), 100, 1.e-6);
+    EXPECT_NEAR(lines.segments[0].polyline[9].y(), 0, 1.e-6);
+    EXPECT_NEAR(lines.segments[0].polyline[100].x(), 800, 1.e-6);
+    // Dense samples are drawn as a line per pixel
+    createLines(waveform, START_TIME, START_TIME + 600*SECOND,
+                800, 100, 1.0, &range, &lines);
+    ASSERT_EQ(lines.nSegments, 1);
+    EXPECT_TRUE(lines.segments[0].polyline.isEmpty());
+    EXPECT_EQ(lines.segments[0].lines.size(), 800);
+    // Zooming refills the same buffers
+    const auto *linesData = lines.segments[0].lines.data();
+    const auto *segmentsData = lines.segments.data();
+    for (int i = 1; i < 50; ++i)
+    {
+        createLines(waveform, START_TIME, START_TIME + (600 - i)*SECOND,
+                    800, 100, 0.95, &range, &lines);
+        EXPECT_EQ(lines.segments[0].lines.size(), 800);
+    }
+    createLines(waveform, START_TIME, START_TIME + 2*SECOND,
+                800, 100, 0.95, &range, &lines);
+    createLines(waveform, START_TIME, START_TIME + 300*SECOND,
+                400, 100, 0.95, &range, &lines);
+    EXPECT_EQ(lines.segments[0].lines.size(), 400);
+    EXPECT_EQ(lines.segments[0].lines.data(), linesData);
+    EXPECT_EQ(lines.segments.data(), segmentsData);
+    // Nothing in the plot
+    createLines(waveform, START_TIME - 10*SECOND, START_TIME - SECOND,
+                800, 100, 0.95, &range, &lines);
+    EXPECT_EQ(lines.nSegments, 0);
+}
+
+}
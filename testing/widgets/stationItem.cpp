@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <QRectF>
+#include <QThreadPool>
+#include "qphase/widgets/waveforms/stationItem.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
+#include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/threeChannelSensor.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+/// The bytes requested from operator new while counting.  These are per
+/// thread so the redraws started on the worker pool are not counted.
+thread_local bool countAllocations{false};
+thread_local int64_t allocatedBytes{0};
+
+void *allocate(const std::size_t size)
+{
+    if (countAllocations)
+    {
+        allocatedBytes = allocatedBytes + static_cast<int64_t> (size);
+    }
+    auto pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr){throw std::bad_alloc{};}
+    return pointer;
+}
+
+/// Counts the bytes the calling thread allocates while it is in scope.
+class AllocationCounter
+{
+public:
+    AllocationCounter()
+    {
+        allocatedBytes = 0;
+        countAllocations = true;
+    }
+    ~AllocationCounter()
+    {
+        countAllocations = false;
+    }
+    [[nodiscard]] int64_t getBytes() const noexcept
+    {
+        return allocatedBytes;
+    }
+};
+}
+
+void *operator new(std::size_t size){return allocate(size);}
+void *operator new[](std::size_t size){return allocate(size);}
+void operator delete(void *pointer) noexcept{std::free(pointer);}
+void operator delete[](void *pointer) noexcept{std::free(pointer);}
+void operator delete(void *pointer, std::size_t) noexcept{std::free(pointer);}
+void operator delete[](void *pointer, std::size_t) noexcept{std::free(pointer);}
+
+namespace
+{
+
+using namespace QPhase::Widgets::Waveforms;
+using namespace QPhase::Waveforms;
+
+constexpr int N_SAMPLES{200000};
+const std::chrono::microseconds START_TIME{1628803598000000};
+
+Channel<double> makeChannel(const std::string &code)
+{
+    std::vector<double> samples(N_SAMPLES);
+    for (int i = 0; i < N_SAMPLES; ++i){samples[i] = i%100;}
+    Segment<double> segment;
+    segment.setSamplingRate(100);
+    segment.setStartTime(START_TIME);
+    segment.setData(samples.size(), samples.data());
+    Waveform<double> waveform;
+    waveform.setSegments(std::move(segment));
+    Channel<double> channel;
+    channel.setChannelCode(code);
+    channel.setWaveform(waveform);
+    return channel;
+}
+
+/// A station with four channels
+std::shared_ptr<std::vector<Station<double>>> makeStations()
+{
+    ThreeChannelSensor<double> sensor;
+    sensor.setVerticalChannel(makeChannel("HHZ"));
+    sensor.setNorthChannel(makeChannel("HHN"));
+    sensor.setEastChannel(makeChannel("HHE"));
+    sensor.setLocationCode("01");
+    SingleChannelVerticalSensor<double> single;
+    single.setVerticalChannel(makeChannel("EHZ"));
+    Station<double> station;
+    station.setNetworkCode("UU");
+    station.setName("FORK");
+    station.add(std::move(sensor));
+    station.add(std::move(single));
+    auto stations = std::make_shared<std::vector<Station<double>>> ();
+    stations->push_back(std::move(station));
+    return stations;
+}
+
+TEST(WidgetsWaveforms, StationItemSharesSamples)
+{
+    auto stations = makeStations();
+    constexpr int64_t sampleBytes{4*N_SAMPLES*sizeof(double)};
+    const QRectF plotArea{0, 0, 800, 600};
+    // Building the items from a shared station allocates no sample memory
+    {
+        std::shared_ptr<const Station<double>> station(stations,
+                                                       &stations->at(0));
+        int64_t bytes{0};
+        std::unique_ptr<StationItem> item;
+        {
+            AllocationCounter counter;
+            item = std::make_unique<StationItem> (station, plotArea);
+            bytes = counter.getBytes();
+        }
+        EXPECT_EQ(item->getNumberOfChannels(), 4);
+        EXPECT_EQ(item->getName().toStdString(), "UU.FORK");
+        EXPECT_LT(bytes, N_SAMPLES*static_cast<int64_t> (sizeof(double)));
+        // The channel items keep the station alive
+        EXPECT_GT(stations.use_count(), 2);
+        item.reset();
+        QThreadPool::globalInstance()->waitForDone();
+        EXPECT_EQ(stations.use_count(), 2);
+    }
+    EXPECT_EQ(stations.use_count(), 1);
+    // Whereas a station passed by reference is copied once
+    {
+        int64_t bytes{0};
+        std::unique_ptr<StationItem> item;
+        {
+            AllocationCounter counter;
+            item = std::make_unique<StationItem> (stations->at(0), plotArea);
+            bytes = counter.getBytes();
+        }
+        EXPECT_EQ(item->getNumberOfChannels(), 4);
+        EXPECT_GE(bytes, sampleBytes);
+        EXPECT_LT(bytes, 2*sampleBytes);
+    }
+    EXPECT_THROW(StationItem(std::shared_ptr<const Station<double>> {},
+                             plotArea),
+                 std::invalid_argument);
+}
+
+}
@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <QGraphicsSceneWheelEvent>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QTest>
+#include <QThreadPool>
+#include "qphase/widgets/waveforms/stationScene.hpp"
+#include "qphase/widgets/waveforms/channelItem.hpp"
+#include "qphase/waveforms/channel.hpp"
+#include "qphase/waveforms/segment.hpp"
+#include "qphase/waveforms/singleChannelVerticalSensor.hpp"
+#include "qphase/waveforms/station.hpp"
+#include "qphase/waveforms/waveform.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Widgets::Waveforms;
+using namespace QPhase::Waveforms;
+
+const std::chrono::microseconds START_TIME{1628803598000000};
+
+/// Stations with one vertical channel each
+std::shared_ptr<std::vector<Station<double>>>
+    makeStations(const int nStations)
+{
+    std::vector<double> samples(1000);
+    for (int i = 0; i < static_cast<int> (samples.size()); ++i)
+    {
+        samples[i] = i%10;
+    }
+    auto stations = std::make_shared<std::vector<Station<double>>> ();
+    for (int is = 0; is < nStations; ++is)
+    {
+        Segment<double> segment;
+        segment.setSamplingRate(100);
+        segment.setStartTime(START_TIME);
+        segment.setData(samples.size(), samples.data());
+        Waveform<double> waveform;
+        waveform.setSegments(std::move(segment));
+        Channel<double> channel;
+        channel.setChannelCode("HHZ");
+        channel.setWaveform(std::move(waveform));
+        SingleChannelVerticalSensor<double> sensor;
+        sensor.setVerticalChannel(std::move(channel));
+        Station<double> station;
+        station.setNetworkCode("UU");
+        station.setName("S" + std::to_string(is));
+        station.add(std::move(sensor));
+        stations->push_back(std::move(station));
+    }
+    return stations;
+}
+
+/// @result The number of channel items after scrolling through the scene.
+int scrollThrough(const int nStations)
+{
+    auto stations = makeStations(nStations);
+    StationScene scene(800, 100);
+    scene.setVirtualized(true);
+    scene.setAbsoluteTimeLimits(std::pair {START_TIME,
+                                           START_TIME + std::chrono::seconds {10}});
+    scene.setStations(stations);
+    scene.resize(QSize(800, 900));
+    int nItems = scene.getNumberOfChannelItems();
+    // Scroll a page at a time
+    for (int row = 0; row < nStations; row = row + 9)
+    {
+        scene.setVisibleRectangle(QRectF(0, row*100, 800, 900));
+        nItems = std::max(nItems, scene.getNumberOfChannelItems());
+    }
+    QThreadPool::globalInstance()->waitForDone();
+    return nItems;
+}
+
+TEST(WidgetsWaveforms, VirtualizedStationScene)
+{
+    // Nine rows are visible plus a margin above and below
+    auto nItems = scrollThrough(100);
+    EXPECT_GT(nItems, 9);
+    EXPECT_LE(nItems, 20);
+    EXPECT_LE(scrollThrough(20), nItems);
+    EXPECT_EQ(scrollThrough(5000), nItems);
+    // Without virtualization every channel has an item
+    auto stations = makeStations(30);
+    StationScene scene(800, 100);
+    scene.setStations(stations);
+    scene.resize(QSize(800, 900));
+    EXPECT_FALSE(scene.isVirtualized());
+    EXPECT_EQ(scene.getNumberOfChannelItems(), 30);
+    scene.setVirtualized(true);
+    EXPECT_LT(scene.getNumberOfChannelItems(), 30);
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+/// Exposes the wheel handler
+class WheelStationScene : public StationScene
+{
+public:
+    using StationScene::StationScene;
+    using StationScene::wheelEvent;
+};
+
+/// @result The channel items showing rows.
+std::vector<ChannelItem<double> *> getChannelItems(const StationScene &scene)
+{
+    std::vector<ChannelItem<double> *> channelItems;
+    for (auto item : scene.items())
+    {
+        auto channelItem = dynamic_cast<ChannelItem<double> *> (item);
+        if (channelItem != nullptr && channelItem->isVisible())
+        {
+            channelItems.push_back(channelItem);
+        }
+    }
+    return channelItems;
+}
+
+TEST(WidgetsWaveforms, ResizeStationScene)
+{
+    auto stations = makeStations(30);
+    for (bool virtualized : {false, true})
+    {
+        StationScene scene(800, 100);
+        scene.setVirtualized(virtualized);
+        scene.setStations(stations);
+        scene.resize(QSize(800, 900));
+        // Let the first resize settle
+        QTest::qWait(300);
+        auto items = scene.items();
+        std::set<QGraphicsItem *> before(items.begin(), items.end());
+        auto channelItems = getChannelItems(scene);
+        ASSERT_FALSE(channelItems.empty());
+        for (auto &channelItem : channelItems){channelItem->waitForRedraw();}
+        // Resizing keeps the existing items and only stretches their lines
+        scene.resize(QSize(1000, 900));
+        scene.resize(QSize(1200, 900));
+        items = scene.items();
+        std::set<QGraphicsItem *> after(items.begin(), items.end());
+        EXPECT_EQ(before, after);
+        EXPECT_EQ(scene.sceneRect().width(), 1200);
+        QTest::qWait(50);
+        for (auto &channelItem : channelItems)
+        {
+            EXPECT_FALSE(channelItem->isRedrawPending());
+        }
+        // Once the resize settles the lines are regenerated
+        QTest::qWait(300);
+        for (auto &channelItem : channelItems)
+        {
+            EXPECT_TRUE(channelItem->isRedrawPending());
+            channelItem->waitForRedraw();
+        }
+        QThreadPool::globalInstance()->waitForDone();
+    }
+}
+
+/// Zooms in with a burst of wheel deltas.
+void zoom(WheelStationScene *scene)
+{
+    for (int i = 0; i < 20; ++i)
+    {
+        QGraphicsSceneWheelEvent event(QEvent::GraphicsSceneWheel);
+        event.setScenePos(QPointF(400, 50));
+        event.setModifiers(Qt::ControlModifier);
+        event.setDelta(120);
+        scene->wheelEvent(&event);
+        EXPECT_TRUE(event.isAccepted());
+    }
+}
+
+TEST(WidgetsWaveforms, StationSceneWheelScheduling)
+{
+    auto stations = makeStations(30);
+    WheelStationScene scene(800, 100);
+    scene.setVirtualized(true);
+    scene.setStations(stations);
+    scene.resize(QSize(800, 900));
+    scene.setVisibleRectangle(QRectF(0, 0, 800, 900));
+    scene.setAbsoluteTimeLimits(std::pair {START_TIME,
+                                           START_TIME + std::chrono::seconds {10}});
+    EXPECT_FALSE(scene.isTimeLimitUpdatePending());
+    // The rows in view and those in the margin below it
+    auto channelItems = getChannelItems(scene);
+    std::vector<ChannelItem<double> *> inView;
+    std::vector<ChannelItem<double> *> outOfView;
+    for (auto &channelItem : channelItems)
+    {
+        channelItem->waitForRedraw();
+        if (channelItem->scenePos().y() < 900)
+        {
+            inView.push_back(channelItem);
+        }
+        else
+        {
+            outOfView.push_back(channelItem);
+        }
+    }
+    ASSERT_FALSE(inView.empty());
+    ASSERT_GE(outOfView.size(), 2);
+    // A burst of wheel deltas only records the new time limits
+    scene.setFrameBudget(std::chrono::microseconds {0});
+    zoom(&scene);
+    EXPECT_TRUE(scene.isTimeLimitUpdatePending());
+    for (auto &channelItem : channelItems)
+    {
+        EXPECT_FALSE(channelItem->isRedrawPending());
+    }
+    // The first frame updates every row in view but, without a budget, only
+    // one row out of view
+    ASSERT_TRUE(QTest::qWaitFor([&inView]()
+                                {
+                                    return inView.front()->isRedrawPending();
+                                }, 1000));
+    for (auto &channelItem : inView)
+    {
+        EXPECT_TRUE(channelItem->isRedrawPending());
+    }
+    auto nUpdated = std::count_if(outOfView.begin(), outOfView.end(),
+                                  [](const ChannelItem<double> *channelItem)
+                                  {
+                                      return channelItem->isRedrawPending();
+                                  });
+    EXPECT_GE(nUpdated, 1);
+    EXPECT_LT(nUpdated, static_cast<int64_t> (outOfView.size()));
+    EXPECT_TRUE(scene.isTimeLimitUpdatePending());
+    // The rows out of view catch up in the following frames
+    EXPECT_TRUE(QTest::qWaitFor([&scene]()
+                                {
+                                    return !scene.isTimeLimitUpdatePending();
+                                }, 5000));
+    for (auto &channelItem : channelItems)
+    {
+        EXPECT_TRUE(channelItem->isRedrawPending());
+        channelItem->waitForRedraw();
+    }
+    // Flushing updates every item at once
+    zoom(&scene);
+    EXPECT_TRUE(scene.isTimeLimitUpdatePending());
+    scene.flushTimeLimits();
+    EXPECT_FALSE(scene.isTimeLimitUpdatePending());
+    for (auto &channelItem : channelItems)
+    {
+        EXPECT_TRUE(channelItem->isRedrawPending());
+        channelItem->waitForRedraw();
+    }
+    // Setting the limits directly supersedes a scheduled update
+    QGraphicsSceneWheelEvent event(QEvent::GraphicsSceneWheel);
+    event.setModifiers(Qt::ShiftModifier);
+    event.setDelta(-120);
+    scene.wheelEvent(&event);
+    EXPECT_TRUE(scene.isTimeLimitUpdatePending());
+    scene.setAbsoluteTimeLimits(std::pair {START_TIME,
+                                           START_TIME + std::chrono::seconds {5}});
+    EXPECT_FALSE(scene.isTimeLimitUpdatePending());
+    EXPECT_EQ(scene.getFrameBudget(), std::chrono::microseconds {0});
+    EXPECT_THROW(scene.setFrameBudget(std::chrono::microseconds {-1}),
+                 std::invalid_argument);
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+}
@@ -0,0 +1,75 @@
+#include <memory>
+#include <QImage>
+#include "qphase/widgets/waveforms/traceTileCache.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using namespace QPhase::Widgets::Waveforms;
+
+std::shared_ptr<const QImage> makeTile()
+{
+    return std::make_shared<QImage> (256, 100,
+                                     QImage::Format_ARGB32_Premultiplied);
+}
+
+TEST(WidgetsWaveforms, TraceTileCache)
+{
+    TraceTileCache cache;
+    const int64_t tileBytes{256*100*4};
+    cache.setBudget(3*tileBytes);
+    EXPECT_EQ(cache.getBudget(), 3*tileBytes);
+    EXPECT_THROW(cache.setBudget(0), std::invalid_argument);
+    EXPECT_THROW(cache.insert(TraceTileCache::Key {}, nullptr),
+                 std::invalid_argument);
+    // Sources are identified for as long as they are alive
+    auto data = std::make_shared<int> (1);
+    auto otherData = std::make_shared<int> (2);
+    auto source = cache.getSourceIdentifier(data);
+    EXPECT_EQ(cache.getSourceIdentifier(data), source);
+    EXPECT_NE(cache.getSourceIdentifier(otherData), source);
+    TraceTileCache::Key key;
+    key.source = source;
+    key.microSecondsPerPixel = 100;
+    key.height = 100;
+    key.heightFraction = 0.95;
+    key.maximum = 1;
+    for (int tile = 0; tile < 3; ++tile)
+    {
+        key.tile = tile;
+        cache.insert(key, makeTile());
+    }
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_EQ(cache.getMemoryUsage(), 3*tileBytes);
+    // Another scale or amplitude range is another tile
+    auto otherKey = key;
+    otherKey.microSecondsPerPixel = 50;
+    EXPECT_EQ(cache.find(otherKey), nullptr);
+    otherKey = key;
+    otherKey.maximum = 2;
+    EXPECT_EQ(cache.find(otherKey), nullptr);
+    // So is other processing
+    otherKey = key;
+    otherKey.processing = 7;
+    EXPECT_EQ(cache.find(otherKey), nullptr);
+    // Exceeding the budget evicts the least recently used tile
+    key.tile = 0;
+    EXPECT_NE(cache.find(key), nullptr);
+    key.tile = 3;
+    cache.insert(key, makeTile());
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_LE(cache.getMemoryUsage(), cache.getBudget());
+    key.tile = 1;
+    EXPECT_EQ(cache.find(key), nullptr);
+    key.tile = 0;
+    EXPECT_NE(cache.find(key), nullptr);
+    EXPECT_EQ(cache.getNumberOfInsertions(), 4);
+    cache.setBudget(tileBytes);
+    EXPECT_EQ(cache.size(), 1);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.getMemoryUsage(), 0);
+}
+
+}